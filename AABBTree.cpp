@@ -0,0 +1,508 @@
+#include "AABBTree.h"
+#include<algorithm>
+#include<cfloat>
+
+static float SurfaceArea(XMVECTOR min, XMVECTOR max)
+{
+	XMFLOAT3 size;
+	XMStoreFloat3(&size, max - min);
+	return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+static bool BoxesOverlap(const XMFLOAT3& minA, const XMFLOAT3& maxA, const XMFLOAT3& minB, const XMFLOAT3& maxB)
+{
+	return minA.x <= maxB.x && minB.x <= maxA.x &&
+		minA.y <= maxB.y && minB.y <= maxA.y &&
+		minA.z <= maxB.z && minB.z <= maxA.z;
+}
+
+static bool SphereOverlapsBox(const XMFLOAT3& center, float radiusSq, const XMFLOAT3& min, const XMFLOAT3& max)
+{
+	XMVECTOR c = XMLoadFloat3(&center);
+	XMVECTOR closest = XMVectorClamp(c, XMLoadFloat3(&min), XMLoadFloat3(&max));
+	return XMVectorGetX(XMVector3LengthSq(closest - c)) <= radiusSq;
+}
+
+//slab test, returns the distance at which the ray enters the box
+static bool RayOverlapsBox(const XMFLOAT3& origin, const XMFLOAT3& invDirection, float maxDistance,
+	const XMFLOAT3& min, const XMFLOAT3& max, float& entry)
+{
+	float tMin = 0.0f;
+	float tMax = maxDistance;
+
+	const float* o = &origin.x;
+	const float* inv = &invDirection.x;
+	const float* bMin = &min.x;
+	const float* bMax = &max.x;
+	for (int i = 0; i < 3; i++)
+	{
+		float t1 = (bMin[i] - o[i]) * inv[i];
+		float t2 = (bMax[i] - o[i]) * inv[i];
+		if (t1 > t2) std::swap(t1, t2);
+		if (t1 > tMin) tMin = t1;
+		if (t2 < tMax) tMax = t2;
+		if (tMin > tMax)
+			return false;
+	}
+
+	entry = tMin;
+	return true;
+}
+
+AABBTree::AABBTree(float margin)
+{
+	this->margin = margin;
+	root = -1;
+	freeList = -1;
+	proxyCount = 0;
+}
+
+int AABBTree::CreateProxy(XMFLOAT3 min, XMFLOAT3 max, void* userData)
+{
+	int proxy = AllocateNode();
+	Node& node = nodes[proxy];
+
+	XMVECTOR fat = XMVectorReplicate(margin);
+	XMStoreFloat3(&node.min, XMLoadFloat3(&min) - fat);
+	XMStoreFloat3(&node.max, XMLoadFloat3(&max) + fat);
+	node.tightMin = min;
+	node.tightMax = max;
+	node.userData = userData;
+	node.height = 0;
+
+	InsertLeaf(proxy);
+	proxyCount++;
+
+	return proxy;
+}
+
+void AABBTree::DestroyProxy(int proxy)
+{
+	if (proxy < 0 || proxy >= (int)nodes.size() || !nodes[proxy].IsLeaf() || nodes[proxy].height != 0)
+		return;
+
+	RemoveLeaf(proxy);
+	FreeNode(proxy);
+	proxyCount--;
+}
+
+bool AABBTree::MoveProxy(int proxy, XMFLOAT3 min, XMFLOAT3 max)
+{
+	Node& node = nodes[proxy];
+	node.tightMin = min;
+	node.tightMax = max;
+
+	//still inside the fat box, the tree doesn't need to change
+	if (node.min.x <= min.x && node.min.y <= min.y && node.min.z <= min.z &&
+		max.x <= node.max.x && max.y <= node.max.y && max.z <= node.max.z)
+	{
+		return false;
+	}
+
+	RemoveLeaf(proxy);
+
+	XMVECTOR fat = XMVectorReplicate(margin);
+	XMStoreFloat3(&nodes[proxy].min, XMLoadFloat3(&min) - fat);
+	XMStoreFloat3(&nodes[proxy].max, XMLoadFloat3(&max) + fat);
+
+	InsertLeaf(proxy);
+	return true;
+}
+
+void AABBTree::Clear()
+{
+	nodes.clear();
+	root = -1;
+	freeList = -1;
+	proxyCount = 0;
+}
+
+void* AABBTree::GetUserData(int proxy)
+{
+	return nodes[proxy].userData;
+}
+
+int AABBTree::GetProxyCount()
+{
+	return proxyCount;
+}
+
+int AABBTree::GetHeight()
+{
+	return root == -1 ? 0 : nodes[root].height;
+}
+
+void AABBTree::QueryBox(XMFLOAT3 min, XMFLOAT3 max, std::vector<void*>& results)
+{
+	if (root == -1)
+		return;
+
+	stack.clear();
+	stack.push_back(root);
+	while (!stack.empty())
+	{
+		const Node& node = nodes[stack.back()];
+		stack.pop_back();
+
+		if (!BoxesOverlap(node.min, node.max, min, max))
+			continue;
+
+		if (node.IsLeaf())
+		{
+			if (BoxesOverlap(node.tightMin, node.tightMax, min, max))
+				results.push_back(node.userData);
+		}
+		else
+		{
+			stack.push_back(node.child1);
+			stack.push_back(node.child2);
+		}
+	}
+}
+
+void AABBTree::QuerySphere(XMFLOAT3 center, float radius, std::vector<void*>& results)
+{
+	if (root == -1)
+		return;
+
+	float radiusSq = radius * radius;
+
+	stack.clear();
+	stack.push_back(root);
+	while (!stack.empty())
+	{
+		const Node& node = nodes[stack.back()];
+		stack.pop_back();
+
+		if (!SphereOverlapsBox(center, radiusSq, node.min, node.max))
+			continue;
+
+		if (node.IsLeaf())
+		{
+			if (SphereOverlapsBox(center, radiusSq, node.tightMin, node.tightMax))
+				results.push_back(node.userData);
+		}
+		else
+		{
+			stack.push_back(node.child1);
+			stack.push_back(node.child2);
+		}
+	}
+}
+
+void* AABBTree::RayCast(XMFLOAT3 origin, XMFLOAT3 direction, float maxDistance, float& hitDistance,
+	RayCastCallback callback)
+{
+	if (root == -1)
+		return nullptr;
+
+	XMStoreFloat3(&direction, XMVector3Normalize(XMLoadFloat3(&direction)));
+
+	//a zero component gives an infinite slab, which the test handles
+	XMFLOAT3 invDirection(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+
+	void* closest = nullptr;
+	float closestDistance = maxDistance;
+
+	stack.clear();
+	stack.push_back(root);
+	while (!stack.empty())
+	{
+		int index = stack.back();
+		stack.pop_back();
+		const Node& node = nodes[index];
+
+		//anything further than the closest hit so far can be skipped
+		float entry;
+		if (!RayOverlapsBox(origin, invDirection, closestDistance, node.min, node.max, entry))
+			continue;
+
+		if (node.IsLeaf())
+		{
+			//the node isn't touched once the callback has been called
+			void* userData = node.userData;
+			float distance;
+			if (callback)
+			{
+				distance = callback(index, userData, closestDistance);
+			}
+			else if (!RayOverlapsBox(origin, invDirection, closestDistance, node.tightMin, node.tightMax, distance))
+			{
+				distance = -1.0f;
+			}
+
+			if (distance >= 0.0f && distance <= closestDistance)
+			{
+				closestDistance = distance;
+				closest = userData;
+			}
+		}
+		else
+		{
+			stack.push_back(node.child1);
+			stack.push_back(node.child2);
+		}
+	}
+
+	if (closest != nullptr)
+		hitDistance = closestDistance;
+
+	return closest;
+}
+
+int AABBTree::AllocateNode()
+{
+	int index;
+	if (freeList != -1)
+	{
+		index = freeList;
+		freeList = nodes[index].parent;
+	}
+	else
+	{
+		index = (int)nodes.size();
+		nodes.emplace_back();
+	}
+
+	Node& node = nodes[index];
+	node.parent = -1;
+	node.child1 = -1;
+	node.child2 = -1;
+	node.height = 0;
+	node.userData = nullptr;
+	return index;
+}
+
+void AABBTree::FreeNode(int node)
+{
+	nodes[node].parent = freeList;
+	nodes[node].height = -1;
+	nodes[node].userData = nullptr;
+	freeList = node;
+}
+
+void AABBTree::InsertLeaf(int leaf)
+{
+	if (root == -1)
+	{
+		root = leaf;
+		nodes[root].parent = -1;
+		return;
+	}
+
+	//walking down to the sibling that grows the total surface area the least
+	XMVECTOR leafMin = XMLoadFloat3(&nodes[leaf].min);
+	XMVECTOR leafMax = XMLoadFloat3(&nodes[leaf].max);
+	int index = root;
+	while (!nodes[index].IsLeaf())
+	{
+		const Node& node = nodes[index];
+		XMVECTOR nodeMin = XMLoadFloat3(&node.min);
+		XMVECTOR nodeMax = XMLoadFloat3(&node.max);
+
+		float area = SurfaceArea(nodeMin, nodeMax);
+		float combinedArea = SurfaceArea(XMVectorMin(nodeMin, leafMin), XMVectorMax(nodeMax, leafMax));
+
+		//cost of making a new parent for this node and the leaf
+		float cost = 2.0f * combinedArea;
+
+		//cost every level below pays for growing this node
+		float inheritanceCost = 2.0f * (combinedArea - area);
+
+		float childCosts[2];
+		int children[2] = { node.child1, node.child2 };
+		for (int i = 0; i < 2; i++)
+		{
+			const Node& child = nodes[children[i]];
+			XMVECTOR childMin = XMLoadFloat3(&child.min);
+			XMVECTOR childMax = XMLoadFloat3(&child.max);
+			float grownArea = SurfaceArea(XMVectorMin(childMin, leafMin), XMVectorMax(childMax, leafMax));
+			if (child.IsLeaf())
+				childCosts[i] = grownArea + inheritanceCost;
+			else
+				childCosts[i] = grownArea - SurfaceArea(childMin, childMax) + inheritanceCost;
+		}
+
+		if (cost < childCosts[0] && cost < childCosts[1])
+			break;
+
+		index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+	}
+
+	int sibling = index;
+	int oldParent = nodes[sibling].parent;
+
+	int newParent = AllocateNode();
+	nodes[newParent].parent = oldParent;
+	nodes[newParent].child1 = sibling;
+	nodes[newParent].child2 = leaf;
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+
+	if (oldParent != -1)
+	{
+		if (nodes[oldParent].child1 == sibling)
+			nodes[oldParent].child1 = newParent;
+		else
+			nodes[oldParent].child2 = newParent;
+	}
+	else
+	{
+		root = newParent;
+	}
+
+	//fixing the heights and bounds on the way back up
+	index = newParent;
+	while (index != -1)
+	{
+		index = Balance(index);
+		Refit(index);
+		index = nodes[index].parent;
+	}
+}
+
+void AABBTree::RemoveLeaf(int leaf)
+{
+	if (leaf == root)
+	{
+		root = -1;
+		return;
+	}
+
+	int parent = nodes[leaf].parent;
+	int grandParent = nodes[parent].parent;
+	int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+	if (grandParent != -1)
+	{
+		//the sibling takes the place of the parent
+		if (nodes[grandParent].child1 == parent)
+			nodes[grandParent].child1 = sibling;
+		else
+			nodes[grandParent].child2 = sibling;
+		nodes[sibling].parent = grandParent;
+		FreeNode(parent);
+
+		int index = grandParent;
+		while (index != -1)
+		{
+			index = Balance(index);
+			Refit(index);
+			index = nodes[index].parent;
+		}
+	}
+	else
+	{
+		root = sibling;
+		nodes[sibling].parent = -1;
+		FreeNode(parent);
+	}
+}
+
+void AABBTree::Refit(int node)
+{
+	Node& n = nodes[node];
+	const Node& child1 = nodes[n.child1];
+	const Node& child2 = nodes[n.child2];
+
+	XMStoreFloat3(&n.min, XMVectorMin(XMLoadFloat3(&child1.min), XMLoadFloat3(&child2.min)));
+	XMStoreFloat3(&n.max, XMVectorMax(XMLoadFloat3(&child1.max), XMLoadFloat3(&child2.max)));
+	n.height = 1 + std::max(child1.height, child2.height);
+}
+
+int AABBTree::Balance(int iA)
+{
+	//rotates the taller grandchild up when the two subtrees differ by more than one level
+	Node& A = nodes[iA];
+	if (A.IsLeaf() || A.height < 2)
+		return iA;
+
+	int iB = A.child1;
+	int iC = A.child2;
+	int balance = nodes[iC].height - nodes[iB].height;
+
+	if (balance > 1)
+	{
+		//C moves up
+		Node& C = nodes[iC];
+		int iF = C.child1;
+		int iG = C.child2;
+
+		C.child1 = iA;
+		C.parent = A.parent;
+		A.parent = iC;
+
+		if (C.parent != -1)
+		{
+			if (nodes[C.parent].child1 == iA)
+				nodes[C.parent].child1 = iC;
+			else
+				nodes[C.parent].child2 = iC;
+		}
+		else
+		{
+			root = iC;
+		}
+
+		//the taller of F and G stays under C, the other one replaces C under A
+		if (nodes[iF].height > nodes[iG].height)
+		{
+			C.child2 = iF;
+			A.child2 = iG;
+			nodes[iG].parent = iA;
+		}
+		else
+		{
+			C.child2 = iG;
+			A.child2 = iF;
+			nodes[iF].parent = iA;
+		}
+
+		Refit(iA);
+		Refit(iC);
+		return iC;
+	}
+
+	if (balance < -1)
+	{
+		//B moves up
+		Node& B = nodes[iB];
+		int iD = B.child1;
+		int iE = B.child2;
+
+		B.child1 = iA;
+		B.parent = A.parent;
+		A.parent = iB;
+
+		if (B.parent != -1)
+		{
+			if (nodes[B.parent].child1 == iA)
+				nodes[B.parent].child1 = iB;
+			else
+				nodes[B.parent].child2 = iB;
+		}
+		else
+		{
+			root = iB;
+		}
+
+		if (nodes[iD].height > nodes[iE].height)
+		{
+			B.child2 = iD;
+			A.child1 = iE;
+			nodes[iE].parent = iA;
+		}
+		else
+		{
+			B.child2 = iE;
+			A.child1 = iD;
+			nodes[iD].parent = iA;
+		}
+
+		Refit(iA);
+		Refit(iB);
+		return iB;
+	}
+
+	return iA;
+}
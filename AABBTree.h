@@ -0,0 +1,71 @@
+#pragma once
+#include<DirectXMath.h>
+#include<vector>
+#include<functional>
+using namespace DirectX;
+
+//called for every proxy whose box the ray crosses, closer than maxDistance
+//returns the distance of the real hit, or a negative value when the ray misses the body
+//it must not create, destroy or move proxies, the walk down the tree is still going on
+typedef std::function<float(int proxy, void* userData, float maxDistance)> RayCastCallback;
+
+//dynamic bounding volume hierarchy over axis aligned boxes
+//leaves store a box grown by a margin so small movements don't touch the tree,
+//the tree is kept balanced with rotations so every query is O(log n)
+class AABBTree
+{
+	struct Node
+	{
+		XMFLOAT3 min; //fat bounds, the union of the children for inner nodes
+		XMFLOAT3 max;
+		XMFLOAT3 tightMin; //bounds that were passed in, only used by leaves
+		XMFLOAT3 tightMax;
+		void* userData;
+		int parent; //next free node while the node is on the free list
+		int child1;
+		int child2;
+		int height; //0 for leaves, -1 for free nodes
+
+		bool IsLeaf() const { return child1 == -1; }
+	};
+
+	std::vector<Node> nodes;
+	int root;
+	int freeList;
+	int proxyCount;
+	float margin;
+
+	//reused by the queries so they don't allocate once warmed up
+	std::vector<int> stack;
+
+	int AllocateNode();
+	void FreeNode(int node);
+	void InsertLeaf(int leaf);
+	void RemoveLeaf(int leaf);
+	int Balance(int node);
+	void Refit(int node);
+
+public:
+	AABBTree(float margin = 0.5f);
+
+	//returns the id of the new proxy
+	int CreateProxy(XMFLOAT3 min, XMFLOAT3 max, void* userData);
+	void DestroyProxy(int proxy);
+
+	//returns true when the bounds left the fat box and the proxy was re-inserted
+	bool MoveProxy(int proxy, XMFLOAT3 min, XMFLOAT3 max);
+	void Clear();
+
+	void* GetUserData(int proxy);
+	int GetProxyCount();
+	int GetHeight();
+
+	//queries against the bounds that were passed in, results are appended
+	void QueryBox(XMFLOAT3 min, XMFLOAT3 max, std::vector<void*>& results);
+	void QuerySphere(XMFLOAT3 center, float radius, std::vector<void*>& results);
+
+	//returns the user data of the closest hit, or nullptr
+	//without a callback the proxies are treated as their boxes
+	void* RayCast(XMFLOAT3 origin, XMFLOAT3 direction, float maxDistance, float& hitDistance,
+		RayCastCallback callback = nullptr);
+};
@@ -4,6 +4,8 @@ Bullet::Bullet(std::shared_ptr<Mesh> mesh, std::shared_ptr<Material> material):E
 {
 	lifeTime = 0;
 	tag = "bullet";
+	layer = CollisionLayer::Bullet;
+	fastMover = true;
 	isActive = false;
 }
 
@@ -11,10 +13,12 @@ Bullet::~Bullet()
 {
 }
 
-bool Bullet::IsColliding(std::shared_ptr<Entity> other)
+bool Bullet::IsColliding(std::shared_ptr<Entity> other, CollisionCache* cache)
 {
-	if (other->GetTag() == "Obstacle"&&useRigidBody
-		&& GetRigidBody()->SATCollision(other->GetRigidBody()))
+	//bullets move far in a single step, so the whole motion is tested
+	float toi;
+	if (other->GetCollisionLayer() == CollisionLayer::Obstacle&&useRigidBody
+		&& GetRigidBody()->SweptCollision(other->GetRigidBody(), toi))
 	{
 		this->isAlive = false;
 		other->Die();
@@ -13,7 +13,7 @@ public:
 	bool isActive;
 	Bullet(std::shared_ptr<Mesh> mesh, std::shared_ptr<Material> material);
 	~Bullet();
-	bool IsColliding(std::shared_ptr<Entity> other) override;
+	bool IsColliding(std::shared_ptr<Entity> other, CollisionCache* cache = nullptr) override;
 	void Update(float deltaTime) override;
 	void Reset();
 };
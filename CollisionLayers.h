@@ -0,0 +1,57 @@
+#pragma once
+
+//layer of an entity, decides which other entities it can collide with
+enum class CollisionLayer : unsigned int
+{
+	Default,
+	Player,
+	Bullet,
+	Obstacle,
+	Count
+};
+
+inline unsigned int LayerBit(CollisionLayer layer)
+{
+	return 1u << (unsigned int)layer;
+}
+
+//symmetric layer vs layer table, stored as one bit mask per layer
+class CollisionMatrix
+{
+	unsigned int masks[(int)CollisionLayer::Count];
+
+public:
+	//every layer collides with every other layer
+	CollisionMatrix()
+	{
+		for (int i = 0; i < (int)CollisionLayer::Count; i++)
+		{
+			masks[i] = ~0u;
+		}
+	}
+
+	void SetCollision(CollisionLayer a, CollisionLayer b, bool collide)
+	{
+		if (collide)
+		{
+			masks[(int)a] |= LayerBit(b);
+			masks[(int)b] |= LayerBit(a);
+		}
+		else
+		{
+			masks[(int)a] &= ~LayerBit(b);
+			masks[(int)b] &= ~LayerBit(a);
+		}
+	}
+
+	bool ShouldCollide(CollisionLayer a, CollisionLayer b) const
+	{
+		return (masks[(int)a] & LayerBit(b)) != 0;
+	}
+
+	//bits of every layer that a collides with
+	unsigned int GetMask(CollisionLayer a) const
+	{
+		return masks[(int)a];
+	}
+};
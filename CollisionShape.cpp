@@ -0,0 +1,333 @@
+#include "CollisionShape.h"
+#include<algorithm>
+#include<random>
+#include<cmath>
+
+//sphere used while cooking, a negative radius is an empty sphere
+struct CookSphere
+{
+	XMVECTOR center;
+	float radius;
+};
+
+static bool SphereContains(const CookSphere& sphere, FXMVECTOR point)
+{
+	if (sphere.radius < 0.0f)
+		return false;
+
+	//a little slack so points on the surface don't keep triggering rebuilds
+	float distance = XMVectorGetX(XMVector3Length(point - sphere.center));
+	return distance <= sphere.radius * 1.00001f + 1e-5f;
+}
+
+static CookSphere SphereFromTwo(FXMVECTOR a, FXMVECTOR b)
+{
+	CookSphere sphere;
+	sphere.center = (a + b) * 0.5f;
+	sphere.radius = XMVectorGetX(XMVector3Length(b - a)) * 0.5f;
+	return sphere;
+}
+
+static CookSphere SphereFromThree(FXMVECTOR a, FXMVECTOR b, FXMVECTOR c)
+{
+	//circumcircle of the triangle, centered in its plane
+	XMVECTOR ab = b - a;
+	XMVECTOR ac = c - a;
+	XMVECTOR normal = XMVector3Cross(ab, ac);
+	float normalLengthSq = XMVectorGetX(XMVector3LengthSq(normal));
+
+	//the points are on a line, the two furthest apart decide the sphere
+	if (normalLengthSq < 1e-12f)
+	{
+		CookSphere s1 = SphereFromTwo(a, b);
+		CookSphere s2 = SphereFromTwo(a, c);
+		CookSphere s3 = SphereFromTwo(b, c);
+		if (s1.radius >= s2.radius && s1.radius >= s3.radius) return s1;
+		return s2.radius >= s3.radius ? s2 : s3;
+	}
+
+	XMVECTOR toCenter = (XMVector3Cross(normal, ab) * XMVectorGetX(XMVector3LengthSq(ac)) +
+		XMVector3Cross(ac, normal) * XMVectorGetX(XMVector3LengthSq(ab))) / (2.0f * normalLengthSq);
+
+	CookSphere sphere;
+	sphere.center = a + toCenter;
+	sphere.radius = XMVectorGetX(XMVector3Length(toCenter));
+	return sphere;
+}
+
+static CookSphere SphereFromFour(FXMVECTOR a, FXMVECTOR b, FXMVECTOR c, GXMVECTOR d)
+{
+	//circumsphere of the tetrahedron
+	XMVECTOR ab = b - a;
+	XMVECTOR ac = c - a;
+	XMVECTOR ad = d - a;
+	float denominator = 2.0f * XMVectorGetX(XMVector3Dot(ab, XMVector3Cross(ac, ad)));
+
+	//flat tetrahedron, fall back to the largest of the triangles
+	if (fabsf(denominator) < 1e-12f)
+	{
+		CookSphere best = SphereFromThree(a, b, c);
+		CookSphere candidates[3] = { SphereFromThree(a, b, d), SphereFromThree(a, c, d), SphereFromThree(b, c, d) };
+		for (int i = 0; i < 3; i++)
+		{
+			if (candidates[i].radius > best.radius) best = candidates[i];
+		}
+		return best;
+	}
+
+	XMVECTOR toCenter = (XMVector3Cross(ac, ad) * XMVectorGetX(XMVector3LengthSq(ab)) +
+		XMVector3Cross(ad, ab) * XMVectorGetX(XMVector3LengthSq(ac)) +
+		XMVector3Cross(ab, ac) * XMVectorGetX(XMVector3LengthSq(ad))) / denominator;
+
+	CookSphere sphere;
+	sphere.center = a + toCenter;
+	sphere.radius = XMVectorGetX(XMVector3Length(toCenter));
+	return sphere;
+}
+
+static CookSphere SphereFromSupport(const XMVECTOR* support, int count)
+{
+	CookSphere sphere;
+	switch (count)
+	{
+	case 0:
+		sphere.center = XMVectorZero();
+		sphere.radius = -1.0f;
+		return sphere;
+	case 1:
+		sphere.center = support[0];
+		sphere.radius = 0.0f;
+		return sphere;
+	case 2:
+		return SphereFromTwo(support[0], support[1]);
+	case 3:
+		return SphereFromThree(support[0], support[1], support[2]);
+	default:
+		return SphereFromFour(support[0], support[1], support[2], support[3]);
+	}
+}
+
+//welzl's algorithm, the recursion only goes as deep as the support set (at most 4)
+static CookSphere MinimalSphere(const std::vector<XMFLOAT3>& points, size_t count, XMVECTOR* support, int supportCount)
+{
+	CookSphere sphere = SphereFromSupport(support, supportCount);
+	if (supportCount == 4)
+		return sphere;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		XMVECTOR point = XMLoadFloat3(&points[i]);
+		if (!SphereContains(sphere, point))
+		{
+			//the point has to be on the surface of the sphere around the first i points
+			support[supportCount] = point;
+			sphere = MinimalSphere(points, i, support, supportCount + 1);
+		}
+	}
+
+	return sphere;
+}
+
+CollisionShape::CollisionShape(const std::vector<XMFLOAT3>& points)
+{
+	min = max = XMFLOAT3(0, 0, 0);
+	sphereCenter = XMFLOAT3(0, 0, 0);
+	sphereRadius = 0.0f;
+	fittedBox.center = XMFLOAT3(0, 0, 0);
+	fittedBox.axes[0] = XMFLOAT3(1, 0, 0);
+	fittedBox.axes[1] = XMFLOAT3(0, 1, 0);
+	fittedBox.axes[2] = XMFLOAT3(0, 0, 1);
+	fittedBox.halfExtents = XMFLOAT3(0, 0, 0);
+
+	//meshes that weren't loaded from an obj have no points
+	if (points.size() == 0)
+		return;
+
+	XMVECTOR vMin = XMLoadFloat3(&points[0]);
+	XMVECTOR vMax = vMin;
+	for (size_t i = 1; i < points.size(); i++)
+	{
+		XMVECTOR point = XMLoadFloat3(&points[i]);
+		vMin = XMVectorMin(vMin, point);
+		vMax = XMVectorMax(vMax, point);
+	}
+	XMStoreFloat3(&min, vMin);
+	XMStoreFloat3(&max, vMax);
+
+	CookBoundingSphere(points);
+	CookFittedBox(points);
+	hull = ConvexHull(points);
+}
+
+void CollisionShape::CookBoundingSphere(const std::vector<XMFLOAT3>& points)
+{
+	//welzl is expected linear time when the points come in random order
+	std::vector<XMFLOAT3> shuffled = points;
+	std::mt19937 randomGenerator(1);
+	std::shuffle(shuffled.begin(), shuffled.end(), randomGenerator);
+
+	XMVECTOR support[4];
+	CookSphere sphere = MinimalSphere(shuffled, shuffled.size(), support, 0);
+
+	XMStoreFloat3(&sphereCenter, sphere.center);
+	sphereRadius = sphere.radius;
+}
+
+void CollisionShape::CookFittedBox(const std::vector<XMFLOAT3>& points)
+{
+	float count = (float)points.size();
+
+	XMVECTOR sum = XMVectorZero();
+	for (size_t i = 0; i < points.size(); i++)
+	{
+		sum += XMLoadFloat3(&points[i]);
+	}
+	XMFLOAT3 mean;
+	XMStoreFloat3(&mean, sum / count);
+
+	//covariance of the points around their mean
+	float covariance[3][3] = {};
+	for (size_t i = 0; i < points.size(); i++)
+	{
+		float d[3] = { points[i].x - mean.x, points[i].y - mean.y, points[i].z - mean.z };
+		for (int r = 0; r < 3; r++)
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				covariance[r][c] += d[r] * d[c];
+			}
+		}
+	}
+
+	//jacobi rotations until the covariance is diagonal, the columns of v are the eigenvectors
+	float a[3][3];
+	float v[3][3] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+	for (int r = 0; r < 3; r++)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			a[r][c] = covariance[r][c] / count;
+		}
+	}
+
+	for (int sweep = 0; sweep < 50; sweep++)
+	{
+		float offDiagonal = fabsf(a[0][1]) + fabsf(a[0][2]) + fabsf(a[1][2]);
+		if (offDiagonal < 1e-9f)
+			break;
+
+		for (int p = 0; p < 2; p++)
+		{
+			for (int q = p + 1; q < 3; q++)
+			{
+				if (fabsf(a[p][q]) < 1e-12f)
+					continue;
+
+				float theta = (a[q][q] - a[p][p]) / (2.0f * a[p][q]);
+				float t = (theta >= 0.0f ? 1.0f : -1.0f) / (fabsf(theta) + sqrtf(theta * theta + 1.0f));
+				float c = 1.0f / sqrtf(t * t + 1.0f);
+				float s = t * c;
+
+				for (int k = 0; k < 3; k++)
+				{
+					float akp = a[k][p];
+					float akq = a[k][q];
+					a[k][p] = c * akp - s * akq;
+					a[k][q] = s * akp + c * akq;
+				}
+				for (int k = 0; k < 3; k++)
+				{
+					float apk = a[p][k];
+					float aqk = a[q][k];
+					a[p][k] = c * apk - s * aqk;
+					a[q][k] = s * apk + c * aqk;
+				}
+				for (int k = 0; k < 3; k++)
+				{
+					float vkp = v[k][p];
+					float vkq = v[k][q];
+					v[k][p] = c * vkp - s * vkq;
+					v[k][q] = s * vkp + c * vkq;
+				}
+			}
+		}
+	}
+
+	XMVECTOR axes[3];
+	for (int i = 0; i < 3; i++)
+	{
+		axes[i] = XMVector3Normalize(XMVectorSet(v[0][i], v[1][i], v[2][i], 0.0f));
+	}
+	//keeping the basis right handed
+	axes[2] = XMVector3Cross(axes[0], axes[1]);
+
+	//extent of the points along each axis
+	float lo[3];
+	float hi[3];
+	for (int i = 0; i < 3; i++)
+	{
+		lo[i] = hi[i] = XMVectorGetX(XMVector3Dot(XMLoadFloat3(&points[0]), axes[i]));
+	}
+	for (size_t j = 1; j < points.size(); j++)
+	{
+		XMVECTOR point = XMLoadFloat3(&points[j]);
+		for (int i = 0; i < 3; i++)
+		{
+			float d = XMVectorGetX(XMVector3Dot(point, axes[i]));
+			if (d < lo[i]) lo[i] = d;
+			if (d > hi[i]) hi[i] = d;
+		}
+	}
+
+	XMVECTOR center = XMVectorZero();
+	for (int i = 0; i < 3; i++)
+	{
+		center += axes[i] * ((lo[i] + hi[i]) * 0.5f);
+		XMStoreFloat3(&fittedBox.axes[i], axes[i]);
+	}
+	XMStoreFloat3(&fittedBox.center, center);
+	fittedBox.halfExtents = XMFLOAT3((hi[0] - lo[0]) * 0.5f, (hi[1] - lo[1]) * 0.5f, (hi[2] - lo[2]) * 0.5f);
+
+	//principal axes aren't always tighter, the plain bounds win if they are smaller
+	XMFLOAT3 size(max.x - min.x, max.y - min.y, max.z - min.z);
+	float boxVolume = size.x * size.y * size.z;
+	float fittedVolume = 8.0f * fittedBox.halfExtents.x * fittedBox.halfExtents.y * fittedBox.halfExtents.z;
+	if (boxVolume <= fittedVolume)
+	{
+		XMStoreFloat3(&fittedBox.center, (XMLoadFloat3(&min) + XMLoadFloat3(&max)) * 0.5f);
+		fittedBox.axes[0] = XMFLOAT3(1, 0, 0);
+		fittedBox.axes[1] = XMFLOAT3(0, 1, 0);
+		fittedBox.axes[2] = XMFLOAT3(0, 0, 1);
+		fittedBox.halfExtents = XMFLOAT3(size.x * 0.5f, size.y * 0.5f, size.z * 0.5f);
+	}
+}
+
+XMFLOAT3 CollisionShape::GetMin() const
+{
+	return min;
+}
+
+XMFLOAT3 CollisionShape::GetMax() const
+{
+	return max;
+}
+
+XMFLOAT3 CollisionShape::GetSphereCenter() const
+{
+	return sphereCenter;
+}
+
+float CollisionShape::GetSphereRadius() const
+{
+	return sphereRadius;
+}
+
+const OrientedBox& CollisionShape::GetFittedBox() const
+{
+	return fittedBox;
+}
+
+const ConvexHull& CollisionShape::GetHull() const
+{
+	return hull;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include<DirectXMath.h>
+#include<vector>
+#include"OrientedBox.h"
+#include"ConvexHull.h"
+using namespace DirectX;
+
+//bounding volumes of a mesh in its local space
+//cooked once from the vertices and then only read, so every entity using the mesh can share it
+class CollisionShape
+{
+	XMFLOAT3 min; //axis aligned bounds
+	XMFLOAT3 max;
+
+	XMFLOAT3 sphereCenter; //smallest sphere around all the points
+	float sphereRadius;
+
+	OrientedBox fittedBox; //box along the principal axes of the points
+
+	ConvexHull hull; //for the exact gjk test once the boxes overlap
+
+	void CookBoundingSphere(const std::vector<XMFLOAT3>& points);
+	void CookFittedBox(const std::vector<XMFLOAT3>& points);
+
+public:
+	CollisionShape(const std::vector<XMFLOAT3>& points);
+
+	XMFLOAT3 GetMin() const;
+	XMFLOAT3 GetMax() const;
+	XMFLOAT3 GetSphereCenter() const;
+	float GetSphereRadius() const;
+	const OrientedBox& GetFittedBox() const;
+	const ConvexHull& GetHull() const;
+};
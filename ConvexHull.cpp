@@ -0,0 +1,333 @@
+#include "ConvexHull.h"
+#include<map>
+#include<cmath>
+#include<cfloat>
+
+//triangle of the hull while it is being built
+struct HullFace
+{
+	int v[3];
+	XMFLOAT3 normal;
+	float offset;
+	std::vector<int> outside; //points in front of this face that aren't on the hull yet
+	bool alive;
+};
+
+static float PlaneDistance(const HullFace& face, const XMFLOAT3& point)
+{
+	return face.normal.x * point.x + face.normal.y * point.y + face.normal.z * point.z - face.offset;
+}
+
+//the normal follows the winding, counter clockwise seen from the front
+static HullFace MakeFace(const std::vector<XMFLOAT3>& points, int a, int b, int c)
+{
+	HullFace face;
+	face.v[0] = a;
+	face.v[1] = b;
+	face.v[2] = c;
+	face.alive = true;
+
+	XMVECTOR pa = XMLoadFloat3(&points[a]);
+	XMVECTOR normal = XMVector3Normalize(XMVector3Cross(XMLoadFloat3(&points[b]) - pa, XMLoadFloat3(&points[c]) - pa));
+	XMStoreFloat3(&face.normal, normal);
+	face.offset = XMVectorGetX(XMVector3Dot(normal, pa));
+
+	return face;
+}
+
+//flips the face if its normal points towards the inside of the hull
+static HullFace OrientFace(const HullFace& face, const XMFLOAT3& inside)
+{
+	if (PlaneDistance(face, inside) <= 0.0f)
+		return face;
+
+	HullFace flipped = face;
+	std::swap(flipped.v[1], flipped.v[2]);
+	flipped.normal = XMFLOAT3(-face.normal.x, -face.normal.y, -face.normal.z);
+	flipped.offset = -face.offset;
+	return flipped;
+}
+
+ConvexHull::ConvexHull()
+{
+}
+
+ConvexHull::ConvexHull(const std::vector<XMFLOAT3>& points)
+{
+	int count = (int)points.size();
+	if (count < 4)
+	{
+		vertices = points;
+		return;
+	}
+
+	//extreme points along each axis
+	int extremes[6] = { 0, 0, 0, 0, 0, 0 };
+	for (int i = 1; i < count; i++)
+	{
+		const float* p = &points[i].x;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			if (p[axis] < (&points[extremes[axis * 2]].x)[axis]) extremes[axis * 2] = i;
+			if (p[axis] > (&points[extremes[axis * 2 + 1]].x)[axis]) extremes[axis * 2 + 1] = i;
+		}
+	}
+
+	//tolerance relative to the size of the mesh
+	XMFLOAT3 size(points[extremes[1]].x - points[extremes[0]].x,
+		points[extremes[3]].y - points[extremes[2]].y,
+		points[extremes[5]].z - points[extremes[4]].z);
+	float epsilon = 1e-5f * XMVectorGetX(XMVector3Length(XMLoadFloat3(&size)));
+
+	//starting tetrahedron, the two extremes furthest apart
+	int i0 = extremes[0];
+	int i1 = extremes[1];
+	float bestDistance = -1.0f;
+	for (int i = 0; i < 6; i++)
+	{
+		for (int j = i + 1; j < 6; j++)
+		{
+			float d = XMVectorGetX(XMVector3LengthSq(XMLoadFloat3(&points[extremes[i]]) - XMLoadFloat3(&points[extremes[j]])));
+			if (d > bestDistance)
+			{
+				bestDistance = d;
+				i0 = extremes[i];
+				i1 = extremes[j];
+			}
+		}
+	}
+
+	//the point furthest from that line
+	XMVECTOR p0 = XMLoadFloat3(&points[i0]);
+	XMVECTOR lineDirection = XMVector3Normalize(XMLoadFloat3(&points[i1]) - p0);
+	int i2 = -1;
+	bestDistance = epsilon;
+	for (int i = 0; i < count; i++)
+	{
+		float d = XMVectorGetX(XMVector3Length(XMVector3Cross(XMLoadFloat3(&points[i]) - p0, lineDirection)));
+		if (d > bestDistance)
+		{
+			bestDistance = d;
+			i2 = i;
+		}
+	}
+
+	//and the point furthest from that plane
+	int i3 = -1;
+	if (i2 != -1)
+	{
+		XMVECTOR planeNormal = XMVector3Normalize(XMVector3Cross(XMLoadFloat3(&points[i1]) - p0, XMLoadFloat3(&points[i2]) - p0));
+		bestDistance = epsilon;
+		for (int i = 0; i < count; i++)
+		{
+			float d = fabsf(XMVectorGetX(XMVector3Dot(XMLoadFloat3(&points[i]) - p0, planeNormal)));
+			if (d > bestDistance)
+			{
+				bestDistance = d;
+				i3 = i;
+			}
+		}
+	}
+
+	//flat or a line, every point is kept so the support function still works
+	if (i3 == -1)
+	{
+		vertices = points;
+		return;
+	}
+
+	XMFLOAT3 inside;
+	XMStoreFloat3(&inside, (XMLoadFloat3(&points[i0]) + XMLoadFloat3(&points[i1]) +
+		XMLoadFloat3(&points[i2]) + XMLoadFloat3(&points[i3])) * 0.25f);
+
+	std::vector<HullFace> faces;
+	faces.push_back(OrientFace(MakeFace(points, i0, i1, i2), inside));
+	faces.push_back(OrientFace(MakeFace(points, i0, i3, i1), inside));
+	faces.push_back(OrientFace(MakeFace(points, i0, i2, i3), inside));
+	faces.push_back(OrientFace(MakeFace(points, i1, i3, i2), inside));
+
+	//directed edge to the face it belongs to, the neighbour across (a, b) owns (b, a)
+	std::map<std::pair<int, int>, int> edgeFaces;
+	for (int f = 0; f < 4; f++)
+	{
+		for (int e = 0; e < 3; e++)
+		{
+			edgeFaces[std::make_pair(faces[f].v[e], faces[f].v[(e + 1) % 3])] = f;
+		}
+	}
+
+	//every point goes to the first face it is in front of, the rest are inside
+	for (int i = 0; i < count; i++)
+	{
+		if (i == i0 || i == i1 || i == i2 || i == i3)
+			continue;
+
+		for (size_t f = 0; f < faces.size(); f++)
+		{
+			if (PlaneDistance(faces[f], points[i]) > epsilon)
+			{
+				faces[f].outside.push_back(i);
+				break;
+			}
+		}
+	}
+
+	std::vector<int> visible;
+	std::vector<bool> isVisible;
+	std::vector<int> orphans;
+	std::vector<std::pair<int, int>> horizon;
+
+	//faces that may still have points in front of them
+	std::vector<int> pending = { 0, 1, 2, 3 };
+
+	while (!pending.empty())
+	{
+		int current = pending.back();
+		pending.pop_back();
+		if (!faces[current].alive || faces[current].outside.empty())
+			continue;
+
+		//the furthest point in front of this face is certainly on the hull
+		int eye = faces[current].outside[0];
+		float eyeDistance = PlaneDistance(faces[current], points[eye]);
+		for (size_t i = 1; i < faces[current].outside.size(); i++)
+		{
+			float d = PlaneDistance(faces[current], points[faces[current].outside[i]]);
+			if (d > eyeDistance)
+			{
+				eyeDistance = d;
+				eye = faces[current].outside[i];
+			}
+		}
+
+		//flood fill over the faces the new point can see, growing from the current one
+		//keeps the region connected so its border is a single loop even with rounding errors
+		isVisible.assign(faces.size(), false);
+		visible.clear();
+		visible.push_back(current);
+		isVisible[current] = true;
+		horizon.clear();
+		for (size_t i = 0; i < visible.size(); i++)
+		{
+			const HullFace& face = faces[visible[i]];
+			for (int e = 0; e < 3; e++)
+			{
+				int a = face.v[e];
+				int b = face.v[(e + 1) % 3];
+				int neighbour = edgeFaces[std::make_pair(b, a)];
+				if (isVisible[neighbour])
+					continue;
+
+				if (PlaneDistance(faces[neighbour], points[eye]) > epsilon)
+				{
+					isVisible[neighbour] = true;
+					visible.push_back(neighbour);
+				}
+				else
+				{
+					//the face on the other side stays, so this edge is on the horizon
+					horizon.push_back(std::make_pair(a, b));
+				}
+			}
+		}
+
+		orphans.clear();
+		for (size_t i = 0; i < visible.size(); i++)
+		{
+			HullFace& face = faces[visible[i]];
+			for (size_t j = 0; j < face.outside.size(); j++)
+			{
+				if (face.outside[j] != eye)
+					orphans.push_back(face.outside[j]);
+			}
+			face.outside.clear();
+			face.alive = false;
+
+			for (int e = 0; e < 3; e++)
+			{
+				edgeFaces.erase(std::make_pair(face.v[e], face.v[(e + 1) % 3]));
+			}
+		}
+
+		//a cone of new faces from the horizon to the new point
+		size_t firstNewFace = faces.size();
+		for (size_t i = 0; i < horizon.size(); i++)
+		{
+			int a = horizon[i].first;
+			int b = horizon[i].second;
+			int f = (int)faces.size();
+
+			//the horizon keeps the winding of the faces that were removed
+			faces.push_back(MakeFace(points, a, b, eye));
+			edgeFaces[std::make_pair(a, b)] = f;
+			edgeFaces[std::make_pair(b, eye)] = f;
+			edgeFaces[std::make_pair(eye, a)] = f;
+		}
+
+		for (size_t i = 0; i < orphans.size(); i++)
+		{
+			for (size_t f = firstNewFace; f < faces.size(); f++)
+			{
+				if (PlaneDistance(faces[f], points[orphans[i]]) > epsilon)
+				{
+					faces[f].outside.push_back(orphans[i]);
+					break;
+				}
+			}
+		}
+
+		for (size_t f = firstNewFace; f < faces.size(); f++)
+		{
+			pending.push_back((int)f);
+		}
+	}
+
+	//keeping only the points that are used by the faces
+	std::vector<int> remap(count, -1);
+	for (size_t f = 0; f < faces.size(); f++)
+	{
+		if (!faces[f].alive)
+			continue;
+
+		for (int e = 0; e < 3; e++)
+		{
+			int v = faces[f].v[e];
+			if (remap[v] == -1)
+			{
+				remap[v] = (int)vertices.size();
+				vertices.push_back(points[v]);
+			}
+			indices.push_back((unsigned int)remap[v]);
+		}
+	}
+}
+
+int ConvexHull::Support(FXMVECTOR direction) const
+{
+	int best = 0;
+	float bestDot = -FLT_MAX;
+	XMFLOAT3 d;
+	XMStoreFloat3(&d, direction);
+
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		float dot = vertices[i].x * d.x + vertices[i].y * d.y + vertices[i].z * d.z;
+		if (dot > bestDot)
+		{
+			bestDot = dot;
+			best = (int)i;
+		}
+	}
+
+	return best;
+}
+
+const std::vector<XMFLOAT3>& ConvexHull::GetVertices() const
+{
+	return vertices;
+}
+
+const std::vector<unsigned int>& ConvexHull::GetIndices() const
+{
+	return indices;
+}
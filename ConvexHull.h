@@ -0,0 +1,22 @@
+#pragma once
+#include<DirectXMath.h>
+#include<vector>
+using namespace DirectX;
+
+//convex hull of a point cloud, built with quickhull
+//only the points on the hull are kept, which is all GJK needs for its support function
+class ConvexHull
+{
+	std::vector<XMFLOAT3> vertices;
+	std::vector<unsigned int> indices; //three per triangle, counter clockwise seen from outside
+
+public:
+	ConvexHull();
+	ConvexHull(const std::vector<XMFLOAT3>& points);
+
+	//index of the vertex furthest along direction
+	int Support(FXMVECTOR direction) const;
+
+	const std::vector<XMFLOAT3>& GetVertices() const;
+	const std::vector<unsigned int>& GetIndices() const;
+};
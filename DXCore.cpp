@@ -2,6 +2,7 @@
 
 #include <WindowsX.h>
 #include <sstream>
+#include <cmath>
 
 // Define the static instance variable so our OS-level 
 // message handling function below can talk to our object
@@ -50,6 +51,11 @@ DXCore::DXCore(
 	// Initialize fields
 	fpsFrameCount = 0;
 	fpsTimeElapsed = 0.0f;
+
+	fixedTimeStep = 0.0f;
+	maxSubSteps = 5;
+	accumulator = 0.0f;
+	interpolationAlpha = 1.0f;
 	
 	device = 0;
 	context = 0;
@@ -391,7 +397,32 @@ HRESULT DXCore::Run()
 				UpdateTitleBarStats();
 
 			// The game loop
-			Update(deltaTime, totalTime);
+			if (fixedTimeStep > 0.0f)
+			{
+				accumulator += deltaTime;
+
+				// Each step gets the time at which it ends, so the
+				// simulation clock never drifts from the frame clock
+				int steps = 0;
+				while (accumulator >= fixedTimeStep && steps < maxSubSteps)
+				{
+					accumulator -= fixedTimeStep;
+					Update(fixedTimeStep, totalTime - accumulator);
+					steps++;
+				}
+
+				// Drop whole steps we didn't get to, otherwise a slow
+				// frame makes every following frame even slower
+				if (accumulator >= fixedTimeStep)
+					accumulator -= floorf(accumulator / fixedTimeStep) * fixedTimeStep;
+
+				interpolationAlpha = accumulator / fixedTimeStep;
+			}
+			else
+			{
+				Update(deltaTime, totalTime);
+				interpolationAlpha = 1.0f;
+			}
 			Draw(deltaTime, totalTime);
 		}
 	}
@@ -402,6 +433,29 @@ HRESULT DXCore::Run()
 }
 
 
+// --------------------------------------------------------
+// Switches between a fixed simulation rate and one Update
+// per frame
+// --------------------------------------------------------
+void DXCore::SetFixedTimeStep(float step, int maxSubSteps)
+{
+	fixedTimeStep = step;
+	this->maxSubSteps = maxSubSteps;
+	accumulator = 0.0f;
+	interpolationAlpha = 1.0f;
+}
+
+
+// --------------------------------------------------------
+// Blend factor between the previous and the current
+// simulation step
+// --------------------------------------------------------
+float DXCore::GetInterpolationAlpha()
+{
+	return interpolationAlpha;
+}
+
+
 // --------------------------------------------------------
 // Sends an OS-level window close message to our process, which
 // will be handled by our message processing function
@@ -37,6 +37,15 @@ public:
 	HRESULT Run();				
 	void Quit();
 	virtual void OnResize();
+
+	// Runs Update at a fixed rate, catching up with at most
+	// maxSubSteps steps per frame. A step of 0 goes back to
+	// one Update per frame with the frame's delta time
+	void SetFixedTimeStep(float step, int maxSubSteps = 5);
+
+	// How far the current frame is between the last two
+	// simulation steps, used to interpolate transforms in Draw
+	float GetInterpolationAlpha();
 	
 	// Pure virtual methods for setup and game functionality
 	virtual void Init()										= 0;
@@ -84,6 +93,12 @@ private:
 	__int64 currentTime;
 	__int64 previousTime;
 
+	// Fixed step simulation
+	float fixedTimeStep;
+	int maxSubSteps;
+	float accumulator;
+	float interpolationAlpha;
+
 	// FPS calculation
 	int fpsFrameCount;
 	float fpsTimeElapsed;
@@ -1,4 +1,8 @@
 #include "Emitter.h"
+#include<cmath>
+#include<cfloat>
+
+unsigned long long Emitter::nextSeed = 1;
 
 Emitter::Emitter(int maxParticles, int particlesPerSecond, 
 	float lifetime, float startSize, float endSize, 
@@ -10,10 +14,8 @@ Emitter::Emitter(int maxParticles, int particlesPerSecond,
 	XMFLOAT3 positionRandomRange, 
 	XMFLOAT4 rotationRandomRanges, 
 	XMFLOAT3 emitterAcceleration, 
-	ID3D11Device* device, 
-	SimpleVertexShader* vs, 
-	SimplePixelShader* ps, 
-	ID3D11ShaderResourceView* texture)
+	std::shared_ptr<ParticlePool> pool,
+	unsigned long long seed)
 {
 	this->maxParticles = maxParticles; //max particles spewed
 	this->particlesPerSecond = particlesPerSecond; //particles spewed per second
@@ -29,9 +31,8 @@ Emitter::Emitter(int maxParticles, int particlesPerSecond,
 	this->positionRandomRange = positionRandomRange; //range of pos
 	this->rotationRandomRanges = rotationRandomRanges; //random ranges of rotation
 	this->emitterAcceleration = emitterAcceleration; //acceleration of emmiter
-	this->ps = ps;
-	this->vs = vs;
-	this->texture = texture;
+	this->pool = pool;
+	random.Seed(seed != 0 ? seed : nextSeed++); //seeded once here instead of for every particle
 
 	timeSinceEmit = 0;//how long since the last particle was emmited
 	livingParticleCount = 0; //count of how many particles
@@ -40,66 +41,43 @@ Emitter::Emitter(int maxParticles, int particlesPerSecond,
 	firstDeadIndex = 0;
 	isDead = false;
 	isTemp = false;
-	emitterAge = true;
+	emitterAge = 0;
 	explosive = false;
-
-	particles = new Particle[maxParticles];//list of particles
-	ZeroMemory(particles, sizeof(Particle) * maxParticles);
-
-	unsigned int* indices = new unsigned int[6 * maxParticles];
-	int indexCount = 0;
-	for (int i = 0; i < maxParticles*4; i+=4)
+	simulationThreads = nullptr;
+	priority = 1.0f;
+	emissionScale = 1.0f;
+	rateScale = 1.0f;
+	lifetimeScale = 1.0f;
+	particleBoundsMin = XMFLOAT3(0, 0, 0);
+	particleBoundsMax = XMFLOAT3(0, 0, 0);
+
+	//a range of the pool for the ring of particles and a slot for what they share. when
+	//either has run out the emitter just never spawns anything
+	poolOffset = pool->Allocate(maxParticles);
+	emitterIndex = poolOffset >= 0 ? pool->AddEmitter() : -1;
+	if (emitterIndex < 0)
 	{
-		indices[indexCount++] = i;
-		indices[indexCount++] = i+1;
-		indices[indexCount++] = i+2;
-		indices[indexCount++] = i;
-		indices[indexCount++] = i+2;
-		indices[indexCount++] = i+3;
-
+		if (poolOffset >= 0)
+			pool->Free(poolOffset, maxParticles);
+		poolOffset = 0;
+		this->maxParticles = 0;
 	}
+	particles = pool->GetParticles() + poolOffset;
+	UpdateEmitterData();
+}
 
-	//creating subresource
-	D3D11_SUBRESOURCE_DATA ibdSub = {};
-	ibdSub.pSysMem =  (indices);
-
-	//creating indexbuffer
-	D3D11_BUFFER_DESC ibd = {};
-	ibd.CPUAccessFlags = 0;
-	ibd.ByteWidth = 6 * sizeof(unsigned int) * maxParticles;
-	ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	ibd.Usage = D3D11_USAGE_DEFAULT;
-
-	device->CreateBuffer(&ibd, &ibdSub, &indexBuffer);
-
-	//create a structured buffer to hold the particles
-	D3D11_BUFFER_DESC particleBufferDesc = {};
-	particleBufferDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE; //bind it to srv
-	particleBufferDesc.ByteWidth = maxParticles*sizeof(Particle);
-	particleBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	particleBufferDesc.StructureByteStride = sizeof(Particle); //sizeof structure
-	particleBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	particleBufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED; //this is a structured buffer
-	//creat the buffer
-	device->CreateBuffer(&particleBufferDesc, 0, &particleBuffer);
-
-	D3D11_SHADER_RESOURCE_VIEW_DESC particleSRV = {}; //srv for particles
-	particleSRV.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
-	particleSRV.Format = DXGI_FORMAT_UNKNOWN;
-	particleSRV.Buffer.FirstElement = 0;
-	particleSRV.Buffer.NumElements = maxParticles;	
-
-	device->CreateShaderResourceView(particleBuffer, &particleSRV, &particleData);
-
-	delete[] indices;
+void Emitter::ResetSeeds(unsigned long long seed)
+{
+	nextSeed = seed;
 }
 
 Emitter::~Emitter()
 {
-	indexBuffer->Release();
-	particleBuffer->Release();
-	particleData->Release();
-	delete[] particles;
+	if (emitterIndex >= 0)
+	{
+		pool->Free(poolOffset, maxParticles);
+		pool->RemoveEmitter(emitterIndex);
+	}
 }
 
 XMFLOAT3 Emitter::GetPosition()
@@ -115,6 +93,7 @@ void Emitter::SetPosition(XMFLOAT3 pos)
 void Emitter::SetAcceleration(XMFLOAT3 acel)
 {
 	emitterAcceleration = acel;
+	UpdateEmitterData();
 }
 
 void Emitter::UpdateParticles(float deltaTime, float currentTime)
@@ -157,73 +136,39 @@ void Emitter::UpdateParticles(float deltaTime, float currentTime)
 		}
 	}
 
-	timeSinceEmit += deltaTime;
+	UpdateBounds(currentTime);
 
-	while(timeSinceEmit >= secondsPerParticle)
+	//the living particles as they are after the deaths above, in one or two runs of the ring
+	if (simulation && livingParticleCount > 0)
 	{
-		SpawnParticle(currentTime);
-		timeSinceEmit -= secondsPerParticle;
+		if (firstAliveIndex < firstDeadIndex)
+		{
+			simulation->Simulate(particles, firstAliveIndex, livingParticleCount, emitterAcceleration, deltaTime, currentTime, simulationThreads);
+		}
+		else
+		{
+			simulation->Simulate(particles, firstAliveIndex, maxParticles - firstAliveIndex, emitterAcceleration, deltaTime, currentTime, simulationThreads);
+			simulation->Simulate(particles, 0, firstDeadIndex, emitterAcceleration, deltaTime, currentTime, simulationThreads);
+		}
+		MarkRingDirty(firstAliveIndex, livingParticleCount);
 	}
 
-}
+	timeSinceEmit += deltaTime;
 
-void Emitter::Draw(ID3D11DeviceContext* context, XMFLOAT4X4 view, XMFLOAT4X4 projection, float currentTime)
-{
-	//mapping the data so that gpu cannot write to it
-	D3D11_MAPPED_SUBRESOURCE mapped = {};
-
-	//mapping the vertex buffer so that cpu can write to it
-	context->Map(particleBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
-
-	//copying the data from cpu to gpu
-	memcpy(mapped.pData, particles, sizeof(Particle) * maxParticles);
-
-	//unmapping the resource
-	context->Unmap(particleBuffer, 0);
-
-	//setting the up the buffer
-	UINT stride = 0;
-	UINT offset = 0;
-	ID3D11Buffer* nullBuffer=nullptr;
-	context->IASetIndexBuffer(indexBuffer, DXGI_FORMAT_R32_UINT, 0);
-	context->IASetVertexBuffers(0, 1, &nullBuffer, &stride, &offset);
-
-	//setting the view and projection matrix
-	vs->SetMatrix4x4("view", view);
-	vs->SetMatrix4x4("projection", projection);
-	vs->SetFloat3("acceleration", emitterAcceleration);
-	vs->SetFloat4("startColor", startColor);
-	vs->SetFloat4("endColor", endColor);
-	vs->SetFloat("startSize", startSize);
-	vs->SetFloat("endSize", endSize);
-	vs->SetFloat("lifetime",lifetime);
-	vs->SetFloat("currentTime",currentTime);
-	vs->SetShader();
-
-	context->VSSetShaderResources(0, 1, &particleData);
-
-	ps->SetShaderResourceView("particle", texture);
-	ps->SetShader();
-	ps->CopyAllBufferData();
-
-	if (firstAliveIndex < firstDeadIndex)
+	//a dead emitter lets its last particles run out
+	if (isDead)
 	{
-		vs->SetInt("startIndex", firstAliveIndex);
-		vs->CopyAllBufferData();
-		context->DrawIndexed(livingParticleCount * 6, 0, 0);
+		timeSinceEmit = 0;
+		return;
 	}
 
-	else
+	//everything due this frame in one batch
+	float spawnInterval = secondsPerParticle / rateScale;
+	int spawnCount = (int)(timeSinceEmit / spawnInterval);
+	if (spawnCount > 0)
 	{
-		//draw from 0 to dead
-		vs->SetInt("startIndex", 0);
-		vs->CopyAllBufferData();
-		context->DrawIndexed(firstDeadIndex*6, 0, 0);
-
-		//draw from alive to max
-		vs->SetInt("startIndex", firstAliveIndex);
-		vs->CopyAllBufferData();
-		context->DrawIndexed((maxParticles - firstAliveIndex) * 6, 0, 0);
+		SpawnParticles(spawnCount, currentTime);
+		timeSinceEmit -= spawnCount * spawnInterval;
 	}
 
 }
@@ -239,17 +184,149 @@ bool Emitter::IsDead()
 	return isDead;
 }
 
+bool Emitter::IsFinished()
+{
+	return isDead && livingParticleCount == 0;
+}
+
 void Emitter::Explosive()
 {
 	explosive = true;
 }
 
+void Emitter::Reset(XMFLOAT3 position)
+{
+	emitterPosition = position;
+	timeSinceEmit = 0;
+	emitterAge = 0;
+	isDead = false;
+	livingParticleCount = 0;
+	firstAliveIndex = 0;
+	firstDeadIndex = 0;
+	pool->Clear(poolOffset, maxParticles);
+	spawnBounds.clear();
+	if (emitterIndex >= 0)
+		pool->ClearEmitterBounds(emitterIndex);
+}
+
+void Emitter::EnableSimulation(const ParticleForces& forces, ThreadPool* threads)
+{
+	if (!simulation)
+	{
+		simulation = std::make_unique<ParticleSimulation>(maxParticles);
+
+		//particles already out carry on from where the closed form has them now, close
+		//enough as this is done once and the emitters turn it on before they spawn anything
+		for (int i = 0; i < maxParticles; i++)
+			simulation->Spawn(i, particles[i].startPosition, particles[i].startVelocity);
+	}
+	simulation->SetForces(forces);
+	simulationThreads = threads;
+	UpdateEmitterData();
+}
+
+void Emitter::SetCollision(const HeightField* ground, XMFLOAT3 groundOffset, float waterLevel)
+{
+	if (simulation)
+		simulation->SetCollision(ground, groundOffset, waterLevel);
+}
+
+void Emitter::GetPathBounds(XMFLOAT3 lowPosition, XMFLOAT3 highPosition, XMFLOAT3 lowVelocity, XMFLOAT3 highVelocity, XMFLOAT3& min, XMFLOAT3& max)
+{
+	//the lifetime it was made with, the budget can only shorten it
+	GetParticlePathBounds(lowPosition, highPosition, lowVelocity, highVelocity, emitterAcceleration, lifetime,
+		simulation ? &simulation->GetForces() : nullptr, min, max);
+}
+
+void Emitter::GetBounds(XMFLOAT3& min, XMFLOAT3& max)
+{
+	XMVECTOR position = XMLoadFloat3(&emitterPosition);
+	XMVECTOR positionRange = XMLoadFloat3(&positionRandomRange);
+	XMVECTOR velocity = XMLoadFloat3(&startVelocity);
+	XMVECTOR velocityRange = XMLoadFloat3(&velocityRandomRange);
+	XMFLOAT3 lowPosition, highPosition, lowVelocity, highVelocity;
+	XMStoreFloat3(&lowPosition, position - positionRange);
+	XMStoreFloat3(&highPosition, position + positionRange);
+	XMStoreFloat3(&lowVelocity, velocity - velocityRange);
+	XMStoreFloat3(&highVelocity, velocity + velocityRange);
+	GetPathBounds(lowPosition, highPosition, lowVelocity, highVelocity, min, max);
+}
+
+bool Emitter::GetParticleBounds(XMFLOAT3& min, XMFLOAT3& max)
+{
+	min = particleBoundsMin;
+	max = particleBoundsMax;
+	return !spawnBounds.empty();
+}
+
+void Emitter::SetPriority(float priority)
+{
+	this->priority = priority;
+}
+
+ParticleBudgetRequest Emitter::GetBudgetRequest()
+{
+	ParticleBudgetRequest request = {};
+	GetBounds(request.boundsMin, request.boundsMax);
+	//a moving emitter leaves particles behind outside what it spawns from here
+	XMFLOAT3 min, max;
+	if (GetParticleBounds(min, max))
+	{
+		XMStoreFloat3(&request.boundsMin, XMVectorMin(XMLoadFloat3(&request.boundsMin), XMLoadFloat3(&min)));
+		XMStoreFloat3(&request.boundsMax, XMVectorMax(XMLoadFloat3(&request.boundsMax), XMLoadFloat3(&max)));
+	}
+	//a dead emitter is only waiting for its last particles to go
+	float demand = isDead ? 0.0f : particlesPerSecond * lifetime;
+	request.demand = demand < maxParticles ? demand : (float)maxParticles;
+	request.priority = priority;
+	return request;
+}
+
+void Emitter::SetEmissionScale(float scale)
+{
+	if (fabsf(scale - emissionScale) < 0.01f)
+		return;
+	emissionScale = scale;
+
+	//a shorter life cuts the particles already out short as well, so it only goes to half
+	//and the rate takes the rest. small changes leave it alone, the particles would flicker
+	float newLifetimeScale = fminf(fmaxf(sqrtf(scale), 0.5f), 1.0f);
+	bool restored = newLifetimeScale == 1.0f && lifetimeScale != 1.0f;
+	if (restored || fabsf(newLifetimeScale - lifetimeScale) > 0.05f)
+	{
+		lifetimeScale = newLifetimeScale;
+		UpdateEmitterData();
+	}
+	rateScale = scale / lifetimeScale;
+}
+
+float Emitter::GetEmissionScale()
+{
+	return emissionScale;
+}
+
+void Emitter::UpdateEmitterData()
+{
+	if (emitterIndex < 0)
+		return;
+
+	ParticleEmitterData data = {};
+	data.startColor = startColor;
+	data.endColor = endColor;
+	//simulated particles have their acceleration applied on the cpu
+	data.acceleration = simulation ? XMFLOAT3(0, 0, 0) : emitterAcceleration;
+	data.lifetime = lifetime * lifetimeScale;
+	data.startSize = startSize;
+	data.endSize = endSize;
+	pool->SetEmitterData(emitterIndex, data);
+}
+
 void Emitter::UpdateSingleParticle(float dt, int index,float currentTime)
 {
 	float age = currentTime - particles[index].spawnTime;
 
 	//if age exceeds its lifespan
-	if (age >= lifetime)
+	if (age >= lifetime * lifetimeScale)
 	{
 		//increase the first alive index
 		firstAliveIndex++;
@@ -261,50 +338,123 @@ void Emitter::UpdateSingleParticle(float dt, int index,float currentTime)
 	}
 }
 
-void Emitter::SpawnParticle(float currentTime)
+void Emitter::SpawnParticles(int count, float currentTime)
 {
-	if (livingParticleCount == maxParticles)
+	if (count > maxParticles - livingParticleCount)
+		count = maxParticles - livingParticleCount;
+
+	//each particle takes two draws of four numbers in [-1, 1). the first gives the position
+	//and the start rotation, the second the velocity and the end rotation, so one multiply
+	//add makes each half. rotations are spread the way they always were, r * (max - min) + min
+	XMVECTOR positionBase = XMVectorSet(emitterPosition.x, emitterPosition.y, emitterPosition.z, rotationRandomRanges.x);
+	XMVECTOR positionScale = XMVectorSet(positionRandomRange.x, positionRandomRange.y, positionRandomRange.z,
+		rotationRandomRanges.y - rotationRandomRanges.x);
+	XMVECTOR velocityBase = XMVectorSet(startVelocity.x, startVelocity.y, startVelocity.z, rotationRandomRanges.z);
+	XMVECTOR velocityScale = XMVectorSet(velocityRandomRange.x, velocityRandomRange.y, velocityRandomRange.z,
+		rotationRandomRanges.w - rotationRandomRanges.z);
+
+	if (count <= 0)
 		return;
 
-	//spawinig a new particle
-	particles[firstDeadIndex].spawnTime = currentTime;
-
-	//random position and veloctiy of the particle
-	std::random_device rd;
-	std::mt19937 randomGenerator(rd());
-	std::uniform_real_distribution<float> dist(-1, 1);
-
-	particles[firstDeadIndex].startPosition = emitterPosition; //particles start at emitter
-	//randomizing their x,y,z
-	particles[firstDeadIndex].startPosition.x += dist(randomGenerator) * positionRandomRange.x;
-	particles[firstDeadIndex].startPosition.y += dist(randomGenerator) * positionRandomRange.y;
-	particles[firstDeadIndex].startPosition.z += dist(randomGenerator) * positionRandomRange.z;
-
-	particles[firstDeadIndex].startVelocity = startVelocity;
-	particles[firstDeadIndex].startVelocity.x += dist(randomGenerator) * velocityRandomRange.x;
-	particles[firstDeadIndex].startVelocity.y += dist(randomGenerator) * velocityRandomRange.y;
-	particles[firstDeadIndex].startVelocity.z += dist(randomGenerator) * velocityRandomRange.z;
-
-	//random start rotation
-	float rotStartMin = rotationRandomRanges.x;
-	float rotStartMax = rotationRandomRanges.y;
-
-	//choosing a random start rotation
-	particles[firstDeadIndex].rotationStart = dist(randomGenerator) * (rotStartMax - rotStartMin) + rotStartMin;
+	//the smallest and largest of what was spawned, for the batch's bounds
+	XMVECTOR lowPosition = XMVectorReplicate(FLT_MAX);
+	XMVECTOR highPosition = XMVectorReplicate(-FLT_MAX);
+	XMVECTOR lowVelocity = lowPosition;
+	XMVECTOR highVelocity = highPosition;
 
-	//random start rotation
-	float rotEndMin = rotationRandomRanges.z;
-	float rotEndMax = rotationRandomRanges.w;
-
-	//choosing a random start rotation
-	particles[firstDeadIndex].rotationEnd = dist(randomGenerator) * (rotEndMax - rotEndMin) + rotEndMin;
-
-	//increment the first dead index
-	firstDeadIndex++;
-	firstDeadIndex %= maxParticles;
+	int start = firstDeadIndex;
+	for (int i = 0; i < count; i++)
+	{
+		Particle& particle = particles[firstDeadIndex];
+		particle.spawnTime = currentTime;
+		particle.emitterIndex = emitterIndex;
+
+		//Particle keeps each rotation straight after its vector, so both go in one store
+		XMVECTOR position = random.NextSigned4() * positionScale + positionBase;
+		XMVECTOR velocity = random.NextSigned4() * velocityScale + velocityBase;
+		XMStoreFloat4((XMFLOAT4*)&particle.startPosition, position);
+		XMStoreFloat4((XMFLOAT4*)&particle.startVelocity, velocity);
+		lowPosition = XMVectorMin(lowPosition, position);
+		highPosition = XMVectorMax(highPosition, position);
+		lowVelocity = XMVectorMin(lowVelocity, velocity);
+		highVelocity = XMVectorMax(highVelocity, velocity);
+		if (simulation)
+			simulation->Spawn(firstDeadIndex, particle.startPosition, particle.startVelocity);
+
+		//increment the first dead index
+		firstDeadIndex++;
+		firstDeadIndex %= maxParticles;
+	}
 
 	//increment living particles
-	livingParticleCount++;
+	livingParticleCount += count;
+	MarkRingDirty(start, count);
+
+	//one batch a frame, spawning twice in a frame grows the same one
+	SpawnBounds bounds;
+	XMFLOAT3 low, high, slow, fast;
+	XMStoreFloat3(&low, lowPosition);
+	XMStoreFloat3(&high, highPosition);
+	XMStoreFloat3(&slow, lowVelocity);
+	XMStoreFloat3(&fast, highVelocity);
+	GetPathBounds(low, high, slow, fast, bounds.min, bounds.max);
+	bounds.spawnTime = currentTime;
+	if (spawnBounds.empty())
+	{
+		particleBoundsMin = bounds.min;
+		particleBoundsMax = bounds.max;
+	}
+	XMStoreFloat3(&particleBoundsMin, XMVectorMin(XMLoadFloat3(&particleBoundsMin), XMLoadFloat3(&bounds.min)));
+	XMStoreFloat3(&particleBoundsMax, XMVectorMax(XMLoadFloat3(&particleBoundsMax), XMLoadFloat3(&bounds.max)));
+	if (!spawnBounds.empty() && spawnBounds.back().spawnTime == currentTime)
+	{
+		SpawnBounds& last = spawnBounds.back();
+		XMStoreFloat3(&last.min, XMVectorMin(XMLoadFloat3(&last.min), XMLoadFloat3(&bounds.min)));
+		XMStoreFloat3(&last.max, XMVectorMax(XMLoadFloat3(&last.max), XMLoadFloat3(&bounds.max)));
+	}
+	else
+	{
+		spawnBounds.push_back(bounds);
+	}
+	pool->SetEmitterBounds(emitterIndex, particleBoundsMin, particleBoundsMax);
+}
 
+void Emitter::UpdateBounds(float currentTime)
+{
+	//the batches die in the order they were spawned, the same way the ring does
+	float currentLifetime = lifetime * lifetimeScale;
+	bool died = false;
+	while (!spawnBounds.empty() && (livingParticleCount == 0 || currentTime - spawnBounds.front().spawnTime >= currentLifetime))
+	{
+		spawnBounds.pop_front();
+		died = true;
+	}
+	if (!died)
+		return;
+	if (spawnBounds.empty())
+	{
+		pool->ClearEmitterBounds(emitterIndex);
+		return;
+	}
+
+	XMVECTOR min = XMLoadFloat3(&spawnBounds.front().min);
+	XMVECTOR max = XMLoadFloat3(&spawnBounds.front().max);
+	for (const SpawnBounds& bounds : spawnBounds)
+	{
+		min = XMVectorMin(min, XMLoadFloat3(&bounds.min));
+		max = XMVectorMax(max, XMLoadFloat3(&bounds.max));
+	}
+	XMStoreFloat3(&particleBoundsMin, min);
+	XMStoreFloat3(&particleBoundsMax, max);
+	pool->SetEmitterBounds(emitterIndex, particleBoundsMin, particleBoundsMax);
 }
 
+void Emitter::MarkRingDirty(int start, int count)
+{
+	//past the end of the ring it carries on from the start
+	int first = count < maxParticles - start ? count : maxParticles - start;
+	if (first > 0)
+		pool->MarkDirty(poolOffset + start, first);
+	if (count > first)
+		pool->MarkDirty(poolOffset, count - first);
+}
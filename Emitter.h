@@ -1,11 +1,15 @@
 #pragma once
 //class to manage a specific group of particles
 #include"Particles.h"
-#include"SimpleShader.h"
+#include"ParticlePool.h"
+#include"ParticleSimulation.h"
+#include"ParticleBudget.h"
+#include"ParticleBounds.h"
 #include<memory>
 #include"Camera.h"
-#include<random>
+#include"Xoshiro128.h"
 #include<vector>
+#include<deque>
 
 #define MAX_PARTICLES 250
 class Emitter
@@ -25,23 +29,51 @@ public:
 		XMFLOAT3 positionRandomRange,
 		XMFLOAT4 rotationRandomRanges,
 		XMFLOAT3 emitterAcceleration,
-		ID3D11Device* device,
-		SimpleVertexShader* vs,
-		SimplePixelShader* ps,
-		ID3D11ShaderResourceView* texture
+		std::shared_ptr<ParticlePool> pool,
+		unsigned long long seed = 0 //0 takes the next one from the shared sequence
 	);
 	~Emitter();
 
+	//emitters made after this with no seed of their own are seeded seed, seed + 1, ... so a
+	//replay or a benchmark that resets first gets the same particles every run
+	static void ResetSeeds(unsigned long long seed);
+
 	XMFLOAT3 GetPosition();
 	void SetPosition(XMFLOAT3 pos);
 	void SetAcceleration(XMFLOAT3 acel);
 
 	void UpdateParticles(float deltaTime, float currentTime);
-	void Draw(ID3D11DeviceContext* context, XMFLOAT4X4 view, XMFLOAT4X4 projection,float currentTime);
+
+	//spawns count particles at once, as many as there is room for
+	void SpawnParticles(int count, float currentTime);
 
 	void SetTemporary(float emitterLife);
 	bool IsDead();
+	//dead and with none of its particles left, so it can be reused
+	bool IsFinished();
 	void Explosive();
+	//starts a finished emitter over at position, keeping its particles' range of the pool
+	void Reset(XMFLOAT3 position);
+
+	//moves this emitter's particles on the cpu from now on, with drag, turbulence and
+	//collisions. threads can be null to run on the calling thread
+	void EnableSimulation(const ParticleForces& forces, ThreadPool* threads);
+	//what simulated particles bounce off, see ParticleSimulation::SetCollision
+	void SetCollision(const HeightField* ground, XMFLOAT3 groundOffset, float waterLevel);
+
+	//a box every particle it could spawn stays in over its whole life, worked out from the
+	//ranges it spawns them with rather than the particles themselves
+	void GetBounds(XMFLOAT3& min, XMFLOAT3& max);
+	//a box the particles alive now stay in for the rest of their lives, false when there are none
+	bool GetParticleBounds(XMFLOAT3& min, XMFLOAT3& max);
+	//how much of the budget it keeps against the others when there isn't enough, 1 to start with
+	void SetPriority(float priority);
+	//its bounds and how many particles it wants alive, for ParticleBudget
+	ParticleBudgetRequest GetBudgetRequest();
+	//keeps scale of its particles alive, by spawning fewer and, down to half, letting them
+	//live less. 1 is what it was made with
+	void SetEmissionScale(float scale);
+	float GetEmissionScale();
 
 private:
 
@@ -57,6 +89,11 @@ private:
 	int livingParticleCount;
 	float lifetime;
 
+	float priority;
+	float emissionScale;
+	float rateScale; //particles per second is multiplied by this
+	float lifetimeScale; //and lifetime by this, emissionScale is the two together
+
 	XMFLOAT3 emitterAcceleration;
 	XMFLOAT3 emitterPosition;
 	XMFLOAT3 startVelocity;
@@ -70,26 +107,37 @@ private:
 	float startSize;
 	float endSize;
 
-	// Particle array
+	//seeded once, every particle's random offsets come from here
+	Xoshiro128 random;
+	static unsigned long long nextSeed;
+
+	// Particle array, a range of the pool's
+	std::shared_ptr<ParticlePool> pool;
 	Particle* particles;
+	int poolOffset;
+	int emitterIndex;
 	int maxParticles;
 	int firstDeadIndex;
 	int firstAliveIndex;
 
-	// Rendering
-	ParticleVertex* particleVertices;
-	ID3D11Buffer* vertexBuffer;
-	ID3D11Buffer* indexBuffer;
-
-	ID3D11ShaderResourceView* texture;
-	SimpleVertexShader* vs;
-	SimplePixelShader* ps;
+	//null while the particles follow the closed form in ParticlesVS
+	std::unique_ptr<ParticleSimulation> simulation;
+	ThreadPool* simulationThreads;
 
-	ID3D11Buffer* particleBuffer;
-	ID3D11ShaderResourceView* particleData;
+	//one box for each batch of living particles, oldest first, and all of them together.
+	//a batch grows the total and it is only worked out again when one dies
+	std::deque<SpawnBounds> spawnBounds;
+	XMFLOAT3 particleBoundsMin;
+	XMFLOAT3 particleBoundsMax;
 
 	// Update Methods
 	void UpdateSingleParticle(float dt, int index, float currentTime);
-	void SpawnParticle(float currentTime);
+	void UpdateEmitterData();
+	//the box particles starting between two positions at between two velocities stay in
+	void GetPathBounds(XMFLOAT3 lowPosition, XMFLOAT3 highPosition, XMFLOAT3 lowVelocity, XMFLOAT3 highVelocity, XMFLOAT3& min, XMFLOAT3& max);
+	//drops the batches that have died and gives the pool what is left
+	void UpdateBounds(float currentTime);
+	//tells the pool count slots of the ring from start changed, wrapping around
+	void MarkRingDirty(int start, int count);
 };
 
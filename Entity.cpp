@@ -13,6 +13,11 @@ Entity::Entity(std::shared_ptr<Mesh> mesh, std::shared_ptr<Material> material)
 
 	XMStoreFloat4(&rotation, XMQuaternionIdentity()); //identity quaternion
 
+	previousPosition = position;
+	previousScale = scale;
+	previousRotation = rotation;
+	hasPreviousTransform = false;
+
 	body = nullptr;
 
 	//don't need to recalculate matrix now
@@ -20,13 +25,28 @@ Entity::Entity(std::shared_ptr<Mesh> mesh, std::shared_ptr<Material> material)
 
 	tag = "default";
 
+	layer = CollisionLayer::Default;
+
 	isAlive = true;
 
 	useRigidBody = false;
+	bodyDirty = false;
+
+	broadphaseProxy = -1;
+
+	fastMover = false;
+
+	tree = nullptr;
+	treeProxy = -1;
+	treeDirty = false;
 }
 
 Entity::~Entity()
 {
+	if (tree != nullptr && treeProxy >= 0)
+	{
+		tree->DestroyProxy(treeProxy);
+	}
 }
 
 void Entity::SetPosition(XMFLOAT3 position)
@@ -54,6 +74,8 @@ void Entity::SetScale(XMFLOAT3 scale)
 void Entity::SetModelMatrix(XMFLOAT4X4 matrix)
 {
 	this->modelMatrix = matrix;
+	bodyDirty = true;
+	treeDirty = true;
 }
 
 void Entity::SetRigidBody(std::shared_ptr<RigidBody> body)
@@ -63,23 +85,87 @@ void Entity::SetRigidBody(std::shared_ptr<RigidBody> body)
 	XMFLOAT4X4 transpose;
 	XMStoreFloat4x4(&transpose, XMMatrixTranspose(XMLoadFloat4x4(&GetModelMatrix())));
 	this->body->SetModelMatrix(transpose);
+	bodyDirty = false;
 }
 
 std::shared_ptr<RigidBody> Entity::GetRigidBody()
 {
-	XMFLOAT4X4 transpose;
-	XMStoreFloat4x4(&transpose, XMMatrixTranspose(XMLoadFloat4x4(&GetModelMatrix())));
-	body->SetModelMatrix(transpose);
+	//the corners and the oriented box are only worked out again when the matrix changed
+	if (recalculateMatrix || bodyDirty)
+	{
+		XMFLOAT4X4 transpose;
+		XMStoreFloat4x4(&transpose, XMMatrixTranspose(XMLoadFloat4x4(&GetModelMatrix())));
+		body->SetModelMatrix(transpose);
+		bodyDirty = false;
+	}
 	return body;
 }
 
-void Entity::UseRigidBody()
+void Entity::UseRigidBody(std::shared_ptr<AABBTree> tree)
 {
-	body = std::make_shared<RigidBody>(mesh->GetPoints());
+	body = std::make_shared<RigidBody>(mesh->GetCollisionShape());
 	XMFLOAT4X4 transpose;
 	XMStoreFloat4x4(&transpose, XMMatrixTranspose(XMLoadFloat4x4(&GetModelMatrix())));
 	body->SetModelMatrix(transpose);
 	useRigidBody = true;
+	bodyDirty = false;
+
+	if (tree != nullptr && treeProxy < 0)
+	{
+		this->tree = tree;
+		treeProxy = tree->CreateProxy(body->GetMinGlobal(), body->GetMaxGlobal(), this);
+	}
+}
+
+void Entity::UpdateTreeProxy()
+{
+	//bringing the matrix up to date is what marks the proxy as moved
+	GetModelMatrix();
+	if (treeProxy < 0 || !treeDirty)
+		return;
+
+	//the tree only changes when the bounds leave the fat box of the proxy
+	auto body = GetRigidBody();
+	tree->MoveProxy(treeProxy, body->GetMinGlobal(), body->GetMaxGlobal());
+	treeDirty = false;
+}
+
+bool Entity::HasRigidBody()
+{
+	return useRigidBody;
+}
+
+void Entity::SetFastMover(bool fastMover)
+{
+	this->fastMover = fastMover;
+}
+
+bool Entity::IsFastMover()
+{
+	return fastMover;
+}
+
+void Entity::BeginPhysicsStep()
+{
+	previousPosition = position;
+	previousScale = scale;
+	previousRotation = rotation;
+	hasPreviousTransform = true;
+
+	if (useRigidBody)
+	{
+		GetRigidBody()->StorePreviousPose();
+	}
+}
+
+int Entity::GetBroadphaseProxy()
+{
+	return broadphaseProxy;
+}
+
+void Entity::SetBroadphaseProxy(int proxy)
+{
+	broadphaseProxy = proxy;
 }
 
 XMFLOAT3 Entity::GetPosition()
@@ -134,22 +220,51 @@ XMFLOAT4X4 Entity::GetModelMatrix()
 		 XMStoreFloat4x4(&modelMatrix,XMMatrixTranspose(scaleMat*rotationMat*translate));
 
 		recalculateMatrix = false;
+		bodyDirty = true;
+		treeDirty = true;
 	}
 
 	//returning the model matrix
 	return modelMatrix;
 }
 
+XMFLOAT4X4 Entity::GetInterpolatedModelMatrix(float alpha)
+{
+	//nothing to blend from before the first step
+	if (!hasPreviousTransform || alpha >= 1.0f)
+	{
+		return GetModelMatrix();
+	}
+
+	XMMATRIX translate = XMMatrixTranslationFromVector(XMVectorLerp(XMLoadFloat3(&previousPosition), XMLoadFloat3(&position), alpha));
+	XMMATRIX scaleMat = XMMatrixScalingFromVector(XMVectorLerp(XMLoadFloat3(&previousScale), XMLoadFloat3(&scale), alpha));
+	XMMATRIX rotationMat = XMMatrixRotationQuaternion(XMQuaternionSlerp(XMLoadFloat4(&previousRotation), XMLoadFloat4(&rotation), alpha));
+
+	XMFLOAT4X4 interpolated;
+	XMStoreFloat4x4(&interpolated, XMMatrixTranspose(scaleMat * rotationMat * translate));
+	return interpolated;
+}
+
 void Entity::SetTag(std::string tag)
 {
 	this->tag = tag;
 }
 
-std::string Entity::GetTag()
+const std::string& Entity::GetTag()
 {
 	return tag;
 }
 
+void Entity::SetCollisionLayer(CollisionLayer layer)
+{
+	this->layer = layer;
+}
+
+CollisionLayer Entity::GetCollisionLayer()
+{
+	return layer;
+}
+
 void Entity::Die()
 {
 	isAlive = false;
@@ -170,10 +285,10 @@ std::shared_ptr<Material> Entity::GetMaterial()
 	return material;
 }
 
-void Entity::PrepareMaterial(XMFLOAT4X4 view, XMFLOAT4X4 projection)
+void Entity::PrepareMaterial(XMFLOAT4X4 view, XMFLOAT4X4 projection, float interpolationAlpha)
 {
 	//setting the appropriate data for the shader
-	material->GetVertexShader()->SetMatrix4x4("world", GetModelMatrix());
+	material->GetVertexShader()->SetMatrix4x4("world", GetInterpolatedModelMatrix(interpolationAlpha));
 	material->GetVertexShader()->SetMatrix4x4("view", view);
 	material->GetVertexShader()->SetMatrix4x4("projection", projection);
 
@@ -195,7 +310,7 @@ void Entity::GetInput(float deltaTime)
 {
 }
 
-bool Entity::IsColliding(std::shared_ptr<Entity> other)
+bool Entity::IsColliding(std::shared_ptr<Entity> other, CollisionCache* cache)
 {
 	return false;
 }
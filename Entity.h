@@ -5,9 +5,11 @@
 #include<string>
 #include<memory>
 #include "RigidBody.h"
+#include"AABBTree.h"
+#include"CollisionLayers.h"
 #include"Material.h"
 using namespace DirectX;
-class Entity
+class Entity : public std::enable_shared_from_this<Entity>
 {
 protected:
 	//vectors for scale and position
@@ -20,6 +22,12 @@ protected:
 	//model matrix of the entity
 	XMFLOAT4X4 modelMatrix;
 
+	//transform at the start of the last physics step, rendering blends from it to the current one
+	XMFLOAT3 previousPosition;
+	XMFLOAT3 previousScale;
+	XMFLOAT4 previousRotation;
+	bool hasPreviousTransform;
+
 	bool recalculateMatrix; // boolean to check if any transform has changed
 
 	std::shared_ptr<Mesh> mesh; //mesh associated with this entity
@@ -28,10 +36,21 @@ protected:
 
 	std::string tag;
 
+	CollisionLayer layer; //used instead of the tag when checking collisions
+
 	bool isAlive;
 
 	std::shared_ptr<RigidBody> body;
 	bool useRigidBody;
+	bool bodyDirty; //moved since the body was last given the model matrix
+
+	int broadphaseProxy; //id of this entity in the broadphase, -1 if it is not in it
+
+	bool fastMover; //tested with its whole motion over a step so it can't tunnel
+
+	std::shared_ptr<AABBTree> tree; //spatial tree used for queries, can be null
+	int treeProxy; //id of this entity in the tree, -1 if it is not in it
+	bool treeDirty; //moved since the tree proxy was last updated
 
 public:
 	//constructor which accepts a mesh
@@ -45,8 +64,21 @@ public:
 	void SetScale(XMFLOAT3 scale);
 	void SetModelMatrix(XMFLOAT4X4 matrix);
 	void SetRigidBody(std::shared_ptr<RigidBody> body);
+	//the body is only given the model matrix again when the entity moved since the last call
 	std::shared_ptr<RigidBody> GetRigidBody();
-	void UseRigidBody();
+	//creates the rigid body from the mesh, the entity joins the tree when one is given
+	void UseRigidBody(std::shared_ptr<AABBTree> tree = nullptr);
+	//moves the tree proxy to the current bounds. called once a step before any query, so the
+	//tree never changes while a query walks it
+	void UpdateTreeProxy();
+	bool HasRigidBody();
+	void SetFastMover(bool fastMover);
+	bool IsFastMover();
+
+	//call before moving the entity, the swept tests and the interpolation start from this pose
+	void BeginPhysicsStep();
+	int GetBroadphaseProxy();
+	void SetBroadphaseProxy(int proxy);
 
 	XMFLOAT3 GetPosition();
 	XMFLOAT3 GetForward();
@@ -56,9 +88,14 @@ public:
 	XMFLOAT3 GetScale();
 	XMFLOAT4 GetRotation();
 	XMFLOAT4X4 GetModelMatrix();
+	//transposed like GetModelMatrix, alpha 0 is the previous step and 1 the current one
+	XMFLOAT4X4 GetInterpolatedModelMatrix(float alpha);
 
 	void SetTag(std::string tag);
-	std::string GetTag();
+	const std::string& GetTag();
+
+	void SetCollisionLayer(CollisionLayer layer);
+	CollisionLayer GetCollisionLayer();
 
 	void Die();
 
@@ -69,11 +106,12 @@ public:
 	std::shared_ptr<Material> GetMaterial();
 
 	//method that prepares the material and sends it to the gpu
-	void PrepareMaterial(XMFLOAT4X4 view, XMFLOAT4X4 projection);
+	void PrepareMaterial(XMFLOAT4X4 view, XMFLOAT4X4 projection, float interpolationAlpha = 1.0f);
 
 	virtual void Update(float deltaTime);
 	virtual void GetInput(float deltaTime);
 
-	virtual bool IsColliding(std::shared_ptr<Entity> other);
+	//cache is the state the pair keeps between frames, null when the caller doesn't keep any
+	virtual bool IsColliding(std::shared_ptr<Entity> other, CollisionCache* cache = nullptr);
 };
 
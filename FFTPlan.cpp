@@ -0,0 +1,14 @@
+#include "FFTPlan.h"
+
+std::unique_ptr<FFTPassPlan> CreateFFTPlan(int size)
+{
+	switch (size)
+	{
+	case 64: return std::make_unique<FFTPlan<64>>();
+	case 128: return std::make_unique<FFTPlan<128>>();
+	case 256: return std::make_unique<FFTPlan<256>>();
+	case 512: return std::make_unique<FFTPlan<512>>();
+	case 1024: return std::make_unique<FFTPlan<1024>>();
+	default: return nullptr;
+	}
+}
@@ -0,0 +1,200 @@
+#pragma once
+#include<DirectXMath.h>
+#include<vector>
+#include<memory>
+#include<cmath>
+using namespace DirectX;
+
+//one pass of the fft. every thread reads radix values a stride of size / radix apart and
+//writes them back span apart, span being the length of the transforms already finished
+//(stockham ordering, so no bit reversal is needed anywhere)
+struct FFTStage
+{
+	int radix;
+	int span;
+};
+
+//what Water and OceanFFT need from a plan without knowing its size when they are compiled
+class FFTPassPlan
+{
+public:
+	virtual ~FFTPassPlan() {}
+
+	virtual int GetSize() const = 0;
+	virtual int GetStageCount() const = 0;
+	virtual FFTStage GetStage(int index) const = 0;
+
+	//e^(2 pi i t / size) for every t below size, what FFTStageCS reads its twiddles from
+	virtual const std::vector<XMFLOAT2>& GetTwiddles() const = 0;
+
+	//the inverse fft of size x size (real, imaginary) values in place, the rows and then the
+	//columns, doing exactly the passes FFTStageCS does so any size can be checked on the cpu
+	virtual void Execute(XMFLOAT2* data) const = 0;
+};
+
+//the pass layout is worked out at compile time for each size, radix 8 while at least three
+//stages of the radix 2 version are left and one radix 4 or 2 pass for the rest.
+//256 goes from 8 radix 2 passes per direction to 8 x 8 x 4
+template<int N>
+class FFTPlan : public FFTPassPlan
+{
+	static_assert(N >= 64 && N <= 1024 && (N & (N - 1)) == 0, "fft size has to be a power of two from 64 to 1024");
+
+	static constexpr int Log2(int n) { return n <= 1 ? 0 : 1 + Log2(n / 2); }
+
+public:
+	static constexpr int LOG2N = Log2(N);
+	static constexpr int STAGE_COUNT = (LOG2N + 2) / 3;
+
+	static constexpr int Radix(int stage)
+	{
+		return stage < LOG2N / 3 ? 8 : (LOG2N % 3 == 2 ? 4 : 2);
+	}
+
+	static constexpr int Span(int stage)
+	{
+		return stage == 0 ? 1 : Span(stage - 1) * Radix(stage - 1);
+	}
+
+private:
+	std::vector<XMFLOAT2> twiddles;
+
+	static XMFLOAT2 Multiply(XMFLOAT2 a, XMFLOAT2 b)
+	{
+		return XMFLOAT2(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+	}
+
+	//the small inverse transforms at the heart of each pass, the same as in FFTStageCS
+	static void FFT2(XMFLOAT2& a, XMFLOAT2& b)
+	{
+		XMFLOAT2 t = a;
+		a = XMFLOAT2(t.x + b.x, t.y + b.y);
+		b = XMFLOAT2(t.x - b.x, t.y - b.y);
+	}
+
+	static void FFT4(XMFLOAT2& a0, XMFLOAT2& a1, XMFLOAT2& a2, XMFLOAT2& a3)
+	{
+		XMFLOAT2 t0(a0.x + a2.x, a0.y + a2.y);
+		XMFLOAT2 t1(a0.x - a2.x, a0.y - a2.y);
+		XMFLOAT2 t2(a1.x + a3.x, a1.y + a3.y);
+		XMFLOAT2 t3(-(a1.y - a3.y), a1.x - a3.x); //times i
+		a0 = XMFLOAT2(t0.x + t2.x, t0.y + t2.y);
+		a1 = XMFLOAT2(t1.x + t3.x, t1.y + t3.y);
+		a2 = XMFLOAT2(t0.x - t2.x, t0.y - t2.y);
+		a3 = XMFLOAT2(t1.x - t3.x, t1.y - t3.y);
+	}
+
+	static void FFT8(XMFLOAT2* v)
+	{
+		//the even and odd halves, then joined with the eighth roots of unity
+		FFT4(v[0], v[2], v[4], v[6]);
+		FFT4(v[1], v[3], v[5], v[7]);
+
+		const float h = 0.70710678f;
+		const XMFLOAT2 roots[4] = { XMFLOAT2(1, 0), XMFLOAT2(h, h), XMFLOAT2(0, 1), XMFLOAT2(-h, h) };
+		XMFLOAT2 result[8];
+		for (int m = 0; m < 4; m++)
+		{
+			XMFLOAT2 even = v[2 * m];
+			XMFLOAT2 odd = Multiply(v[2 * m + 1], roots[m]);
+			result[m] = XMFLOAT2(even.x + odd.x, even.y + odd.y);
+			result[m + 4] = XMFLOAT2(even.x - odd.x, even.y - odd.y);
+		}
+		for (int m = 0; m < 8; m++)
+		{
+			v[m] = result[m];
+		}
+	}
+
+	//one pass over one line, what a row of FFTStageCS threads does
+	void RunStage(const XMFLOAT2* input, XMFLOAT2* output, int radix, int span) const
+	{
+		int stride = N / radix;
+		int twiddleStep = N / (span * radix);
+		for (int j = 0; j < stride; j++)
+		{
+			int k = j % span;
+			XMFLOAT2 v[8];
+			for (int r = 0; r < radix; r++)
+			{
+				v[r] = Multiply(input[j + r * stride], twiddles[k * r * twiddleStep]);
+			}
+
+			if (radix == 8)
+				FFT8(v);
+			else if (radix == 4)
+				FFT4(v[0], v[1], v[2], v[3]);
+			else
+				FFT2(v[0], v[1]);
+
+			int base = (j - k) * radix + k;
+			for (int r = 0; r < radix; r++)
+			{
+				output[base + r * span] = v[r];
+			}
+		}
+	}
+
+	//all the passes over one line, ping ponging like the gpu between the line and scratch
+	void ExecuteLine(XMFLOAT2* line, XMFLOAT2* scratch) const
+	{
+		XMFLOAT2* buffers[2] = { line, scratch };
+		int pingpong = 0;
+		for (int stage = 0; stage < STAGE_COUNT; stage++)
+		{
+			RunStage(buffers[pingpong], buffers[1 - pingpong], Radix(stage), Span(stage));
+			pingpong = 1 - pingpong;
+		}
+
+		if (pingpong == 1)
+		{
+			for (int i = 0; i < N; i++)
+			{
+				line[i] = scratch[i];
+			}
+		}
+	}
+
+public:
+	FFTPlan()
+	{
+		twiddles.resize(N);
+		for (int t = 0; t < N; t++)
+		{
+			double angle = 2.0 * 3.14159265358979323846 * t / N;
+			twiddles[t] = XMFLOAT2((float)cos(angle), (float)sin(angle));
+		}
+	}
+
+	int GetSize() const override { return N; }
+	int GetStageCount() const override { return STAGE_COUNT; }
+	FFTStage GetStage(int index) const override { return FFTStage{ Radix(index), Span(index) }; }
+	const std::vector<XMFLOAT2>& GetTwiddles() const override { return twiddles; }
+
+	void Execute(XMFLOAT2* data) const override
+	{
+		std::vector<XMFLOAT2> scratch(N);
+		std::vector<XMFLOAT2> column(N);
+
+		for (int y = 0; y < N; y++)
+		{
+			ExecuteLine(data + y * N, scratch.data());
+		}
+
+		for (int x = 0; x < N; x++)
+		{
+			for (int y = 0; y < N; y++)
+			{
+				column[y] = data[y * N + x];
+			}
+			ExecuteLine(column.data(), scratch.data());
+			for (int y = 0; y < N; y++)
+			{
+				data[y * N + x] = column[y];
+			}
+		}
+	}
+};
+
+//the plan for a size picked at run time, null when the size is not one of 64 to 1024
+std::unique_ptr<FFTPassPlan> CreateFFTPlan(int size);
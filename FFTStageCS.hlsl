@@ -0,0 +1,127 @@
+//one pass of the inverse fft, radix 2, 4 or 8, laid out by FFTPlan
+//each thread reads radix values fftRes / radix apart, transforms them and writes them span apart
+
+cbuffer externData: register(b0)
+{
+	int radix;
+	int span;
+	int direction;
+	int pingpong;
+	int fftRes;
+}
+
+static const float SQRT_HALF = 0.70710678f;
+
+//e^(2 pi i t / fftRes), fftRes x 1
+Texture2D<float2> twiddles: register(t0);
+
+RWTexture2D<float4> pingpong0: register(u0);
+RWTexture2D<float4> pingpong1: register(u1);
+
+float2 Mul(float2 c0, float2 c1)
+{
+	return float2(c0.x * c1.x - c0.y * c1.y, c0.x * c1.y + c0.y * c1.x);
+}
+
+float2 MulI(float2 c)
+{
+	return float2(-c.y, c.x);
+}
+
+uint2 Texel(int index, int line)
+{
+	//rows first, then columns
+	if (direction == 0)
+		return uint2(index, line);
+	return uint2(line, index);
+}
+
+float2 Read(int index, int line)
+{
+	if (pingpong == 0)
+		return pingpong0[Texel(index, line)].rg;
+	return pingpong1[Texel(index, line)].rg;
+}
+
+void Write(int index, int line, float2 value)
+{
+	if (pingpong == 0)
+		pingpong1[Texel(index, line)] = float4(value, 0, 1);
+	else
+		pingpong0[Texel(index, line)] = float4(value, 0, 1);
+}
+
+void FFT2(inout float2 a, inout float2 b)
+{
+	float2 t = a;
+	a = t + b;
+	b = t - b;
+}
+
+void FFT4(inout float2 a0, inout float2 a1, inout float2 a2, inout float2 a3)
+{
+	float2 t0 = a0 + a2;
+	float2 t1 = a0 - a2;
+	float2 t2 = a1 + a3;
+	float2 t3 = MulI(a1 - a3);
+	a0 = t0 + t2;
+	a1 = t1 + t3;
+	a2 = t0 - t2;
+	a3 = t1 - t3;
+}
+
+[numthreads(16, 16, 1)]
+void main( uint3 id : SV_DispatchThreadID )
+{
+	int stride = fftRes / radix;
+	int j = id.x;
+	int line = id.y;
+	if (j >= stride || line >= fftRes)
+		return;
+
+	int k = j % span;
+	int twiddleStep = fftRes / (span * radix);
+
+	float2 v[8];
+	[unroll]
+	for (int r = 0; r < 8; r++)
+	{
+		v[r] = float2(0, 0);
+		if (r < radix)
+			v[r] = Mul(Read(j + r * stride, line), twiddles[uint2(k * r * twiddleStep, 0)]);
+	}
+
+	if (radix == 8)
+	{
+		//the even and odd halves, then joined with the eighth roots of unity
+		FFT4(v[0], v[2], v[4], v[6]);
+		FFT4(v[1], v[3], v[5], v[7]);
+
+		float2 roots[4] = { float2(1, 0), float2(SQRT_HALF, SQRT_HALF), float2(0, 1), float2(-SQRT_HALF, SQRT_HALF) };
+		float2 result[8];
+		[unroll]
+		for (int m = 0; m < 4; m++)
+		{
+			float2 odd = Mul(v[2 * m + 1], roots[m]);
+			result[m] = v[2 * m] + odd;
+			result[m + 4] = v[2 * m] - odd;
+		}
+		v = result;
+	}
+	else if (radix == 4)
+	{
+		FFT4(v[0], v[1], v[2], v[3]);
+	}
+	else
+	{
+		FFT2(v[0], v[1]);
+	}
+
+	int base = (j - k) * radix + k;
+	[unroll]
+	for (int w = 0; w < 8; w++)
+	{
+		if (w < radix)
+			Write(base + w * span, line, v[w]);
+	}
+}
@@ -0,0 +1,49 @@
+#include "Frustum.h"
+
+Frustum::Frustum()
+{
+	//sees everything
+	for (int i = 0; i < 6; i++)
+	{
+		planes[i] = XMFLOAT4(0, 0, 0, 1);
+	}
+}
+
+Frustum::Frustum(const XMFLOAT4X4& view, const XMFLOAT4X4& projection)
+{
+	//with both transposed the rows here are the columns of view * projection, and the
+	//planes come straight out of them
+	XMFLOAT4X4 viewProj;
+	XMStoreFloat4x4(&viewProj, XMMatrixMultiply(XMLoadFloat4x4(&projection), XMLoadFloat4x4(&view)));
+	XMFLOAT4 row[4] = {
+		XMFLOAT4(viewProj._11, viewProj._12, viewProj._13, viewProj._14),
+		XMFLOAT4(viewProj._21, viewProj._22, viewProj._23, viewProj._24),
+		XMFLOAT4(viewProj._31, viewProj._32, viewProj._33, viewProj._34),
+		XMFLOAT4(viewProj._41, viewProj._42, viewProj._43, viewProj._44) };
+	planes[0] = XMFLOAT4(row[3].x + row[0].x, row[3].y + row[0].y, row[3].z + row[0].z, row[3].w + row[0].w);
+	planes[1] = XMFLOAT4(row[3].x - row[0].x, row[3].y - row[0].y, row[3].z - row[0].z, row[3].w - row[0].w);
+	planes[2] = XMFLOAT4(row[3].x + row[1].x, row[3].y + row[1].y, row[3].z + row[1].z, row[3].w + row[1].w);
+	planes[3] = XMFLOAT4(row[3].x - row[1].x, row[3].y - row[1].y, row[3].z - row[1].z, row[3].w - row[1].w);
+	planes[4] = row[2]; //z goes from 0 to w
+	planes[5] = XMFLOAT4(row[3].x - row[2].x, row[3].y - row[2].y, row[3].z - row[2].z, row[3].w - row[2].w);
+}
+
+bool Frustum::IntersectsBox(XMFLOAT3 min, XMFLOAT3 max) const
+{
+	for (int i = 0; i < 6; i++)
+	{
+		//the corner of the box furthest along the plane's normal
+		const XMFLOAT4& p = planes[i];
+		float px = p.x >= 0 ? max.x : min.x;
+		float py = p.y >= 0 ? max.y : min.y;
+		float pz = p.z >= 0 ? max.z : min.z;
+		if (p.x * px + p.y * py + p.z * pz + p.w < 0)
+			return false;
+	}
+	return true;
+}
+
+XMFLOAT4 Frustum::GetPlane(int index) const
+{
+	return planes[index];
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include<DirectXMath.h>
+using namespace DirectX;
+
+//the six planes of a camera's view volume, for throwing away boxes it can't see
+class Frustum
+{
+	XMFLOAT4 planes[6]; //pointing inwards, left, right, bottom, top, near, far
+
+public:
+	Frustum();
+	//view and projection transposed for hlsl, the way Camera keeps them
+	Frustum(const XMFLOAT4X4& view, const XMFLOAT4X4& projection);
+
+	//false only when the box is entirely outside one of the planes
+	bool IntersectsBox(XMFLOAT3 min, XMFLOAT3 max) const;
+	XMFLOAT4 GetPlane(int index) const;
+};
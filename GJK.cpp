@@ -0,0 +1,530 @@
+#include "GJK.h"
+#include<cmath>
+#include<cfloat>
+#include<algorithm>
+
+#define GJK_MAX_ITERATIONS 32
+#define EPA_MAX_ITERATIONS 64
+#define EPA_MAX_VERTICES 96
+#define EPA_MAX_FACES 192
+
+//point of the minkowski difference and the hull vertices it came from
+struct SimplexVertex
+{
+	XMVECTOR w;
+	int indexA;
+	int indexB;
+};
+
+//support function of the minkowski difference a - b
+struct MinkowskiDifference
+{
+	const ConvexHull* hullA;
+	const ConvexHull* hullB;
+	XMMATRIX worldA;
+	XMMATRIX worldB;
+	XMMATRIX toLocalA; //transposed world matrices, they take a direction into the hull's space
+	XMMATRIX toLocalB;
+
+	XMVECTOR Point(int indexA, int indexB) const
+	{
+		XMVECTOR pointA = XMVector3TransformCoord(XMLoadFloat3(&hullA->GetVertices()[indexA]), worldA);
+		XMVECTOR pointB = XMVector3TransformCoord(XMLoadFloat3(&hullB->GetVertices()[indexB]), worldB);
+		return pointA - pointB;
+	}
+
+	SimplexVertex Support(FXMVECTOR direction) const
+	{
+		SimplexVertex vertex;
+		vertex.indexA = hullA->Support(XMVector3TransformNormal(direction, toLocalA));
+		vertex.indexB = hullB->Support(XMVector3TransformNormal(-direction, toLocalB));
+		vertex.w = Point(vertex.indexA, vertex.indexB);
+		return vertex;
+	}
+};
+
+static float Dot(FXMVECTOR a, FXMVECTOR b)
+{
+	return XMVectorGetX(XMVector3Dot(a, b));
+}
+
+//the closest point to the origin on a simplex, which is reduced to the vertices of the
+//feature that point lies on
+static XMVECTOR ClosestOnSegment(SimplexVertex* simplex, int& count)
+{
+	XMVECTOR a = simplex[0].w;
+	XMVECTOR ab = simplex[1].w - a;
+	float lengthSq = Dot(ab, ab);
+	float t = lengthSq > 1e-12f ? Dot(-a, ab) / lengthSq : 0.0f;
+
+	if (t <= 0.0f)
+	{
+		count = 1;
+		return a;
+	}
+	if (t >= 1.0f)
+	{
+		simplex[0] = simplex[1];
+		count = 1;
+		return simplex[0].w;
+	}
+
+	return a + ab * t;
+}
+
+static XMVECTOR ClosestOnTriangle(SimplexVertex* simplex, int& count)
+{
+	//voronoi regions of the triangle, see real time collision detection 5.1.5
+	XMVECTOR a = simplex[0].w;
+	XMVECTOR b = simplex[1].w;
+	XMVECTOR c = simplex[2].w;
+	XMVECTOR ab = b - a;
+	XMVECTOR ac = c - a;
+
+	float d1 = Dot(ab, -a);
+	float d2 = Dot(ac, -a);
+	if (d1 <= 0.0f && d2 <= 0.0f)
+	{
+		count = 1;
+		return a;
+	}
+
+	float d3 = Dot(ab, -b);
+	float d4 = Dot(ac, -b);
+	if (d3 >= 0.0f && d4 <= d3)
+	{
+		simplex[0] = simplex[1];
+		count = 1;
+		return b;
+	}
+
+	float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+	{
+		count = 2;
+		return a + ab * (d1 / (d1 - d3));
+	}
+
+	float d5 = Dot(ab, -c);
+	float d6 = Dot(ac, -c);
+	if (d6 >= 0.0f && d5 <= d6)
+	{
+		simplex[0] = simplex[2];
+		count = 1;
+		return c;
+	}
+
+	float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+	{
+		simplex[1] = simplex[2];
+		count = 2;
+		return a + ac * (d2 / (d2 - d6));
+	}
+
+	float va = d3 * d6 - d5 * d4;
+	if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+	{
+		simplex[0] = simplex[1];
+		simplex[1] = simplex[2];
+		count = 2;
+		return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+	}
+
+	//a sliver, the closest point is on one of its edges
+	float area = va + vb + vc;
+	if (fabsf(area) < 1e-12f)
+	{
+		count = 2;
+		return ClosestOnSegment(simplex, count);
+	}
+
+	float denominator = 1.0f / area;
+	return a + ab * (vb * denominator) + ac * (vc * denominator);
+}
+
+//true when the origin and d are on different sides of the plane through a, b and c
+static bool OriginOutsideFace(FXMVECTOR a, FXMVECTOR b, FXMVECTOR c, GXMVECTOR d)
+{
+	XMVECTOR normal = XMVector3Cross(b - a, c - a);
+	float signOrigin = Dot(-a, normal);
+	float signD = Dot(d - a, normal);
+
+	//a flat tetrahedron can't contain the origin, every face has to be checked
+	float flatness = 1e-4f * XMVectorGetX(XMVector3Length(normal)) * XMVectorGetX(XMVector3Length(d - a));
+	if (fabsf(signD) <= flatness)
+		return true;
+
+	return signOrigin * signD < 0.0f;
+}
+
+static XMVECTOR ClosestOnTetrahedron(SimplexVertex* simplex, int& count, bool& containsOrigin)
+{
+	static const int faces[4][4] = { { 0, 1, 2, 3 }, { 0, 2, 3, 1 }, { 0, 3, 1, 2 }, { 1, 3, 2, 0 } };
+
+	containsOrigin = true;
+	XMVECTOR closest = XMVectorZero();
+	float closestDistanceSq = FLT_MAX;
+	SimplexVertex best[3];
+	int bestCount = 0;
+
+	for (int i = 0; i < 4; i++)
+	{
+		const int* f = faces[i];
+		if (!OriginOutsideFace(simplex[f[0]].w, simplex[f[1]].w, simplex[f[2]].w, simplex[f[3]].w))
+			continue;
+
+		containsOrigin = false;
+
+		SimplexVertex triangle[3] = { simplex[f[0]], simplex[f[1]], simplex[f[2]] };
+		int triangleCount = 3;
+		XMVECTOR point = ClosestOnTriangle(triangle, triangleCount);
+		float distanceSq = Dot(point, point);
+		if (distanceSq < closestDistanceSq)
+		{
+			closestDistanceSq = distanceSq;
+			closest = point;
+			bestCount = triangleCount;
+			for (int j = 0; j < triangleCount; j++)
+			{
+				best[j] = triangle[j];
+			}
+		}
+	}
+
+	if (containsOrigin)
+		return XMVectorZero();
+
+	count = bestCount;
+	for (int j = 0; j < bestCount; j++)
+	{
+		simplex[j] = best[j];
+	}
+	return closest;
+}
+
+static XMVECTOR ClosestOnSimplex(SimplexVertex* simplex, int& count, bool& containsOrigin)
+{
+	containsOrigin = false;
+	switch (count)
+	{
+	case 1:
+		return simplex[0].w;
+	case 2:
+		return ClosestOnSegment(simplex, count);
+	case 3:
+		return ClosestOnTriangle(simplex, count);
+	default:
+		return ClosestOnTetrahedron(simplex, count, containsOrigin);
+	}
+}
+
+//grows the simplex gjk stopped with into a tetrahedron, epa needs a volume to start from
+static bool BlowUpSimplex(const MinkowskiDifference& shape, SimplexVertex* simplex, int& count)
+{
+	const float epsilon = 1e-6f;
+
+	if (count == 1)
+	{
+		XMVECTOR directions[6] = {
+			XMVectorSet(1, 0, 0, 0), XMVectorSet(-1, 0, 0, 0),
+			XMVectorSet(0, 1, 0, 0), XMVectorSet(0, -1, 0, 0),
+			XMVectorSet(0, 0, 1, 0), XMVectorSet(0, 0, -1, 0) };
+		for (int i = 0; i < 6 && count == 1; i++)
+		{
+			SimplexVertex w = shape.Support(directions[i]);
+			if (XMVectorGetX(XMVector3LengthSq(w.w - simplex[0].w)) > epsilon)
+				simplex[count++] = w;
+		}
+	}
+
+	if (count == 2)
+	{
+		//searching around the line
+		XMVECTOR line = XMVector3Normalize(simplex[1].w - simplex[0].w);
+		XMFLOAT3 l;
+		XMStoreFloat3(&l, XMVectorAbs(line));
+		XMVECTOR axis = (l.x <= l.y && l.x <= l.z) ? XMVectorSet(1, 0, 0, 0) :
+			(l.y <= l.z ? XMVectorSet(0, 1, 0, 0) : XMVectorSet(0, 0, 1, 0));
+		XMVECTOR side1 = XMVector3Normalize(XMVector3Cross(line, axis));
+		XMVECTOR side2 = XMVector3Cross(line, side1);
+
+		for (int i = 0; i < 6 && count == 2; i++)
+		{
+			float angle = i * XM_PI / 3.0f;
+			SimplexVertex w = shape.Support(side1 * cosf(angle) + side2 * sinf(angle));
+			if (XMVectorGetX(XMVector3LengthSq(XMVector3Cross(w.w - simplex[0].w, line))) > epsilon)
+				simplex[count++] = w;
+		}
+	}
+
+	if (count == 3)
+	{
+		XMVECTOR normal = XMVector3Normalize(XMVector3Cross(simplex[1].w - simplex[0].w, simplex[2].w - simplex[0].w));
+		SimplexVertex w = shape.Support(normal);
+		if (fabsf(Dot(w.w - simplex[0].w, normal)) <= epsilon)
+			w = shape.Support(-normal);
+		if (fabsf(Dot(w.w - simplex[0].w, normal)) > epsilon)
+			simplex[count++] = w;
+	}
+
+	return count == 4;
+}
+
+struct EPAFace
+{
+	int v[3];
+	XMFLOAT3 normal;
+	float distance;
+};
+
+struct EPAPolytope
+{
+	XMFLOAT3 vertices[EPA_MAX_VERTICES];
+	int vertexCount;
+	EPAFace faces[EPA_MAX_FACES];
+	int faceCount;
+	XMFLOAT3 inside; //stays inside while the polytope grows, used to orient new faces
+
+	bool AddFace(int a, int b, int c)
+	{
+		if (faceCount == EPA_MAX_FACES)
+			return false;
+
+		EPAFace& face = faces[faceCount++];
+		face.v[0] = a;
+		face.v[1] = b;
+		face.v[2] = c;
+
+		XMVECTOR pa = XMLoadFloat3(&vertices[a]);
+		XMVECTOR normal = XMVector3Cross(XMLoadFloat3(&vertices[b]) - pa, XMLoadFloat3(&vertices[c]) - pa);
+		float length = XMVectorGetX(XMVector3Length(normal));
+		if (length < 1e-12f)
+		{
+			//a sliver, never picked as the closest face
+			face.normal = XMFLOAT3(0, 0, 0);
+			face.distance = FLT_MAX;
+			return true;
+		}
+
+		normal /= length;
+		if (Dot(normal, pa - XMLoadFloat3(&inside)) < 0.0f)
+		{
+			normal = -normal;
+			std::swap(face.v[1], face.v[2]);
+		}
+
+		XMStoreFloat3(&face.normal, normal);
+		face.distance = Dot(normal, pa);
+		return true;
+	}
+};
+
+static void RunEPA(const MinkowskiDifference& shape, const SimplexVertex* simplex, ContactInfo* contact)
+{
+	EPAPolytope polytope;
+	polytope.vertexCount = 4;
+	polytope.faceCount = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		XMStoreFloat3(&polytope.vertices[i], simplex[i].w);
+	}
+	XMStoreFloat3(&polytope.inside, (simplex[0].w + simplex[1].w + simplex[2].w + simplex[3].w) * 0.25f);
+
+	polytope.AddFace(0, 1, 2);
+	polytope.AddFace(0, 3, 1);
+	polytope.AddFace(0, 2, 3);
+	polytope.AddFace(1, 3, 2);
+
+	int edges[EPA_MAX_FACES * 3][2];
+	int closest = 0;
+
+	for (int iteration = 0; iteration < EPA_MAX_ITERATIONS; iteration++)
+	{
+		closest = 0;
+		for (int i = 1; i < polytope.faceCount; i++)
+		{
+			if (polytope.faces[i].distance < polytope.faces[closest].distance)
+				closest = i;
+		}
+
+		//the polytope can't grow any further towards this face, it is on the boundary
+		XMVECTOR normal = XMLoadFloat3(&polytope.faces[closest].normal);
+		XMVECTOR w = shape.Support(normal).w;
+		if (Dot(w, normal) - polytope.faces[closest].distance < 1e-4f || polytope.vertexCount == EPA_MAX_VERTICES)
+			break;
+
+		int newVertex = polytope.vertexCount++;
+		XMStoreFloat3(&polytope.vertices[newVertex], w);
+
+		//removing the faces that can see the new point, their outline stays as the horizon
+		int edgeCount = 0;
+		for (int i = polytope.faceCount - 1; i >= 0; i--)
+		{
+			EPAFace& face = polytope.faces[i];
+			if (face.distance == FLT_MAX ||
+				Dot(XMLoadFloat3(&face.normal), w - XMLoadFloat3(&polytope.vertices[face.v[0]])) <= 1e-6f)
+			{
+				continue;
+			}
+
+			for (int e = 0; e < 3; e++)
+			{
+				int a = face.v[e];
+				int b = face.v[(e + 1) % 3];
+
+				//an edge shared by two removed faces is inside the hole
+				bool shared = false;
+				for (int j = 0; j < edgeCount; j++)
+				{
+					if (edges[j][0] == b && edges[j][1] == a)
+					{
+						edges[j][0] = edges[edgeCount - 1][0];
+						edges[j][1] = edges[edgeCount - 1][1];
+						edgeCount--;
+						shared = true;
+						break;
+					}
+				}
+				if (!shared)
+				{
+					edges[edgeCount][0] = a;
+					edges[edgeCount][1] = b;
+					edgeCount++;
+				}
+			}
+
+			polytope.faces[i] = polytope.faces[--polytope.faceCount];
+		}
+
+		bool full = false;
+		for (int j = 0; j < edgeCount && !full; j++)
+		{
+			full = !polytope.AddFace(edges[j][0], edges[j][1], newVertex);
+		}
+		if (full)
+			break;
+	}
+
+	closest = 0;
+	for (int i = 1; i < polytope.faceCount; i++)
+	{
+		if (polytope.faces[i].distance < polytope.faces[closest].distance)
+			closest = i;
+	}
+
+	contact->normal = polytope.faces[closest].normal;
+	contact->depth = polytope.faces[closest].distance;
+	contact->distance = 0.0f;
+}
+
+bool GJKCollision(const ConvexHull& hullA, const XMFLOAT4X4& worldA,
+	const ConvexHull& hullB, const XMFLOAT4X4& worldB,
+	GJKCache* cache, ContactInfo* contact)
+{
+	if (hullA.GetVertices().empty() || hullB.GetVertices().empty())
+		return false;
+
+	MinkowskiDifference shape;
+	shape.hullA = &hullA;
+	shape.hullB = &hullB;
+	shape.worldA = XMLoadFloat4x4(&worldA);
+	shape.worldB = XMLoadFloat4x4(&worldB);
+	shape.toLocalA = XMMatrixTranspose(shape.worldA);
+	shape.toLocalB = XMMatrixTranspose(shape.worldB);
+
+	//rebuilding last frame's simplex from the same hull vertices, placed where the bodies are now
+	SimplexVertex simplex[4];
+	int count = 0;
+	if (cache != nullptr)
+	{
+		for (int i = 0; i < cache->count; i++)
+		{
+			if (cache->indexA[i] >= (int)hullA.GetVertices().size() || cache->indexB[i] >= (int)hullB.GetVertices().size())
+			{
+				count = 0;
+				break;
+			}
+
+			simplex[count].indexA = cache->indexA[i];
+			simplex[count].indexB = cache->indexB[i];
+			simplex[count].w = shape.Point(cache->indexA[i], cache->indexB[i]);
+			count++;
+		}
+	}
+
+	//otherwise the direction from a to b is a good first guess
+	if (count == 0)
+	{
+		XMVECTOR direction = shape.worldB.r[3] - shape.worldA.r[3];
+		if (Dot(direction, direction) < 1e-12f)
+			direction = XMVectorSet(1, 0, 0, 0);
+		simplex[0] = shape.Support(direction);
+		count = 1;
+	}
+
+	bool intersecting = false;
+	XMVECTOR v = ClosestOnSimplex(simplex, count, intersecting);
+
+	for (int iteration = 0; iteration < GJK_MAX_ITERATIONS && !intersecting; iteration++)
+	{
+		float vLengthSq = Dot(v, v);
+		if (vLengthSq < 1e-10f)
+		{
+			intersecting = true;
+			break;
+		}
+
+		SimplexVertex w = shape.Support(-v);
+		float vDotW = Dot(v, w.w);
+
+		//a separating plane is enough when nobody asked for the distance
+		if (contact == nullptr && vDotW > 0.0f)
+			break;
+
+		//the closest point can't get any closer
+		if (vLengthSq - vDotW <= 1e-5f * vLengthSq)
+			break;
+
+		simplex[count++] = w;
+		v = ClosestOnSimplex(simplex, count, intersecting);
+	}
+
+	if (cache != nullptr)
+	{
+		cache->count = count;
+		for (int i = 0; i < count; i++)
+		{
+			cache->indexA[i] = simplex[i].indexA;
+			cache->indexB[i] = simplex[i].indexB;
+		}
+	}
+
+	if (!intersecting)
+	{
+		if (contact != nullptr)
+		{
+			contact->distance = sqrtf(Dot(v, v));
+			contact->depth = 0.0f;
+			XMStoreFloat3(&contact->normal, XMVector3Normalize(-v));
+		}
+		return false;
+	}
+
+	if (contact != nullptr)
+	{
+		if (BlowUpSimplex(shape, simplex, count))
+		{
+			RunEPA(shape, simplex, contact);
+		}
+		else
+		{
+			//the hulls only touch, there is no depth to report
+			XMStoreFloat3(&contact->normal, XMVector3Normalize(shape.worldB.r[3] - shape.worldA.r[3]));
+			contact->depth = 0.0f;
+			contact->distance = 0.0f;
+		}
+	}
+
+	return true;
+}
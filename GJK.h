@@ -0,0 +1,28 @@
+#pragma once
+#include<DirectXMath.h>
+#include"ConvexHull.h"
+using namespace DirectX;
+
+//what GJK keeps between frames for one pair of hulls
+//the simplex is stored as the hull vertices it was made of and rebuilt at the new poses,
+//which usually finishes in one or two iterations because bodies barely move between frames
+struct GJKCache
+{
+	int count; //0 when there is nothing cached yet
+	int indexA[4];
+	int indexB[4];
+};
+
+struct ContactInfo
+{
+	XMFLOAT3 normal; //from a towards b
+	float depth; //how far the hulls overlap along the normal
+	float distance; //gap between the hulls when they don't touch
+};
+
+//gjk distance between two hulls placed with their (untransposed) world matrices
+//returns true when they overlap, in which case epa fills the contact normal and depth
+//cache and contact can be null
+bool GJKCollision(const ConvexHull& hullA, const XMFLOAT4X4& worldA,
+	const ConvexHull& hullB, const XMFLOAT4X4& worldB,
+	GJKCache* cache, ContactInfo* contact);
@@ -1,5 +1,6 @@
 #include "Game.h"
 #include "Vertex.h"
+#include<cstring>
 
 // For the DirectX Math library
 using namespace DirectX;
@@ -67,6 +68,8 @@ Game::Game(HINSTANCE hInstance)
 	waterReflectionPS = nullptr;
 	waterReflectionVS = nullptr;
 	waterSampler = nullptr;
+	//started with -lowendocean on the command line for machines that can't run the fft
+	lowEndOcean = strstr(GetCommandLineA(), "-lowendocean") != nullptr;
 
 	terrainTexture1 = nullptr;
 	terrainTexture2 = nullptr;
@@ -77,13 +80,8 @@ Game::Game(HINSTANCE hInstance)
 	terrainBlendMap=nullptr;
 	terrainPS = nullptr;
 
-	noiseR1 = nullptr;
-	noiseI1 = nullptr;
-	noiseR2 = nullptr;
-	noiseI2 = nullptr;
 	foam = nullptr;
-	twiddleFactorsCS = nullptr;
-	butterflyCS = nullptr;
+	fftStageCS = nullptr;
 	inversionCS = nullptr;
 	sobelFilter = nullptr;
 	jacobianCS = nullptr;
@@ -205,10 +203,8 @@ Game::~Game()
 	particleDepth->Release();
 	dssLessEqual->Release();
 
-	delete h0CS;
 	delete htCS;
-	delete twiddleFactorsCS;
-	delete butterflyCS;
+	delete fftStageCS;
 	delete inversionCS;
 	delete sobelFilter;
 	delete jacobianCS;
@@ -239,18 +235,6 @@ Game::~Game()
 	if (waterReflectionSRV)
 		waterReflectionSRV->Release();
 
-	if (noiseR1)
-		noiseR1->Release();
-
-	if (noiseI1)
-		noiseI1->Release();
-
-	if (noiseR2)
-		noiseR2->Release();
-
-	if (noiseI2)
-		noiseI2->Release();
-
 	if (waterSampler)
 		waterSampler->Release();
 
@@ -379,7 +363,7 @@ void Game::Init()
 	blend.RenderTarget[0].BlendEnable = true;
 	blend.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
 	blend.RenderTarget[0].SrcBlend = D3D11_BLEND_SRC_ALPHA; // Still respect pixel shader output alpha
-	blend.RenderTarget[0].DestBlend = D3D11_BLEND_ONE;
+	blend.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA; // the pool draws back to front, so over blending works
 	blend.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
 	blend.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
 	blend.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ONE;
@@ -523,6 +507,19 @@ void Game::Init()
 
 	CreateEnvironmentLUTs();
 
+	spatialTree = std::make_shared<AABBTree>();
+
+	//one worker per extra hardware thread, shared by everything that splits up work on the cpu
+	threads = std::make_unique<ThreadPool>();
+
+	//the simulation runs at 60hz whatever the frame rate is, rendering interpolates between steps
+	SetFixedTimeStep(1.0f / 60.0f, 5);
+
+	//obstacles don't hit each other and bullets only hit obstacles
+	collisionMatrix.SetCollision(CollisionLayer::Obstacle, CollisionLayer::Obstacle, false);
+	collisionMatrix.SetCollision(CollisionLayer::Bullet, CollisionLayer::Bullet, false);
+	collisionMatrix.SetCollision(CollisionLayer::Bullet, CollisionLayer::Player, false);
+
 	InitializeEntities();
 
 	bulletCounter = 0;
@@ -530,6 +527,12 @@ void Game::Init()
 	auto emmiterPos = ship->GetPosition();
 	emmiterPos.x += 4;
 
+	//every run seeds its emitters the same, in the order they are made
+	Emitter::ResetSeeds(1);
+	//one pool that every emitter's particles live in and are drawn from
+	particlePool = std::make_shared<ParticlePool>(device, particleVS, particlePS, particleTexture, threads.get());
+	particleBudget.SetBudget(PARTICLE_BUDGET);
+
 	shipGas = std::make_shared<Emitter>(
 		3000, //max particles
 		100, //particles per second
@@ -544,7 +547,7 @@ void Game::Init()
 		XMFLOAT3(0.1f, 0.1f, 0.1f), //position deviation range
 		XMFLOAT4(-2, 2, -2, 2), //rotation around z axis
 		XMFLOAT3(0.f, -1.f, 0.f), //acceleration
-		device, particleVS, particlePS, particleTexture);
+		particlePool);
 
 	auto emitter = std::make_shared<Emitter>(
 		1000, //max particles
@@ -560,7 +563,7 @@ void Game::Init()
 		XMFLOAT3(0.1f, 0.1f, 0.1f), //position deviatio
 		XMFLOAT4(-2, 2, -2, 2), //rotation around z axi
 		XMFLOAT3(0.f, 1.f, 0.f), //acceleration
-		device, particleVS, particlePS, particleTexture
+		particlePool
 		);
 
 	auto emitter2 = std::make_shared<Emitter>(
@@ -577,8 +580,11 @@ void Game::Init()
 		XMFLOAT3(0.1f, 0.1f, 0.1f), //position deviatio
 		XMFLOAT4(-2, 2, -2, 2), //rotation around z axi
 		XMFLOAT3(0.f, -2.f, 0.f), //acceleration
-		device, particleVS, particlePS, particleTexture
+		particlePool
 		);
+	//the ship's trails go last when the budget runs short
+	emitter->SetPriority(2.0f);
+	emitter2->SetPriority(2.0f);
 	emitterList.emplace_back(emitter);
 	emitterList.emplace_back(emitter2);
 
@@ -661,17 +667,11 @@ void Game::LoadShaders()
 	terrainPS = new SimplePixelShader(device, context);
 	terrainPS->LoadShaderFile(L"TerrainPS.cso");
 
-	h0CS = new SimpleComputeShader(device, context);
-	h0CS->LoadShaderFile(L"H0OceanCS.cso");
-
 	htCS = new SimpleComputeShader(device, context);
 	htCS->LoadShaderFile(L"HtOceanCS.cso");
 
-	twiddleFactorsCS = new SimpleComputeShader(device, context);
-	twiddleFactorsCS->LoadShaderFile(L"TwiddleFactorsCS.cso");
-
-	butterflyCS = new SimpleComputeShader(device, context);
-	butterflyCS->LoadShaderFile(L"ButterflyCS.cso");
+	fftStageCS = new SimpleComputeShader(device, context);
+	fftStageCS->LoadShaderFile(L"FFTStageCS.cso");
 
 	inversionCS = new SimpleComputeShader(device, context);
 	inversionCS->LoadShaderFile(L"InversionCS.cso");
@@ -733,11 +733,6 @@ void Game::CreateBasicGeometry()
 	CreateWICTextureFromFile(device, context, L"../../Assets/Textures/grass3_normals.png", 0, &terrainNormalTexture2);
 	CreateWICTextureFromFile(device, context, L"../../Assets/Textures/mountain3_normals.png", 0, &terrainNormalTexture3);
 
-	//noise textures
-	CreateWICTextureFromFile(device, context, L"../../Assets/Textures/NoiseR1.jpg", 0, &noiseR1);
-	CreateWICTextureFromFile(device, context, L"../../Assets/Textures/NoiseI1.jpg", 0, &noiseI1);
-	CreateWICTextureFromFile(device, context, L"../../Assets/Textures/NoiseR2.jpg", 0, &noiseR2);
-	CreateWICTextureFromFile(device, context, L"../../Assets/Textures/NoiseI2.jpg", 0, &noiseI2);
 	CreateWICTextureFromFile(device, context, L"../../Assets/Textures/foam.png", 0, &foam);
 
 	//creating a sampler state
@@ -770,7 +765,6 @@ void Game::CreateBasicGeometry()
 	std::shared_ptr<Mesh> object = std::make_shared<Mesh>("../../Assets/Models/cube.obj", device);
 	obstacleMesh = std::make_shared<Mesh>("../../Assets/Models/sphere.obj", device);
 	bulletMesh = std::make_shared<Mesh>("../../Assets/Models/sphere.obj", device);
-	waterMesh = std::make_shared<Mesh>("../../Assets/Models/quad.obj", device);
 
 	//sampler state description
 	memset(&samplerDesc, 0, sizeof(samplerDesc));
@@ -827,7 +821,7 @@ void Game::GenerateTerrain()
 void Game::InitializeEntities()
 {
 	ship = std::make_shared<Ship>(shipMesh, material);
-	ship->UseRigidBody();
+	ship->UseRigidBody(spatialTree);
 	ship->SetTag("Player");
 	ship->SetPosition(XMFLOAT3(-50, 2, 0));
 	entities.emplace_back(ship);
@@ -847,18 +841,52 @@ void Game::InitializeEntities()
 		bullets.emplace_back(newBullet);
 	}
 
-	water = std::make_shared<Water>(waterMesh, 
-		waterDiffuse, 
+	//the swell over a kilometre every other frame, then two smaller patches for the detail,
+	//instead of a single 1024 x 1024 transform
+	std::vector<OceanCascadeDesc> oceanCascades;
+	oceanCascades.push_back(OceanCascadeDesc{ 256, 1000, 2 });
+	oceanCascades.push_back(OceanCascadeDesc{ 256, 250, 1 });
+	oceanCascades.push_back(OceanCascadeDesc{ 128, 60, 1 });
+
+	//the cascades' h0 is made on the cpu from this, the fft size, L and band are per cascade
+	OceanSpectrumDesc oceanSpectrum = {};
+	oceanSpectrum.type = OceanSpectrumType::Phillips;
+	oceanSpectrum.amp = 4.0f;
+	oceanSpectrum.windDir = XMFLOAT2(1, 1);
+	oceanSpectrum.windSpeed = 40.0f;
+	oceanSpectrum.fetch = 100000.0f;
+	oceanSpectrum.depth = 30.0f;
+	oceanSpectrum.seed = 1;
+
+	water = std::make_shared<Water>(waterDiffuse, 
 		waterNormal1, waterNormal2, 
-		waterPS, waterVS, waterHS, waterDS, h0CS, htCS,
-		twiddleFactorsCS, butterflyCS,
+		waterPS, waterVS, waterHS, waterDS, htCS,
+		fftStageCS,
 		inversionCS, sobelFilter, jacobianCS,
 		samplerState,device,
-		noiseR1,noiseI1,noiseR2,noiseI2);
-
-	water->CreateH0Texture();
+		oceanSpectrum,oceanCascades,threads.get());
 
-	water->CreateTwiddleIndices();
+	//low end mode bakes a loop of the swell cascade's spectrum the first time and reads it
+	//back after. the file is named for the spectrum and its header has to match the loop, so
+	//changing either bakes again
+	if (lowEndOcean)
+	{
+		OceanSpectrumDesc bakedSpectrum = water->GetBakedSpectrum();
+		std::string cacheFile = "OceanCache" + std::to_string(OceanSpectrum::Hash(bakedSpectrum)) + ".bin";
+		std::shared_ptr<OceanCache> oceanCache = std::make_shared<OceanCache>();
+		if (!oceanCache->Load(cacheFile) ||
+			oceanCache->GetResolution() != bakedSpectrum.fftRes ||
+			oceanCache->GetPeriod() != OCEAN_CACHE_PERIOD ||
+			oceanCache->GetFrameCount() != OCEAN_CACHE_FRAMES ||
+			oceanCache->GetStartTime() != OCEAN_CACHE_START)
+		{
+			OceanFFT ocean(bakedSpectrum.fftRes, bakedSpectrum.L, bakedSpectrum.amp, bakedSpectrum.windDir, bakedSpectrum.windSpeed, threads.get());
+			ocean.SetH0(*OceanSpectrum::CreateH0(bakedSpectrum, threads.get()));
+			oceanCache->Bake(ocean, OCEAN_CACHE_PERIOD, OCEAN_CACHE_FRAMES, OCEAN_CACHE_START);
+			oceanCache->Save(cacheFile);
+		}
+		water->UseBakedOcean(oceanCache, device);
+	}
 
 	
 }
@@ -1227,6 +1255,10 @@ void Game::RestartGame()
 		entities[i] = nullptr;
 	}
 
+	//the proxies point at the entities that were just released
+	broadphase.Clear();
+	pairCache.Clear();
+
 	bulletCounter = 0;
 	
 	InitializeEntities();
@@ -1267,7 +1299,7 @@ void Game::DrawSceneOpaque(XMFLOAT4 clip)
 		entities[i]->GetMaterial()->GetVertexShader()->SetMatrix4x4("lightView", lightView);
 		entities[i]->GetMaterial()->GetVertexShader()->SetMatrix4x4("lightProj", lightProjection);
 		entities[i]->GetMaterial()->GetVertexShader()->SetFloat4("clipDistance", clip);
-		entities[i]->PrepareMaterial(view, camera->GetProjectionMatrix());
+		entities[i]->PrepareMaterial(view, camera->GetProjectionMatrix(), GetInterpolationAlpha());
 
 		//adding lights and sending camera position
 		entities[i]->GetMaterial()->GetPixelShader()->SetData("light", &directionalLight, sizeof(DirectionalLight)); //adding directional lights to the scene
@@ -1333,19 +1365,22 @@ void Game::DrawSceneBlend(XMFLOAT4 clip)
 
 void Game::DrawParticles(float totalTime, XMFLOAT4 clip)
 {
+	//emitters off screen are left out, and with none on screen there is nothing to set up
+	auto view = camera->GetViewMatrix();
+	auto projection = camera->GetProjectionMatrix();
+	int pass = reflect ? 1 : 0;
+	if (!particlePool->Cull(view, projection, pass))
+		return;
+
 	//rendering particle
 	float blend[4] = { 1,1,1,1 };
 	context->OMSetBlendState(particleBlendState, blend, 0xffffffff);
 	context->OMSetDepthStencilState(particleDepth, 0);
 
-	auto view = camera->GetViewMatrix();
-
 	particlePS->SetSamplerState("sampleOptions", samplerState);
 
-	for (int i = 0; i < emitterList.size(); i++)
-	{
-		emitterList[i]->Draw(context, view, camera->GetProjectionMatrix(), totalTime);
-	}
+	//every emitter at once, back to front
+	particlePool->Draw(context, view, projection, totalTime, pass);
 
 	context->OMSetDepthStencilState(0, 0);
 	context->OMSetBlendState(0, blend, 0xffffffff);
@@ -1398,7 +1433,7 @@ void Game::RenderShadowMap()
 		auto tempVertexBuffer = entities[i]->GetMesh()->GetVertexBuffer();
 		shadowVertexShader->SetMatrix4x4("view", lightView);
 		shadowVertexShader->SetMatrix4x4("projection", lightProjection);
-		shadowVertexShader->SetMatrix4x4("worldMatrix", entities[i]->GetModelMatrix());
+		shadowVertexShader->SetMatrix4x4("worldMatrix", entities[i]->GetInterpolatedModelMatrix(GetInterpolationAlpha()));
 		shadowVertexShader->CopyAllBufferData();
 		context->IASetVertexBuffers(0, 1, &tempVertexBuffer, &stride, &offset);
 		context->IASetIndexBuffer(entities[i]->GetMesh()->GetIndexBuffer(), DXGI_FORMAT_R32_UINT, 0);
@@ -1430,6 +1465,18 @@ void Game::DrawFullScreenQuad(ID3D11ShaderResourceView* texSRV)
 
 void Game::CreateExplosion(XMFLOAT3 pos)
 {
+	//an explosion that has burnt out is started over, so this allocates nothing once there
+	//have been a few
+	if (!spareExplosions.empty())
+	{
+		std::shared_ptr<Emitter> explosion = spareExplosions.back();
+		spareExplosions.pop_back();
+		explosion->Reset(pos);
+		explosion->SetTemporary(2.f);
+		emitterList.emplace_back(explosion);
+		return;
+	}
+
 	std::shared_ptr<Emitter> explosion = std::make_shared<Emitter>(
 		1000, //max particles
 		100, //particles per second
@@ -1444,7 +1491,18 @@ void Game::CreateExplosion(XMFLOAT3 pos)
 		XMFLOAT3(0.0f, 0.0f, 0.0f), //position deviation range
 		XMFLOAT4(-2, 2, -2, 2), //rotation around z axis
 		XMFLOAT3(0.f, 0.f, 0.f), //acceleration
-		device, particleVS, particlePS, particleTexture);
+		particlePool);
+
+	//the sparks slow down in the air and drift up, swirling, and skip off the land and the sea
+	ParticleForces forces = {};
+	forces.wind = XMFLOAT3(0.f, 1.f, 0.f);
+	forces.drag = 2.0f;
+	forces.turbulence = 3.0f;
+	forces.turbulenceScale = 0.5f;
+	forces.bounce = 0.3f;
+	forces.friction = 0.5f;
+	explosion->EnableSimulation(forces, threads.get());
+	explosion->SetCollision(&terrain->GetHeightField(), terrain->GetOffset(), water->GetQuadtree().GetSeaLevel());
 
 	explosion->SetTemporary(2.f);
 	emitterList.emplace_back(explosion);
@@ -1466,12 +1524,76 @@ void Game::CreateSmoke(XMFLOAT3 shipPos)
 		XMFLOAT3(0.2f, 0.2f, 0.2f), //position deviation range
 		XMFLOAT4(-2, 2, -2, 2), //rotation around z axis
 		XMFLOAT3(0.f, 0.f, 0.f), //acceleration
-		device, particleVS, particlePS, particleTexture);
+		particlePool);
 
 	emitterList.emplace_back(smoke);
 
 }
 
+std::shared_ptr<Entity> Game::RayCast(XMFLOAT3 origin, XMFLOAT3 direction, float maxDistance, float& hitDistance, unsigned int layerMask)
+{
+	XMStoreFloat3(&direction, XMVector3Normalize(XMLoadFloat3(&direction)));
+
+	//the tree only knows the boxes, the oriented box gives the real hit
+	void* hit = spatialTree->RayCast(origin, direction, maxDistance, hitDistance,
+		[&](int proxy, void* userData, float closest)
+		{
+			Entity* entity = static_cast<Entity*>(userData);
+			float distance;
+			if (!entity->GetAliveState() || (LayerBit(entity->GetCollisionLayer()) & layerMask) == 0 ||
+				!RayOBB(entity->GetRigidBody()->GetOrientedBox(), origin, direction, closest, distance))
+			{
+				return -1.0f;
+			}
+			return distance;
+		});
+
+	if (hit == nullptr)
+		return nullptr;
+
+	return static_cast<Entity*>(hit)->shared_from_this();
+}
+
+void Game::QuerySphere(XMFLOAT3 center, float radius, std::vector<std::shared_ptr<Entity>>& results, unsigned int layerMask)
+{
+	queryResults.clear();
+	spatialTree->QuerySphere(center, radius, queryResults);
+
+	for (size_t i = 0; i < queryResults.size(); i++)
+	{
+		Entity* entity = static_cast<Entity*>(queryResults[i]);
+		if (entity->GetAliveState() && (LayerBit(entity->GetCollisionLayer()) & layerMask) != 0 &&
+			SphereOBB(entity->GetRigidBody()->GetOrientedBox(), center, radius))
+		{
+			results.emplace_back(entity->shared_from_this());
+		}
+	}
+}
+
+void Game::QueryBox(XMFLOAT3 min, XMFLOAT3 max, std::vector<std::shared_ptr<Entity>>& results, unsigned int layerMask)
+{
+	queryResults.clear();
+	spatialTree->QueryBox(min, max, queryResults);
+
+	//the query box as an oriented box with the world axes
+	OrientedBox box;
+	XMStoreFloat3(&box.center, (XMLoadFloat3(&min) + XMLoadFloat3(&max)) * 0.5f);
+	XMStoreFloat3(&box.halfExtents, (XMLoadFloat3(&max) - XMLoadFloat3(&min)) * 0.5f);
+	box.axes[0] = XMFLOAT3(1, 0, 0);
+	box.axes[1] = XMFLOAT3(0, 1, 0);
+	box.axes[2] = XMFLOAT3(0, 0, 1);
+
+	for (size_t i = 0; i < queryResults.size(); i++)
+	{
+		Entity* entity = static_cast<Entity*>(queryResults[i]);
+		if (entity->GetAliveState() && (LayerBit(entity->GetCollisionLayer()) & layerMask) != 0 &&
+			OBBOverlap(box, entity->GetRigidBody()->GetOrientedBox()))
+		{
+			results.emplace_back(entity->shared_from_this());
+		}
+	}
+}
+
 
 // --------------------------------------------------------
 // Handle resizing DirectX "stuff" to match the new window size.
@@ -1503,9 +1625,6 @@ void Game::Update(float deltaTime, float totalTime)
 	if (GetAsyncKeyState(VK_ESCAPE))
 		Quit();
 
-	//updating the camera
-	camera->Update(deltaTime);
-
 	// add obstacles to screen
 	frameCounter += deltaTime;
 
@@ -1518,6 +1637,7 @@ void Game::Update(float deltaTime, float totalTime)
 	{
 		if (entities[i]->GetAliveState())
 		{
+			entities[i]->BeginPhysicsStep();
 			entities[i]->Update(deltaTime);
 			if (ship->GetHealth() < 4)
 			{
@@ -1529,19 +1649,112 @@ void Game::Update(float deltaTime, float totalTime)
 
 	water->Update(deltaTime, ship->GetPosition());
 
+	//bodies that went into the ground are pushed straight back up out of it
+	for (size_t i = 0; i < entities.size(); i++)
+	{
+		if (!entities[i]->HasRigidBody() || !entities[i]->GetAliveState())
+			continue;
 
-	//checking for collision
-	for (int i = 0; i < entities.size(); i++)
+		float depth;
+		if (terrain->CollideBody(entities[i]->GetRigidBody(), depth))
+		{
+			XMFLOAT3 position = entities[i]->GetPosition();
+			position.y += depth;
+			entities[i]->SetPosition(position);
+		}
+	}
+
+
+	//the tree only changes here, so RayCast and the other queries never run while it moves
+	for (size_t i = 0; i < entities.size(); i++)
 	{
-		for (int j = 0; j < entities.size(); j++)
+		if (entities[i]->GetAliveState())
+			entities[i]->UpdateTreeProxy();
+	}
+
+	//sending the world bounds of every living rigid body to the broadphase
+	for (size_t i = 0; i < entities.size(); i++)
+	{
+		if (!entities[i]->HasRigidBody())
+			continue;
+
+		int proxy = entities[i]->GetBroadphaseProxy();
+
+		//dead entities don't collide anymore
+		if (!entities[i]->GetAliveState())
+		{
+			if (proxy >= 0)
+			{
+				broadphase.RemoveProxy(proxy);
+				pairCache.RemoveProxy(proxy);
+				entities[i]->SetBroadphaseProxy(-1);
+			}
+			continue;
+		}
+
+		//getting the rigid body updates its bounds to the current model matrix
+		auto body = entities[i]->GetRigidBody();
+		CollisionLayer layer = entities[i]->GetCollisionLayer();
+
+		//fast movers cover everything they passed through this step
+		XMFLOAT3 min = entities[i]->IsFastMover() ? body->GetSweptMinGlobal() : body->GetMinGlobal();
+		XMFLOAT3 max = entities[i]->IsFastMover() ? body->GetSweptMaxGlobal() : body->GetMaxGlobal();
+
+		if (proxy < 0)
 		{
-			entities[i]->IsColliding(entities[j]);
+			entities[i]->SetBroadphaseProxy(broadphase.AddProxy(min, max, entities[i].get(),
+				LayerBit(layer), collisionMatrix.GetMask(layer)));
 		}
+		else
+		{
+			broadphase.UpdateProxy(proxy, min, max);
+			broadphase.SetProxyFilter(proxy, LayerBit(layer), collisionMatrix.GetMask(layer));
+		}
+	}
+
+	//checking for collision only between entities whose bounds overlap
+	const std::vector<BroadphasePair>& pairs = broadphase.FindPairs();
+	pairCache.BeginFrame();
+	for (size_t i = 0; i < pairs.size(); i++)
+	{
+		std::shared_ptr<Entity> entityA = static_cast<Entity*>(pairs[i].userDataA)->shared_from_this();
+		std::shared_ptr<Entity> entityB = static_cast<Entity*>(pairs[i].userDataB)->shared_from_this();
+		CollisionCache* cache = pairCache.Get(pairs[i].proxyA, pairs[i].proxyB);
+
+		bool hitA = entityA->IsColliding(entityB, cache);
+		bool hitB = entityB->IsColliding(entityA, cache);
+
+		//shots that hit something throw up a splash where they stopped
+		if (hitA && entityA->GetCollisionLayer() == CollisionLayer::Bullet)
+			water->AddSplash(entityA->GetPosition(), 0.5f);
+		if (hitB && entityB->GetCollisionLayer() == CollisionLayer::Bullet)
+			water->AddSplash(entityB->GetPosition(), 0.5f);
+	}
+	//pairs that left the broadphase start cold if they meet again
+	pairCache.EvictStale();
+
+	//emitters far away or off screen spawn less so the ones in front keep to the budget
+	budgetRequests.clear();
+	for (int i = 0; i < emitterList.size(); i++)
+	{
+		budgetRequests.push_back(emitterList[i]->GetBudgetRequest());
+	}
+	particleBudget.Update(budgetRequests, camera->GetViewMatrix(), camera->GetProjectionMatrix(), camera->GetPosition());
+	for (int i = 0; i < emitterList.size(); i++)
+	{
+		emitterList[i]->SetEmissionScale(particleBudget.GetScale(i));
 	}
 	
 	for (int i = 0; i < emitterList.size(); i++)
 	{
 		emitterList[i]->UpdateParticles(deltaTime, totalTime);
+
+		//only explosions are temporary, the finished ones are kept to be reused
+		if (emitterList[i]->IsFinished())
+		{
+			spareExplosions.emplace_back(emitterList[i]);
+			emitterList[i] = nullptr;
+		}
 	}
 
 
@@ -1555,6 +1768,10 @@ void Game::Update(float deltaTime, float totalTime)
 // --------------------------------------------------------
 void Game::Draw(float deltaTime, float totalTime)
 {
+	//the camera moves once a rendered frame instead of with the fixed steps, so it is as smooth
+	//as the interpolated entities and takes the input straight away
+	camera->Update(deltaTime);
+
 	// Background color (Cornflower Blue in this case) for clearing
 	const float color[4] = { 0.4f, 0.6f, 0.75f, 0.0f };
 
@@ -15,10 +15,19 @@
 #include"Textures.h"
 #include"Terrain.h"
 #include"Water.h"
+#include"SweepAndPrune.h"
+#include"AABBTree.h"
+#include"PairCache.h"
 #include<thread>
 #include<mutex>
 
 #define MAX_BULLETS 3
+//live particles every emitter shares
+#define PARTICLE_BUDGET 20000
+//the loop the low end ocean bakes, seconds long, frames in it and where in time it starts
+#define OCEAN_CACHE_PERIOD 20.0f
+#define OCEAN_CACHE_FRAMES 64
+#define OCEAN_CACHE_START 500.0f
 class Game 
 	: public DXCore
 {
@@ -60,6 +69,13 @@ private:
 	void CreateExplosion(XMFLOAT3 pos);
 	void CreateSmoke(XMFLOAT3 shipPos);
 
+	//spatial queries against the living entities in the tree, tested with their oriented boxes
+	//layerMask holds the LayerBit of every layer that can be found. the tree is as of the last
+	//UpdateTreeProxy pass in Update, entities that moved since are found where they were
+	std::shared_ptr<Entity> RayCast(XMFLOAT3 origin, XMFLOAT3 direction, float maxDistance, float& hitDistance, unsigned int layerMask = ~0u);
+	void QuerySphere(XMFLOAT3 center, float radius, std::vector<std::shared_ptr<Entity>>& results, unsigned int layerMask = ~0u);
+	void QueryBox(XMFLOAT3 min, XMFLOAT3 max, std::vector<std::shared_ptr<Entity>>& results, unsigned int layerMask = ~0u);
+
 
 	// Wrappers for DirectX shaders to provide simplified functionality
 	SimpleVertexShader* vertexShader;
@@ -89,11 +105,27 @@ private:
 	//sampler state for basic textures
 	ID3D11SamplerState* samplerState;
 
+	//the one pool of workers, for the ocean's spectra and the particles. declared before what
+	//uses it so it is destroyed after them
+	std::unique_ptr<ThreadPool> threads;
+
 	//creating a list of vectors
 	std::shared_ptr<Ship> ship;
 	std::vector<std::shared_ptr<Bullet>> bullets;
 	std::vector<std::shared_ptr<Entity>> entities;
 
+	//broadphase that finds the entity pairs worth testing for collision
+	SweepAndPrune broadphase;
+	//what each broadphase pair remembers from the last frame it was tested in
+	PairCache pairCache;
+
+	//which layers collide with each other, pairs of other layers never leave the broadphase
+	CollisionMatrix collisionMatrix;
+
+	//entities that can be found by ray, sphere and box queries
+	std::shared_ptr<AABBTree> spatialTree;
+	std::vector<void*> queryResults;
+
 	//meshes
 	std::shared_ptr<Mesh> shipMesh;
 	std::shared_ptr<Mesh> obstacleMesh;
@@ -195,9 +227,13 @@ private:
 	ID3D11ShaderResourceView* particleTexture;
 	ID3D11DepthStencilState* particleDepth;
 	ID3D11BlendState* particleBlendState;
+	std::shared_ptr<ParticlePool> particlePool; //before the emitters, which give their ranges back to it
 	std::shared_ptr<Emitter> shipGas;
 	std::shared_ptr<Emitter> shipGas2;
 	std::vector<std::shared_ptr<Emitter>> emitterList;
+	std::vector<std::shared_ptr<Emitter>> spareExplosions;
+	ParticleBudget particleBudget;
+	std::vector<ParticleBudgetRequest> budgetRequests;
 
 	//textures
 	ID3D11ShaderResourceView* textureSRV;
@@ -222,10 +258,10 @@ private:
 
 	//water textures
 	std::shared_ptr<Water> water;
+	bool lowEndOcean; //streams a baked loop instead of running the ocean fft every frame
 	ID3D11ShaderResourceView* waterDiffuse;
 	ID3D11ShaderResourceView* waterNormal1;
 	ID3D11ShaderResourceView* waterNormal2;
-	std::shared_ptr<Mesh> waterMesh;
 	ID3D11SamplerState* waterSampler;
 	SimplePixelShader* waterPS;
 	SimpleVertexShader* waterVS;
@@ -234,19 +270,13 @@ private:
 	ID3D11ShaderResourceView* waterReflectionSRV;
 	ID3D11RenderTargetView* waterReflectionRTV;
 	SimplePixelShader* fullScreenTrianglePS;
-	SimpleComputeShader* h0CS;
 	SimpleComputeShader* htCS;
-	SimpleComputeShader* twiddleFactorsCS;
-	SimpleComputeShader* butterflyCS;
+	SimpleComputeShader* fftStageCS;
 	SimpleComputeShader* inversionCS;
 	SimpleComputeShader* sobelFilter;
 	SimpleComputeShader* jacobianCS;
 	SimpleHullShader* waterHS;
 	SimpleDomainShader* waterDS;
-	ID3D11ShaderResourceView* noiseR1;
-	ID3D11ShaderResourceView* noiseI1;
-	ID3D11ShaderResourceView* noiseR2;
-	ID3D11ShaderResourceView* noiseI2;
 	ID3D11ShaderResourceView* foam;
 	ID3D11RasterizerState* wireFrame;
 	bool reflect;
@@ -0,0 +1,232 @@
+#include "GerstnerWaves.h"
+#include<cmath>
+
+//the value WaterVS uses, kept so the phases match the shader exactly
+static const float SHADER_PI = 3.14159f;
+//below this the jacobian is too close to singular for a newton step
+static const float MIN_DETERMINANT = 0.1f;
+
+GerstnerWaves::GerstnerWaves()
+{
+	iterations = 4;
+}
+
+void GerstnerWaves::AddWave(XMFLOAT4 wave)
+{
+	Wave w;
+	w.parameters = wave;
+	w.steepness = wave.z;
+	w.k = 2 * SHADER_PI / wave.w;
+	w.omega = sqrtf(9.8f / w.k) / 2;
+	w.amplitude = w.steepness / w.k;
+
+	float length = sqrtf(wave.x * wave.x + wave.y * wave.y);
+	w.directionX = wave.x / length;
+	w.directionZ = wave.y / length;
+
+	waves.push_back(w);
+}
+
+int GerstnerWaves::GetWaveCount() const
+{
+	return (int)waves.size();
+}
+
+XMFLOAT4 GerstnerWaves::GetWave(int index) const
+{
+	return waves[index].parameters;
+}
+
+void GerstnerWaves::SetIterations(int iterations)
+{
+	this->iterations = iterations;
+}
+
+void GerstnerWaves::Displace(float x, float z, float time, XMFLOAT3& displacement, XMFLOAT3& tangent, XMFLOAT3& binormal) const
+{
+	displacement = XMFLOAT3(0, 0, 0);
+	tangent = XMFLOAT3(1, 0, 0);
+	binormal = XMFLOAT3(0, 0, 1);
+
+	for (size_t i = 0; i < waves.size(); i++)
+	{
+		const Wave& w = waves[i];
+		float dx = w.directionX;
+		float dz = w.directionZ;
+
+		//f = k * (dot(d, pos.xz) - c / 2 * dt) in the shader
+		float f = w.k * (dx * x + dz * z - w.omega * time);
+		float s = sinf(f);
+		float c = cosf(f);
+
+		displacement.x += dx * (w.amplitude * c);
+		displacement.y += w.amplitude * s;
+		displacement.z += dz * (w.amplitude * c);
+
+		tangent.x -= dx * dx * (w.steepness * s);
+		tangent.y += dx * (w.steepness * c);
+		tangent.z -= dx * dz * (w.steepness * s);
+
+		binormal.x -= dx * dz * (w.steepness * s);
+		binormal.y += dz * (w.steepness * c);
+		binormal.z -= dz * dz * (w.steepness * s);
+	}
+}
+
+XMFLOAT3 GerstnerWaves::GetDisplacement(float x, float z, float time) const
+{
+	XMFLOAT3 displacement, tangent, binormal;
+	Displace(x, z, time, displacement, tangent, binormal);
+	return displacement;
+}
+
+float GerstnerWaves::GetHeight(float x, float z, float time, XMFLOAT3* normal) const
+{
+	//finding the undisplaced point that the waves carry over (x, z)
+	float px = x;
+	float pz = z;
+	XMFLOAT3 displacement, tangent, binormal;
+	Displace(px, pz, time, displacement, tangent, binormal);
+	for (int i = 0; i < iterations; i++)
+	{
+		float errorX = px + displacement.x - x;
+		float errorZ = pz + displacement.z - z;
+
+		float determinant = tangent.x * binormal.z - binormal.x * tangent.z;
+		if (determinant > MIN_DETERMINANT)
+		{
+			px -= (binormal.z * errorX - binormal.x * errorZ) / determinant;
+			pz -= (tangent.x * errorZ - tangent.z * errorX) / determinant;
+		}
+		else
+		{
+			px -= errorX;
+			pz -= errorZ;
+		}
+
+		Displace(px, pz, time, displacement, tangent, binormal);
+	}
+
+	if (normal != nullptr)
+	{
+		XMStoreFloat3(normal, XMVector3Normalize(XMVector3Cross(XMLoadFloat3(&binormal), XMLoadFloat3(&tangent))));
+	}
+
+	return displacement.y;
+}
+
+void GerstnerWaves::GetHeights(const float* x, const float* z, float time, float* heights,
+	float* normalX, float* normalY, float* normalZ, int count) const
+{
+	bool needNormals = normalX != nullptr && normalY != nullptr && normalZ != nullptr;
+	XMVECTOR minDeterminant = XMVectorReplicate(MIN_DETERMINANT);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		//one point per lane
+		XMVECTOR targetX = XMVectorSet(x[i], x[i + 1], x[i + 2], x[i + 3]);
+		XMVECTOR targetZ = XMVectorSet(z[i], z[i + 1], z[i + 2], z[i + 3]);
+		XMVECTOR px = targetX;
+		XMVECTOR pz = targetZ;
+
+		//set for real at the top of every step, zeroed so no path reads them unset
+		XMVECTOR displacementX = XMVectorZero(), displacementY = XMVectorZero(), displacementZ = XMVectorZero();
+		XMVECTOR tangentX = XMVectorZero(), tangentY = XMVectorZero(), tangentZ = XMVectorZero();
+		XMVECTOR binormalX = XMVectorZero(), binormalY = XMVectorZero(), binormalZ = XMVectorZero();
+
+		for (int step = 0; step <= iterations; step++)
+		{
+			if (step > 0)
+			{
+				XMVECTOR errorX = px + displacementX - targetX;
+				XMVECTOR errorZ = pz + displacementZ - targetZ;
+
+				//newton where the jacobian can be trusted, a plain fixed point step elsewhere
+				XMVECTOR determinant = tangentX * binormalZ - binormalX * tangentZ;
+				XMVECTOR useNewton = XMVectorGreater(determinant, minDeterminant);
+				XMVECTOR inverse = XMVectorReciprocal(XMVectorSelect(XMVectorSplatOne(), determinant, useNewton));
+				XMVECTOR newtonX = (binormalZ * errorX - binormalX * errorZ) * inverse;
+				XMVECTOR newtonZ = (tangentX * errorZ - tangentZ * errorX) * inverse;
+
+				px -= XMVectorSelect(errorX, newtonX, useNewton);
+				pz -= XMVectorSelect(errorZ, newtonZ, useNewton);
+			}
+
+			displacementX = XMVectorZero();
+			displacementY = XMVectorZero();
+			displacementZ = XMVectorZero();
+			tangentX = XMVectorSplatOne();
+			tangentY = XMVectorZero();
+			tangentZ = XMVectorZero();
+			binormalX = XMVectorZero();
+			binormalY = XMVectorZero();
+			binormalZ = XMVectorSplatOne();
+
+			for (size_t w = 0; w < waves.size(); w++)
+			{
+				const Wave& wave = waves[w];
+				XMVECTOR dx = XMVectorReplicate(wave.directionX);
+				XMVECTOR dz = XMVectorReplicate(wave.directionZ);
+				XMVECTOR f = XMVectorScale(px * dx + pz * dz - XMVectorReplicate(wave.omega * time), wave.k);
+
+				XMVECTOR s, c;
+				XMVectorSinCos(&s, &c, f);
+
+				XMVECTOR ac = XMVectorScale(c, wave.amplitude);
+				XMVECTOR ss = XMVectorScale(s, wave.steepness);
+				XMVECTOR sc = XMVectorScale(c, wave.steepness);
+				displacementX += dx * ac;
+				displacementY += XMVectorScale(s, wave.amplitude);
+				displacementZ += dz * ac;
+				tangentX -= dx * dx * ss;
+				tangentY += dx * sc;
+				tangentZ -= dx * dz * ss;
+				binormalX -= dx * dz * ss;
+				binormalY += dz * sc;
+				binormalZ -= dz * dz * ss;
+			}
+		}
+
+		XMFLOAT4 result;
+		XMStoreFloat4(&result, displacementY);
+		heights[i] = result.x;
+		heights[i + 1] = result.y;
+		heights[i + 2] = result.z;
+		heights[i + 3] = result.w;
+
+		if (needNormals)
+		{
+			//cross(binormal, tangent) one component per vector
+			XMVECTOR nx = binormalY * tangentZ - binormalZ * tangentY;
+			XMVECTOR ny = binormalZ * tangentX - binormalX * tangentZ;
+			XMVECTOR nz = binormalX * tangentY - binormalY * tangentX;
+			XMVECTOR inverseLength = XMVectorReciprocal(XMVectorSqrt(nx * nx + ny * ny + nz * nz));
+
+			XMFLOAT4 normal[3];
+			XMStoreFloat4(&normal[0], nx * inverseLength);
+			XMStoreFloat4(&normal[1], ny * inverseLength);
+			XMStoreFloat4(&normal[2], nz * inverseLength);
+			float* outputs[3] = { normalX, normalY, normalZ };
+			for (int axis = 0; axis < 3; axis++)
+			{
+				outputs[axis][i] = normal[axis].x;
+				outputs[axis][i + 1] = normal[axis].y;
+				outputs[axis][i + 2] = normal[axis].z;
+				outputs[axis][i + 3] = normal[axis].w;
+			}
+		}
+	}
+
+	for (; i < count; i++)
+	{
+		XMFLOAT3 normal;
+		heights[i] = GetHeight(x[i], z[i], time, needNormals ? &normal : nullptr);
+		if (needNormals)
+		{
+			normalX[i] = normal.x;
+			normalY[i] = normal.y;
+			normalZ[i] = normal.z;
+		}
+	}
+}
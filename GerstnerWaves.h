@@ -0,0 +1,51 @@
+#pragma once
+#include<DirectXMath.h>
+#include<vector>
+using namespace DirectX;
+
+//cpu copy of the gerstner waves in WaterVS.hlsl, the same formulas so floating objects
+//follow the surface that is drawn. positions are in the water mesh's local space, the
+//space the shader displaces in
+class GerstnerWaves
+{
+	//what the shader derives from a wave, worked out once when it is added
+	struct Wave
+	{
+		XMFLOAT4 parameters; //xy direction, z steepness, w wavelength, as WaterVS takes it
+		float directionX; //normalized direction
+		float directionZ;
+		float k; //wave number
+		float omega; //k times the phase speed the shader uses (c / 2)
+		float amplitude;
+		float steepness;
+	};
+
+	std::vector<Wave> waves;
+	int iterations; //steps used to undo the horizontal displacement
+
+	//the shader's sum, tangent and binormal start at (1,0,0) and (0,0,1) like in WaterVS
+	void Displace(float x, float z, float time, XMFLOAT3& displacement, XMFLOAT3& tangent, XMFLOAT3& binormal) const;
+
+public:
+	GerstnerWaves();
+
+	void AddWave(XMFLOAT4 wave);
+	int GetWaveCount() const;
+	XMFLOAT4 GetWave(int index) const;
+	void SetIterations(int iterations);
+
+	//where the surface point that starts at (x, 0, z) ends up, relative to where it started
+	XMFLOAT3 GetDisplacement(float x, float z, float time) const;
+
+	//height and normal of the surface right above (x, z)
+	//the waves also move points sideways, so the point p that lands on (x, z) is found first.
+	//the xz parts of the tangent and binormal are the jacobian of p + displacement(p), so
+	//each step is a newton step, falling back to p = (x, z) - displacement(p) near crests
+	//where the jacobian gets close to singular
+	float GetHeight(float x, float z, float time, XMFLOAT3* normal = nullptr) const;
+
+	//the same for count points at once, four at a time with DirectXMath vectors
+	//the normal arrays can be null when only heights are needed
+	void GetHeights(const float* x, const float* z, float time, float* heights,
+		float* normalX, float* normalY, float* normalZ, int count) const;
+};
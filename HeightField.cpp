@@ -0,0 +1,403 @@
+#include "HeightField.h"
+#include<algorithm>
+#include<cmath>
+#include<cfloat>
+#include<emmintrin.h>
+
+HeightField::HeightField()
+{
+	width = 0;
+	depth = 0;
+	heightScale = 0.0f;
+	spacing = 1.0f;
+	minX = 0.0f;
+	minZ = 0.0f;
+}
+
+HeightField::HeightField(const std::vector<unsigned short>& heights, int width, int depth, float heightScale, float spacing, float minX, float minZ)
+{
+	this->heights = heights;
+	this->width = width;
+	this->depth = depth;
+	this->heightScale = heightScale;
+	this->spacing = spacing;
+	this->minX = minX;
+	this->minZ = minZ;
+
+	//a single row or column has no cells
+	if (width < 2 || depth < 2 || (int)heights.size() < width * depth)
+	{
+		this->width = 0;
+		this->depth = 0;
+		this->heights.clear();
+		return;
+	}
+
+	BuildPyramid();
+}
+
+float HeightField::Sample(int x, int z) const
+{
+	return heights[z * width + x] * heightScale;
+}
+
+void HeightField::BuildPyramid()
+{
+	//level 0, the range of the four corners of every cell
+	int cellsX = width - 1;
+	int cellsZ = depth - 1;
+	std::vector<HeightRange> cells(cellsX * cellsZ);
+	for (int z = 0; z < cellsZ; z++)
+	{
+		for (int x = 0; x < cellsX; x++)
+		{
+			unsigned short h00 = heights[z * width + x];
+			unsigned short h10 = heights[z * width + x + 1];
+			unsigned short h01 = heights[(z + 1) * width + x];
+			unsigned short h11 = heights[(z + 1) * width + x + 1];
+
+			HeightRange& range = cells[z * cellsX + x];
+			range.min = std::min(std::min(h00, h10), std::min(h01, h11));
+			range.max = std::max(std::max(h00, h10), std::max(h01, h11));
+		}
+	}
+	pyramid.push_back(cells);
+	levelWidth.push_back(cellsX);
+	levelDepth.push_back(cellsZ);
+
+	//every level above covers 2x2 cells of the one below, until one cell covers everything
+	while (levelWidth.back() > 1 || levelDepth.back() > 1)
+	{
+		const std::vector<HeightRange>& below = pyramid.back();
+		int belowWidth = levelWidth.back();
+		int belowDepth = levelDepth.back();
+		int levelX = (belowWidth + 1) / 2;
+		int levelZ = (belowDepth + 1) / 2;
+
+		std::vector<HeightRange> level(levelX * levelZ);
+		for (int z = 0; z < levelZ; z++)
+		{
+			for (int x = 0; x < levelX; x++)
+			{
+				HeightRange range = below[(z * 2) * belowWidth + x * 2];
+				for (int child = 1; child < 4; child++)
+				{
+					int childX = x * 2 + (child & 1);
+					int childZ = z * 2 + (child >> 1);
+					if (childX >= belowWidth || childZ >= belowDepth)
+						continue;
+
+					const HeightRange& childRange = below[childZ * belowWidth + childX];
+					range.min = std::min(range.min, childRange.min);
+					range.max = std::max(range.max, childRange.max);
+				}
+				level[z * levelX + x] = range;
+			}
+		}
+
+		pyramid.push_back(level);
+		levelWidth.push_back(levelX);
+		levelDepth.push_back(levelZ);
+	}
+}
+
+float HeightField::GetHeight(float x, float z) const
+{
+	if (IsEmpty())
+		return 0.0f;
+
+	float gx = std::min(std::max((x - minX) / spacing, 0.0f), (float)(width - 1));
+	float gz = std::min(std::max((z - minZ) / spacing, 0.0f), (float)(depth - 1));
+	int ix = std::min((int)gx, width - 2);
+	int iz = std::min((int)gz, depth - 2);
+	float fx = gx - ix;
+	float fz = gz - iz;
+
+	float h0 = Sample(ix, iz) + (Sample(ix + 1, iz) - Sample(ix, iz)) * fx;
+	float h1 = Sample(ix, iz + 1) + (Sample(ix + 1, iz + 1) - Sample(ix, iz + 1)) * fx;
+	return h0 + (h1 - h0) * fz;
+}
+
+XMFLOAT3 HeightField::GetNormal(float x, float z) const
+{
+	if (IsEmpty())
+		return XMFLOAT3(0, 1, 0);
+
+	float gx = std::min(std::max((x - minX) / spacing, 0.0f), (float)(width - 1));
+	float gz = std::min(std::max((z - minZ) / spacing, 0.0f), (float)(depth - 1));
+	int ix = std::min((int)gx, width - 2);
+	int iz = std::min((int)gz, depth - 2);
+	float fx = gx - ix;
+	float fz = gz - iz;
+
+	float h00 = Sample(ix, iz);
+	float h10 = Sample(ix + 1, iz);
+	float h01 = Sample(ix, iz + 1);
+	float h11 = Sample(ix + 1, iz + 1);
+
+	//slope of the bilinear patch, the normal is (-dh/dx, 1, -dh/dz)
+	float slopeX = ((h10 - h00) * (1.0f - fz) + (h11 - h01) * fz) / spacing;
+	float slopeZ = ((h01 - h00) * (1.0f - fx) + (h11 - h10) * fx) / spacing;
+
+	XMFLOAT3 normal;
+	XMStoreFloat3(&normal, XMVector3Normalize(XMVectorSet(-slopeX, 1.0f, -slopeZ, 0.0f)));
+	return normal;
+}
+
+void HeightField::GetHeights(const float* x, const float* z, float* heights, int count) const
+{
+	if (IsEmpty())
+	{
+		std::fill(heights, heights + count, 0.0f);
+		return;
+	}
+
+	__m128 originX = _mm_set1_ps(minX);
+	__m128 originZ = _mm_set1_ps(minZ);
+	__m128 inverseSpacing = _mm_set1_ps(1.0f / spacing);
+	__m128 zero = _mm_setzero_ps();
+	__m128 lastX = _mm_set1_ps((float)(width - 1));
+	__m128 lastZ = _mm_set1_ps((float)(depth - 1));
+	__m128 lastCellX = _mm_set1_ps((float)(width - 2));
+	__m128 lastCellZ = _mm_set1_ps((float)(depth - 2));
+	__m128 rowLength = _mm_set1_ps((float)width);
+	__m128 scale = _mm_set1_ps(heightScale);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		//grid coordinates clamped to the edges, they are positive so truncating is floor
+		__m128 gx = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(x + i), originX), inverseSpacing), zero), lastX);
+		__m128 gz = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(z + i), originZ), inverseSpacing), zero), lastZ);
+		__m128 cellX = _mm_min_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(gx)), lastCellX);
+		__m128 cellZ = _mm_min_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(gz)), lastCellZ);
+		__m128 fx = _mm_sub_ps(gx, cellX);
+		__m128 fz = _mm_sub_ps(gz, cellZ);
+
+		//the index is exact in a float for any map that fits in memory
+		alignas(16) int index[4];
+		_mm_store_si128((__m128i*)index, _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(cellZ, rowLength), cellX)));
+
+		//sse has no gather, the corners are fetched one lane at a time
+		alignas(16) float h00[4];
+		alignas(16) float h10[4];
+		alignas(16) float h01[4];
+		alignas(16) float h11[4];
+		for (int lane = 0; lane < 4; lane++)
+		{
+			const unsigned short* corner = &this->heights[index[lane]];
+			h00[lane] = corner[0];
+			h10[lane] = corner[1];
+			h01[lane] = corner[width];
+			h11[lane] = corner[width + 1];
+		}
+
+		__m128 a = _mm_load_ps(h00);
+		__m128 b = _mm_load_ps(h10);
+		__m128 c = _mm_load_ps(h01);
+		__m128 d = _mm_load_ps(h11);
+		__m128 h0 = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), fx));
+		__m128 h1 = _mm_add_ps(c, _mm_mul_ps(_mm_sub_ps(d, c), fx));
+		__m128 h = _mm_add_ps(h0, _mm_mul_ps(_mm_sub_ps(h1, h0), fz));
+		_mm_storeu_ps(heights + i, _mm_mul_ps(h, scale));
+	}
+
+	for (; i < count; i++)
+	{
+		heights[i] = GetHeight(x[i], z[i]);
+	}
+}
+
+bool HeightField::IntersectCell(int cellX, int cellZ, const float* origin, const float* direction, float tStart, float tEnd, float& t) const
+{
+	float h00 = Sample(cellX, cellZ);
+	float h10 = Sample(cellX + 1, cellZ);
+	float h01 = Sample(cellX, cellZ + 1);
+	float h11 = Sample(cellX + 1, cellZ + 1);
+
+	//h(u, v) = h00 + A u + B v + C u v, along the ray it is a quadratic in t
+	float A = h10 - h00;
+	float B = h01 - h00;
+	float C = h00 - h10 - h01 + h11;
+	float u0 = origin[0] + direction[0] * tStart - cellX;
+	float v0 = origin[2] + direction[2] * tStart - cellZ;
+	float du = direction[0];
+	float dv = direction[2];
+
+	//height of the ray above the surface, a s^2 + b s + c with s = t - tStart
+	float a = -C * du * dv;
+	float b = direction[1] - A * du - B * dv - C * (u0 * dv + v0 * du);
+	float c = origin[1] + direction[1] * tStart - (h00 + A * u0 + B * v0 + C * u0 * v0);
+	float span = tEnd - tStart;
+
+	//already under the ground where the ray enters the cell
+	if (c <= 0.0f)
+	{
+		t = tStart;
+		return true;
+	}
+
+	float s = FLT_MAX;
+	if (fabsf(a) < 1e-12f)
+	{
+		if (b < 0.0f)
+			s = -c / b;
+	}
+	else
+	{
+		float discriminant = b * b - 4.0f * a * c;
+		if (discriminant < 0.0f)
+			return false;
+
+		float root = sqrtf(discriminant);
+		float s0 = (-b - root) / (2.0f * a);
+		float s1 = (-b + root) / (2.0f * a);
+		if (s0 > s1) std::swap(s0, s1);
+		s = s0 >= 0.0f ? s0 : (s1 >= 0.0f ? s1 : FLT_MAX);
+	}
+
+	if (s > span)
+		return false;
+
+	t = tStart + s;
+	return true;
+}
+
+bool HeightField::TraceLevel(int level, int cellMinX, int cellMinZ, int cellMaxX, int cellMaxZ,
+	const float* origin, const float* direction, float tStart, float tEnd, float& t) const
+{
+	float size = (float)(1 << level);
+	int cellsX = levelWidth[level];
+
+	int x = std::min(std::max((int)floorf((origin[0] + direction[0] * tStart) / size), cellMinX), cellMaxX);
+	int z = std::min(std::max((int)floorf((origin[2] + direction[2] * tStart) / size), cellMinZ), cellMaxZ);
+
+	//distance along the ray to the next cell border on each axis, and between borders
+	int stepX = direction[0] > 0.0f ? 1 : -1;
+	int stepZ = direction[2] > 0.0f ? 1 : -1;
+	float nextX = FLT_MAX;
+	float nextZ = FLT_MAX;
+	float deltaX = FLT_MAX;
+	float deltaZ = FLT_MAX;
+	if (direction[0] != 0.0f)
+	{
+		nextX = ((x + (stepX > 0 ? 1 : 0)) * size - origin[0]) / direction[0];
+		deltaX = size / fabsf(direction[0]);
+	}
+	if (direction[2] != 0.0f)
+	{
+		nextZ = ((z + (stepZ > 0 ? 1 : 0)) * size - origin[2]) / direction[2];
+		deltaZ = size / fabsf(direction[2]);
+	}
+
+	float t0 = tStart;
+	while (true)
+	{
+		float t1 = std::max(std::min(std::min(nextX, nextZ), tEnd), t0);
+
+		//the ray can only hit this cell if it gets below its highest point
+		float lowest = origin[1] + direction[1] * (direction[1] < 0.0f ? t1 : t0);
+		if (lowest <= pyramid[level][z * cellsX + x].max * heightScale)
+		{
+			if (level == 0)
+			{
+				if (IntersectCell(x, z, origin, direction, t0, t1, t))
+					return true;
+			}
+			else
+			{
+				int childMaxX = std::min(x * 2 + 1, levelWidth[level - 1] - 1);
+				int childMaxZ = std::min(z * 2 + 1, levelDepth[level - 1] - 1);
+				if (TraceLevel(level - 1, x * 2, z * 2, childMaxX, childMaxZ, origin, direction, t0, t1, t))
+					return true;
+			}
+		}
+
+		if (t1 >= tEnd)
+			return false;
+
+		if (nextX < nextZ)
+		{
+			x += stepX;
+			t0 = nextX;
+			nextX += deltaX;
+		}
+		else
+		{
+			z += stepZ;
+			t0 = nextZ;
+			nextZ += deltaZ;
+		}
+
+		if (x < cellMinX || x > cellMaxX || z < cellMinZ || z > cellMaxZ)
+			return false;
+	}
+}
+
+bool HeightField::RayCast(XMFLOAT3 origin, XMFLOAT3 direction, float maxDistance, float& distance, XMFLOAT3& normal) const
+{
+	if (IsEmpty())
+		return false;
+
+	//grid space, x and z are in samples and y stays in world units so t is still a world distance
+	float o[3] = { (origin.x - minX) / spacing, origin.y, (origin.z - minZ) / spacing };
+	float d[3] = { direction.x / spacing, direction.y, direction.z / spacing };
+
+	//clipping the ray to the box around the whole field
+	float boxMin[3] = { 0.0f, GetMinHeight(), 0.0f };
+	float boxMax[3] = { (float)(width - 1), GetMaxHeight(), (float)(depth - 1) };
+	float tStart = 0.0f;
+	float tEnd = maxDistance;
+	for (int i = 0; i < 3; i++)
+	{
+		if (fabsf(d[i]) < 1e-12f)
+		{
+			if (o[i] < boxMin[i] || o[i] > boxMax[i])
+				return false;
+			continue;
+		}
+
+		float t0 = (boxMin[i] - o[i]) / d[i];
+		float t1 = (boxMax[i] - o[i]) / d[i];
+		if (t0 > t1) std::swap(t0, t1);
+		tStart = std::max(tStart, t0);
+		tEnd = std::min(tEnd, t1);
+		if (tStart > tEnd)
+			return false;
+	}
+
+	int top = GetLevelCount() - 1;
+	float t;
+	if (!TraceLevel(top, 0, 0, levelWidth[top] - 1, levelDepth[top] - 1, o, d, tStart, tEnd, t))
+		return false;
+
+	distance = t;
+	normal = GetNormal(origin.x + direction.x * t, origin.z + direction.z * t);
+	return true;
+}
+
+bool HeightField::IsEmpty() const
+{
+	return width == 0;
+}
+
+bool HeightField::Contains(float x, float z) const
+{
+	return !IsEmpty() && x >= minX && z >= minZ &&
+		x <= minX + (width - 1) * spacing && z <= minZ + (depth - 1) * spacing;
+}
+
+float HeightField::GetMinHeight() const
+{
+	return IsEmpty() ? 0.0f : pyramid.back()[0].min * heightScale;
+}
+
+float HeightField::GetMaxHeight() const
+{
+	return IsEmpty() ? 0.0f : pyramid.back()[0].max * heightScale;
+}
+
+int HeightField::GetLevelCount() const
+{
+	return (int)pyramid.size();
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include<DirectXMath.h>
+#include<vector>
+using namespace DirectX;
+
+//the heights of a heightmap kept after the terrain mesh is built, for ground queries
+//samples stay as the 16 bit values read from the file, so a 513x513 map is about half a
+//megabyte. only depends on DirectXMath so it can run without a device
+class HeightField
+{
+	//lowest and highest sample of a cell, and of 2x2 blocks of the level below
+	struct HeightRange
+	{
+		unsigned short min;
+		unsigned short max;
+	};
+
+	std::vector<unsigned short> heights; //rows along z of samples along x
+	std::vector<std::vector<HeightRange>> pyramid; //level 0 has one range per cell
+	std::vector<int> levelWidth; //cells along x of each level
+	std::vector<int> levelDepth; //cells along z of each level
+
+	int width; //samples along x
+	int depth; //samples along z
+	float heightScale; //world height of one step of a sample
+	float spacing; //world distance between samples
+	float minX; //position of the first sample
+	float minZ;
+
+	float Sample(int x, int z) const;
+	void BuildPyramid();
+	//hierarchical dda over the cells of a level between tStart and tEnd, ray in grid space
+	bool TraceLevel(int level, int cellMinX, int cellMinZ, int cellMaxX, int cellMaxZ,
+		const float* origin, const float* direction, float tStart, float tEnd, float& t) const;
+	//first point in [tStart, tEnd] where the ray goes under the bilinear surface of a cell
+	bool IntersectCell(int cellX, int cellZ, const float* origin, const float* direction, float tStart, float tEnd, float& t) const;
+
+public:
+	HeightField();
+	HeightField(const std::vector<unsigned short>& heights, int width, int depth, float heightScale, float spacing, float minX, float minZ);
+
+	//points outside the grid use the height at the closest edge
+	float GetHeight(float x, float z) const;
+	XMFLOAT3 GetNormal(float x, float z) const;
+	//four points at a time with sse, count doesn't have to be a multiple of four
+	void GetHeights(const float* x, const float* z, float* heights, int count) const;
+
+	//distance along a normalized ray to where it first hits the ground
+	bool RayCast(XMFLOAT3 origin, XMFLOAT3 direction, float maxDistance, float& distance, XMFLOAT3& normal) const;
+
+	bool IsEmpty() const;
+	bool Contains(float x, float z) const;
+	float GetMinHeight() const;
+	float GetMaxHeight() const;
+	int GetLevelCount() const;
+};
@@ -3,6 +3,7 @@ cbuffer externData: register(b0)
 	int fftRes;
 	int L;
 	float time;
+	float loopPeriod; //above zero rounds every frequency to whole turns in that many seconds
 }
 
 
@@ -57,6 +58,11 @@ void main( uint3 id : SV_DispatchThreadID )
 	float magSq = mag * mag;
 
 	float w = sqrt(9.81 * mag);
+	if (loopPeriod > 0)
+	{
+		float w0 = 2 * PI / loopPeriod;
+		w = floor(w / w0) * w0;
+	}
 
 	float2 tildeH0Vals = tildeH0[id.xy].rg;
 	Complex fourierCmp;
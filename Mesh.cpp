@@ -126,11 +126,22 @@ unsigned int Mesh::GetIndexCount()
 	return numIndices;
 }
 
-std::vector<XMFLOAT3> Mesh::GetPoints()
+const std::vector<XMFLOAT3>& Mesh::GetPoints()
 {
 	return points;
 }
 
+std::shared_ptr<const CollisionShape> Mesh::GetCollisionShape()
+{
+	//every entity with this mesh shares the same shape
+	if (collisionShape == nullptr)
+	{
+		collisionShape = std::make_shared<const CollisionShape>(points);
+	}
+
+	return collisionShape;
+}
+
 void Mesh::LoadOBJ(ID3D11Device* device,std::string& fileName)
 {
 	std::ifstream ifile(fileName.c_str());
@@ -7,6 +7,7 @@
 #include<vector>
 #include<fstream>
 #include<DirectXMath.h>
+#include"CollisionShape.h"
 #include<assimp/Importer.hpp>
 #include<assimp/scene.h>
 #include<assimp/postprocess.h>
@@ -21,6 +22,7 @@ class Mesh
 
 	unsigned int numIndices; //number of indices in the mesh
 	std::vector<XMFLOAT3> points;
+	std::shared_ptr<const CollisionShape> collisionShape; //cooked the first time a rigid body asks for it
 
 public:
 
@@ -34,7 +36,8 @@ public:
 	ID3D11Buffer* GetVertexBuffer();
 	ID3D11Buffer* GetIndexBuffer();
 	unsigned int GetIndexCount();
-	std::vector<XMFLOAT3> GetPoints();
+	const std::vector<XMFLOAT3>& GetPoints();
+	std::shared_ptr<const CollisionShape> GetCollisionShape();
 
 	//load fbx files
 	void LoadFBX(ID3D11Device* device, std::string& filename);
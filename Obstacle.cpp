@@ -3,13 +3,14 @@
 Obstacle::Obstacle(std::shared_ptr<Mesh> mesh, std::shared_ptr<Material> material):Entity(mesh, material)
 {
 	tag = "Obstacle";
+	layer = CollisionLayer::Obstacle;
 }
 
 Obstacle::~Obstacle()
 {
 }
 
-bool Obstacle::IsColliding(std::shared_ptr<Entity> other)
+bool Obstacle::IsColliding(std::shared_ptr<Entity> other, CollisionCache* cache)
 {
 	return false;
 }
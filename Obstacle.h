@@ -6,7 +6,7 @@ class Obstacle :
 public:
 	Obstacle(std::shared_ptr<Mesh> mesh, std::shared_ptr<Material> material);
 	~Obstacle();
-	bool IsColliding(std::shared_ptr<Entity> other) override;
+	bool IsColliding(std::shared_ptr<Entity> other, CollisionCache* cache = nullptr) override;
 	void Update(float deltaTime) override;
 };
 
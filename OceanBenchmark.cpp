@@ -0,0 +1,652 @@
+#include "OceanBenchmark.h"
+#include "GerstnerWaves.h"
+#include "OceanFFT.h"
+#include "FFTPlan.h"
+#include "OceanCache.h"
+#include "OceanSpectrum.h"
+#include "Philox.h"
+#include "OceanQuadtree.h"
+#include "WaveParticles.h"
+#include<chrono>
+#include<random>
+#include<vector>
+#include<fstream>
+#include<iterator>
+#include<cstring>
+#include<cmath>
+#include<algorithm>
+#include<cstdio>
+
+using namespace DirectX;
+
+void RunWaveBenchmark(int probeCount, int frameCount, unsigned int seed)
+{
+	std::mt19937 randomGenerator(seed);
+
+	//the waves Water gives WaterVS
+	GerstnerWaves waves;
+	waves.AddWave(XMFLOAT4(1.0f, 1.0f, 0.3f, 2.0f));
+	waves.AddWave(XMFLOAT4(0, 1, 0.3f, 2.0f));
+	waves.AddWave(XMFLOAT4(-1, 1, 0.3f, 2.0f));
+	waves.AddWave(XMFLOAT4(1, 0, 0.3f, 2.0f));
+	GerstnerWaves converged = waves;
+	converged.SetIterations(50);
+
+	std::uniform_real_distribution<float> coordinate(-10.0f, 10.0f);
+	std::vector<float> x(probeCount);
+	std::vector<float> z(probeCount);
+	for (int i = 0; i < probeCount; i++)
+	{
+		x[i] = coordinate(randomGenerator);
+		z[i] = coordinate(randomGenerator);
+	}
+
+	std::vector<float> single(probeCount);
+	std::vector<float> batch(probeCount);
+	std::vector<float> normalX(probeCount);
+	std::vector<float> normalY(probeCount);
+	std::vector<float> normalZ(probeCount);
+	double singleTime = 0.0;
+	double batchTime = 0.0;
+	float largestDifference = 0.0f;
+	float largestError = 0.0f;
+	float largestNormalError = 0.0f;
+
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		float time = frame / 60.0f;
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < probeCount; i++)
+		{
+			XMFLOAT3 normal;
+			single[i] = waves.GetHeight(x[i], z[i], time, &normal);
+		}
+		auto afterSingle = std::chrono::high_resolution_clock::now();
+		waves.GetHeights(x.data(), z.data(), time, batch.data(), normalX.data(), normalY.data(), normalZ.data(), probeCount);
+		auto afterBatch = std::chrono::high_resolution_clock::now();
+
+		singleTime += std::chrono::duration<double>(afterSingle - start).count();
+		batchTime += std::chrono::duration<double>(afterBatch - afterSingle).count();
+
+		//checking a slice of the probes each frame, the converged answer is slow
+		for (int i = frame % 16; i < probeCount; i += 16)
+		{
+			XMFLOAT3 normal;
+			float height = converged.GetHeight(x[i], z[i], time, &normal);
+			largestDifference = std::max(largestDifference, fabsf(single[i] - batch[i]));
+			largestError = std::max(largestError, fabsf(batch[i] - height));
+			largestNormalError = std::max(largestNormalError, fabsf(normalX[i] - normal.x) + fabsf(normalY[i] - normal.y) + fabsf(normalZ[i] - normal.z));
+		}
+	}
+
+	int samples = probeCount * frameCount;
+	printf("gerstner waves: %d probes, %d frames\n", probeCount, frameCount);
+	printf("  single:        %8.2f ns/probe\n", singleTime * 1e9 / samples);
+	printf("  batch of 4:    %8.2f ns/probe, largest difference %g\n", batchTime * 1e9 / samples, largestDifference);
+	printf("  against converged: height %g, normal %g\n", largestError, largestNormalError);
+}
+
+void RunOceanBenchmark(int fftRes, int frameCount, unsigned int seed)
+{
+	ThreadPool threads;
+	OceanFFT ocean(fftRes, 1000, 4, XMFLOAT2(1, 1), 40.0f, &threads);
+	ocean.CreateH0(seed);
+
+	//the time RenderFFT hands HtOceanCS
+	float time = 0.0f;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		time = (frame / 60.0f) * 1.4f + 500.0f;
+		ocean.Update(time);
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+
+	int count = fftRes * fftRes;
+	std::vector<float> dx(count);
+	std::vector<float> dy(count);
+	std::vector<float> dz(count);
+	auto referenceStart = std::chrono::high_resolution_clock::now();
+	ocean.UpdateReference(time, dx.data(), dy.data(), dz.data());
+	auto referenceEnd = std::chrono::high_resolution_clock::now();
+
+	const float* maps[3] = { ocean.GetDisplacementX(), ocean.GetHeights(), ocean.GetDisplacementZ() };
+	const float* references[3] = { dx.data(), dy.data(), dz.data() };
+	float largestDifference = 0.0f;
+	float largestValue = 0.0f;
+	for (int map = 0; map < 3; map++)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			largestDifference = std::max(largestDifference, fabsf(maps[map][i] - references[map][i]));
+			largestValue = std::max(largestValue, fabsf(references[map][i]));
+		}
+	}
+
+	printf("ocean fft: %dx%d, three maps\n", fftRes, fftRes);
+	printf("  update:        %8.3f ms/frame\n", std::chrono::duration<double>(end - start).count() * 1e3 / frameCount);
+	printf("  shader steps:  %8.3f ms/frame, largest difference %g of %g\n", std::chrono::duration<double>(referenceEnd - referenceStart).count() * 1e3, largestDifference, largestValue);
+}
+
+void RunFFTPlanBenchmark(unsigned int seed)
+{
+	std::mt19937 randomGenerator(seed);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	printf("fft plans:\n");
+	for (int size = 64; size <= 1024; size *= 2)
+	{
+		std::unique_ptr<FFTPassPlan> plan = CreateFFTPlan(size);
+		std::uniform_int_distribution<int> position(0, size - 1);
+
+		//a spike of a at (px, py) turns into a e^(2 pi i (x px + y py) / size)
+		const int spikeCount = 8;
+		int px[spikeCount], py[spikeCount];
+		XMFLOAT2 amplitude[spikeCount];
+		std::vector<XMFLOAT2> data(size * size, XMFLOAT2(0, 0));
+		for (int i = 0; i < spikeCount; i++)
+		{
+			px[i] = position(randomGenerator);
+			py[i] = position(randomGenerator);
+			amplitude[i] = XMFLOAT2(unit(randomGenerator), unit(randomGenerator));
+			data[py[i] * size + px[i]].x += amplitude[i].x;
+			data[py[i] * size + px[i]].y += amplitude[i].y;
+		}
+
+		auto start = std::chrono::high_resolution_clock::now();
+		plan->Execute(data.data());
+		auto end = std::chrono::high_resolution_clock::now();
+
+		double largestError = 0.0;
+		for (int y = 0; y < size; y++)
+		{
+			for (int x = 0; x < size; x++)
+			{
+				double real = 0.0;
+				double imaginary = 0.0;
+				for (int i = 0; i < spikeCount; i++)
+				{
+					//wrapped before turning into an angle so large sizes keep their precision
+					int turn = (int)(((long long)x * px[i] + (long long)y * py[i]) % size);
+					double angle = 2.0 * 3.14159265358979323846 * turn / size;
+					real += amplitude[i].x * cos(angle) - amplitude[i].y * sin(angle);
+					imaginary += amplitude[i].x * sin(angle) + amplitude[i].y * cos(angle);
+				}
+				largestError = std::max(largestError, fabs(real - data[y * size + x].x));
+				largestError = std::max(largestError, fabs(imaginary - data[y * size + x].y));
+			}
+		}
+
+		int radix2Passes = 0;
+		while ((1 << radix2Passes) < size)
+			radix2Passes++;
+
+		printf("  %4d: %d passes a direction (radix 2 takes %2d), %8.3f ms, largest error %g\n",
+			size, plan->GetStageCount(), radix2Passes, std::chrono::duration<double>(end - start).count() * 1e3, largestError);
+	}
+}
+
+void RunCascadeBenchmark(int frameCount, unsigned int seed)
+{
+	//fft size, patch length and update interval, as in Game::LoadContent
+	const int cascadeCount = 3;
+	const int sizes[cascadeCount] = { 256, 256, 128 };
+	const int lengths[cascadeCount] = { 1000, 250, 60 };
+	const int intervals[cascadeCount] = { 2, 1, 1 };
+
+	//one pool for all of them, the way Game shares its own
+	ThreadPool threads;
+	std::vector<std::unique_ptr<OceanFFT>> cascades;
+	for (int i = 0; i < cascadeCount; i++)
+	{
+		cascades.emplace_back(std::make_unique<OceanFFT>(sizes[i], lengths[i], 4, XMFLOAT2(1, 1), 40.0f, &threads));
+		cascades.back()->CreateH0(seed + i);
+	}
+
+	auto cascadeStart = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		float time = (frame / 60.0f) * 1.4f + 500.0f;
+		for (int i = 0; i < cascadeCount; i++)
+		{
+			if (frame % intervals[i] == i % intervals[i])
+				cascades[i]->Update(time);
+		}
+	}
+	auto cascadeEnd = std::chrono::high_resolution_clock::now();
+
+	OceanFFT single(1024, 1000, 4, XMFLOAT2(1, 1), 40.0f, &threads);
+	single.CreateH0(seed);
+	auto singleStart = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		single.Update((frame / 60.0f) * 1.4f + 500.0f);
+	}
+	auto singleEnd = std::chrono::high_resolution_clock::now();
+
+	//the finest detail each gives, in metres per texel
+	float finest = (float)lengths[cascadeCount - 1] / sizes[cascadeCount - 1];
+
+	printf("ocean cascades: 256 @ 1000m every other frame, 256 @ 250m, 128 @ 60m\n");
+	printf("  cascades:      %8.3f ms/frame, %.2f m per texel at the finest\n", std::chrono::duration<double>(cascadeEnd - cascadeStart).count() * 1e3 / frameCount, finest);
+	printf("  single 1024:   %8.3f ms/frame, %.2f m per texel\n", std::chrono::duration<double>(singleEnd - singleStart).count() * 1e3 / frameCount, 1000.0f / 1024);
+}
+
+void RunOceanCacheBenchmark(int fftRes, int frameCount, unsigned int seed)
+{
+	const float period = 20.0f;
+	const float startTime = 500.0f;
+	ThreadPool threads;
+	OceanFFT ocean(fftRes, 1000, 4, XMFLOAT2(1, 1), 40.0f, &threads);
+	ocean.CreateH0(seed);
+
+	OceanCache cache;
+	auto bakeStart = std::chrono::high_resolution_clock::now();
+	cache.Bake(ocean, period, frameCount, startTime);
+	auto bakeEnd = std::chrono::high_resolution_clock::now();
+
+	const char* fileName = "OceanCacheBenchmark.bin";
+	OceanCache loaded;
+	bool reloaded = cache.Save(fileName) && loaded.Load(fileName);
+
+	//broken copies of the file, every one has to be turned down without reading past the data.
+	//13 words of header and the offset count, then the frame offsets, the data size and the data
+	std::vector<char> file;
+	{
+		std::ifstream input(fileName, std::ios::binary);
+		file.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+	}
+	const size_t offsetsStart = 14 * sizeof(unsigned int);
+	auto setWord = [](std::vector<char>& bytes, size_t at, unsigned int value) { memcpy(&bytes[at], &value, sizeof(value)); };
+	unsigned int dataSize;
+	memcpy(&dataSize, &file[offsetsStart + frameCount * sizeof(unsigned int)], sizeof(dataSize));
+	std::vector<std::vector<char>> broken(4, file);
+	broken[0].resize(file.size() / 2); //cut off halfway
+	setWord(broken[1], 2 * sizeof(unsigned int), 0); //no resolution
+	setWord(broken[2], offsetsStart + sizeof(unsigned int), dataSize + 100); //a frame past the data
+	setWord(broken[3], offsetsStart + (frameCount - 1) * sizeof(unsigned int), dataSize - 1); //the last frame's codes run out
+	int rejected = 0;
+	for (size_t i = 0; i < broken.size(); i++)
+	{
+		{
+			std::ofstream output(fileName, std::ios::binary);
+			output.write(broken[i].data(), broken[i].size());
+		}
+		OceanCache corrupt;
+		if (!corrupt.Load(fileName) && corrupt.GetFrameCount() == 0)
+			rejected++;
+	}
+	std::remove(fileName);
+
+	int count = fftRes * fftRes;
+	std::vector<float> maps[CACHE_MAP_COUNT];
+	std::vector<float> loopedMaps[CACHE_MAP_COUNT];
+	float* outputs[CACHE_MAP_COUNT];
+	float* loopedOutputs[CACHE_MAP_COUNT];
+	for (int m = 0; m < CACHE_MAP_COUNT; m++)
+	{
+		maps[m].resize(count);
+		loopedMaps[m].resize(count);
+		outputs[m] = maps[m].data();
+		loopedOutputs[m] = loopedMaps[m].data();
+	}
+
+	//two loops at 60 frames a second, the way Water plays it
+	const int playbackFrames = (int)(period * 60) * 2;
+	auto playStart = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < playbackFrames; frame++)
+	{
+		loaded.Sample(startTime + frame / 60.0f, outputs);
+	}
+	auto playEnd = std::chrono::high_resolution_clock::now();
+
+	//a time between baked frames, one loop apart, and the live ocean at it
+	float between = startTime + period * 10.5f / frameCount;
+	loaded.Sample(between, outputs);
+	loaded.Sample(between + period, loopedOutputs);
+	ocean.Update(between);
+	float loopDifference = 0.0f;
+	float liveDifference = 0.0f;
+	float largestHeight = 0.0f;
+	for (int i = 0; i < count; i++)
+	{
+		loopDifference = std::max(loopDifference, fabsf(maps[CACHE_HEIGHT][i] - loopedMaps[CACHE_HEIGHT][i]));
+		liveDifference = std::max(liveDifference, fabsf(maps[CACHE_HEIGHT][i] - ocean.GetHeights()[i]));
+		largestHeight = std::max(largestHeight, fabsf(ocean.GetHeights()[i]));
+	}
+
+	const OceanCacheReport& report = cache.GetReport();
+	const char* names[CACHE_MAP_COUNT] = { "dx", "dy", "dz", "normal x", "normal y", "folding" };
+	printf("ocean cache: %dx%d, %d frames over %.0f s\n", report.resolution, report.resolution, report.frameCount, report.period);
+	printf("  bake:          %8.3f ms\n", std::chrono::duration<double>(bakeEnd - bakeStart).count() * 1e3);
+	printf("  raw:           %8.2f MB\n", report.rawBytes / (1024.0 * 1024.0));
+	printf("  compressed:    %8.2f MB, %.1f to 1, %s from disk\n", report.compressedBytes / (1024.0 * 1024.0),
+		(double)report.rawBytes / report.compressedBytes, reloaded ? "same" : "failed");
+	printf("  decoder:       %8.2f MB\n", report.decoderBytes / (1024.0 * 1024.0));
+	printf("  broken files:  %8d of %zu turned down\n", rejected, broken.size());
+	for (int m = 0; m < CACHE_MAP_COUNT; m++)
+	{
+		printf("  %-9s      step %g, largest error %g, rms %g\n", names[m], report.step[m], report.maxError[m], report.rmsError[m]);
+	}
+	printf("  playback:      %8.3f ms/frame\n", std::chrono::duration<double>(playEnd - playStart).count() * 1e3 / playbackFrames);
+	printf("  one loop on:   largest height difference %g\n", loopDifference);
+	printf("  live fft:      largest height difference %g of %g between frames\n", liveDifference, largestHeight);
+}
+
+void RunSpectrumBenchmark(int fftRes, int repeatCount, unsigned int seed)
+{
+	//philox4x32-10 known answers, the zero and the pi key
+	unsigned int zeroCounter[4] = { 0, 0, 0, 0 };
+	unsigned int piCounter[4] = { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 };
+	unsigned int zeroAnswer[4] = { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 };
+	unsigned int piAnswer[4] = { 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 };
+	unsigned int output[4];
+	bool known = true;
+	Philox(0, 0).Generate(zeroCounter, output);
+	for (int i = 0; i < 4; i++)
+		known = known && output[i] == zeroAnswer[i];
+	Philox(0xa4093822, 0x299f31d0).Generate(piCounter, output);
+	for (int i = 0; i < 4; i++)
+		known = known && output[i] == piAnswer[i];
+
+	//a million gaussians should come out near mean 0 and variance 1
+	Philox random(seed);
+	double sum = 0;
+	double sumSq = 0;
+	const int gaussianCount = 1 << 20;
+	for (int i = 0; i < gaussianCount / 4; i++)
+	{
+		unsigned int counter[4] = { (unsigned int)i, 0, 0, 0 };
+		float gaussian[4];
+		random.Gaussian(counter, gaussian);
+		for (int j = 0; j < 4; j++)
+		{
+			sum += gaussian[j];
+			sumSq += gaussian[j] * gaussian[j];
+		}
+	}
+	double mean = sum / gaussianCount;
+	double variance = sumSq / gaussianCount - mean * mean;
+
+	printf("ocean spectrum: %dx%d, %d repeats\n", fftRes, fftRes, repeatCount);
+	printf("  philox:        known answers %s, gaussian mean %.4f, variance %.4f\n", known ? "match" : "DIFFER", mean, variance);
+
+	OceanSpectrumDesc desc = {};
+	desc.fftRes = fftRes;
+	desc.L = 1000;
+	desc.amp = 4.0f;
+	desc.windDir = XMFLOAT2(1, 1);
+	desc.windSpeed = 40.0f;
+	desc.fetch = 100000.0f;
+	desc.depth = 30.0f;
+	desc.seed = seed;
+
+	ThreadPool threads;
+	const char* names[3] = { "phillips", "jonswap", "tma" };
+	OceanSpectrumType types[3] = { OceanSpectrumType::Phillips, OceanSpectrumType::JONSWAP, OceanSpectrumType::TMA };
+	for (int t = 0; t < 3; t++)
+	{
+		desc.type = types[t];
+
+		std::shared_ptr<OceanH0> single;
+		auto singleStart = std::chrono::high_resolution_clock::now();
+		for (int r = 0; r < repeatCount; r++)
+		{
+			single = OceanSpectrum::CreateH0(desc, nullptr);
+		}
+		auto singleEnd = std::chrono::high_resolution_clock::now();
+
+		std::shared_ptr<OceanH0> pooled;
+		auto poolStart = std::chrono::high_resolution_clock::now();
+		for (int r = 0; r < repeatCount; r++)
+		{
+			pooled = OceanSpectrum::CreateH0(desc, &threads);
+		}
+		auto poolEnd = std::chrono::high_resolution_clock::now();
+
+		//the rows can be made in any order and still have to be the same bits
+		bool same = true;
+		double heightSq = 0;
+		for (int i = 0; i < fftRes * fftRes; i++)
+		{
+			const XMFLOAT4& a = single->h0[i];
+			const XMFLOAT4& b = pooled->h0[i];
+			const XMFLOAT4& aMinus = single->h0Minus[i];
+			const XMFLOAT4& bMinus = pooled->h0Minus[i];
+			same = same && a.x == b.x && a.y == b.y && aMinus.x == bMinus.x && aMinus.y == bMinus.y;
+			heightSq += a.x * a.x + a.y * a.y;
+		}
+
+		double singleMs = std::chrono::duration<double>(singleEnd - singleStart).count() * 1e3 / repeatCount;
+		double poolMs = std::chrono::duration<double>(poolEnd - poolStart).count() * 1e3 / repeatCount;
+		printf("  %-9s      %8.3f ms one thread, %8.3f ms on %d workers, %.1fx, %s, rms h0 %g\n", names[t],
+			singleMs, poolMs, threads.GetWorkerCount(), singleMs / poolMs, same ? "same" : "DIFFERENT",
+			sqrt(heightSq / (fftRes * fftRes)));
+	}
+
+	//the first ask makes the spectrum, the rest are a hash lookup
+	OceanSpectrum spectrum(&threads);
+	desc.type = OceanSpectrumType::JONSWAP;
+	auto missStart = std::chrono::high_resolution_clock::now();
+	std::shared_ptr<const OceanH0> first = spectrum.GetH0(desc);
+	auto missEnd = std::chrono::high_resolution_clock::now();
+	std::shared_ptr<const OceanH0> again;
+	auto hitStart = std::chrono::high_resolution_clock::now();
+	for (int r = 0; r < repeatCount; r++)
+	{
+		again = spectrum.GetH0(desc);
+	}
+	auto hitEnd = std::chrono::high_resolution_clock::now();
+
+	OceanSpectrumDesc otherSeed = desc;
+	otherSeed.seed++;
+	bool hashes = OceanSpectrum::Hash(desc) == OceanSpectrum::Hash(OceanSpectrumDesc(desc)) &&
+		OceanSpectrum::Hash(desc) != OceanSpectrum::Hash(otherSeed);
+
+	printf("  cache:         %8.3f ms to make, %8.5f ms to ask again, %s, %d hits %d misses\n",
+		std::chrono::duration<double>(missEnd - missStart).count() * 1e3,
+		std::chrono::duration<double>(hitEnd - hitStart).count() * 1e3 / repeatCount,
+		first == again ? "same spectrum" : "MADE AGAIN", spectrum.GetCacheHits(), spectrum.GetCacheMisses());
+	printf("  hash:          %s\n", hashes ? "stable, changes with the seed" : "WRONG");
+}
+
+void RunOceanQuadtreeBenchmark(int frameCount)
+{
+	//the camera Game starts with, 10 metres up, turning all the way around and moving on
+	XMFLOAT4X4 projection;
+	XMStoreFloat4x4(&projection, XMMatrixTranspose(XMMatrixPerspectiveFovLH(0.25f * 3.1415926535f, 16.0f / 9.0f, 0.1f, 10000.0f)));
+
+	float oceanSizes[3] = { 2048.0f, 8192.0f, 32768.0f };
+	printf("ocean quadtree: %d frames, 8 m patches at 16\n", frameCount);
+	for (int s = 0; s < 3; s++)
+	{
+		OceanQuadtree quadtree(oceanSizes[s], 8.0f, 16.0f, 2.0f);
+		quadtree.SetBounds(-2.0f, 20.0f);
+
+		double patchTotal = 0;
+		double triangleTotal = 0;
+		double culledTotal = 0;
+		int mostPatches = 0;
+		int levels = 0;
+		int cracks = 0;
+		double seconds = 0;
+		for (int frame = 0; frame < frameCount; frame++)
+		{
+			float yaw = 2 * 3.1415926535f * frame / frameCount;
+			XMFLOAT3 position(50.0f + frame * 3.0f, 10.0f, frame * 2.0f);
+			XMVECTOR eye = XMLoadFloat3(&position);
+			XMVECTOR forward = XMVectorSet(sinf(yaw), -0.15f, cosf(yaw), 0);
+			XMFLOAT4X4 view;
+			XMStoreFloat4x4(&view, XMMatrixTranspose(XMMatrixLookAtLH(eye, XMVectorAdd(eye, forward), XMVectorSet(0, 1, 0, 0))));
+
+			auto start = std::chrono::high_resolution_clock::now();
+			quadtree.Update(position, view, projection);
+			auto end = std::chrono::high_resolution_clock::now();
+			seconds += std::chrono::duration<double>(end - start).count();
+
+			const std::vector<OceanPatch>& patches = quadtree.GetPatches();
+			patchTotal += patches.size();
+			culledTotal += quadtree.GetCulledCount();
+			mostPatches = std::max(mostPatches, (int)patches.size());
+			levels = std::max(levels, quadtree.GetLevelCount());
+			for (const OceanPatch& patch : patches)
+			{
+				triangleTotal += 2.0 * patch.insideTess * patch.insideTess;
+			}
+
+			//two patches touching along an edge have to put their vertices the same distance apart
+			for (size_t a = 0; a < patches.size(); a++)
+			{
+				for (size_t b = 0; b < patches.size(); b++)
+				{
+					const OceanPatch& p = patches[a];
+					const OceanPatch& q = patches[b];
+					bool overlapZ = p.origin.y < q.origin.y + q.size && q.origin.y < p.origin.y + p.size;
+					bool overlapX = p.origin.x < q.origin.x + q.size && q.origin.x < p.origin.x + p.size;
+					if (overlapZ && p.origin.x + p.size == q.origin.x &&
+						p.size / p.edgeTess.y != q.size / q.edgeTess.x)
+						cracks++;
+					if (overlapX && p.origin.y + p.size == q.origin.y &&
+						p.size / p.edgeTess.w != q.size / q.edgeTess.z)
+						cracks++;
+				}
+			}
+		}
+
+		//the same ocean as one grid at the spacing the closest patches get
+		double uniform = 2.0 * (oceanSizes[s] / (8.0 / 16.0)) * (oceanSizes[s] / (8.0 / 16.0));
+		printf("  %6.0f m:      %6.1f patches (most %d), %d levels, %6.1f nodes culled, %9.0f triangles, %7.4f ms, %d cracks\n",
+			oceanSizes[s], patchTotal / frameCount, mostPatches, levels, culledTotal / frameCount,
+			triangleTotal / frameCount, seconds * 1e3 / frameCount, cracks);
+		printf("                 one grid at the finest spacing: %.3g triangles\n", uniform);
+	}
+}
+
+void RunWakeBenchmark(int budget, int frameCount)
+{
+	WaveParticles wake(budget);
+	const float deltaTime = 1.0f / 60.0f;
+	const float shipSpeed = 10.0f;
+	float travelled = 0.0f;
+
+	double updateSeconds = 0;
+	double splatSeconds = 0;
+	double particleTotal = 0;
+	double dirtyTotal = 0;
+	int mostParticles = 0;
+	int splits = 0;
+	int merges = 0;
+	int drops = 0;
+	float shipX = 0.0f;
+	float shipZ = 0.0f;
+	//what the texture would hold, uploaded after every third step the way a slow frame does
+	std::vector<float> texture(wake.GetResolution() * wake.GetResolution(), 0.0f);
+	int staleTexels = 0;
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		//the ship turns slowly so the wake curls
+		float heading = frame * deltaTime * 0.2f;
+		shipX += sinf(heading) * shipSpeed * deltaTime;
+		shipZ += cosf(heading) * shipSpeed * deltaTime;
+		travelled += shipSpeed * deltaTime;
+		if (travelled >= 2.0f)
+		{
+			wake.EmitRing(shipX, shipZ, 0.25f, 24);
+			travelled -= 2.0f;
+		}
+		if (frame % 60 == 30)
+			wake.EmitRing(shipX + 20.0f, shipZ + 15.0f, 0.5f, 32);
+
+		auto updateStart = std::chrono::high_resolution_clock::now();
+		wake.Update(deltaTime);
+		auto splatStart = std::chrono::high_resolution_clock::now();
+		wake.Splat(shipX, shipZ);
+		auto splatEnd = std::chrono::high_resolution_clock::now();
+		updateSeconds += std::chrono::duration<double>(splatStart - updateStart).count();
+		splatSeconds += std::chrono::duration<double>(splatEnd - splatStart).count();
+
+		particleTotal += wake.GetCount();
+		if (frame % 3 == 2)
+		{
+			int resolution = wake.GetResolution();
+			int tilesARow = resolution / WAKE_TILE_SIZE;
+			const std::vector<float>& heights = wake.GetHeights();
+			dirtyTotal += wake.GetDirtyTiles().size();
+			for (int tile : wake.GetDirtyTiles())
+			{
+				int tileX = (tile % tilesARow) * WAKE_TILE_SIZE;
+				int tileY = (tile / tilesARow) * WAKE_TILE_SIZE;
+				for (int row = 0; row < WAKE_TILE_SIZE; row++)
+				{
+					int start = (tileY + row) * resolution + tileX;
+					std::copy(heights.begin() + start, heights.begin() + start + WAKE_TILE_SIZE, texture.begin() + start);
+				}
+			}
+			wake.ClearDirtyTiles();
+			for (int texel = 0; texel < resolution * resolution; texel++)
+			{
+				if (texture[texel] != heights[texel])
+					staleTexels++;
+			}
+		}
+		mostParticles = std::max(mostParticles, wake.GetCount());
+		splits += wake.GetSplitCount();
+		merges += wake.GetMergeCount();
+		drops += wake.GetDropCount();
+	}
+
+	//a fresh ring splatted alone has to match the bump it was made from
+	WaveParticles single(budget);
+	single.EmitRing(0.0f, 0.0f, 0.3f, 8);
+	single.Update(0.25f);
+	single.Splat(0.0f, 0.0f);
+	float largestError = 0.0f;
+	XMFLOAT2 origin = single.GetGridOrigin();
+	for (int i = 0; i < 200; i++)
+	{
+		float px = -8.0f + i * 0.08f;
+		float sampleX = floorf((px - origin.x) / single.GetCellSize()) * single.GetCellSize() + origin.x;
+		float expected = 0.0f;
+		for (int p = 0; p < 8; p++)
+		{
+			float angle = 2 * 3.1415926535f * p / 8;
+			float dx = sampleX - cosf(angle);
+			float dz = -sinf(angle);
+			float d = sqrtf(dx * dx + dz * dz) / 3.0f;
+			if (d < 1.0f)
+				expected += 0.3f * expf(-0.3f * 0.25f) * 0.5f * (1.0f + cosf(3.1415926535f * d));
+		}
+		largestError = std::max(largestError, fabsf(single.GetHeight(sampleX, 0.0f) - expected));
+	}
+
+	//a ring against the grid's right edge can't put anything in a tile it didn't flag, that
+	//would never be cleared or uploaded
+	WaveParticles edge(budget);
+	float edgeX = edge.GetResolution() * edge.GetCellSize() * 0.5f - 0.75f;
+	edge.EmitRing(edgeX, 0.0f, 0.3f, 8);
+	edge.Splat(0.0f, 0.0f);
+	int edgeTilesARow = edge.GetResolution() / WAKE_TILE_SIZE;
+	std::vector<unsigned char> flagged(edgeTilesARow * edgeTilesARow, 0);
+	for (int tile : edge.GetDirtyTiles())
+		flagged[tile] = 1;
+	int leaked = 0;
+	for (int texel = 0; texel < edge.GetResolution() * edge.GetResolution(); texel++)
+	{
+		int tile = (texel / edge.GetResolution() / WAKE_TILE_SIZE) * edgeTilesARow + (texel % edge.GetResolution()) / WAKE_TILE_SIZE;
+		if (edge.GetHeights()[texel] != 0.0f && !flagged[tile])
+			leaked++;
+	}
+
+	int tileCount = (wake.GetResolution() / WAKE_TILE_SIZE) * (wake.GetResolution() / WAKE_TILE_SIZE);
+	printf("wake particles: budget %d, %d frames, %dx%d grid of %.1f m\n", wake.GetBudget(), frameCount,
+		wake.GetResolution(), wake.GetResolution(), wake.GetCellSize());
+	printf("  particles:     %8.1f on average, most %d, %d splits, %d merged, %d dropped\n",
+		particleTotal / frameCount, mostParticles, splits, merges, drops);
+	printf("  update:        %8.3f ms/frame\n", updateSeconds * 1e3 / frameCount);
+	printf("  splat:         %8.3f ms/frame, %.1f of %d tiles to upload every third frame\n", splatSeconds * 1e3 / frameCount,
+		dirtyTotal / (frameCount / 3), tileCount);
+	printf("  uploads:       %8d texels stale after uploading three steps at once\n", staleTexels);
+	printf("  one ring:      largest difference %g from the bumps\n", largestError);
+	printf("  at the edge:   %8d texels written outside the tiles given out\n", leaked);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+//headless benchmarks for the cpu side of the water, they only need DirectXMath and the
+//standard library like the ones in PhysicsBenchmark.h, whose main runs them
+
+//samples the water's gerstner waves under probeCount buoyancy probes for frameCount frames,
+//one at a time and four wide, and checks both against a fully converged inversion
+void RunWaveBenchmark(int probeCount, int frameCount, unsigned int seed = 1);
+
+//runs the cpu ocean with the parameters of Water's first cascade for frameCount frames and
+//checks the last one against the step by step copy of the compute shaders
+void RunOceanBenchmark(int fftRes, int frameCount, unsigned int seed = 1);
+
+//runs every FFTPlan size on a few random spikes, whose transform is known exactly, and
+//prints the passes each one takes next to the radix 2 count
+void RunFFTPlanBenchmark(unsigned int seed = 1);
+
+//times the cascades Game gives Water, skipping frames the same way, against the single
+//1024 x 1024 ocean they replace
+void RunCascadeBenchmark(int frameCount, unsigned int seed = 1);
+
+//bakes a loop of the ocean, prints the cache's memory and quality report, times playing it
+//back and checks it loops, reloads from disk and stays close to the live fft between frames
+void RunOceanCacheBenchmark(int fftRes, int frameCount, unsigned int seed = 1);
+
+//checks Philox against the random123 known answers and its gaussians' spread, then times
+//making h0 for every spectrum on one thread and on the pool, and asking the cache again
+void RunSpectrumBenchmark(int fftRes, int repeatCount, unsigned int seed = 1);
+
+//flies a camera over oceans of a few sizes for frameCount frames and prints what Water's
+//quadtree draws, the triangles it tessellates to and whether any two patch edges disagree
+void RunOceanQuadtreeBenchmark(int frameCount);
+
+//sails a ship leaving a ring every two metres and splashes a shot every second into a budget
+//of wave particles, timing the update and the splat and checking the grid against the bumps
+void RunWakeBenchmark(int budget, int frameCount);
@@ -0,0 +1,534 @@
+#include "OceanCache.h"
+#include<cmath>
+#include<fstream>
+#include<algorithm>
+
+//"OCNC", then the version
+static const unsigned int CACHE_MAGIC = 0x434E434F;
+static const unsigned int CACHE_VERSION = 1;
+
+//Water gives NormalMapCS the same strength
+static const float NORMAL_STRENGTH = 8.0f;
+
+//residuals this many times the rice parameter and over are written out whole
+static const int RICE_ESCAPE = 24;
+
+//the largest fft the ocean runs, anything bigger in a file is corrupt
+static const int CACHE_MAX_RESOLUTION = 1024;
+
+//bits into bytes, lowest first
+struct BitWriter
+{
+	std::vector<unsigned char>& output;
+	unsigned long long buffer;
+	int count;
+
+	BitWriter(std::vector<unsigned char>& output) : output(output), buffer(0), count(0) {}
+
+	void Write(unsigned int bits, int length)
+	{
+		buffer |= (unsigned long long)bits << count;
+		count += length;
+		while (count >= 8)
+		{
+			output.push_back((unsigned char)buffer);
+			buffer >>= 8;
+			count -= 8;
+		}
+	}
+
+	void Flush()
+	{
+		if (count > 0)
+			output.push_back((unsigned char)buffer);
+		buffer = 0;
+		count = 0;
+	}
+};
+
+//reading past end gives zeros and marks the read as failed
+struct BitReader
+{
+	const unsigned char* input;
+	const unsigned char* end;
+	unsigned long long buffer;
+	int count;
+	bool failed;
+
+	BitReader(const unsigned char* input, const unsigned char* end) : input(input), end(end), buffer(0), count(0), failed(false) {}
+
+	unsigned int Read(int length)
+	{
+		while (count < length)
+		{
+			if (input == end)
+				failed = true;
+			else
+				buffer |= (unsigned long long)(*input++) << count;
+			count += 8;
+		}
+		unsigned int bits = (unsigned int)(buffer & ((1ull << length) - 1));
+		buffer >>= length;
+		count -= length;
+		return bits;
+	}
+};
+
+//zigzag so small negative residuals stay small
+static unsigned int ZigZag(int value)
+{
+	return ((unsigned int)value << 1) ^ (unsigned int)(value >> 31);
+}
+
+static int UnZigZag(unsigned int value)
+{
+	return (int)(value >> 1) ^ -(int)(value & 1);
+}
+
+//one map of one frame as rice codes, the parameter picked from the mean residual
+static void WriteResiduals(BitWriter& writer, const std::vector<unsigned int>& residuals)
+{
+	unsigned long long sum = 0;
+	for (unsigned int r : residuals)
+	{
+		sum += r;
+	}
+	int k = 0;
+	while (k < 31 && ((unsigned long long)residuals.size() << (k + 1)) <= sum)
+		k++;
+
+	writer.Write(k, 5);
+	for (unsigned int r : residuals)
+	{
+		unsigned int q = r >> k;
+		if (q < RICE_ESCAPE)
+		{
+			writer.Write((1u << q) - 1, q + 1);
+			writer.Write(r & ((1u << k) - 1), k);
+		}
+		else
+		{
+			writer.Write((1u << RICE_ESCAPE) - 1, RICE_ESCAPE);
+			writer.Write(r, 32);
+		}
+	}
+}
+
+static int ReadResidualParameter(BitReader& reader)
+{
+	return (int)reader.Read(5);
+}
+
+static int ReadResidual(BitReader& reader, int k)
+{
+	unsigned int q = 0;
+	while (reader.Read(1))
+	{
+		q++;
+		if (q == RICE_ESCAPE)
+			return UnZigZag(reader.Read(32));
+	}
+	return UnZigZag((q << k) | reader.Read(k));
+}
+
+//the normal and folding maps the way NormalMapCS and JacobianCS make them from the
+//displacements, wrapping at the edges like the water's sampler
+static void CreateDerivedMaps(int n, const float* dx, const float* dy, float* normalX, float* normalY, float* folding)
+{
+	for (int y = 0; y < n; y++)
+	{
+		int up = (y + n - 1) % n;
+		int down = (y + 1) % n;
+		for (int x = 0; x < n; x++)
+		{
+			int left = (x + n - 1) % n;
+			int right = (x + 1) % n;
+
+			//sobel filter
+			float z0 = dy[up * n + left], z1 = dy[up * n + x], z2 = dy[up * n + right];
+			float z3 = dy[y * n + left], z4 = dy[y * n + right];
+			float z5 = dy[down * n + left], z6 = dy[down * n + x], z7 = dy[down * n + right];
+			float nx = (z2 + 2.0f * z4 + z7) - (z0 + 2.0f * z3 + z5);
+			float ny = (z5 + 2.0f * z6 + z7) - (z0 + 2.0f * z1 + z2);
+			float nz = 1 / NORMAL_STRENGTH;
+			float length = sqrtf(nx * nx + ny * ny + nz * nz);
+			normalX[y * n + x] = nx / length;
+			normalY[y * n + x] = ny / length;
+
+			float y1 = dy[y * n + x];
+			float y2 = dy[down * n + x];
+			float y3 = dy[y * n + right];
+			float x1 = dx[y * n + x];
+			float x2 = dx[y * n + right];
+			float x3 = dx[down * n + x];
+			float jyy = 1 + (y2 - y1) * 1.8f;
+			float jxx = 1 + (x2 - x1) * 1.8f;
+			float jxy = 1 + (x3 - y1) * 1.8f;
+			float jyx = 1 + (y3 - y1) * 1.8f;
+			folding[y * n + x] = (jxx * jyy) - (jxy * jyx) + 0.1f;
+		}
+	}
+}
+
+OceanCache::OceanCache()
+{
+	resolution = 0;
+	frameCount = 0;
+	keyframeInterval = 1;
+	period = 0;
+	startTime = 0;
+	for (int m = 0; m < CACHE_MAP_COUNT; m++)
+	{
+		step[m] = 1;
+	}
+	report = {};
+	Reset();
+}
+
+void OceanCache::Clear()
+{
+	resolution = 0;
+	frameCount = 0;
+	data.clear();
+	frameOffsets.clear();
+	report = {};
+	Reset();
+}
+
+void OceanCache::Reset()
+{
+	int count = resolution * resolution * CACHE_MAP_COUNT;
+	frames[0].assign(count, 0);
+	frames[1].assign(count, 0);
+	frameIndex[0] = -1;
+	frameIndex[1] = -1;
+}
+
+void OceanCache::Bake(OceanFFT& ocean, float period, int frameCount, float startTime, int bits, int keyframeInterval)
+{
+	ocean.SetLoopPeriod(period);
+	this->resolution = ocean.GetResolution();
+	this->frameCount = frameCount;
+	this->keyframeInterval = keyframeInterval < 1 ? 1 : keyframeInterval;
+	this->period = period;
+	this->startTime = startTime;
+
+	int n = resolution;
+	int texels = n * n;
+	std::vector<float> maps(texels * CACHE_MAP_COUNT);
+	auto renderFrame = [&](int frame)
+	{
+		ocean.Update(startTime + period * frame / frameCount);
+		std::copy(ocean.GetDisplacementX(), ocean.GetDisplacementX() + texels, maps.begin() + CACHE_DISPLACEMENT_X * texels);
+		std::copy(ocean.GetHeights(), ocean.GetHeights() + texels, maps.begin() + CACHE_HEIGHT * texels);
+		std::copy(ocean.GetDisplacementZ(), ocean.GetDisplacementZ() + texels, maps.begin() + CACHE_DISPLACEMENT_Z * texels);
+		CreateDerivedMaps(n, &maps[CACHE_DISPLACEMENT_X * texels], &maps[CACHE_HEIGHT * texels],
+			&maps[CACHE_NORMAL_X * texels], &maps[CACHE_NORMAL_Y * texels], &maps[CACHE_FOLDING * texels]);
+	};
+
+	//the range of every map over the whole loop first, so one step holds for all frames
+	float largest[CACHE_MAP_COUNT] = {};
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		renderFrame(frame);
+		for (int m = 0; m < CACHE_MAP_COUNT; m++)
+		{
+			for (int i = 0; i < texels; i++)
+			{
+				largest[m] = std::max(largest[m], fabsf(maps[m * texels + i]));
+			}
+		}
+	}
+
+	int levels = (1 << (bits - 1)) - 1;
+	for (int m = 0; m < CACHE_MAP_COUNT; m++)
+	{
+		step[m] = largest[m] > 0 ? largest[m] / levels : 1.0f;
+	}
+
+	report = {};
+	report.resolution = n;
+	report.frameCount = frameCount;
+	report.period = period;
+	double squaredError[CACHE_MAP_COUNT] = {};
+
+	data.clear();
+	frameOffsets.clear();
+	std::vector<int> previous(texels * CACHE_MAP_COUNT, 0);
+	std::vector<int> quantized(texels * CACHE_MAP_COUNT);
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		renderFrame(frame);
+		for (int m = 0; m < CACHE_MAP_COUNT; m++)
+		{
+			for (int i = 0; i < texels; i++)
+			{
+				float value = maps[m * texels + i];
+				int q = (int)lroundf(value / step[m]);
+				quantized[m * texels + i] = q;
+
+				float error = fabsf(q * step[m] - value);
+				report.maxError[m] = std::max(report.maxError[m], error);
+				squaredError[m] += (double)error * error;
+			}
+		}
+
+		EncodeFrame(frame, previous, quantized);
+		previous.swap(quantized);
+	}
+
+	for (int m = 0; m < CACHE_MAP_COUNT; m++)
+	{
+		report.step[m] = step[m];
+		report.rmsError[m] = (float)sqrt(squaredError[m] / ((double)texels * frameCount));
+	}
+	report.rawBytes = (size_t)texels * CACHE_MAP_COUNT * frameCount * sizeof(float);
+	report.compressedBytes = data.size() + frameOffsets.size() * sizeof(unsigned int);
+	report.decoderBytes = (size_t)texels * CACHE_MAP_COUNT * 2 * sizeof(int);
+
+	Reset();
+}
+
+void OceanCache::EncodeFrame(int frame, const std::vector<int>& previous, const std::vector<int>& quantized)
+{
+	frameOffsets.push_back((unsigned int)data.size());
+	int texels = resolution * resolution;
+	bool keyframe = frame % keyframeInterval == 0;
+	std::vector<unsigned int> residuals(texels);
+	BitWriter writer(data);
+	for (int m = 0; m < CACHE_MAP_COUNT; m++)
+	{
+		const int* values = &quantized[m * texels];
+		const int* before = &previous[m * texels];
+		int prediction = 0;
+		for (int i = 0; i < texels; i++)
+		{
+			//keyframes against the texel to the left, the rest take the change since the
+			//last frame against the change of the texel to the left
+			int value = keyframe ? values[i] : values[i] - before[i];
+			residuals[i] = ZigZag(value - prediction);
+			prediction = value;
+		}
+		WriteResiduals(writer, residuals);
+	}
+	writer.Flush();
+}
+
+bool OceanCache::DecodeFrame(int frame, const std::vector<int>& previous, std::vector<int>& output)
+{
+	//a frame's codes end where the next one's start
+	size_t end = frame + 1 < frameCount ? frameOffsets[frame + 1] : data.size();
+	BitReader reader(data.data() + frameOffsets[frame], data.data() + end);
+	int texels = resolution * resolution;
+	bool keyframe = frame % keyframeInterval == 0;
+	for (int m = 0; m < CACHE_MAP_COUNT; m++)
+	{
+		int k = ReadResidualParameter(reader);
+		int prediction = 0;
+		for (int i = m * texels; i < (m + 1) * texels; i++)
+		{
+			prediction += ReadResidual(reader, k);
+			output[i] = keyframe ? prediction : previous[i] + prediction;
+		}
+	}
+	return !reader.failed;
+}
+
+void OceanCache::SeekFrame(int slot, int frame)
+{
+	int keyframe = frame - frame % keyframeInterval;
+	for (int f = keyframe; f <= frame; f++)
+	{
+		DecodeFrame(f, frames[slot], frames[slot]);
+	}
+	frameIndex[slot] = frame;
+}
+
+void OceanCache::Sample(float time, float* maps[CACHE_MAP_COUNT])
+{
+	if (frameCount == 0)
+		return;
+
+	float phase = fmodf(time - startTime, period);
+	if (phase < 0)
+		phase += period;
+	float position = phase / period * frameCount;
+	int a = (int)position;
+	if (a >= frameCount)
+		a = frameCount - 1;
+	int b = (a + 1) % frameCount;
+	float t = position - a;
+
+	//playing forward the second frame becomes the first, so only one frame is decoded
+	//each time the time crosses into the next one
+	if (frameIndex[0] != a)
+	{
+		if (frameIndex[1] == a)
+		{
+			frames[0].swap(frames[1]);
+			std::swap(frameIndex[0], frameIndex[1]);
+		}
+		else
+		{
+			SeekFrame(0, a);
+		}
+	}
+	if (frameIndex[1] != b)
+	{
+		if (b == a + 1 && b % keyframeInterval != 0)
+		{
+			DecodeFrame(b, frames[0], frames[1]);
+			frameIndex[1] = b;
+		}
+		else
+		{
+			SeekFrame(1, b);
+		}
+	}
+
+	int texels = resolution * resolution;
+	for (int m = 0; m < CACHE_MAP_COUNT; m++)
+	{
+		const int* first = &frames[0][m * texels];
+		const int* second = &frames[1][m * texels];
+		float* output = maps[m];
+		float weightA = (1 - t) * step[m];
+		float weightB = t * step[m];
+		for (int i = 0; i < texels; i++)
+		{
+			output[i] = first[i] * weightA + second[i] * weightB;
+		}
+	}
+}
+
+bool OceanCache::Save(const std::string& fileName)
+{
+	std::ofstream file(fileName.c_str(), std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	unsigned int offsetCount = (unsigned int)frameOffsets.size();
+	unsigned int dataSize = (unsigned int)data.size();
+	file.write((const char*)&CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	file.write((const char*)&CACHE_VERSION, sizeof(CACHE_VERSION));
+	file.write((const char*)&resolution, sizeof(resolution));
+	file.write((const char*)&frameCount, sizeof(frameCount));
+	file.write((const char*)&keyframeInterval, sizeof(keyframeInterval));
+	file.write((const char*)&period, sizeof(period));
+	file.write((const char*)&startTime, sizeof(startTime));
+	file.write((const char*)step, sizeof(step));
+	file.write((const char*)&offsetCount, sizeof(offsetCount));
+	file.write((const char*)frameOffsets.data(), offsetCount * sizeof(unsigned int));
+	file.write((const char*)&dataSize, sizeof(dataSize));
+	file.write((const char*)data.data(), dataSize);
+
+	return file.good();
+}
+
+bool OceanCache::Load(const std::string& fileName)
+{
+	std::ifstream file(fileName.c_str(), std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	unsigned int magic = 0, version = 0;
+	file.read((char*)&magic, sizeof(magic));
+	file.read((char*)&version, sizeof(version));
+	if (!file.good() || magic != CACHE_MAGIC || version != CACHE_VERSION)
+		return false;
+
+	unsigned int offsetCount = 0, dataSize = 0;
+	file.read((char*)&resolution, sizeof(resolution));
+	file.read((char*)&frameCount, sizeof(frameCount));
+	file.read((char*)&keyframeInterval, sizeof(keyframeInterval));
+	file.read((char*)&period, sizeof(period));
+	file.read((char*)&startTime, sizeof(startTime));
+	file.read((char*)step, sizeof(step));
+	file.read((char*)&offsetCount, sizeof(offsetCount));
+	if (!file.good() || resolution < 1 || resolution > CACHE_MAX_RESOLUTION || frameCount < 1 ||
+		offsetCount != (unsigned int)frameCount || keyframeInterval < 1 || !(period > 0))
+	{
+		Clear();
+		return false;
+	}
+
+	frameOffsets.resize(offsetCount);
+	file.read((char*)frameOffsets.data(), offsetCount * sizeof(unsigned int));
+	file.read((char*)&dataSize, sizeof(dataSize));
+
+	//the data has to be all there before it is allocated, and every frame has to start
+	//inside it after the one before
+	std::streamoff dataStart = file.tellg();
+	file.seekg(0, std::ios::end);
+	bool complete = file.good() && file.tellg() - dataStart >= (std::streamoff)dataSize;
+	for (unsigned int i = 0; complete && i < offsetCount; i++)
+	{
+		complete = frameOffsets[i] < dataSize && (i == 0 || frameOffsets[i] > frameOffsets[i - 1]);
+	}
+	if (!complete)
+	{
+		Clear();
+		return false;
+	}
+
+	file.seekg(dataStart);
+	data.resize(dataSize);
+	file.read((char*)data.data(), dataSize);
+	if (!file.good())
+	{
+		Clear();
+		return false;
+	}
+
+	//every frame is decoded once, so Sample never meets one that runs off its codes
+	Reset();
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		if (!DecodeFrame(frame, frames[0], frames[0]))
+		{
+			Clear();
+			return false;
+		}
+	}
+
+	//the errors are only known while baking
+	report = {};
+	report.resolution = resolution;
+	report.frameCount = frameCount;
+	report.period = period;
+	for (int m = 0; m < CACHE_MAP_COUNT; m++)
+	{
+		report.step[m] = step[m];
+	}
+	report.rawBytes = (size_t)resolution * resolution * CACHE_MAP_COUNT * frameCount * sizeof(float);
+	report.compressedBytes = data.size() + frameOffsets.size() * sizeof(unsigned int);
+	report.decoderBytes = (size_t)resolution * resolution * CACHE_MAP_COUNT * 2 * sizeof(int);
+
+	Reset();
+	return true;
+}
+
+int OceanCache::GetResolution()
+{
+	return resolution;
+}
+
+int OceanCache::GetFrameCount()
+{
+	return frameCount;
+}
+
+float OceanCache::GetPeriod()
+{
+	return period;
+}
+
+float OceanCache::GetStartTime()
+{
+	return startTime;
+}
+
+const OceanCacheReport& OceanCache::GetReport()
+{
+	return report;
+}
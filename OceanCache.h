@@ -0,0 +1,89 @@
+#pragma once
+#include<vector>
+#include<string>
+#include"OceanFFT.h"
+
+//the maps a baked frame keeps, in the order they are stored. the normal's z is left out,
+//it is always the positive root, and these are what the fft chain leaves in dx/dy/dz,
+//the normal map and the folding map
+enum OceanCacheMap
+{
+	CACHE_DISPLACEMENT_X,
+	CACHE_HEIGHT,
+	CACHE_DISPLACEMENT_Z,
+	CACHE_NORMAL_X,
+	CACHE_NORMAL_Y,
+	CACHE_FOLDING,
+	CACHE_MAP_COUNT
+};
+
+//what a bake costs and how close it stays to the maps it was made from
+struct OceanCacheReport
+{
+	int resolution;
+	int frameCount;
+	float period;
+	size_t rawBytes; //every frame as floats
+	size_t compressedBytes; //what is kept in memory and written to disk
+	size_t decoderBytes; //the two decoded frames Sample keeps besides that
+	float step[CACHE_MAP_COUNT]; //the quantization step of each map
+	float maxError[CACHE_MAP_COUNT]; //over every texel of every baked frame
+	float rmsError[CACHE_MAP_COUNT];
+};
+
+//one loop of the ocean baked ahead of time, for machines that cannot run the fft every frame.
+//every map is quantized to a fixed step, keyframes store each texel against the one to its
+//left and the frames in between store its change since the frame before against its left
+//neighbour's, all as rice codes. Sample decodes frames in order and blends the two around
+//the time it is given
+class OceanCache
+{
+	int resolution;
+	int frameCount;
+	int keyframeInterval;
+	float period;
+	float startTime;
+	float step[CACHE_MAP_COUNT];
+
+	std::vector<unsigned char> data;
+	std::vector<unsigned int> frameOffsets;
+
+	//the two frames around the last time sampled, quantized, and which frames they are
+	std::vector<int> frames[2];
+	int frameIndex[2];
+
+	OceanCacheReport report;
+
+	void EncodeFrame(int frame, const std::vector<int>& previous, const std::vector<int>& quantized);
+	//decodes on top of previous, which can be output itself. keyframes ignore it. false when
+	//the frame's codes run out before its texels do
+	bool DecodeFrame(int frame, const std::vector<int>& previous, std::vector<int>& output);
+	//decodes forward from the keyframe before frame
+	void SeekFrame(int slot, int frame);
+	void Reset();
+	//back to an empty cache, after a file that failed to load
+	void Clear();
+
+public:
+	OceanCache();
+
+	//bakes frameCount frames of one loop, starting at startTime. the ocean's dispersion is
+	//rounded to the period first so the last frame runs back into the first. bits is the
+	//precision each map keeps over its own range
+	void Bake(OceanFFT& ocean, float period, int frameCount, float startTime, int bits = 10, int keyframeInterval = 16);
+
+	//false when the file cannot be opened or is not a cache. Load also checks the header and
+	//decodes every frame once, a truncated or corrupt file leaves the cache empty
+	bool Save(const std::string& fileName);
+	bool Load(const std::string& fileName);
+
+	//every map at time, resolution x resolution floats each, blended between the baked frames
+	//and wrapped around the period
+	void Sample(float time, float* maps[CACHE_MAP_COUNT]);
+
+	int GetResolution();
+	int GetFrameCount();
+	float GetPeriod();
+	float GetStartTime();
+	const OceanCacheReport& GetReport();
+};
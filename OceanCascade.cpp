@@ -0,0 +1,192 @@
+#include "OceanCascade.h"
+
+//a size x height map the compute shaders can read and write, data filled in when given
+static void CreateMap(ID3D11Device* device, int width, int height, DXGI_FORMAT format,
+	ID3D11ShaderResourceView** srv, ID3D11UnorderedAccessView** uav, const D3D11_SUBRESOURCE_DATA* data = nullptr)
+{
+	ID3D11Texture2D* texture;
+
+	D3D11_TEXTURE2D_DESC texDesc = {};
+	texDesc.Width = width;
+	texDesc.Height = height;
+	texDesc.ArraySize = 1;
+	texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	if (uav)
+		texDesc.BindFlags |= D3D11_BIND_UNORDERED_ACCESS;
+	texDesc.CPUAccessFlags = 0;
+	texDesc.Format = format;
+	texDesc.MipLevels = 1;
+	texDesc.MiscFlags = 0;
+	texDesc.SampleDesc.Count = 1;
+	texDesc.SampleDesc.Quality = 0;
+	texDesc.Usage = uav ? D3D11_USAGE_DEFAULT : D3D11_USAGE_IMMUTABLE;
+	device->CreateTexture2D(&texDesc, data, &texture);
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Format = texDesc.Format;
+	srvDesc.Texture2D.MipLevels = 1;
+	srvDesc.Texture2D.MostDetailedMip = 0;
+	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+	device->CreateShaderResourceView(texture, &srvDesc, srv);
+
+	if (uav)
+	{
+		D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+		uavDesc.Format = texDesc.Format;
+		uavDesc.Texture2D.MipSlice = 0;
+		uavDesc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
+		device->CreateUnorderedAccessView(texture, &uavDesc, uav);
+	}
+
+	texture->Release();
+}
+
+OceanCascade::OceanCascade(ID3D11Device* device, const OceanH0& h0, int L, int updateInterval, int updatePhase)
+{
+	fftPlan = CreateFFTPlan(h0.fftRes);
+	this->fftSize = h0.fftRes;
+	this->L = L;
+	this->updateInterval = updateInterval < 1 ? 1 : updateInterval;
+	this->updatePhase = updatePhase % this->updateInterval;
+
+	//h0 is made on the cpu and starts out in the maps HtOceanCS reads
+	int size = this->fftSize;
+	D3D11_SUBRESOURCE_DATA h0Data = {};
+	h0Data.pSysMem = h0.h0.data();
+	h0Data.SysMemPitch = sizeof(XMFLOAT4) * size;
+	CreateMap(device, size, size, DXGI_FORMAT_R32G32B32A32_FLOAT, &h0SRV, &h0UAV, &h0Data);
+	h0Data.pSysMem = h0.h0Minus.data();
+	CreateMap(device, size, size, DXGI_FORMAT_R32G32B32A32_FLOAT, &h0MinusSRV, &h0MinusUAV, &h0Data);
+
+	for (int i = 0; i < 3; i++)
+	{
+		CreateMap(device, size, size, DXGI_FORMAT_R32G32B32A32_FLOAT, &spectrumSRV[i], &spectrumUAV[i]);
+		CreateMap(device, size, size, DXGI_FORMAT_R32G32B32A32_FLOAT, &displacementSRV[i], &displacementUAV[i]);
+	}
+
+	//twiddles filled from the plan's table so nothing has to be dispatched for them
+	D3D11_SUBRESOURCE_DATA twiddleData = {};
+	twiddleData.pSysMem = fftPlan->GetTwiddles().data();
+	twiddleData.SysMemPitch = sizeof(XMFLOAT2) * size;
+	CreateMap(device, size, 1, DXGI_FORMAT_R32G32_FLOAT, &twiddleSRV, nullptr, &twiddleData);
+
+	CreateMap(device, size, size, DXGI_FORMAT_R32G32B32A32_FLOAT, &pingpongSRV, &pingpongUAV);
+	CreateMap(device, size, size, DXGI_FORMAT_R32G32B32A32_FLOAT, &normalMapSRV, &normalMapUAV);
+	CreateMap(device, size, size, DXGI_FORMAT_R32G32B32A32_FLOAT, &foldingMapSRV, &foldingMapUAV);
+}
+
+OceanCascade::~OceanCascade()
+{
+	h0SRV->Release();
+	h0UAV->Release();
+	h0MinusSRV->Release();
+	h0MinusUAV->Release();
+
+	for (int i = 0; i < 3; i++)
+	{
+		spectrumSRV[i]->Release();
+		spectrumUAV[i]->Release();
+		displacementSRV[i]->Release();
+		displacementUAV[i]->Release();
+	}
+
+	twiddleSRV->Release();
+	pingpongSRV->Release();
+	pingpongUAV->Release();
+
+	normalMapSRV->Release();
+	normalMapUAV->Release();
+	foldingMapSRV->Release();
+	foldingMapUAV->Release();
+}
+
+void OceanCascade::UploadH0(ID3D11DeviceContext* context, const OceanH0& h0)
+{
+	if (h0.fftRes != fftSize)
+		return;
+
+	ID3D11Resource* h0Texture;
+	h0SRV->GetResource(&h0Texture);
+	context->UpdateSubresource(h0Texture, 0, nullptr, h0.h0.data(), sizeof(XMFLOAT4) * fftSize, 0);
+	h0Texture->Release();
+
+	ID3D11Resource* h0MinusTexture;
+	h0MinusSRV->GetResource(&h0MinusTexture);
+	context->UpdateSubresource(h0MinusTexture, 0, nullptr, h0.h0Minus.data(), sizeof(XMFLOAT4) * fftSize, 0);
+	h0MinusTexture->Release();
+}
+
+int OceanCascade::GetSize()
+{
+	return fftSize;
+}
+
+int OceanCascade::GetL()
+{
+	return L;
+}
+
+const FFTPassPlan* OceanCascade::GetPlan()
+{
+	return fftPlan.get();
+}
+
+bool OceanCascade::IsDue(int frame)
+{
+	return frame % updateInterval == updatePhase;
+}
+
+ID3D11UnorderedAccessView* OceanCascade::GetH0UAV()
+{
+	return h0UAV;
+}
+
+ID3D11UnorderedAccessView* OceanCascade::GetH0MinusUAV()
+{
+	return h0MinusUAV;
+}
+
+ID3D11UnorderedAccessView* OceanCascade::GetSpectrumUAV(int axis)
+{
+	return spectrumUAV[axis];
+}
+
+ID3D11ShaderResourceView* OceanCascade::GetDisplacementSRV(int axis)
+{
+	return displacementSRV[axis];
+}
+
+ID3D11UnorderedAccessView* OceanCascade::GetDisplacementUAV(int axis)
+{
+	return displacementUAV[axis];
+}
+
+ID3D11ShaderResourceView* OceanCascade::GetTwiddleSRV()
+{
+	return twiddleSRV;
+}
+
+ID3D11UnorderedAccessView* OceanCascade::GetPingpongUAV()
+{
+	return pingpongUAV;
+}
+
+ID3D11ShaderResourceView* OceanCascade::GetNormalMapSRV()
+{
+	return normalMapSRV;
+}
+
+ID3D11UnorderedAccessView* OceanCascade::GetNormalMapUAV()
+{
+	return normalMapUAV;
+}
+
+ID3D11ShaderResourceView* OceanCascade::GetFoldingMapSRV()
+{
+	return foldingMapSRV;
+}
+
+ID3D11UnorderedAccessView* OceanCascade::GetFoldingMapUAV()
+{
+	return foldingMapUAV;
+}
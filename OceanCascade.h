@@ -0,0 +1,77 @@
+#pragma once
+#include<d3d11.h>
+#include<DirectXMath.h>
+#include<memory>
+#include"FFTPlan.h"
+#include"OceanSpectrum.h"
+using namespace DirectX;
+
+//what Game picks for each cascade, Water works out the bands and amplitudes from these
+struct OceanCascadeDesc
+{
+	int fftSize;
+	int L; //patch length in metres
+	int updateInterval; //in frames
+};
+
+//one spectrum of the ocean. every cascade tiles its own patch of L metres with its own fft size,
+//and its h0 only keeps its own band of wave numbers so the cascades add up to one spectrum
+//instead of repeating the same waves. Water owns the shaders and runs the passes on these maps
+class OceanCascade
+{
+	int fftSize;
+	int L;
+	int updateInterval; //in frames, 2 renders every other frame
+	int updatePhase; //which of those frames, so slow cascades do not all land on the same one
+
+	std::unique_ptr<FFTPassPlan> fftPlan;
+
+	ID3D11ShaderResourceView* h0SRV;
+	ID3D11UnorderedAccessView* h0UAV;
+	ID3D11ShaderResourceView* h0MinusSRV;
+	ID3D11UnorderedAccessView* h0MinusUAV;
+
+	//x, y and z, the spectra HtOceanCS writes and the displacements they turn into
+	ID3D11ShaderResourceView* spectrumSRV[3];
+	ID3D11UnorderedAccessView* spectrumUAV[3];
+	ID3D11ShaderResourceView* displacementSRV[3];
+	ID3D11UnorderedAccessView* displacementUAV[3];
+
+	ID3D11ShaderResourceView* twiddleSRV;
+	ID3D11ShaderResourceView* pingpongSRV;
+	ID3D11UnorderedAccessView* pingpongUAV;
+
+	ID3D11ShaderResourceView* normalMapSRV;
+	ID3D11UnorderedAccessView* normalMapUAV;
+	ID3D11ShaderResourceView* foldingMapSRV;
+	ID3D11UnorderedAccessView* foldingMapUAV;
+
+public:
+	//the fft size is h0's, anything from 64 to 1024
+	OceanCascade(ID3D11Device* device, const OceanH0& h0, int L, int updateInterval, int updatePhase);
+	~OceanCascade();
+
+	//replaces h0 with another spectrum of the same size
+	void UploadH0(ID3D11DeviceContext* context, const OceanH0& h0);
+
+	int GetSize();
+	int GetL();
+	const FFTPassPlan* GetPlan();
+	//true on the frames this cascade has to be rendered again
+	bool IsDue(int frame);
+
+	ID3D11UnorderedAccessView* GetH0UAV();
+	ID3D11UnorderedAccessView* GetH0MinusUAV();
+	//0 for x, 1 for y and 2 for z
+	ID3D11UnorderedAccessView* GetSpectrumUAV(int axis);
+	ID3D11ShaderResourceView* GetDisplacementSRV(int axis);
+	ID3D11UnorderedAccessView* GetDisplacementUAV(int axis);
+
+	ID3D11ShaderResourceView* GetTwiddleSRV();
+	ID3D11UnorderedAccessView* GetPingpongUAV();
+
+	ID3D11ShaderResourceView* GetNormalMapSRV();
+	ID3D11UnorderedAccessView* GetNormalMapUAV();
+	ID3D11ShaderResourceView* GetFoldingMapSRV();
+	ID3D11UnorderedAccessView* GetFoldingMapUAV();
+};
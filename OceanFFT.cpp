@@ -0,0 +1,445 @@
+#include "OceanFFT.h"
+#include<cmath>
+
+//the constants the ocean shaders use
+static const float PI = 3.1415926535897932384626433832795f;
+static const float GRAVITY = 9.81f;
+
+//packs a row by row array of per texel values four columns to a vector
+static void Pack(const std::vector<float>& values, std::vector<XMVECTOR>& vectors)
+{
+	vectors.resize(values.size() / 4);
+	for (size_t i = 0; i < vectors.size(); i++)
+	{
+		vectors[i] = XMVectorSet(values[i * 4], values[i * 4 + 1], values[i * 4 + 2], values[i * 4 + 3]);
+	}
+}
+
+//the order the first radix 2 stage wants its inputs in
+static int ReverseBits(int num, int bits)
+{
+	int reversed = 0;
+	for (int i = 0; i < bits; i++)
+	{
+		reversed = (reversed << 1) | ((num >> i) & 1);
+	}
+	return reversed;
+}
+
+//(a + bi)(c + di) with the twiddle the same in every lane
+static void MultiplyTwiddle(XMVECTOR& real, XMVECTOR& imaginary, float twiddleReal, float twiddleImaginary)
+{
+	XMVECTOR r = XMVectorScale(real, twiddleReal) - XMVectorScale(imaginary, twiddleImaginary);
+	imaginary = XMVectorScale(imaginary, twiddleReal) + XMVectorScale(real, twiddleImaginary);
+	real = r;
+}
+
+OceanFFT::OceanFFT(int fftRes, int L, float amp, XMFLOAT2 windDir, float windSpeed, ThreadPool* threads)
+{
+	this->fftRes = fftRes;
+	this->L = L;
+	this->amp = amp;
+	this->windDir = windDir;
+	this->windSpeed = windSpeed;
+
+	log2N = 0;
+	while ((1 << log2N) < fftRes)
+		log2N++;
+
+	rowVectors = fftRes / 4;
+	int vectorCount = fftRes * rowVectors;
+	for (int map = 0; map < 3; map++)
+	{
+		real[map].resize(vectorCount);
+		imaginary[map].resize(vectorCount);
+		transposedReal[map].resize(vectorCount);
+		transposedImaginary[map].resize(vectorCount);
+		displacement[map].resize(fftRes * fftRes);
+	}
+
+	bitReversed.resize(fftRes);
+	for (int i = 0; i < fftRes; i++)
+	{
+		bitReversed[i] = ReverseBits(i, log2N);
+	}
+
+	//the same twiddles the gpu passes get
+	plan = CreateFFTPlan(fftRes);
+	const std::vector<XMFLOAT2>& twiddles = plan->GetTwiddles();
+	twiddleReal.resize(fftRes / 2);
+	twiddleImaginary.resize(fftRes / 2);
+	for (int t = 0; t < fftRes / 2; t++)
+	{
+		twiddleReal[t] = twiddles[t].x;
+		twiddleImaginary[t] = twiddles[t].y;
+	}
+
+	loopPeriod = 0;
+	CreateDispersion();
+
+	this->threads = threads;
+
+	CreateH0(1);
+}
+
+void OceanFFT::CreateDispersion()
+{
+	//per texel terms that do not change with time
+	std::vector<float> omegaValues(fftRes * fftRes);
+	std::vector<float> slopeXValues(fftRes * fftRes);
+	std::vector<float> slopeZValues(fftRes * fftRes);
+	for (int y = 0; y < fftRes; y++)
+	{
+		for (int x = 0; x < fftRes; x++)
+		{
+			float kx = 2 * PI * (x - fftRes / 2.0f) / L;
+			float kz = 2 * PI * (y - fftRes / 2.0f) / L;
+			float mag = sqrtf(kx * kx + kz * kz);
+			if (mag < 0.00001f) mag = 0.00001f;
+
+			float w = sqrtf(GRAVITY * mag);
+			if (loopPeriod > 0)
+			{
+				//down to a whole number of turns per period, like HtOceanCS
+				float w0 = 2 * PI / loopPeriod;
+				w = floorf(w / w0) * w0;
+			}
+
+			omegaValues[y * fftRes + x] = w;
+			slopeXValues[y * fftRes + x] = -kx / mag;
+			slopeZValues[y * fftRes + x] = -kz / mag;
+		}
+	}
+	Pack(omegaValues, omega);
+	Pack(slopeXValues, slopeX);
+	Pack(slopeZValues, slopeZ);
+}
+
+void OceanFFT::SetLoopPeriod(float period)
+{
+	loopPeriod = period;
+	CreateDispersion();
+}
+
+float OceanFFT::GetLoopPeriod()
+{
+	return loopPeriod;
+}
+
+void OceanFFT::CreateH0(unsigned int seed)
+{
+	//the same phillips spectrum and noise Water gives its first cascade for this seed
+	OceanSpectrumDesc desc = {};
+	desc.type = OceanSpectrumType::Phillips;
+	desc.fftRes = fftRes;
+	desc.L = L;
+	desc.amp = amp;
+	desc.windDir = windDir;
+	desc.windSpeed = windSpeed;
+	desc.seed = seed;
+	SetH0(*OceanSpectrum::CreateH0(desc, threads));
+}
+
+void OceanFFT::SetH0(const OceanH0& h0)
+{
+	int count = fftRes * fftRes;
+	std::vector<float> h0r(count), h0i(count), h0mr(count), h0mi(count);
+	for (int i = 0; i < count; i++)
+	{
+		h0r[i] = h0.h0[i].x;
+		h0i[i] = h0.h0[i].y;
+		//conjugated like HtOceanCS does
+		h0mr[i] = h0.h0Minus[i].x;
+		h0mi[i] = -h0.h0Minus[i].y;
+	}
+
+	Pack(h0r, h0Real);
+	Pack(h0i, h0Imaginary);
+	Pack(h0mr, h0MinusReal);
+	Pack(h0mi, h0MinusImaginary);
+}
+
+void OceanFFT::CreateSpectrum(int row, float time)
+{
+	for (int c = 0; c < rowVectors; c++)
+	{
+		int i = row * rowVectors + c;
+
+		XMVECTOR s, co;
+		XMVectorSinCos(&s, &co, XMVectorScale(omega[i], time));
+
+		//h0 e^(iwt) + conj(h0(-k)) e^(-iwt)
+		XMVECTOR heightReal = h0Real[i] * co - h0Imaginary[i] * s + h0MinusReal[i] * co + h0MinusImaginary[i] * s;
+		XMVECTOR heightImaginary = h0Real[i] * s + h0Imaginary[i] * co + h0MinusImaginary[i] * co - h0MinusReal[i] * s;
+
+		//multiplying by (0, -k / |k|) for the sideways maps
+		real[0][i] = XMVectorNegate(slopeX[i] * heightImaginary);
+		imaginary[0][i] = slopeX[i] * heightReal;
+		real[1][i] = heightReal;
+		imaginary[1][i] = heightImaginary;
+		real[2][i] = XMVectorNegate(slopeZ[i] * heightImaginary);
+		imaginary[2][i] = slopeZ[i] * heightReal;
+	}
+}
+
+void OceanFFT::InverseFFT(XMVECTOR* columnReal, XMVECTOR* columnImaginary)
+{
+	int n = fftRes;
+	int span = 1;
+
+	//an odd number of stages leaves one plain radix 2 stage, its twiddles are all one
+	if (log2N % 2 == 1)
+	{
+		for (int i = 0; i < n; i += 2)
+		{
+			XMVECTOR ar = columnReal[i];
+			XMVECTOR ai = columnImaginary[i];
+			XMVECTOR br = columnReal[i + 1];
+			XMVECTOR bi = columnImaginary[i + 1];
+			columnReal[i] = ar + br;
+			columnImaginary[i] = ai + bi;
+			columnReal[i + 1] = ar - br;
+			columnImaginary[i + 1] = ai - bi;
+		}
+		span = 2;
+	}
+
+	//two radix 2 stages at a time, so each group of four is loaded and stored once
+	for (; span < n; span *= 4)
+	{
+		int innerStep = n / (2 * span);
+		int outerStep = n / (4 * span);
+		for (int group = 0; group < n; group += 4 * span)
+		{
+			for (int j = 0; j < span; j++)
+			{
+				int i0 = group + j;
+				int i1 = i0 + span;
+				int i2 = i1 + span;
+				int i3 = i2 + span;
+
+				XMVECTOR r0 = columnReal[i0], m0 = columnImaginary[i0];
+				XMVECTOR r1 = columnReal[i1], m1 = columnImaginary[i1];
+				XMVECTOR r2 = columnReal[i2], m2 = columnImaginary[i2];
+				XMVECTOR r3 = columnReal[i3], m3 = columnImaginary[i3];
+
+				//the stage over 2 * span
+				float wr = twiddleReal[j * innerStep];
+				float wi = twiddleImaginary[j * innerStep];
+				MultiplyTwiddle(r1, m1, wr, wi);
+				MultiplyTwiddle(r3, m3, wr, wi);
+				XMVECTOR br0 = r0 + r1, bm0 = m0 + m1;
+				XMVECTOR br1 = r0 - r1, bm1 = m0 - m1;
+				XMVECTOR br2 = r2 + r3, bm2 = m2 + m3;
+				XMVECTOR br3 = r2 - r3, bm3 = m2 - m3;
+
+				//the stage over 4 * span, the odd pair's twiddle is this one times i
+				wr = twiddleReal[j * outerStep];
+				wi = twiddleImaginary[j * outerStep];
+				MultiplyTwiddle(br2, bm2, wr, wi);
+				MultiplyTwiddle(br3, bm3, wr, wi);
+				XMVECTOR tr = XMVectorNegate(bm3);
+				XMVECTOR tm = br3;
+
+				columnReal[i0] = br0 + br2;
+				columnImaginary[i0] = bm0 + bm2;
+				columnReal[i2] = br0 - br2;
+				columnImaginary[i2] = bm0 - bm2;
+				columnReal[i1] = br1 + tr;
+				columnImaginary[i1] = bm1 + tm;
+				columnReal[i3] = br1 - tr;
+				columnImaginary[i3] = bm1 - tm;
+			}
+		}
+	}
+}
+
+void OceanFFT::FirstPass(int map, int block)
+{
+	//the column is copied out so the butterflies run on memory next to each other instead
+	//of a row apart, the bit reversal happens on the way
+	std::vector<XMVECTOR> column(2 * fftRes);
+	XMVECTOR* columnReal = column.data();
+	XMVECTOR* columnImaginary = columnReal + fftRes;
+	for (int row = 0; row < fftRes; row++)
+	{
+		columnReal[bitReversed[row]] = real[map][row * rowVectors + block];
+		columnImaginary[bitReversed[row]] = imaginary[map][row * rowVectors + block];
+	}
+
+	InverseFFT(columnReal, columnImaginary);
+
+	//flipped 4x4 at a time, these four columns become four whole rows of the transpose
+	for (int rowBlock = 0; rowBlock < rowVectors; rowBlock++)
+	{
+		for (int part = 0; part < 2; part++)
+		{
+			XMVECTOR* source = (part == 0 ? columnReal : columnImaginary) + rowBlock * 4;
+			std::vector<XMVECTOR>& destination = part == 0 ? transposedReal[map] : transposedImaginary[map];
+
+			XMMATRIX flip = XMMatrixTranspose(XMMATRIX(source[0], source[1], source[2], source[3]));
+			for (int i = 0; i < 4; i++)
+			{
+				destination[(block * 4 + i) * rowVectors + rowBlock] = flip.r[i];
+			}
+		}
+	}
+}
+
+void OceanFFT::SecondPass(int map, int block)
+{
+	std::vector<XMVECTOR> column(2 * fftRes);
+	XMVECTOR* columnReal = column.data();
+	XMVECTOR* columnImaginary = columnReal + fftRes;
+	for (int row = 0; row < fftRes; row++)
+	{
+		columnReal[bitReversed[row]] = transposedReal[map][row * rowVectors + block];
+		columnImaginary[bitReversed[row]] = transposedImaginary[map][row * rowVectors + block];
+	}
+
+	InverseFFT(columnReal, columnImaginary);
+
+	//flipping back, keeping the real part and undoing the shift of k to the centre the way
+	//InversionCS does, with a sign that flips on every texel and the 1 / N^2 scale
+	float scale = 1.0f / (float)(fftRes * fftRes);
+	XMVECTOR evenRow = XMVectorSet(scale, -scale, scale, -scale);
+	XMVECTOR oddRow = XMVectorNegate(evenRow);
+	for (int columnBlock = 0; columnBlock < rowVectors; columnBlock++)
+	{
+		XMVECTOR* source = columnReal + columnBlock * 4;
+		XMMATRIX flip = XMMatrixTranspose(XMMATRIX(source[0], source[1], source[2], source[3]));
+		for (int i = 0; i < 4; i++)
+		{
+			int y = block * 4 + i;
+			XMVECTOR values = flip.r[i] * ((y % 2 == 0) ? evenRow : oddRow);
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&displacement[map][y * fftRes + columnBlock * 4]), values);
+		}
+	}
+}
+
+void OceanFFT::Update(float time)
+{
+	int blocks = rowVectors;
+
+	//down the columns four at a time, then across the rows by doing the columns of the transpose
+	RunJobs(fftRes, [&](int row) { CreateSpectrum(row, time); });
+	RunJobs(3 * blocks, [&](int job) { FirstPass(job / blocks, job % blocks); });
+	RunJobs(3 * blocks, [&](int job) { SecondPass(job / blocks, job % blocks); });
+}
+
+void OceanFFT::RunJobs(int count, const std::function<void(int)>& job)
+{
+	if (threads)
+		threads->ParallelFor(count, job);
+	else
+	{
+		for (int i = 0; i < count; i++)
+			job(i);
+	}
+}
+
+void OceanFFT::UpdateReference(float time, float* dx, float* dy, float* dz)
+{
+	int n = fftRes;
+	std::vector<XMFLOAT2> spectra[3];
+	for (int map = 0; map < 3; map++)
+	{
+		spectra[map].resize(n * n);
+	}
+
+	//HtOceanCS, one texel at a time from the unpacked h0
+	for (int y = 0; y < n; y++)
+	{
+		for (int x = 0; x < n; x++)
+		{
+			int v = (y * n + x) / 4;
+			int lane = x % 4;
+			float h0r = XMVectorGetByIndex(h0Real[v], lane);
+			float h0i = XMVectorGetByIndex(h0Imaginary[v], lane);
+			float hmr = XMVectorGetByIndex(h0MinusReal[v], lane);
+			float hmi = XMVectorGetByIndex(h0MinusImaginary[v], lane);
+			float w = XMVectorGetByIndex(omega[v], lane);
+			float sx = XMVectorGetByIndex(slopeX[v], lane);
+			float sz = XMVectorGetByIndex(slopeZ[v], lane);
+
+			float c = cosf(w * time);
+			float s = sinf(w * time);
+			float hr = (h0r * c - h0i * s) + (hmr * c + hmi * s);
+			float hi = (h0r * s + h0i * c) + (hmi * c - hmr * s);
+
+			spectra[0][y * n + x] = XMFLOAT2(-sx * hi, sx * hr);
+			spectra[1][y * n + x] = XMFLOAT2(hr, hi);
+			spectra[2][y * n + x] = XMFLOAT2(-sz * hi, sz * hr);
+		}
+	}
+
+	float* outputs[3] = { dx, dy, dz };
+	for (int map = 0; map < 3; map++)
+	{
+		//the FFTStageCS passes
+		plan->Execute(spectra[map].data());
+
+		//InversionCS
+		for (int y = 0; y < n; y++)
+		{
+			for (int x = 0; x < n; x++)
+			{
+				float perm = (x + y) % 2 == 0 ? 1.0f : -1.0f;
+				outputs[map][y * n + x] = perm * (spectra[map][y * n + x].x / float(n * n));
+			}
+		}
+	}
+}
+
+int OceanFFT::GetResolution()
+{
+	return fftRes;
+}
+
+int OceanFFT::GetL()
+{
+	return L;
+}
+
+const float* OceanFFT::GetDisplacementX()
+{
+	return displacement[0].data();
+}
+
+const float* OceanFFT::GetHeights()
+{
+	return displacement[1].data();
+}
+
+const float* OceanFFT::GetDisplacementZ()
+{
+	return displacement[2].data();
+}
+
+XMFLOAT3 OceanFFT::Sample(float u, float v)
+{
+	//texel centres sit at (i + 0.5) / fftRes, everything wraps
+	float fx = u * fftRes - 0.5f;
+	float fy = v * fftRes - 0.5f;
+	float cellX = floorf(fx);
+	float cellY = floorf(fy);
+	float tx = fx - cellX;
+	float ty = fy - cellY;
+
+	int mask = fftRes - 1;
+	int x0 = (int)cellX & mask;
+	int y0 = (int)cellY & mask;
+	int x1 = (x0 + 1) & mask;
+	int y1 = (y0 + 1) & mask;
+
+	float result[3];
+	for (int map = 0; map < 3; map++)
+	{
+		const std::vector<float>& d = displacement[map];
+		float top = d[y0 * fftRes + x0] + (d[y0 * fftRes + x1] - d[y0 * fftRes + x0]) * tx;
+		float bottom = d[y1 * fftRes + x0] + (d[y1 * fftRes + x1] - d[y1 * fftRes + x0]) * tx;
+		result[map] = top + (bottom - top) * ty;
+	}
+
+	return XMFLOAT3(result[0], result[1], result[2]);
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include<DirectXMath.h>
+#include<vector>
+#include<memory>
+#include"ThreadPool.h"
+#include"FFTPlan.h"
+#include"OceanSpectrum.h"
+using namespace DirectX;
+
+//cpu copy of the tessendorf ocean that Water::RenderFFT runs on the gpu. it starts from the
+//same OceanSpectrum and HtOceanCS parameters and ends with the same three maps InversionCS writes,
+//so it can run without a device, check the shaders and answer height queries for gameplay
+class OceanFFT
+{
+	int fftRes; //has to be a power of two from 64 to 1024
+	int log2N;
+	int L;
+	float amp;
+	XMFLOAT2 windDir;
+	float windSpeed;
+
+	//everything per texel is kept four columns to a vector, row after row
+	int rowVectors;
+	std::vector<XMVECTOR> h0Real;
+	std::vector<XMVECTOR> h0Imaginary;
+	std::vector<XMVECTOR> h0MinusReal; //already conjugated like HtOceanCS does
+	std::vector<XMVECTOR> h0MinusImaginary;
+	std::vector<XMVECTOR> omega; //dispersion, sqrt(g * |k|)
+	float loopPeriod; //zero when the dispersion is left as it is
+	std::vector<XMVECTOR> slopeX; //-k.x / |k|, turns the height into the x displacement
+	std::vector<XMVECTOR> slopeZ;
+
+	//the spectra of dx, dy and dz, then the same after the first pass of the fft, transposed
+	std::vector<XMVECTOR> real[3];
+	std::vector<XMVECTOR> imaginary[3];
+	std::vector<XMVECTOR> transposedReal[3];
+	std::vector<XMVECTOR> transposedImaginary[3];
+
+	std::unique_ptr<FFTPassPlan> plan; //the gpu's passes, for UpdateReference
+	std::vector<int> bitReversed;
+	std::vector<float> twiddleReal; //e^(2 pi i t / fftRes) for t below fftRes / 2
+	std::vector<float> twiddleImaginary;
+
+	std::vector<float> displacement[3]; //dx, dy and dz as InversionCS leaves them
+
+	ThreadPool* threads;
+
+	//on the pool when there is one, in order on the calling thread when there isn't
+	void RunJobs(int count, const std::function<void(int)>& job);
+	void CreateDispersion();
+	void CreateSpectrum(int row, float time);
+	//an inverse fft of four columns at once, already in bit reversed order
+	void InverseFFT(XMVECTOR* columnReal, XMVECTOR* columnImaginary);
+	//down four columns of the spectrum, stored transposed
+	void FirstPass(int map, int block);
+	//down four columns of the transpose, which are four rows of the map, ending in the map
+	void SecondPass(int map, int block);
+
+public:
+	//the transforms are spread over threads, or run on the calling thread when it is null
+	OceanFFT(int fftRes, int L, float amp, XMFLOAT2 windDir, float windSpeed, ThreadPool* threads = nullptr);
+
+	//h0 from the phillips spectrum with these parameters and philox noise for the seed
+	void CreateH0(unsigned int seed);
+	//h0 from any OceanSpectrum, which has to be fftRes x fftRes
+	void SetH0(const OceanH0& h0);
+
+	//rounds every wave's frequency down to a whole number of turns in period seconds, so the
+	//maps repeat exactly after it. zero goes back to the plain dispersion
+	void SetLoopPeriod(float period);
+	float GetLoopPeriod();
+
+	//the maps at the time given to HtOceanCS, RenderFFT hands it totalTime * 1.4 + 500
+	void Update(float time);
+
+	//the whole pipeline the way the compute shaders run it, one texel at a time and through
+	//the same FFTPlan passes as FFTStageCS. slow, it is only there to check Update against
+	void UpdateReference(float time, float* dx, float* dy, float* dz);
+
+	int GetResolution();
+	int GetL();
+	const float* GetDisplacementX();
+	const float* GetHeights();
+	const float* GetDisplacementZ();
+
+	//filtered and wrapped like the water's sampler, uv in texture space. the domain shader
+	//scales y by 0.02 and x and z by 1.8 * 0.02 before using them
+	XMFLOAT3 Sample(float u, float v);
+};
@@ -0,0 +1,196 @@
+#include "OceanQuadtree.h"
+#include<cmath>
+
+OceanQuadtree::OceanQuadtree(float oceanSize, float minPatchSize, float patchTess, float lodDistance)
+{
+	this->oceanSize = oceanSize;
+	this->minPatchSize = minPatchSize;
+	this->lodDistance = lodDistance;
+
+	//rounded down to a power of two between 1 and 64, what the hull shader can take
+	float tess = 1.0f;
+	while (tess * 2.0f <= patchTess && tess < 64.0f)
+		tess *= 2.0f;
+	this->patchTess = tess;
+
+	seaLevel = 0.0f;
+	maxDisplacement = 0.0f;
+	rootOrigin = XMFLOAT2(-oceanSize / 2, -oceanSize / 2);
+	cameraPos = XMFLOAT3(0, 0, 0);
+	for (int i = 0; i < 6; i++)
+	{
+		planes[i] = XMFLOAT4(0, 0, 0, 1);
+	}
+	nodeCount = 0;
+	culledCount = 0;
+	levelCount = 0;
+}
+
+void OceanQuadtree::SetBounds(float seaLevel, float maxDisplacement)
+{
+	this->seaLevel = seaLevel;
+	this->maxDisplacement = maxDisplacement;
+}
+
+void OceanQuadtree::Update(XMFLOAT3 cameraPos, const XMFLOAT4X4& view, const XMFLOAT4X4& projection)
+{
+	this->cameraPos = cameraPos;
+
+	//the root follows the camera an eighth of its size at a time, so every patch from the
+	//third level down stays on the same grid and its vertices do not swim as the camera moves
+	float snap = oceanSize / 8;
+	rootOrigin.x = floorf(cameraPos.x / snap + 0.5f) * snap - oceanSize / 2;
+	rootOrigin.y = floorf(cameraPos.z / snap + 0.5f) * snap - oceanSize / 2;
+
+	//the camera keeps its matrices transposed, so the rows here are the columns of view *
+	//projection and the planes come straight out of them
+	XMFLOAT4X4 viewProj;
+	XMStoreFloat4x4(&viewProj, XMMatrixMultiply(XMLoadFloat4x4(&projection), XMLoadFloat4x4(&view)));
+	XMFLOAT4 row[4] = {
+		XMFLOAT4(viewProj._11, viewProj._12, viewProj._13, viewProj._14),
+		XMFLOAT4(viewProj._21, viewProj._22, viewProj._23, viewProj._24),
+		XMFLOAT4(viewProj._31, viewProj._32, viewProj._33, viewProj._34),
+		XMFLOAT4(viewProj._41, viewProj._42, viewProj._43, viewProj._44) };
+	planes[0] = XMFLOAT4(row[3].x + row[0].x, row[3].y + row[0].y, row[3].z + row[0].z, row[3].w + row[0].w); //left
+	planes[1] = XMFLOAT4(row[3].x - row[0].x, row[3].y - row[0].y, row[3].z - row[0].z, row[3].w - row[0].w); //right
+	planes[2] = XMFLOAT4(row[3].x + row[1].x, row[3].y + row[1].y, row[3].z + row[1].z, row[3].w + row[1].w); //bottom
+	planes[3] = XMFLOAT4(row[3].x - row[1].x, row[3].y - row[1].y, row[3].z - row[1].z, row[3].w - row[1].w); //top
+	planes[4] = row[2]; //near, z goes from 0 to w
+	planes[5] = XMFLOAT4(row[3].x - row[2].x, row[3].y - row[2].y, row[3].z - row[2].z, row[3].w - row[2].w); //far
+
+	patches.clear();
+	nodeCount = 0;
+	culledCount = 0;
+	levelCount = 0;
+	AddNode(rootOrigin.x, rootOrigin.y, oceanSize, 0);
+}
+
+bool OceanQuadtree::ShouldSplit(float x, float z, float size)
+{
+	if (size * 0.5f < minPatchSize)
+		return false;
+
+	//distance from the camera to the closest point of the node's bounds
+	float dx = fmaxf(fmaxf(x - cameraPos.x, cameraPos.x - (x + size)), 0.0f);
+	float dz = fmaxf(fmaxf(z - cameraPos.z, cameraPos.z - (z + size)), 0.0f);
+	float dy = fmaxf(fabsf(cameraPos.y - seaLevel) - maxDisplacement, 0.0f);
+	return dx * dx + dy * dy + dz * dz < (lodDistance * size) * (lodDistance * size);
+}
+
+bool OceanQuadtree::IsVisible(float x, float z, float size)
+{
+	float minY = seaLevel - maxDisplacement;
+	float maxY = seaLevel + maxDisplacement;
+	for (int i = 0; i < 6; i++)
+	{
+		//the corner of the box furthest along the plane's normal
+		const XMFLOAT4& p = planes[i];
+		float px = p.x >= 0 ? x + size : x;
+		float py = p.y >= 0 ? maxY : minY;
+		float pz = p.z >= 0 ? z + size : z;
+		if (p.x * px + p.y * py + p.z * pz + p.w < 0)
+			return false;
+	}
+	return true;
+}
+
+int OceanQuadtree::GetLevelAt(float x, float z)
+{
+	float nodeX = rootOrigin.x;
+	float nodeZ = rootOrigin.y;
+	float size = oceanSize;
+	if (x < nodeX || z < nodeZ || x >= nodeX + size || z >= nodeZ + size)
+		return -1;
+
+	int level = 0;
+	while (ShouldSplit(nodeX, nodeZ, size))
+	{
+		size *= 0.5f;
+		if (x >= nodeX + size)
+			nodeX += size;
+		if (z >= nodeZ + size)
+			nodeZ += size;
+		level++;
+	}
+	return level;
+}
+
+void OceanQuadtree::AddNode(float x, float z, float size, int level)
+{
+	nodeCount++;
+	if (!IsVisible(x, z, size))
+	{
+		culledCount++;
+		return;
+	}
+
+	if (ShouldSplit(x, z, size))
+	{
+		float half = size * 0.5f;
+		AddNode(x, z, half, level + 1);
+		AddNode(x + half, z, half, level + 1);
+		AddNode(x, z + half, half, level + 1);
+		AddNode(x + half, z + half, half, level + 1);
+		return;
+	}
+
+	OceanPatch patch;
+	patch.origin = XMFLOAT2(x, z);
+	patch.size = size;
+	patch.insideTess = patchTess;
+
+	//each edge looks at the leaf just past its middle. a bigger leaf has patchTess over a
+	//longer edge, so this one drops a factor of two for every level between them. smaller
+	//leaves do that on their side, and past the root's edge nothing has to match
+	float step = minPatchSize * 0.5f;
+	float centreX = x + size * 0.5f;
+	float centreZ = z + size * 0.5f;
+	XMFLOAT2 outside[4] = {
+		XMFLOAT2(x - step, centreZ),
+		XMFLOAT2(x + size + step, centreZ),
+		XMFLOAT2(centreX, z - step),
+		XMFLOAT2(centreX, z + size + step) };
+	float* edges = &patch.edgeTess.x;
+	for (int i = 0; i < 4; i++)
+	{
+		int neighbourLevel = GetLevelAt(outside[i].x, outside[i].y);
+		float tess = patchTess;
+		for (int l = neighbourLevel; l >= 0 && l < level && tess > 1.0f; l++)
+			tess *= 0.5f;
+		edges[i] = tess;
+	}
+
+	patches.push_back(patch);
+	if (level + 1 > levelCount)
+		levelCount = level + 1;
+}
+
+const std::vector<OceanPatch>& OceanQuadtree::GetPatches()
+{
+	return patches;
+}
+
+int OceanQuadtree::GetNodeCount()
+{
+	return nodeCount;
+}
+
+int OceanQuadtree::GetCulledCount()
+{
+	return culledCount;
+}
+
+int OceanQuadtree::GetLevelCount()
+{
+	return levelCount;
+}
+
+float OceanQuadtree::GetOceanSize()
+{
+	return oceanSize;
+}
+
+float OceanQuadtree::GetSeaLevel()
+{
+	return seaLevel;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include<DirectXMath.h>
+#include<vector>
+using namespace DirectX;
+
+//one square of ocean WaterVS draws as two tessellated triangles, laid out the way WaterVS
+//reads them from its structured buffer
+struct OceanPatch
+{
+	XMFLOAT2 origin; //the corner with the smallest x and z, in world space
+	float size;
+	float insideTess;
+	XMFLOAT4 edgeTess; //the -x, +x, -z and +z edges
+};
+
+//the ocean surface as a quadtree of patches centred on the camera. nodes split while the
+//camera is closer than lodDistance times their size, so every level adds about the same ring
+//of patches and the count only grows with the log of the ocean's size. nodes outside the
+//frustum are dropped with everything under them. every patch is tessellated the same, and an
+//edge against a bigger patch drops to that patch's spacing so the two share their vertices
+class OceanQuadtree
+{
+	float oceanSize;
+	float minPatchSize;
+	float patchTess; //a power of two, so halving it for every level of difference stays whole
+	float lodDistance;
+	float seaLevel;
+	float maxDisplacement; //how far the waves move the surface, added to every patch's bounds
+
+	XMFLOAT2 rootOrigin;
+	XMFLOAT3 cameraPos;
+	XMFLOAT4 planes[6];
+
+	std::vector<OceanPatch> patches;
+	int nodeCount; //nodes visited by the last Update
+	int culledCount; //nodes dropped by the frustum, their children are never visited
+	int levelCount;
+
+	bool ShouldSplit(float x, float z, float size);
+	bool IsVisible(float x, float z, float size);
+	//the level of the leaf over the point, whether it is drawn or not. -1 outside the root
+	int GetLevelAt(float x, float z);
+	void AddNode(float x, float z, float size, int level);
+
+public:
+	//oceanSize is the side of the whole surface, cut down to patches no smaller than minPatchSize
+	OceanQuadtree(float oceanSize, float minPatchSize, float patchTess = 16.0f, float lodDistance = 2.0f);
+
+	//the height band the waves stay in, for culling
+	void SetBounds(float seaLevel, float maxDisplacement);
+
+	//rebuilds the patches for the camera. view and projection are the camera's, transposed
+	//for hlsl the way Camera keeps them
+	void Update(XMFLOAT3 cameraPos, const XMFLOAT4X4& view, const XMFLOAT4X4& projection);
+
+	const std::vector<OceanPatch>& GetPatches();
+	int GetNodeCount();
+	int GetCulledCount();
+	int GetLevelCount();
+	float GetOceanSize();
+	float GetSeaLevel();
+};
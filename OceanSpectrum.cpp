@@ -0,0 +1,189 @@
+#include "OceanSpectrum.h"
+#include "Philox.h"
+#include<cmath>
+
+//the constants the ocean shaders use
+static const float PI = 3.1415926535897932384626433832795f;
+static const float GRAVITY = 9.81f;
+
+static bool SameDesc(const OceanSpectrumDesc& a, const OceanSpectrumDesc& b)
+{
+	return a.type == b.type && a.fftRes == b.fftRes && a.L == b.L && a.amp == b.amp &&
+		a.windDir.x == b.windDir.x && a.windDir.y == b.windDir.y && a.windSpeed == b.windSpeed &&
+		a.fetch == b.fetch && a.depth == b.depth && a.kMin == b.kMin && a.kMax == b.kMax && a.seed == b.seed;
+}
+
+//the jonswap spectrum over frequency, hasselmann et al. 1973
+static float JONSWAP(float omega, float windSpeed, float fetch)
+{
+	float alpha = 0.076f * powf(windSpeed * windSpeed / (fetch * GRAVITY), 0.22f);
+	float peak = 22.0f * powf(GRAVITY * GRAVITY / (windSpeed * fetch), 1.0f / 3.0f);
+	float sigma = omega <= peak ? 0.07f : 0.09f;
+	float r = expf(-(omega - peak) * (omega - peak) / (2.0f * sigma * sigma * peak * peak));
+	float ratio = peak / omega;
+	return alpha * GRAVITY * GRAVITY / powf(omega, 5.0f) * expf(-1.25f * ratio * ratio * ratio * ratio) * powf(3.3f, r);
+}
+
+//kitaigorodskii's depth attenuation, what turns jonswap into tma
+static float DepthAttenuation(float omega, float depth)
+{
+	float omegaH = omega * sqrtf(depth / GRAVITY);
+	if (omegaH <= 1.0f)
+		return 0.5f * omegaH * omegaH;
+	if (omegaH < 2.0f)
+		return 1.0f - 0.5f * (2.0f - omegaH) * (2.0f - omegaH);
+	return 1.0f;
+}
+
+OceanSpectrum::OceanSpectrum(ThreadPool* threads)
+{
+	this->threads = threads;
+	hits = 0;
+	misses = 0;
+}
+
+std::shared_ptr<const OceanH0> OceanSpectrum::GetH0(const OceanSpectrumDesc& desc)
+{
+	unsigned long long key = Hash(desc);
+	auto found = cache.find(key);
+	if (found != cache.end() && SameDesc(found->second.desc, desc))
+	{
+		hits++;
+		return found->second.h0;
+	}
+
+	misses++;
+	std::shared_ptr<const OceanH0> h0 = CreateH0(desc, threads);
+	cache[key] = CacheEntry{ desc, h0 };
+	return h0;
+}
+
+void OceanSpectrum::ClearCache()
+{
+	cache.clear();
+}
+
+int OceanSpectrum::GetCacheSize()
+{
+	return (int)cache.size();
+}
+
+int OceanSpectrum::GetCacheHits()
+{
+	return hits;
+}
+
+int OceanSpectrum::GetCacheMisses()
+{
+	return misses;
+}
+
+unsigned long long OceanSpectrum::Hash(const OceanSpectrumDesc& desc)
+{
+	unsigned long long hash = 14695981039346656037ull;
+	auto add = [&hash](const void* value, size_t size)
+	{
+		const unsigned char* bytes = (const unsigned char*)value;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+	};
+
+	//field by field, the padding between them is never written
+	int type = (int)desc.type;
+	add(&type, sizeof(type));
+	add(&desc.fftRes, sizeof(desc.fftRes));
+	add(&desc.L, sizeof(desc.L));
+	add(&desc.amp, sizeof(desc.amp));
+	add(&desc.windDir, sizeof(desc.windDir));
+	add(&desc.windSpeed, sizeof(desc.windSpeed));
+	add(&desc.fetch, sizeof(desc.fetch));
+	add(&desc.depth, sizeof(desc.depth));
+	add(&desc.kMin, sizeof(desc.kMin));
+	add(&desc.kMax, sizeof(desc.kMax));
+	add(&desc.seed, sizeof(desc.seed));
+	return hash;
+}
+
+float OceanSpectrum::GetAmplitude(const OceanSpectrumDesc& desc, float kx, float kz)
+{
+	//no wave at the centre, and none outside the band
+	float mag = sqrtf(kx * kx + kz * kz);
+	if (mag <= 0.0f || mag < desc.kMin || (desc.kMax > 0 && mag >= desc.kMax))
+		return 0.0f;
+
+	//the wind term is squared, so k and -k get the same size
+	float windLength = sqrtf(desc.windDir.x * desc.windDir.x + desc.windDir.y * desc.windDir.y);
+	float kDotW = (kx * desc.windDir.x + kz * desc.windDir.y) / (mag * windLength);
+	float magSq = mag * mag;
+
+	if (desc.type == OceanSpectrumType::Phillips)
+	{
+		//the spectrum the ocean has always had, in the units the rest of the chain is tuned for
+		float largestWave = (desc.windSpeed * desc.windSpeed) / GRAVITY;
+		float smallWave = desc.L / 2000.0f;
+		float phillips = (desc.amp / (magSq * magSq)) * kDotW * kDotW
+			* expf(-(1.0f / (magSq * largestWave * largestWave)))
+			* expf(-magSq * smallWave * smallWave);
+		float h0k = sqrtf(phillips) / sqrtf(2.0f);
+		return h0k > 4000.0f ? 4000.0f : h0k;
+	}
+
+	//jonswap and tma are over frequency, moved over to k with the deep water dispersion
+	//and spread around by cos squared, which goes to one over the circle with the 1 / pi
+	float omega = sqrtf(GRAVITY * mag);
+	float spectrum = JONSWAP(omega, desc.windSpeed, desc.fetch);
+	if (desc.type == OceanSpectrumType::TMA)
+		spectrum *= DepthAttenuation(omega, desc.depth);
+	float dOmegaDk = GRAVITY / (2.0f * omega);
+	spectrum *= dOmegaDk / mag * kDotW * kDotW / PI;
+
+	//a wave's height is the spectrum over one cell of the k grid, and InversionCS divides
+	//by fftRes squared, which is put back here so these come out in metres
+	float dk = 2 * PI / desc.L;
+	float n2 = (float)desc.fftRes * desc.fftRes;
+	return sqrtf(desc.amp * spectrum * dk * dk / 2.0f) * n2;
+}
+
+std::shared_ptr<OceanH0> OceanSpectrum::CreateH0(const OceanSpectrumDesc& desc, ThreadPool* threads)
+{
+	std::shared_ptr<OceanH0> result = std::make_shared<OceanH0>();
+	int n = desc.fftRes;
+	result->fftRes = n;
+	result->h0.resize(n * n);
+	result->h0Minus.resize(n * n);
+
+	//the texel is the counter, so every row can go on any thread and still get its own noise
+	Philox random(desc.seed);
+	auto createRow = [&](int y)
+	{
+		for (int x = 0; x < n; x++)
+		{
+			float kx = 2 * PI * (x - n / 2.0f) / desc.L;
+			float kz = 2 * PI * (y - n / 2.0f) / desc.L;
+			float h0k = GetAmplitude(desc, kx, kz);
+
+			unsigned int counter[4] = { (unsigned int)x, (unsigned int)y, 0, 0 };
+			float gaussian[4];
+			random.Gaussian(counter, gaussian);
+
+			result->h0[y * n + x] = XMFLOAT4(gaussian[0] * h0k, gaussian[1] * h0k, 0, 1);
+			result->h0Minus[y * n + x] = XMFLOAT4(gaussian[2] * h0k, gaussian[3] * h0k, 0, 1);
+		}
+	};
+
+	if (threads)
+	{
+		threads->ParallelFor(n, createRow);
+	}
+	else
+	{
+		for (int y = 0; y < n; y++)
+		{
+			createRow(y);
+		}
+	}
+	return result;
+}
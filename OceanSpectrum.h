@@ -0,0 +1,73 @@
+#pragma once
+#include<DirectXMath.h>
+#include<vector>
+#include<memory>
+#include<unordered_map>
+#include"ThreadPool.h"
+using namespace DirectX;
+
+enum class OceanSpectrumType
+{
+	Phillips,
+	JONSWAP, //a sea still growing over a fetch of open water
+	TMA //jonswap in shallow water, damped by the depth
+};
+
+//everything that goes into an h0 spectrum, the same settings always give the same waves
+struct OceanSpectrumDesc
+{
+	OceanSpectrumType type;
+	int fftRes;
+	int L; //patch length in metres
+	float amp; //multiplies the spectrum, jonswap and tma are already in metres at 1
+	XMFLOAT2 windDir;
+	float windSpeed;
+	float fetch; //metres of open water upwind, for jonswap and tma
+	float depth; //metres, for tma
+	float kMin; //the band of wave numbers kept, kMax of zero or less has no upper end
+	float kMax;
+	unsigned int seed;
+};
+
+//h0(k) and h0(-k) for every texel row by row, (real, imaginary, 0, 1) the way HtOceanCS
+//reads tildeH0 and tildeMinusH0
+struct OceanH0
+{
+	int fftRes;
+	std::vector<XMFLOAT4> h0;
+	std::vector<XMFLOAT4> h0Minus;
+};
+
+//makes h0 spectra on the cpu from philox noise, rows spread over a ThreadPool, and keeps
+//every spectrum it has made so asking again for the same settings costs a hash lookup
+class OceanSpectrum
+{
+	struct CacheEntry
+	{
+		OceanSpectrumDesc desc;
+		std::shared_ptr<const OceanH0> h0;
+	};
+
+	std::unordered_map<unsigned long long, CacheEntry> cache;
+	ThreadPool* threads;
+	int hits;
+	int misses;
+
+public:
+	//the rows are made on threads, or on the calling thread when it is null
+	OceanSpectrum(ThreadPool* threads = nullptr);
+
+	//the cached spectrum for desc, made the first time it is asked for
+	std::shared_ptr<const OceanH0> GetH0(const OceanSpectrumDesc& desc);
+	void ClearCache();
+	int GetCacheSize();
+	int GetCacheHits();
+	int GetCacheMisses();
+
+	//fnv-1a over every setting
+	static unsigned long long Hash(const OceanSpectrumDesc& desc);
+	//the size of the wave at k before the gaussian noise, sqrt(spectrum / 2)
+	static float GetAmplitude(const OceanSpectrumDesc& desc, float kx, float kz);
+	//makes a spectrum without the cache, on threads when they are given
+	static std::shared_ptr<OceanH0> CreateH0(const OceanSpectrumDesc& desc, ThreadPool* threads);
+};
@@ -0,0 +1,419 @@
+#include "OrientedBox.h"
+#include<cmath>
+#include<utility>
+#include<xmmintrin.h>
+
+//added to the rotation terms so that near parallel edges don't produce a zero axis
+static const float OBB_EPSILON = 1e-6f;
+
+bool OBBOverlap(const OrientedBox& a, const OrientedBox& b, int* separatingAxis)
+{
+	XMVECTOR aAxes[3];
+	XMVECTOR bAxes[3];
+	for (int i = 0; i < 3; i++)
+	{
+		aAxes[i] = XMLoadFloat3(&a.axes[i]);
+		bAxes[i] = XMLoadFloat3(&b.axes[i]);
+	}
+
+	//rotation of b expressed in a's frame
+	float R[3][3];
+	float AbsR[3][3];
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			R[i][j] = XMVectorGetX(XMVector3Dot(aAxes[i], bAxes[j]));
+			AbsR[i][j] = fabsf(R[i][j]) + OBB_EPSILON;
+		}
+	}
+
+	//translation between the centers in a's frame
+	XMVECTOR translation = XMLoadFloat3(&b.center) - XMLoadFloat3(&a.center);
+	float t[3];
+	for (int i = 0; i < 3; i++)
+	{
+		t[i] = XMVectorGetX(XMVector3Dot(translation, aAxes[i]));
+	}
+
+	float ae[3] = { a.halfExtents.x, a.halfExtents.y, a.halfExtents.z };
+	float be[3] = { b.halfExtents.x, b.halfExtents.y, b.halfExtents.z };
+	float ra, rb;
+
+	//face axes of a
+	for (int i = 0; i < 3; i++)
+	{
+		ra = ae[i];
+		rb = be[0] * AbsR[i][0] + be[1] * AbsR[i][1] + be[2] * AbsR[i][2];
+		if (fabsf(t[i]) > ra + rb)
+		{
+			if (separatingAxis != nullptr) *separatingAxis = i;
+			return false;
+		}
+	}
+
+	//face axes of b
+	for (int i = 0; i < 3; i++)
+	{
+		ra = ae[0] * AbsR[0][i] + ae[1] * AbsR[1][i] + ae[2] * AbsR[2][i];
+		rb = be[i];
+		if (fabsf(t[0] * R[0][i] + t[1] * R[1][i] + t[2] * R[2][i]) > ra + rb)
+		{
+			if (separatingAxis != nullptr) *separatingAxis = 3 + i;
+			return false;
+		}
+	}
+
+	//the nine edge cross products a[i] x b[j]
+	for (int i = 0; i < 3; i++)
+	{
+		int i1 = (i + 1) % 3;
+		int i2 = (i + 2) % 3;
+
+		for (int j = 0; j < 3; j++)
+		{
+			int j1 = (j + 1) % 3;
+			int j2 = (j + 2) % 3;
+
+			ra = ae[i1] * AbsR[i2][j] + ae[i2] * AbsR[i1][j];
+			rb = be[j1] * AbsR[i][j2] + be[j2] * AbsR[i][j1];
+			if (fabsf(t[i2] * R[i1][j] - t[i1] * R[i2][j]) > ra + rb)
+			{
+				if (separatingAxis != nullptr) *separatingAxis = 6 + i * 3 + j;
+				return false;
+			}
+		}
+	}
+
+	//no separating axis
+	if (separatingAxis != nullptr) *separatingAxis = -1;
+	return true;
+}
+
+//dot product of two plain float3s
+static inline float Dot3(const XMFLOAT3& u, const XMFLOAT3& v)
+{
+	return u.x * v.x + u.y * v.y + u.z * v.z;
+}
+
+bool OBBSeparatedOnAxis(const OrientedBox& a, const OrientedBox& b, int axis)
+{
+	//the same terms as the matching axis of OBBOverlap, so both always agree, but
+	//only the handful of dot products this axis needs
+	const float* ae = &a.halfExtents.x;
+	const float* be = &b.halfExtents.x;
+	XMFLOAT3 translation(b.center.x - a.center.x, b.center.y - a.center.y, b.center.z - a.center.z);
+	float ra, rb, distance;
+
+	if (axis < 3)
+	{
+		ra = ae[axis];
+		rb = 0.0f;
+		for (int j = 0; j < 3; j++)
+		{
+			rb += be[j] * (fabsf(Dot3(a.axes[axis], b.axes[j])) + OBB_EPSILON);
+		}
+		distance = Dot3(translation, a.axes[axis]);
+	}
+	else if (axis < 6)
+	{
+		int i = axis - 3;
+		ra = 0.0f;
+		for (int j = 0; j < 3; j++)
+		{
+			ra += ae[j] * (fabsf(Dot3(a.axes[j], b.axes[i])) + OBB_EPSILON);
+		}
+		rb = be[i];
+		distance = Dot3(translation, b.axes[i]);
+	}
+	else
+	{
+		int i = (axis - 6) / 3;
+		int j = (axis - 6) % 3;
+		int i1 = (i + 1) % 3;
+		int i2 = (i + 2) % 3;
+		int j1 = (j + 1) % 3;
+		int j2 = (j + 2) % 3;
+
+		float r1j = Dot3(a.axes[i1], b.axes[j]);
+		float r2j = Dot3(a.axes[i2], b.axes[j]);
+		ra = ae[i1] * (fabsf(r2j) + OBB_EPSILON) + ae[i2] * (fabsf(r1j) + OBB_EPSILON);
+		rb = be[j1] * (fabsf(Dot3(a.axes[i], b.axes[j2])) + OBB_EPSILON) + be[j2] * (fabsf(Dot3(a.axes[i], b.axes[j1])) + OBB_EPSILON);
+		distance = Dot3(translation, a.axes[i2]) * r1j - Dot3(translation, a.axes[i1]) * r2j;
+	}
+
+	return fabsf(distance) > ra + rb;
+}
+
+bool RayOBB(const OrientedBox& box, XMFLOAT3 origin, XMFLOAT3 direction, float maxDistance, float& distance)
+{
+	//slab test in the space of the box
+	XMVECTOR toOrigin = XMLoadFloat3(&origin) - XMLoadFloat3(&box.center);
+	XMVECTOR dir = XMLoadFloat3(&direction);
+	const float* extents = &box.halfExtents.x;
+
+	float tMin = 0.0f;
+	float tMax = maxDistance;
+	for (int i = 0; i < 3; i++)
+	{
+		XMVECTOR axis = XMLoadFloat3(&box.axes[i]);
+		float o = XMVectorGetX(XMVector3Dot(toOrigin, axis));
+		float d = XMVectorGetX(XMVector3Dot(dir, axis));
+
+		if (fabsf(d) < OBB_EPSILON)
+		{
+			//parallel to the slab, has to start between the planes
+			if (fabsf(o) > extents[i])
+				return false;
+			continue;
+		}
+
+		float t1 = (-extents[i] - o) / d;
+		float t2 = (extents[i] - o) / d;
+		if (t1 > t2) std::swap(t1, t2);
+		if (t1 > tMin) tMin = t1;
+		if (t2 < tMax) tMax = t2;
+		if (tMin > tMax)
+			return false;
+	}
+
+	distance = tMin;
+	return true;
+}
+
+bool SphereOBB(const OrientedBox& box, XMFLOAT3 center, float radius)
+{
+	//distance from the center to the closest point of the box
+	XMVECTOR toCenter = XMLoadFloat3(&center) - XMLoadFloat3(&box.center);
+	const float* extents = &box.halfExtents.x;
+
+	float distanceSq = 0.0f;
+	for (int i = 0; i < 3; i++)
+	{
+		float d = fabsf(XMVectorGetX(XMVector3Dot(toCenter, XMLoadFloat3(&box.axes[i]))));
+		if (d > extents[i])
+			distanceSq += (d - extents[i]) * (d - extents[i]);
+	}
+
+	return distanceSq <= radius * radius;
+}
+
+bool SweptOBB(const OrientedBox& a, XMFLOAT3 displacementA, const OrientedBox& b, XMFLOAT3 displacementB, float& toi)
+{
+	//the same 15 axes as the static test
+	XMVECTOR axes[15];
+	int axisCount = 0;
+	for (int i = 0; i < 3; i++)
+	{
+		axes[axisCount++] = XMLoadFloat3(&a.axes[i]);
+		axes[axisCount++] = XMLoadFloat3(&b.axes[i]);
+	}
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			XMVECTOR cross = XMVector3Cross(XMLoadFloat3(&a.axes[i]), XMLoadFloat3(&b.axes[j]));
+			float lengthSq = XMVectorGetX(XMVector3LengthSq(cross));
+
+			//parallel edges, the face axes already cover this direction
+			if (lengthSq < OBB_EPSILON)
+				continue;
+			axes[axisCount++] = cross / sqrtf(lengthSq);
+		}
+	}
+
+	//b seen from a, a stands still and b moves by the difference
+	XMVECTOR offset = XMLoadFloat3(&b.center) - XMLoadFloat3(&a.center);
+	XMVECTOR velocity = XMLoadFloat3(&displacementB) - XMLoadFloat3(&displacementA);
+	const float* aExtents = &a.halfExtents.x;
+	const float* bExtents = &b.halfExtents.x;
+
+	//every axis gives an interval of the step during which the projections overlap
+	float tFirst = 0.0f;
+	float tLast = 1.0f;
+	for (int k = 0; k < axisCount; k++)
+	{
+		float r = 0.0f;
+		for (int i = 0; i < 3; i++)
+		{
+			r += aExtents[i] * fabsf(XMVectorGetX(XMVector3Dot(XMLoadFloat3(&a.axes[i]), axes[k])));
+			r += bExtents[i] * fabsf(XMVectorGetX(XMVector3Dot(XMLoadFloat3(&b.axes[i]), axes[k])));
+		}
+
+		float p = XMVectorGetX(XMVector3Dot(offset, axes[k]));
+		float s = XMVectorGetX(XMVector3Dot(velocity, axes[k]));
+
+		if (fabsf(s) < OBB_EPSILON)
+		{
+			//not moving along this axis, separated for the whole step or never
+			if (fabsf(p) > r)
+				return false;
+			continue;
+		}
+
+		float t0 = (-r - p) / s;
+		float t1 = (r - p) / s;
+		if (t0 > t1) std::swap(t0, t1);
+		if (t0 > tFirst) tFirst = t0;
+		if (t1 < tLast) tLast = t1;
+		if (tFirst > tLast)
+			return false;
+	}
+
+	toi = tFirst;
+	return true;
+}
+
+bool SweptSphereOBB(const OrientedBox& box, XMFLOAT3 start, XMFLOAT3 end, float radius, float& toi)
+{
+	OrientedBox grown = box;
+	XMStoreFloat3(&grown.halfExtents, XMLoadFloat3(&box.halfExtents) + XMVectorReplicate(radius));
+
+	XMVECTOR motion = XMLoadFloat3(&end) - XMLoadFloat3(&start);
+	float length = XMVectorGetX(XMVector3Length(motion));
+	if (length < OBB_EPSILON)
+	{
+		toi = 0.0f;
+		return SphereOBB(box, start, radius);
+	}
+
+	XMFLOAT3 direction;
+	XMStoreFloat3(&direction, motion / length);
+
+	float distance;
+	if (!RayOBB(grown, start, direction, length, distance))
+		return false;
+
+	toi = distance / length;
+	return true;
+}
+
+void SetOrientedBox4Lane(OrientedBox4& batch, int lane, const OrientedBox& box)
+{
+	batch.centerX[lane] = box.center.x;
+	batch.centerY[lane] = box.center.y;
+	batch.centerZ[lane] = box.center.z;
+
+	for (int i = 0; i < 3; i++)
+	{
+		batch.axisX[i][lane] = box.axes[i].x;
+		batch.axisY[i][lane] = box.axes[i].y;
+		batch.axisZ[i][lane] = box.axes[i].z;
+	}
+
+	batch.halfExtents[0][lane] = box.halfExtents.x;
+	batch.halfExtents[1][lane] = box.halfExtents.y;
+	batch.halfExtents[2][lane] = box.halfExtents.z;
+}
+
+//every lane array is 16 bytes and OrientedBox4 is 16 byte aligned
+static inline XMVECTOR LoadLanes(const float* lanes)
+{
+	return _mm_load_ps(lanes);
+}
+
+int OBBOverlap4(const OrientedBox4& a, const OrientedBox4& b)
+{
+	//same test as OBBOverlap, every vector holds one float per pair
+	XMVECTOR aX[3], aY[3], aZ[3];
+	XMVECTOR bX[3], bY[3], bZ[3];
+	XMVECTOR ae[3], be[3];
+	for (int i = 0; i < 3; i++)
+	{
+		aX[i] = LoadLanes(a.axisX[i]);
+		aY[i] = LoadLanes(a.axisY[i]);
+		aZ[i] = LoadLanes(a.axisZ[i]);
+		bX[i] = LoadLanes(b.axisX[i]);
+		bY[i] = LoadLanes(b.axisY[i]);
+		bZ[i] = LoadLanes(b.axisZ[i]);
+		ae[i] = LoadLanes(a.halfExtents[i]);
+		be[i] = LoadLanes(b.halfExtents[i]);
+	}
+
+	XMVECTOR epsilon = XMVectorReplicate(OBB_EPSILON);
+	XMVECTOR R[3][3];
+	XMVECTOR AbsR[3][3];
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			R[i][j] = aX[i] * bX[j] + aY[i] * bY[j] + aZ[i] * bZ[j];
+			AbsR[i][j] = XMVectorAbs(R[i][j]) + epsilon;
+		}
+	}
+
+	XMVECTOR tx = LoadLanes(b.centerX) - LoadLanes(a.centerX);
+	XMVECTOR ty = LoadLanes(b.centerY) - LoadLanes(a.centerY);
+	XMVECTOR tz = LoadLanes(b.centerZ) - LoadLanes(a.centerZ);
+	XMVECTOR t[3];
+	for (int i = 0; i < 3; i++)
+	{
+		t[i] = tx * aX[i] + ty * aY[i] + tz * aZ[i];
+	}
+
+	//lanes that found a separating axis
+	XMVECTOR separated = XMVectorZero();
+
+	for (int i = 0; i < 3; i++)
+	{
+		XMVECTOR ra = ae[i];
+		XMVECTOR rb = be[0] * AbsR[i][0] + be[1] * AbsR[i][1] + be[2] * AbsR[i][2];
+		separated = XMVectorOrInt(separated, XMVectorGreater(XMVectorAbs(t[i]), ra + rb));
+	}
+
+	for (int i = 0; i < 3; i++)
+	{
+		XMVECTOR ra = ae[0] * AbsR[0][i] + ae[1] * AbsR[1][i] + ae[2] * AbsR[2][i];
+		XMVECTOR rb = be[i];
+		XMVECTOR dist = XMVectorAbs(t[0] * R[0][i] + t[1] * R[1][i] + t[2] * R[2][i]);
+		separated = XMVectorOrInt(separated, XMVectorGreater(dist, ra + rb));
+	}
+
+	//every pair is already separated, skip the edge axes
+	if (_mm_movemask_ps(separated) == 0xF)
+		return 0;
+
+	for (int i = 0; i < 3; i++)
+	{
+		int i1 = (i + 1) % 3;
+		int i2 = (i + 2) % 3;
+
+		for (int j = 0; j < 3; j++)
+		{
+			int j1 = (j + 1) % 3;
+			int j2 = (j + 2) % 3;
+
+			XMVECTOR ra = ae[i1] * AbsR[i2][j] + ae[i2] * AbsR[i1][j];
+			XMVECTOR rb = be[j1] * AbsR[i][j2] + be[j2] * AbsR[i][j1];
+			XMVECTOR dist = XMVectorAbs(t[i2] * R[i1][j] - t[i1] * R[i2][j]);
+			separated = XMVectorOrInt(separated, XMVectorGreater(dist, ra + rb));
+		}
+	}
+
+	return ~_mm_movemask_ps(separated) & 0xF;
+}
+
+void OBBOverlapBatch(const OrientedBox* a, const OrientedBox* b, int count, bool* results)
+{
+	OrientedBox4 batchA;
+	OrientedBox4 batchB;
+
+	for (int first = 0; first < count; first += 4)
+	{
+		int lanes = count - first < 4 ? count - first : 4;
+
+		for (int lane = 0; lane < 4; lane++)
+		{
+			//unused lanes repeat the last pair, their results are ignored
+			int index = first + (lane < lanes ? lane : lanes - 1);
+			SetOrientedBox4Lane(batchA, lane, a[index]);
+			SetOrientedBox4Lane(batchB, lane, b[index]);
+		}
+
+		int mask = OBBOverlap4(batchA, batchB);
+		for (int lane = 0; lane < lanes; lane++)
+		{
+			results[first + lane] = (mask & (1 << lane)) != 0;
+		}
+	}
+}
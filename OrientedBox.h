@@ -0,0 +1,54 @@
+#pragma once
+#include<DirectXMath.h>
+using namespace DirectX;
+
+//box with an arbitrary orientation in world space
+struct OrientedBox
+{
+	XMFLOAT3 center;
+	XMFLOAT3 axes[3]; //unit length local x, y and z axes
+	XMFLOAT3 halfExtents; //half size along each of the axes
+};
+
+//four boxes in structure of arrays layout, lane i of every array belongs to box i
+struct alignas(16) OrientedBox4
+{
+	float centerX[4];
+	float centerY[4];
+	float centerZ[4];
+	float axisX[3][4]; //x component of axis 0, 1 and 2
+	float axisY[3][4];
+	float axisZ[3][4];
+	float halfExtents[3][4];
+};
+
+//separating axis test on the 15 candidate axes of two boxes, nothing is allocated
+//separatingAxis gets the axis that separated them (see OBBSeparatedOnAxis) or -1 if they overlap
+bool OBBOverlap(const OrientedBox& a, const OrientedBox& b, int* separatingAxis = nullptr);
+
+//tests a single axis, 0-2 are a's faces, 3-5 b's faces and 6 + 3i + j is a[i] x b[j]
+//pairs that stay apart usually stay apart on the same axis, so it is worth trying first
+bool OBBSeparatedOnAxis(const OrientedBox& a, const OrientedBox& b, int axis);
+
+//distance along a normalized ray to the point where it enters the box, 0 if it starts inside
+bool RayOBB(const OrientedBox& box, XMFLOAT3 origin, XMFLOAT3 direction, float maxDistance, float& distance);
+
+bool SphereOBB(const OrientedBox& box, XMFLOAT3 center, float radius);
+
+//time of impact of two boxes that translate by the given displacements over one step
+//toi is the fraction of the step at which they first touch, 0 if they already overlap
+bool SweptOBB(const OrientedBox& a, XMFLOAT3 displacementA, const OrientedBox& b, XMFLOAT3 displacementB, float& toi);
+
+//time of impact of a sphere moving from start to end against a box that doesn't move
+//the box is grown by the radius, so hits near the corners come slightly early
+bool SweptSphereOBB(const OrientedBox& box, XMFLOAT3 start, XMFLOAT3 end, float radius, float& toi);
+
+//copies a box into one lane of a batch
+void SetOrientedBox4Lane(OrientedBox4& batch, int lane, const OrientedBox& box);
+
+//tests a.lane[i] against b.lane[i] for all four lanes at once
+//returns a bit mask with bit i set when pair i overlaps
+int OBBOverlap4(const OrientedBox4& a, const OrientedBox4& b);
+
+//tests count pairs a[i] against b[i] four at a time and writes the results
+void OBBOverlapBatch(const OrientedBox* a, const OrientedBox* b, int count, bool* results);
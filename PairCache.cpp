@@ -0,0 +1,67 @@
+#include "PairCache.h"
+#include<algorithm>
+
+PairCache::PairCache()
+{
+	frame = 0;
+}
+
+unsigned long long PairCache::Key(int proxyA, int proxyB)
+{
+	//the same key whichever way round the pair is reported
+	unsigned long long low = (unsigned int)std::min(proxyA, proxyB);
+	unsigned long long high = (unsigned int)std::max(proxyA, proxyB);
+	return (high << 32) | low;
+}
+
+void PairCache::BeginFrame()
+{
+	frame++;
+}
+
+CollisionCache* PairCache::Get(int proxyA, int proxyB)
+{
+	auto result = entries.emplace(Key(proxyA, proxyB), CollisionCache());
+	CollisionCache& entry = result.first->second;
+	if (result.second)
+	{
+		entry.owner = nullptr;
+		entry.separatingAxis = -1;
+		entry.gjk.count = 0;
+	}
+	entry.lastFrame = frame;
+	return &entry;
+}
+
+void PairCache::EvictStale()
+{
+	for (auto it = entries.begin(); it != entries.end();)
+	{
+		if (it->second.lastFrame != frame)
+			it = entries.erase(it);
+		else
+			++it;
+	}
+}
+
+void PairCache::RemoveProxy(int proxy)
+{
+	unsigned long long id = (unsigned int)proxy;
+	for (auto it = entries.begin(); it != entries.end();)
+	{
+		if ((it->first & 0xffffffffull) == id || (it->first >> 32) == id)
+			it = entries.erase(it);
+		else
+			++it;
+	}
+}
+
+void PairCache::Clear()
+{
+	entries.clear();
+}
+
+int PairCache::GetCount()
+{
+	return (int)entries.size();
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include<unordered_map>
+#include"GJK.h"
+
+//collision state one pair of bodies keeps between frames
+struct CollisionCache
+{
+	const void* owner; //the body the cached axis and simplex are relative to, it always goes first
+	int separatingAxis; //axis that kept the boxes apart last time, -1 if they overlapped
+	GJKCache gjk;
+	int lastFrame; //frame the pair was last reported in
+};
+
+//cache entries of the broadphase pairs, keyed by their proxy ids
+class PairCache
+{
+	std::unordered_map<unsigned long long, CollisionCache> entries;
+	int frame;
+
+	static unsigned long long Key(int proxyA, int proxyB);
+
+public:
+	PairCache();
+
+	void BeginFrame();
+	//entry of the pair, created empty the first time the pair is seen
+	//the pointer stays valid until the entry is evicted
+	CollisionCache* Get(int proxyA, int proxyB);
+	//drops the pairs that weren't asked for since BeginFrame, which are the pairs the
+	//broadphase stopped reporting
+	void EvictStale();
+	//drops every pair of a proxy that left the broadphase, its id can be reused straight away
+	void RemoveProxy(int proxy);
+	void Clear();
+
+	int GetCount();
+};
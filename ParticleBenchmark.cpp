@@ -0,0 +1,823 @@
+#include "ParticleBenchmark.h"
+#include "HeightField.h"
+#include "Xoshiro128.h"
+#include "SlabAllocator.h"
+#include "ParticleSimulation.h"
+#include "ParticleSorter.h"
+#include "UploadPlanner.h"
+#include "ParticleBudget.h"
+#include "ParticleBounds.h"
+#include<chrono>
+#include<random>
+#include<vector>
+#include<deque>
+#include<cfloat>
+#include<cmath>
+#include<algorithm>
+#include<cstdio>
+
+using namespace DirectX;
+
+void RunParticleRandomBenchmark(int particleCount, unsigned long long seed)
+{
+	//position, velocity and the two rotations, as Emitter fills them
+	std::vector<XMFLOAT4> oldValues(particleCount * 2);
+	std::vector<XMFLOAT4> newValues(particleCount * 2);
+
+	auto oldStart = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < particleCount; i++)
+	{
+		std::random_device rd;
+		std::mt19937 randomGenerator(rd());
+		std::uniform_real_distribution<float> dist(-1, 1);
+		oldValues[i * 2] = XMFLOAT4(dist(randomGenerator), dist(randomGenerator), dist(randomGenerator), dist(randomGenerator));
+		oldValues[i * 2 + 1] = XMFLOAT4(dist(randomGenerator), dist(randomGenerator), dist(randomGenerator), dist(randomGenerator));
+	}
+	auto oldEnd = std::chrono::high_resolution_clock::now();
+
+	Xoshiro128 random(seed);
+	auto newStart = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < particleCount * 2; i++)
+	{
+		XMStoreFloat4(&newValues[i], random.NextSigned4());
+	}
+	auto newEnd = std::chrono::high_resolution_clock::now();
+
+	//the same seed again has to give every number back, a different one none of them
+	Xoshiro128 again(seed);
+	Xoshiro128 other(seed + 1);
+	int differences = 0;
+	int matches = 0;
+	for (int i = 0; i < particleCount * 2; i++)
+	{
+		XMFLOAT4 a;
+		XMFLOAT4 b;
+		XMStoreFloat4(&a, again.NextSigned4());
+		XMStoreFloat4(&b, other.NextSigned4());
+		const float* x = &newValues[i].x;
+		for (int c = 0; c < 4; c++)
+		{
+			if ((&a.x)[c] != x[c])
+				differences++;
+			if ((&b.x)[c] == x[c])
+				matches++;
+		}
+	}
+
+	double sum = 0;
+	double squares = 0;
+	float smallest = 1.0f;
+	float largest = -1.0f;
+	for (const XMFLOAT4& v : newValues)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			float x = (&v.x)[c];
+			sum += x;
+			squares += x * x;
+			smallest = std::min(smallest, x);
+			largest = std::max(largest, x);
+		}
+	}
+	double n = particleCount * 8.0;
+
+	double oldSeconds = std::chrono::duration<double>(oldEnd - oldStart).count();
+	double newSeconds = std::chrono::duration<double>(newEnd - newStart).count();
+	printf("particle random numbers: %d particles, 8 numbers each\n", particleCount);
+	printf("  mt19937 each:  %8.3f ms, %.1f ns a particle\n", oldSeconds * 1e3, oldSeconds * 1e9 / particleCount);
+	printf("  xoshiro128+:   %8.3f ms, %.1f ns a particle, %.0fx faster\n", newSeconds * 1e3,
+		newSeconds * 1e9 / particleCount, oldSeconds / newSeconds);
+	printf("  range:         [%g, %g], mean %.5f, variance %.5f (1/3 expected)\n", smallest, largest,
+		sum / n, squares / n - (sum / n) * (sum / n));
+	printf("  same seed:     %d differences, %d matches from the next seed\n", differences, matches);
+}
+
+void RunParticlePoolBenchmark(int frameCount, unsigned int seed)
+{
+	struct Range
+	{
+		int offset;
+		int count;
+		int framesLeft;
+	};
+
+	//the pool's size and slabs, with ParticlePool's defaults
+	SlabAllocator allocator(65536, 64);
+	std::mt19937 randomGenerator(seed);
+	std::uniform_int_distribution<int> kind(0, 9);
+	std::uniform_int_distribution<int> life(60, 300);
+	const int counts[3] = { 300, 1000, 3000 };
+
+	std::vector<Range> live;
+	int allocations = 0;
+	int failures = 0;
+	int overlaps = 0;
+	int mostLive = 0;
+	double topTotal = 0;
+	double usedTotal = 0;
+	double seconds = 0;
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		for (size_t i = 0; i < live.size();)
+		{
+			if (--live[i].framesLeft > 0)
+			{
+				i++;
+				continue;
+			}
+			allocator.Free(live[i].offset, live[i].count);
+			live[i] = live.back();
+			live.pop_back();
+		}
+
+		//a few explosions and now and then some smoke or a big trail
+		int starts = kind(randomGenerator) == 0 ? 1 : 0;
+		for (int s = 0; s < starts; s++)
+		{
+			int k = kind(randomGenerator);
+			int count = counts[k < 7 ? 1 : (k < 9 ? 0 : 2)];
+			int offset = allocator.Allocate(count);
+			allocations++;
+			if (offset < 0)
+			{
+				failures++;
+				continue;
+			}
+			live.push_back({ offset, count, life(randomGenerator) });
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+		seconds += std::chrono::duration<double>(end - start).count();
+
+		if (frame % 600 == 0)
+		{
+			std::vector<std::pair<int, int>> spans;
+			for (const Range& r : live)
+				spans.push_back({ r.offset, r.offset + allocator.GetSlabSize(r.count) });
+			std::sort(spans.begin(), spans.end());
+			for (size_t i = 1; i < spans.size(); i++)
+			{
+				if (spans[i].first < spans[i - 1].second)
+					overlaps++;
+			}
+			for (const auto& span : spans)
+			{
+				if (span.second > allocator.GetTop())
+					overlaps++;
+			}
+		}
+
+		mostLive = std::max(mostLive, (int)live.size());
+		topTotal += allocator.GetTop();
+		usedTotal += allocator.GetUsed();
+	}
+
+	printf("particle pool: %d slots, %d frames, emitters of %d, %d and %d particles\n", allocator.GetCapacity(),
+		frameCount, counts[0], counts[1], counts[2]);
+	printf("  allocations:   %8d, %d found no room, most %d live at once\n", allocations, failures, mostLive);
+	printf("  time:          %8.3f us/frame\n", seconds * 1e6 / frameCount);
+	printf("  drawn:         %8.0f slots on average, %.0f of them in use (%.0f%%)\n", topTotal / frameCount,
+		usedTotal / frameCount, 100.0 * usedTotal / std::max(topTotal, 1.0));
+	printf("  overlaps:      %8d\n", overlaps);
+}
+
+void RunParticleSimulationBenchmark(int particleCount, int frameCount, unsigned int seed)
+{
+	std::mt19937 randomGenerator(seed);
+
+	//the same hills as the height field benchmark, 100 m across and a few metres high
+	const int size = 257;
+	std::vector<unsigned short> heights(size * size);
+	for (int z = 0; z < size; z++)
+	{
+		for (int x = 0; x < size; x++)
+		{
+			float h = 32000.0f + 12000.0f * sinf(x * 0.05f) * cosf(z * 0.07f) + 8000.0f * sinf(x * 0.31f + z * 0.17f);
+			heights[z * size + x] = (unsigned short)h;
+		}
+	}
+	float spacing = 0.4f;
+	float half = (size - 1) * spacing * 0.5f;
+	HeightField field(heights, size, size, 6.0f / 65535.0f, spacing, -half, -half);
+	XMFLOAT3 groundOffset(0.0f, -2.0f, 0.0f);
+	const float waterLevel = 0.0f;
+
+	ParticleForces forces = {};
+	forces.wind = XMFLOAT3(2.0f, 0.0f, 0.0f);
+	forces.drag = 0.5f;
+	forces.turbulence = 3.0f;
+	forces.turbulenceScale = 0.5f;
+	forces.bounce = 0.3f;
+	forces.friction = 0.5f;
+	XMFLOAT3 gravity(0.0f, -9.8f, 0.0f);
+	const float deltaTime = 1.0f / 60.0f;
+
+	//fountains all over the field, every particle a different age
+	std::uniform_real_distribution<float> coordinate(-half * 1.2f, half * 1.2f);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::vector<Particle> particles(particleCount);
+	ParticleSimulation simulation(particleCount);
+	for (int i = 0; i < particleCount; i++)
+	{
+		Particle& p = particles[i];
+		p = {};
+		p.spawnTime = -unit(randomGenerator) - 1.0f;
+		p.startPosition = XMFLOAT3(coordinate(randomGenerator), 8.0f + unit(randomGenerator), coordinate(randomGenerator));
+		p.startVelocity = XMFLOAT3(unit(randomGenerator) * 3.0f, 6.0f + unit(randomGenerator) * 3.0f, unit(randomGenerator) * 3.0f);
+		simulation.Spawn(i, p.startPosition, p.startVelocity);
+	}
+	simulation.SetForces(forces);
+	simulation.SetCollision(&field, groundOffset, waterLevel);
+
+	ThreadPool threads;
+	double singleSeconds = 0;
+	double pooledSeconds = 0;
+	float time = 0.0f;
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		time += deltaTime;
+		//every other frame on each, so both see the same mix of flying and landed particles
+		ThreadPool* pool = frame % 2 ? &threads : nullptr;
+		auto start = std::chrono::high_resolution_clock::now();
+		simulation.Simulate(particles.data(), 0, particleCount, gravity, deltaTime, time, pool);
+		auto end = std::chrono::high_resolution_clock::now();
+		(pool ? pooledSeconds : singleSeconds) += std::chrono::duration<double>(end - start).count();
+	}
+
+	int underground = 0;
+	float largestError = 0.0f;
+	for (int i = 0; i < particleCount; i++)
+	{
+		XMFLOAT3 position = simulation.GetPosition(i);
+		float floor = waterLevel;
+		float localX = position.x - groundOffset.x;
+		float localZ = position.z - groundOffset.z;
+		if (field.Contains(localX, localZ))
+			floor = std::max(floor, field.GetHeight(localX, localZ) + groundOffset.y);
+		if (position.y < floor - 1e-3f)
+			underground++;
+
+		const Particle& p = particles[i];
+		float t = time - p.spawnTime;
+		XMVECTOR drawn = XMLoadFloat3(&p.startPosition) + XMLoadFloat3(&p.startVelocity) * t;
+		largestError = std::max(largestError, XMVectorGetX(XMVector3Length(drawn - XMLoadFloat3(&position))));
+	}
+
+	//a full ring, simulated the way Emitter does once it has wrapped, in two runs split at a
+	//different slot every frame, against a plain one particle at a time copy of the step
+	const int ringSize = 1021;
+	std::vector<Particle> ringParticles(ringSize);
+	ParticleSimulation ring(ringSize);
+	std::vector<XMFLOAT3> referencePosition(ringSize);
+	std::vector<XMFLOAT3> referenceVelocity(ringSize);
+	for (int i = 0; i < ringSize; i++)
+	{
+		Particle& p = ringParticles[i];
+		p = {};
+		p.spawnTime = -unit(randomGenerator) - 1.0f;
+		p.startPosition = XMFLOAT3(coordinate(randomGenerator), 8.0f + unit(randomGenerator), coordinate(randomGenerator));
+		p.startVelocity = XMFLOAT3(unit(randomGenerator) * 3.0f, 6.0f + unit(randomGenerator) * 3.0f, unit(randomGenerator) * 3.0f);
+		ring.Spawn(i, p.startPosition, p.startVelocity);
+		referencePosition[i] = p.startPosition;
+		referenceVelocity[i] = p.startVelocity;
+	}
+	ring.SetForces(forces);
+	ring.SetCollision(&field, groundOffset, waterLevel);
+	std::uniform_int_distribution<int> split(1, ringSize - 1);
+	time = 0.0f;
+	for (int frame = 0; frame < 120; frame++)
+	{
+		time += deltaTime;
+		int firstAlive = split(randomGenerator);
+		ring.Simulate(ringParticles.data(), firstAlive, ringSize - firstAlive, gravity, deltaTime, time, nullptr);
+		ring.Simulate(ringParticles.data(), 0, firstAlive, gravity, deltaTime, time, nullptr);
+
+		float keep = expf(-forces.drag * deltaTime);
+		float phase = time * 0.7f;
+		for (int i = 0; i < ringSize; i++)
+		{
+			XMFLOAT3& x = referencePosition[i];
+			XMFLOAT3& v = referenceVelocity[i];
+			float turbulence = forces.turbulence * deltaTime;
+			v.x += sinf(x.z * forces.turbulenceScale + phase) * turbulence;
+			v.y += sinf(x.x * forces.turbulenceScale + phase) * turbulence;
+			v.z += sinf(x.y * forces.turbulenceScale + phase) * turbulence;
+			v.x = forces.wind.x + (v.x + gravity.x * deltaTime - forces.wind.x) * keep;
+			v.y = forces.wind.y + (v.y + gravity.y * deltaTime - forces.wind.y) * keep;
+			v.z = forces.wind.z + (v.z + gravity.z * deltaTime - forces.wind.z) * keep;
+			x.x += v.x * deltaTime;
+			x.y += v.y * deltaTime;
+			x.z += v.z * deltaTime;
+
+			float floor = waterLevel;
+			float localX = x.x - groundOffset.x;
+			float localZ = x.z - groundOffset.z;
+			if (field.Contains(localX, localZ))
+				floor = std::max(floor, field.GetHeight(localX, localZ) + groundOffset.y);
+			if (x.y < floor)
+			{
+				x.y = floor;
+				if (v.y < 0)
+					v.y *= -forces.bounce;
+				v.x *= 1.0f - forces.friction;
+				v.z *= 1.0f - forces.friction;
+			}
+		}
+	}
+	int ringErrors = 0;
+	for (int i = 0; i < ringSize; i++)
+	{
+		XMFLOAT3 position = ring.GetPosition(i);
+		XMVECTOR difference = XMLoadFloat3(&position) - XMLoadFloat3(&referencePosition[i]);
+		if (XMVectorGetX(XMVector3Length(difference)) > 1e-2f)
+			ringErrors++;
+	}
+
+	int singleFrames = frameCount - frameCount / 2;
+	int pooledFrames = std::max(frameCount / 2, 1);
+	printf("particle simulation: %d particles, %d frames, %d workers\n", particleCount, frameCount, threads.GetWorkerCount());
+	printf("  one thread:    %8.3f ms/frame, %.0f M particles/s\n", singleSeconds * 1e3 / singleFrames,
+		particleCount * singleFrames / singleSeconds / 1e6);
+	printf("  pool:          %8.3f ms/frame, %.0f M particles/s\n", pooledSeconds * 1e3 / pooledFrames,
+		particleCount * pooledFrames / pooledSeconds / 1e6);
+	printf("  under floor:   %8d\n", underground);
+	printf("  drawn:         largest distance %g from the simulated position\n", largestError);
+	printf("  wrapped ring:  %8d of %d particles off the one at a time step\n", ringErrors, ringSize);
+}
+
+void RunParticleSortBenchmark(int particleCount, int frameCount, unsigned int seed)
+{
+	std::mt19937 randomGenerator(seed);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	//eight fountains on a circle, each particle two seconds long
+	const int emitterCount = 8;
+	std::vector<ParticleEmitterData> emitters(emitterCount);
+	for (int e = 0; e < emitterCount; e++)
+	{
+		emitters[e] = {};
+		emitters[e].acceleration = XMFLOAT3(0.0f, -4.0f, 0.0f);
+		emitters[e].lifetime = 2.0f;
+	}
+	std::vector<Particle> particles(particleCount);
+	auto spawn = [&](int slot, float time)
+	{
+		int e = slot % emitterCount;
+		float angle = e * 2 * 3.1415926535f / emitterCount;
+		Particle& p = particles[slot];
+		p = {};
+		p.emitterIndex = e;
+		p.spawnTime = time;
+		p.startPosition = XMFLOAT3(cosf(angle) * 20.0f, 0.0f, sinf(angle) * 20.0f);
+		p.startVelocity = XMFLOAT3(unit(randomGenerator) * 2.0f, 6.0f + unit(randomGenerator), unit(randomGenerator) * 2.0f);
+	};
+	for (int i = 0; i < particleCount; i++)
+		spawn(i, -(i % 120) / 60.0f);
+
+	ThreadPool threads;
+	ParticleSorter sorter;
+	const float deltaTime = 1.0f / 60.0f;
+	double radixSeconds = 0;
+	double referenceSeconds = 0;
+	int outOfOrder = 0;
+	int missing = 0;
+	std::vector<unsigned int> reference;
+	std::vector<float> depths(particleCount);
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		float time = frame * deltaTime;
+		//a 120th of the particles die and come back every frame
+		for (int i = frame % 120; i < particleCount; i += 120)
+			spawn(i, time);
+
+		//a slow circle for the first half, then a new direction every frame
+		float heading = frame < frameCount / 2 ? frame * 0.002f : unit(randomGenerator) * 3.1415926535f;
+		XMFLOAT3 forward(sinf(heading), -0.2f, cosf(heading));
+		XMStoreFloat3(&forward, XMVector3Normalize(XMLoadFloat3(&forward)));
+		XMFLOAT3 eye(-forward.x * 60.0f, 15.0f, -forward.z * 60.0f);
+		XMFLOAT4 plane(forward.x, forward.y, forward.z, -(forward.x * eye.x + forward.y * eye.y + forward.z * eye.z));
+
+		auto start = std::chrono::high_resolution_clock::now();
+		sorter.Sort(particles.data(), particleCount, emitters.data(), nullptr, plane, time, &threads);
+		auto end = std::chrono::high_resolution_clock::now();
+		radixSeconds += std::chrono::duration<double>(end - start).count();
+
+		//the same depths sorted the plain way
+		start = std::chrono::high_resolution_clock::now();
+		reference.clear();
+		for (int i = 0; i < particleCount; i++)
+		{
+			const Particle& p = particles[i];
+			float t = time - p.spawnTime;
+			if (t < 0 || t >= emitters[p.emitterIndex].lifetime)
+				continue;
+			XMVECTOR position = XMLoadFloat3(&p.startPosition) + XMLoadFloat3(&p.startVelocity) * t +
+				XMLoadFloat3(&emitters[p.emitterIndex].acceleration) * (0.5f * t * t);
+			depths[i] = XMVectorGetX(XMVector3Dot(position, XMLoadFloat3(&forward))) + plane.w;
+			reference.push_back(i);
+		}
+		std::sort(reference.begin(), reference.end(), [&](unsigned int a, unsigned int b) { return depths[a] > depths[b]; });
+		end = std::chrono::high_resolution_clock::now();
+		referenceSeconds += std::chrono::duration<double>(end - start).count();
+
+		//16 bit keys can swap particles closer than a step apart, anything more is wrong
+		const std::vector<unsigned int>& order = sorter.GetOrder();
+		missing += (int)reference.size() - (int)order.size();
+		float range = depths[reference.front()] - depths[reference.back()];
+		for (size_t i = 1; i < order.size(); i++)
+		{
+			if (depths[order[i]] - depths[order[i - 1]] > range / 65535.0f * 2)
+				outOfOrder++;
+		}
+	}
+
+	printf("particle sort: %d particles, %d frames, %d workers\n", particleCount, frameCount, threads.GetWorkerCount());
+	printf("  radix:         %8.3f ms/frame\n", radixSeconds * 1e3 / frameCount);
+	printf("  std::sort:     %8.3f ms/frame\n", referenceSeconds * 1e3 / frameCount);
+	printf("  out of order:  %8d, %d particles missing\n", outOfOrder, missing);
+}
+
+void RunUploadPlanBenchmark(int frameCount, unsigned int seed)
+{
+	//a ring of particles the way Emitter keeps one, spawning at a steady rate
+	struct Ring
+	{
+		int offset;
+		int maxParticles;
+		float particlesPerSecond;
+		float lifetime;
+		float framesLeft; //for explosions, below zero lives forever
+		int head; //the next slot to spawn in
+		float owed;
+	};
+
+	const int poolSize = 65536;
+	const int particleSize = 48; //sizeof(Particle)
+	const float deltaTime = 1.0f / 60.0f;
+	SlabAllocator allocator(poolSize, 64);
+	UploadPlanner planner(poolSize, particleSize);
+	std::vector<unsigned int> cpu(poolSize, 0);
+	std::vector<unsigned int> gpu(poolSize, 0);
+	std::vector<float> spawnTime(poolSize, -1e30f);
+	std::vector<float> slotLifetime(poolSize, 0.0f);
+	unsigned int version = 0;
+	std::mt19937 randomGenerator(seed);
+	std::uniform_int_distribution<int> chance(0, 59);
+
+	std::vector<Ring> rings;
+	auto addRing = [&](int maxParticles, float rate, float lifetime, float frames)
+	{
+		int offset = allocator.Allocate(maxParticles);
+		if (offset >= 0)
+			rings.push_back({ offset, maxParticles, rate, lifetime, frames, 0, 0.0f });
+	};
+	//the two emitters Game starts with
+	addRing(1000, 100, 2.0f, -1);
+	addRing(1000, 50, 2.0f, -1);
+
+	double plannedBytes = 0;
+	double wholeBytes = 0;
+	double rangeTotal = 0;
+	int mostRanges = 0;
+	int stale = 0;
+	double seconds = 0;
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		float time = frame * deltaTime;
+
+		//about an explosion a second, each lasting two and its sparks 0.7
+		if (chance(randomGenerator) == 0)
+			addRing(1000, 100, 0.7f, 120 + 42);
+		for (size_t i = 0; i < rings.size();)
+		{
+			Ring& ring = rings[i];
+			if (ring.framesLeft >= 0 && --ring.framesLeft < 0)
+			{
+				allocator.Free(ring.offset, ring.maxParticles);
+				rings[i] = rings.back();
+				rings.pop_back();
+				continue;
+			}
+
+			auto start = std::chrono::high_resolution_clock::now();
+			ring.owed += ring.particlesPerSecond * deltaTime;
+			int count = ring.framesLeft >= 0 && ring.framesLeft < 42 ? 0 : (int)ring.owed;
+			ring.owed -= (int)ring.owed;
+			int first = std::min(count, ring.maxParticles - ring.head);
+			for (int n = 0; n < count; n++)
+			{
+				int slot = ring.offset + (ring.head + n) % ring.maxParticles;
+				cpu[slot] = ++version;
+				spawnTime[slot] = time;
+				slotLifetime[slot] = ring.lifetime;
+			}
+			if (first > 0)
+				planner.MarkDirty(ring.offset + ring.head, first);
+			if (count > first)
+				planner.MarkDirty(ring.offset, count - first);
+			ring.head = (ring.head + count) % ring.maxParticles;
+			auto end = std::chrono::high_resolution_clock::now();
+			seconds += std::chrono::duration<double>(end - start).count();
+			i++;
+		}
+
+		auto start = std::chrono::high_resolution_clock::now();
+		const std::vector<UploadRange>& ranges = planner.Plan(allocator.GetTop());
+		auto end = std::chrono::high_resolution_clock::now();
+		seconds += std::chrono::duration<double>(end - start).count();
+		for (const UploadRange& range : ranges)
+			std::copy(cpu.begin() + range.offset, cpu.begin() + range.offset + range.count, gpu.begin() + range.offset);
+
+		plannedBytes += planner.GetPlannedBytes();
+		wholeBytes += (double)allocator.GetTop() * particleSize;
+		rangeTotal += ranges.size();
+		mostRanges = std::max(mostRanges, (int)ranges.size());
+
+		//every particle the shader could be given has to be up to date
+		for (int slot = 0; slot < allocator.GetTop(); slot++)
+		{
+			float age = time - spawnTime[slot];
+			if (age >= 0 && age < slotLifetime[slot] && cpu[slot] != gpu[slot])
+				stale++;
+		}
+	}
+
+	printf("particle uploads: %d frames, Game's emitters and an explosion a second\n", frameCount);
+	printf("  whole pool:    %8.1f KB/frame\n", wholeBytes / frameCount / 1024);
+	printf("  planned:       %8.1f KB/frame, %.1f copies a frame, most %d\n", plannedBytes / frameCount / 1024,
+		rangeTotal / frameCount, mostRanges);
+	printf("  marking:       %8.3f us/frame\n", seconds * 1e6 / frameCount);
+	printf("  stale:         %8d live particles the copy had wrong\n", stale);
+}
+
+void RunParticleBudgetBenchmark(int emitterCount, int frameCount, int budget, unsigned int seed)
+{
+	//explosions and trails the size of Game's, up to 200 metres away, in pairs at the same
+	//spot with different priorities
+	std::mt19937 randomGenerator(seed);
+	std::uniform_real_distribution<float> spread(-200.0f, 200.0f);
+	std::uniform_real_distribution<float> height(0.0f, 20.0f);
+	std::vector<ParticleBudgetRequest> requests(emitterCount);
+	for (int i = 0; i < emitterCount; i += 2)
+	{
+		XMFLOAT3 centre(spread(randomGenerator), height(randomGenerator), spread(randomGenerator));
+		float radius = i % 8 == 0 ? 6.0f : 3.0f;
+		for (int j = i; j < i + 2 && j < emitterCount; j++)
+		{
+			requests[j].boundsMin = XMFLOAT3(centre.x - radius, centre.y - radius, centre.z - radius);
+			requests[j].boundsMax = XMFLOAT3(centre.x + radius, centre.y + radius, centre.z + radius);
+			requests[j].demand = i % 8 == 0 ? 200.0f : 70.0f;
+			requests[j].priority = j == i ? 1.0f : 2.0f;
+		}
+	}
+
+	ParticleBudget particleBudget(budget);
+	XMFLOAT4X4 projection;
+	XMStoreFloat4x4(&projection, XMMatrixTranspose(XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.1f, 1000.0f)));
+	XMFLOAT3 cameraPosition(0.0f, 5.0f, 0.0f);
+
+	double seconds = 0;
+	double requested = 0;
+	double granted = 0;
+	double culled = 0;
+	int overBudget = 0;
+	int culledOverVisible = 0;
+	int priorityInverted = 0;
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		float yaw = XM_2PI * frame / frameCount;
+		XMFLOAT4X4 view;
+		XMStoreFloat4x4(&view, XMMatrixTranspose(XMMatrixLookToLH(XMLoadFloat3(&cameraPosition),
+			XMVectorSet(sinf(yaw), -0.1f, cosf(yaw), 0.0f), XMVectorSet(0, 1, 0, 0))));
+
+		auto start = std::chrono::high_resolution_clock::now();
+		particleBudget.Update(requests, view, projection, cameraPosition);
+		auto end = std::chrono::high_resolution_clock::now();
+		seconds += std::chrono::duration<double>(end - start).count();
+
+		requested += particleBudget.GetRequested();
+		granted += particleBudget.GetGranted();
+		culled += particleBudget.GetCulledCount();
+		//it can only go over when everything is already down to the least it keeps
+		float least = 0.0f;
+		for (int i = 0; i < emitterCount; i++)
+			least += requests[i].demand * 0.1f;
+		if (particleBudget.GetGranted() > budget * 1.001f && particleBudget.GetGranted() > least * 1.001f)
+			overBudget++;
+
+		float mostCulled = 0.0f;
+		float leastVisible = 1.0f;
+		for (int i = 0; i < emitterCount; i++)
+		{
+			if (particleBudget.IsVisible(i))
+				leastVisible = std::min(leastVisible, particleBudget.GetScale(i));
+			else
+				mostCulled = std::max(mostCulled, particleBudget.GetScale(i));
+		}
+		if (mostCulled > leastVisible)
+			culledOverVisible++;
+		for (int i = 0; i + 1 < emitterCount; i += 2)
+		{
+			if (particleBudget.GetScale(i + 1) < particleBudget.GetScale(i))
+				priorityInverted++;
+		}
+	}
+
+	printf("particle budget: %d emitters, %d frames, a budget of %d\n", emitterCount, frameCount, budget);
+	printf("  requested:     %8.0f particles/frame\n", requested / frameCount);
+	printf("  granted:       %8.0f particles/frame\n", granted / frameCount);
+	printf("  culled:        %8.1f emitters/frame\n", culled / frameCount);
+	printf("  update:        %8.3f us/frame\n", seconds * 1e6 / frameCount);
+	printf("  over budget:   %8d frames\n", overBudget);
+	printf("  wrong order:   %8d frames a culled emitter got more, %d pairs a priority got less\n",
+		culledOverVisible, priorityInverted);
+}
+
+void RunParticleBoundsBenchmark(int emitterCount, int frameCount, unsigned int seed)
+{
+	struct BoundsParticle
+	{
+		XMFLOAT3 position;
+		XMFLOAT3 velocity;
+		float spawnTime;
+	};
+	struct BoundsEmitter
+	{
+		XMFLOAT3 centre; //it circles this, the way a trail follows the ship
+		XMFLOAT3 position;
+		XMFLOAT3 velocity;
+		XMFLOAT3 velocityRange;
+		XMFLOAT3 acceleration;
+		float rate;
+		float lifetime;
+		float owed;
+		std::deque<BoundsParticle> particles;
+		std::deque<SpawnBounds> batches;
+		XMFLOAT3 min;
+		XMFLOAT3 max;
+	};
+
+	//Game's two trails and its explosions
+	std::mt19937 randomGenerator(seed);
+	std::uniform_real_distribution<float> spread(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::vector<BoundsEmitter> emitters(emitterCount);
+	for (int i = 0; i < emitterCount; i++)
+	{
+		BoundsEmitter& e = emitters[i];
+		e.centre = XMFLOAT3(spread(randomGenerator), 5.0f, spread(randomGenerator));
+		e.position = e.centre;
+		bool trail = i % 2 == 0;
+		e.velocity = trail ? XMFLOAT3(0, 5, 0) : XMFLOAT3(0, 0, 0);
+		e.velocityRange = trail ? XMFLOAT3(0.2f, 0.2f, 0.2f) : XMFLOAT3(5, 5, 5);
+		e.acceleration = trail ? XMFLOAT3(0, -1, 0) : XMFLOAT3(0, 0, 0);
+		e.rate = 100.0f;
+		e.lifetime = trail ? 2.0f : 0.7f;
+		e.owed = 0.0f;
+		e.min = XMFLOAT3(1, 1, 1);
+		e.max = XMFLOAT3(0, 0, 0);
+	}
+
+	XMFLOAT4X4 projection;
+	XMStoreFloat4x4(&projection, XMMatrixTranspose(XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.1f, 1000.0f)));
+	XMFLOAT3 cameraPosition(0.0f, 5.0f, 0.0f);
+	const float deltaTime = 1.0f / 60.0f;
+
+	double seconds = 0;
+	int escaped = 0;
+	int escapedSpawnBox = 0;
+	double particleTotal = 0;
+	double drawnParticles = 0;
+	double drawnEmitters = 0;
+	double batchTotal = 0;
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		float time = frame * deltaTime;
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < emitterCount; i++)
+		{
+			BoundsEmitter& e = emitters[i];
+			float angle = time * 2.0f + i;
+			e.position = XMFLOAT3(e.centre.x + 10.0f * cosf(angle), e.centre.y, e.centre.z + 10.0f * sinf(angle));
+
+			//the batches and particles that died
+			bool died = false;
+			while (!e.particles.empty() && time - e.particles.front().spawnTime >= e.lifetime)
+				e.particles.pop_front();
+			while (!e.batches.empty() && time - e.batches.front().spawnTime >= e.lifetime)
+			{
+				e.batches.pop_front();
+				died = true;
+			}
+			if (died)
+			{
+				e.min = XMFLOAT3(1, 1, 1);
+				e.max = XMFLOAT3(0, 0, 0);
+				for (size_t b = 0; b < e.batches.size(); b++)
+				{
+					XMVECTOR min = XMLoadFloat3(&e.batches[b].min);
+					XMVECTOR max = XMLoadFloat3(&e.batches[b].max);
+					if (b > 0)
+					{
+						min = XMVectorMin(min, XMLoadFloat3(&e.min));
+						max = XMVectorMax(max, XMLoadFloat3(&e.max));
+					}
+					XMStoreFloat3(&e.min, min);
+					XMStoreFloat3(&e.max, max);
+				}
+			}
+
+			//this frame's batch
+			e.owed += e.rate * deltaTime;
+			int count = (int)e.owed;
+			e.owed -= count;
+			if (count == 0)
+				continue;
+			XMVECTOR lowVelocity = XMVectorReplicate(FLT_MAX);
+			XMVECTOR highVelocity = XMVectorReplicate(-FLT_MAX);
+			for (int n = 0; n < count; n++)
+			{
+				BoundsParticle p;
+				p.position = e.position;
+				p.velocity = XMFLOAT3(e.velocity.x + unit(randomGenerator) * e.velocityRange.x,
+					e.velocity.y + unit(randomGenerator) * e.velocityRange.y,
+					e.velocity.z + unit(randomGenerator) * e.velocityRange.z);
+				p.spawnTime = time;
+				e.particles.push_back(p);
+				lowVelocity = XMVectorMin(lowVelocity, XMLoadFloat3(&p.velocity));
+				highVelocity = XMVectorMax(highVelocity, XMLoadFloat3(&p.velocity));
+			}
+			SpawnBounds batch;
+			XMFLOAT3 slow, fast;
+			XMStoreFloat3(&slow, lowVelocity);
+			XMStoreFloat3(&fast, highVelocity);
+			GetParticlePathBounds(e.position, e.position, slow, fast, e.acceleration, e.lifetime, nullptr, batch.min, batch.max);
+			batch.spawnTime = time;
+			if (e.batches.empty())
+			{
+				e.min = batch.min;
+				e.max = batch.max;
+			}
+			XMStoreFloat3(&e.min, XMVectorMin(XMLoadFloat3(&e.min), XMLoadFloat3(&batch.min)));
+			XMStoreFloat3(&e.max, XMVectorMax(XMLoadFloat3(&e.max), XMLoadFloat3(&batch.max)));
+			e.batches.push_back(batch);
+		}
+
+		//the camera turns a full circle, culling what it can't see
+		float yaw = XM_2PI * frame / frameCount;
+		XMFLOAT4X4 view;
+		XMStoreFloat4x4(&view, XMMatrixTranspose(XMMatrixLookToLH(XMLoadFloat3(&cameraPosition),
+			XMVectorSet(sinf(yaw), -0.1f, cosf(yaw), 0.0f), XMVectorSet(0, 1, 0, 0))));
+		Frustum frustum(view, projection);
+		std::vector<unsigned char> visible(emitterCount);
+		for (int i = 0; i < emitterCount; i++)
+		{
+			const BoundsEmitter& e = emitters[i];
+			visible[i] = e.min.x <= e.max.x && frustum.IntersectsBox(e.min, e.max);
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+		seconds += std::chrono::duration<double>(end - start).count();
+
+		//every live particle has to be in its emitter's box, and in the box of what it could
+		//spawn for culling with that to be safe
+		for (int i = 0; i < emitterCount; i++)
+		{
+			const BoundsEmitter& e = emitters[i];
+			XMFLOAT3 spawnMin, spawnMax;
+			XMVECTOR velocity = XMLoadFloat3(&e.velocity);
+			XMVECTOR velocityRange = XMLoadFloat3(&e.velocityRange);
+			XMFLOAT3 slow, fast;
+			XMStoreFloat3(&slow, velocity - velocityRange);
+			XMStoreFloat3(&fast, velocity + velocityRange);
+			GetParticlePathBounds(e.position, e.position, slow, fast, e.acceleration, e.lifetime, nullptr, spawnMin, spawnMax);
+			for (const BoundsParticle& p : e.particles)
+			{
+				float t = time - p.spawnTime;
+				float x = p.position.x + p.velocity.x * t + 0.5f * e.acceleration.x * t * t;
+				float y = p.position.y + p.velocity.y * t + 0.5f * e.acceleration.y * t * t;
+				float z = p.position.z + p.velocity.z * t + 0.5f * e.acceleration.z * t * t;
+				const float slack = 1e-3f;
+				if (x < e.min.x - slack || y < e.min.y - slack || z < e.min.z - slack ||
+					x > e.max.x + slack || y > e.max.y + slack || z > e.max.z + slack)
+					escaped++;
+				if (x < spawnMin.x - slack || y < spawnMin.y - slack || z < spawnMin.z - slack ||
+					x > spawnMax.x + slack || y > spawnMax.y + slack || z > spawnMax.z + slack)
+					escapedSpawnBox++;
+			}
+			particleTotal += e.particles.size();
+			batchTotal += e.batches.size();
+			if (visible[i])
+			{
+				drawnEmitters++;
+				drawnParticles += e.particles.size();
+			}
+		}
+	}
+
+	printf("particle bounds: %d moving emitters, %d frames\n", emitterCount, frameCount);
+	printf("  batches:       %8.1f an emitter\n", batchTotal / frameCount / emitterCount);
+	printf("  drawn:         %8.1f of %d emitters, %.0f of %.0f particles a frame\n", drawnEmitters / frameCount, emitterCount,
+		drawnParticles / frameCount, particleTotal / frameCount);
+	printf("  bounds+cull:   %8.3f us/frame\n", seconds * 1e6 / frameCount);
+	printf("  escaped:       %8d particles outside their box, %d outside the spawn ranges' box\n", escaped, escapedSpawnBox);
+}
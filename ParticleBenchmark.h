@@ -0,0 +1,39 @@
+#pragma once
+
+//headless benchmarks for the particle pool and emitters, they only need DirectXMath and the
+//standard library like the ones in PhysicsBenchmark.h, whose main runs them
+
+//fills particleCount particles the way Emitter spawned them, a new mt19937 from random_device
+//for each one, and the way it does now from one seeded Xoshiro128, then checks the new numbers
+//stay in range, average out and come back the same for the same seed
+void RunParticleRandomBenchmark(int particleCount, unsigned long long seed = 1);
+
+//starts and ends emitters of Game's sizes at random over frameCount frames in the pool's slab
+//allocator, timing it and checking no two ranges in use overlap and how much of the drawn part
+//of the pool is really in use
+void RunParticlePoolBenchmark(int frameCount, unsigned int seed = 1);
+
+//throws particleCount simulated particles over a hilly height field into a sea for frameCount
+//frames on one thread and on the pool, checking none end up under the floor and that the
+//particles written for upload put the shader on the simulated positions
+void RunParticleSimulationBenchmark(int particleCount, int frameCount, unsigned int seed = 1);
+
+//sorts particleCount particles from a few emitters, respawning some every frame, while the
+//camera circles slowly and then jumps about, timing the radix sort against std::sort and
+//checking every order is back to front
+void RunParticleSortBenchmark(int particleCount, int frameCount, unsigned int seed = 1);
+
+//runs Game's emitters and some explosions through rings in the pool for frameCount frames and
+//uploads what UploadPlanner plans to a copy standing in for the gpu, printing the bytes sent
+//against uploading the whole used pool and checking the copy never has a stale live particle
+void RunUploadPlanBenchmark(int frameCount, unsigned int seed = 1);
+
+//scatters emitterCount emitters around a camera that turns a full circle over frameCount
+//frames and shares a budget between them, timing it and checking the budget is kept, culled
+//emitters get the least and a higher priority never gets less than a lower one as close
+void RunParticleBudgetBenchmark(int emitterCount, int frameCount, int budget, unsigned int seed = 1);
+
+//moves emitterCount trails and explosions about for frameCount frames keeping a box for each
+//batch they spawn the way Emitter does, checking no live particle is ever outside its
+//emitter's box and counting how many emitters and particles a turning camera culls
+void RunParticleBoundsBenchmark(int emitterCount, int frameCount, unsigned int seed = 1);
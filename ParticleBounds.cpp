@@ -0,0 +1,44 @@
+#include "ParticleBounds.h"
+#include<cmath>
+
+void GetParticlePathBounds(XMFLOAT3 lowPosition, XMFLOAT3 highPosition, XMFLOAT3 lowVelocity, XMFLOAT3 highVelocity,
+	XMFLOAT3 acceleration, float lifetime, const ParticleForces* forces, XMFLOAT3& min, XMFLOAT3& max)
+{
+	float* mins = &min.x;
+	float* maxs = &max.x;
+	const float* lowPositions = &lowPosition.x;
+	const float* highPositions = &highPosition.x;
+	const float* lowVelocities = &lowVelocity.x;
+	const float* highVelocities = &highVelocity.x;
+	const float* accelerations = &acceleration.x;
+	float swirl = forces ? 0.5f * forces->turbulence * lifetime * lifetime : 0.0f;
+	for (int i = 0; i < 3; i++)
+	{
+		float low = lowVelocities[i];
+		float high = highVelocities[i];
+		if (forces)
+		{
+			low = fminf(low, (&forces->wind.x)[i]);
+			high = fmaxf(high, (&forces->wind.x)[i]);
+		}
+
+		//the slowest and fastest particles at both ends of their lives and where they turn,
+		//if that's in between
+		float a = accelerations[i];
+		auto travel = [&](float v, float t) { return v * t + 0.5f * a * t * t; };
+		float lowTravel = fminf(0.0f, travel(low, lifetime));
+		float highTravel = fmaxf(0.0f, travel(high, lifetime));
+		if (a != 0.0f)
+		{
+			float lowTurn = -low / a;
+			float highTurn = -high / a;
+			if (lowTurn > 0.0f && lowTurn < lifetime)
+				lowTravel = fminf(lowTravel, travel(low, lowTurn));
+			if (highTurn > 0.0f && highTurn < lifetime)
+				highTravel = fmaxf(highTravel, travel(high, highTurn));
+		}
+
+		mins[i] = lowPositions[i] + lowTravel - swirl;
+		maxs[i] = highPositions[i] + highTravel + swirl;
+	}
+}
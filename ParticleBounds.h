@@ -0,0 +1,17 @@
+#pragma once
+#include"ParticleSimulation.h"
+
+//the box a batch of particles spawned together stays in for as long as they live
+struct SpawnBounds
+{
+	XMFLOAT3 min;
+	XMFLOAT3 max;
+	float spawnTime;
+};
+
+//the box particles stay in over lifetime seconds when they start anywhere between lowPosition
+//and highPosition at anywhere between lowVelocity and highVelocity, moving the way
+//ParticlesVS has them, p + v * t + a * t^2 / 2. forces is null for those, simulated particles
+//can take on the wind's velocity as well and are pushed about by the turbulence
+void GetParticlePathBounds(XMFLOAT3 lowPosition, XMFLOAT3 highPosition, XMFLOAT3 lowVelocity, XMFLOAT3 highVelocity,
+	XMFLOAT3 acceleration, float lifetime, const ParticleForces* forces, XMFLOAT3& min, XMFLOAT3& max);
@@ -0,0 +1,115 @@
+#include "ParticleBudget.h"
+#include<algorithm>
+#include<cmath>
+
+ParticleBudget::ParticleBudget(int budget, float minScale, float fullDetailSize)
+{
+	this->budget = budget;
+	this->minScale = minScale;
+	this->fullDetailSize = fullDetailSize;
+	culledCount = 0;
+	requested = 0.0f;
+	granted = 0.0f;
+}
+
+void ParticleBudget::SetBudget(int budget)
+{
+	this->budget = budget;
+}
+
+float ParticleBudget::Grant(const std::vector<ParticleBudgetRequest>& requests, float factor)
+{
+	float total = 0.0f;
+	for (size_t i = 0; i < requests.size(); i++)
+	{
+		float scale = detail[i] * std::min(1.0f, factor * requests[i].priority);
+		total += requests[i].demand * std::max(scale, minScale);
+	}
+	return total;
+}
+
+void ParticleBudget::Update(const std::vector<ParticleBudgetRequest>& requests, const XMFLOAT4X4& view, const XMFLOAT4X4& projection, XMFLOAT3 cameraPosition)
+{
+	int count = (int)requests.size();
+	scales.assign(count, 1.0f);
+	detail.assign(count, 1.0f);
+	visible.assign(count, 1);
+	culledCount = 0;
+	requested = 0.0f;
+
+	//the projection's _22 is one over the tangent of half the field of view
+	Frustum frustum(view, projection);
+	float focal = projection._22;
+	float maxPriority = 0.0f;
+	for (int i = 0; i < count; i++)
+	{
+		const ParticleBudgetRequest& r = requests[i];
+		requested += r.demand;
+		maxPriority = std::max(maxPriority, r.priority);
+		if (!frustum.IntersectsBox(r.boundsMin, r.boundsMax))
+		{
+			visible[i] = 0;
+			detail[i] = minScale;
+			culledCount++;
+			continue;
+		}
+
+		//how much of the screen's height the sphere around the bounds covers
+		XMVECTOR min = XMLoadFloat3(&r.boundsMin);
+		XMVECTOR max = XMLoadFloat3(&r.boundsMax);
+		float radius = XMVectorGetX(XMVector3Length(max - min)) * 0.5f;
+		float distance = XMVectorGetX(XMVector3Length((min + max) * 0.5f - XMLoadFloat3(&cameraPosition)));
+		float size = radius * focal / std::max(distance, radius);
+		detail[i] = std::min(std::max(size / fullDetailSize, minScale), 1.0f);
+	}
+
+	if (Grant(requests, 1e30f) > budget && maxPriority > 0.0f)
+	{
+		//the factor that just fits, no emitter is cut below minScale even if that's over
+		float low = 0.0f;
+		float high = 1.0f / std::max(minScale * maxPriority, 1e-6f);
+		for (int i = 0; i < 30; i++)
+		{
+			float factor = (low + high) * 0.5f;
+			if (Grant(requests, factor) > budget)
+				high = factor;
+			else
+				low = factor;
+		}
+		for (int i = 0; i < count; i++)
+			scales[i] = std::max(detail[i] * std::min(1.0f, low * requests[i].priority), minScale);
+	}
+	else
+	{
+		scales = detail;
+	}
+
+	granted = 0.0f;
+	for (int i = 0; i < count; i++)
+		granted += requests[i].demand * scales[i];
+}
+
+float ParticleBudget::GetScale(int index) const
+{
+	return scales[index];
+}
+
+bool ParticleBudget::IsVisible(int index) const
+{
+	return visible[index] != 0;
+}
+
+int ParticleBudget::GetCulledCount() const
+{
+	return culledCount;
+}
+
+float ParticleBudget::GetRequested() const
+{
+	return requested;
+}
+
+float ParticleBudget::GetGranted() const
+{
+	return granted;
+}
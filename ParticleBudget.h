@@ -0,0 +1,50 @@
+#pragma once
+#include"Frustum.h"
+#include<vector>
+
+//what one emitter asks the budget for
+struct ParticleBudgetRequest
+{
+	XMFLOAT3 boundsMin; //everywhere its particles can be
+	XMFLOAT3 boundsMax;
+	float demand; //particles it keeps alive at its full rate and lifetime
+	float priority; //how much more it keeps when there isn't enough, relative to the others
+};
+
+//shares a global number of live particles between emitters. an emitter whose bounds are
+//off screen is culled and only keeps minScale of its particles so it isn't empty when it
+//comes back. one on screen gets a level of detail from how big its bounds look, full at
+//fullDetailSize of the screen's height and less below that. when the total still doesn't fit
+//every emitter is cut back by the same factor times its priority, found by bisection, never
+//below minScale
+class ParticleBudget
+{
+	int budget;
+	float minScale;
+	float fullDetailSize;
+
+	std::vector<float> scales;
+	std::vector<float> detail;
+	std::vector<unsigned char> visible;
+	int culledCount;
+	float requested;
+	float granted;
+
+	//particles kept if every emitter gets its detail times min(1, factor * priority)
+	float Grant(const std::vector<ParticleBudgetRequest>& requests, float factor);
+
+public:
+	ParticleBudget(int budget = 20000, float minScale = 0.1f, float fullDetailSize = 0.25f);
+
+	void SetBudget(int budget);
+	//view and projection transposed the way Camera keeps them
+	void Update(const std::vector<ParticleBudgetRequest>& requests, const XMFLOAT4X4& view, const XMFLOAT4X4& projection, XMFLOAT3 cameraPosition);
+
+	//what part of its particles request i keeps
+	float GetScale(int index) const;
+	bool IsVisible(int index) const;
+	int GetCulledCount() const;
+	//particles asked for and given out by the last Update
+	float GetRequested() const;
+	float GetGranted() const;
+};
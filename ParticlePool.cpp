@@ -0,0 +1,285 @@
+#include "ParticlePool.h"
+
+//spawn time of a particle nobody has spawned, old enough to be past any lifetime
+static const float DEAD_SPAWN_TIME = -1e30f;
+
+ParticlePool::ParticlePool(ID3D11Device* device, SimpleVertexShader* vs, SimplePixelShader* ps, ID3D11ShaderResourceView* texture, ThreadPool* threads)
+	: allocator(PARTICLE_POOL_SIZE, PARTICLE_SLAB_SIZE), uploads(PARTICLE_POOL_SIZE, sizeof(Particle))
+{
+	this->vs = vs;
+	this->ps = ps;
+	this->texture = texture;
+	this->threads = threads;
+
+	particles = new Particle[PARTICLE_POOL_SIZE];
+	ZeroMemory(particles, sizeof(Particle) * PARTICLE_POOL_SIZE);
+	Clear(0, PARTICLE_POOL_SIZE);
+
+	emitterData.resize(PARTICLE_POOL_EMITTERS);
+	boundsMin.assign(PARTICLE_POOL_EMITTERS, XMFLOAT3(1, 1, 1));
+	boundsMax.assign(PARTICLE_POOL_EMITTERS, XMFLOAT3(0, 0, 0));
+	for (int pass = 0; pass < 2; pass++)
+	{
+		visible[pass].assign(PARTICLE_POOL_EMITTERS, 1);
+		visibleCount[pass] = 0;
+	}
+	emitterTop = 0;
+	emittersDirty = true;
+
+	//four vertices a particle, the vertex shader works out which corner it is from the id
+	unsigned int* indices = new unsigned int[6 * PARTICLE_POOL_SIZE];
+	int indexCount = 0;
+	for (int i = 0; i < PARTICLE_POOL_SIZE * 4; i += 4)
+	{
+		indices[indexCount++] = i;
+		indices[indexCount++] = i + 1;
+		indices[indexCount++] = i + 2;
+		indices[indexCount++] = i;
+		indices[indexCount++] = i + 2;
+		indices[indexCount++] = i + 3;
+	}
+
+	D3D11_SUBRESOURCE_DATA ibdSub = {};
+	ibdSub.pSysMem = indices;
+
+	D3D11_BUFFER_DESC ibd = {};
+	ibd.ByteWidth = 6 * sizeof(unsigned int) * PARTICLE_POOL_SIZE;
+	ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	ibd.Usage = D3D11_USAGE_DEFAULT;
+	device->CreateBuffer(&ibd, &ibdSub, &indexBuffer);
+	delete[] indices;
+
+	//the particles start out as the dead ones in the array and are updated a range at a time
+	D3D11_BUFFER_DESC bufferDesc = {};
+	bufferDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+	bufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+	bufferDesc.ByteWidth = PARTICLE_POOL_SIZE * sizeof(Particle);
+	bufferDesc.StructureByteStride = sizeof(Particle);
+	D3D11_SUBRESOURCE_DATA particleData = {};
+	particleData.pSysMem = particles;
+	device->CreateBuffer(&bufferDesc, &particleData, &particleBuffer);
+
+	//the emitters and the order are rewritten whole
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.ByteWidth = PARTICLE_POOL_EMITTERS * sizeof(ParticleEmitterData);
+	bufferDesc.StructureByteStride = sizeof(ParticleEmitterData);
+	device->CreateBuffer(&bufferDesc, 0, &emitterBuffer);
+
+	//the slots to draw, farthest first
+	bufferDesc.ByteWidth = PARTICLE_POOL_SIZE * sizeof(unsigned int);
+	bufferDesc.StructureByteStride = sizeof(unsigned int);
+	device->CreateBuffer(&bufferDesc, 0, &orderBuffer);
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+	srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+	srvDesc.Buffer.FirstElement = 0;
+	srvDesc.Buffer.NumElements = PARTICLE_POOL_SIZE;
+	device->CreateShaderResourceView(particleBuffer, &srvDesc, &particleSRV);
+
+	srvDesc.Buffer.NumElements = PARTICLE_POOL_EMITTERS;
+	device->CreateShaderResourceView(emitterBuffer, &srvDesc, &emitterSRV);
+
+	srvDesc.Buffer.NumElements = PARTICLE_POOL_SIZE;
+	device->CreateShaderResourceView(orderBuffer, &srvDesc, &orderSRV);
+}
+
+ParticlePool::~ParticlePool()
+{
+	indexBuffer->Release();
+	particleBuffer->Release();
+	particleSRV->Release();
+	emitterBuffer->Release();
+	emitterSRV->Release();
+	orderBuffer->Release();
+	orderSRV->Release();
+	delete[] particles;
+}
+
+int ParticlePool::Allocate(int count)
+{
+	return allocator.Allocate(count);
+}
+
+void ParticlePool::Free(int offset, int count)
+{
+	Clear(offset, count);
+	allocator.Free(offset, count);
+}
+
+void ParticlePool::Clear(int offset, int count)
+{
+	//only the cpu's copy. the gpu only reads the slots in the sorted order, which never has
+	//a dead one, so they don't have to go up
+	for (int i = offset; i < offset + count; i++)
+	{
+		particles[i].spawnTime = DEAD_SPAWN_TIME;
+	}
+}
+
+Particle* ParticlePool::GetParticles()
+{
+	return particles;
+}
+
+void ParticlePool::MarkDirty(int offset, int count)
+{
+	uploads.MarkDirty(offset, count);
+}
+
+int ParticlePool::AddEmitter()
+{
+	if (!freeEmitters.empty())
+	{
+		int index = freeEmitters.back();
+		freeEmitters.pop_back();
+		return index;
+	}
+	if (emitterTop == PARTICLE_POOL_EMITTERS)
+		return -1;
+	return emitterTop++;
+}
+
+void ParticlePool::RemoveEmitter(int index)
+{
+	ClearEmitterBounds(index);
+	freeEmitters.push_back(index);
+}
+
+void ParticlePool::SetEmitterData(int index, const ParticleEmitterData& data)
+{
+	emitterData[index] = data;
+	emittersDirty = true;
+}
+
+void ParticlePool::SetEmitterBounds(int index, XMFLOAT3 min, XMFLOAT3 max)
+{
+	boundsMin[index] = min;
+	boundsMax[index] = max;
+}
+
+void ParticlePool::ClearEmitterBounds(int index)
+{
+	boundsMin[index] = XMFLOAT3(1, 1, 1);
+	boundsMax[index] = XMFLOAT3(0, 0, 0);
+}
+
+bool ParticlePool::Cull(XMFLOAT4X4 view, XMFLOAT4X4 projection, int pass)
+{
+	Frustum frustum(view, projection);
+	int count = 0;
+	for (int i = 0; i < emitterTop; i++)
+	{
+		bool seen = boundsMin[i].x <= boundsMax[i].x && frustum.IntersectsBox(boundsMin[i], boundsMax[i]);
+		visible[pass][i] = seen ? 1 : 0;
+		if (seen)
+			count++;
+	}
+	visibleCount[pass] = count;
+	return count > 0;
+}
+
+void ParticlePool::Draw(ID3D11DeviceContext* context, XMFLOAT4X4 view, XMFLOAT4X4 projection, float currentTime, int pass)
+{
+	int top = allocator.GetTop();
+	if (top == 0 || visibleCount[pass] == 0)
+		return;
+
+	//the view is kept transposed, its third row is the camera's forward axis and the offset
+	//that gives a point's view depth
+	XMFLOAT4 plane(view._31, view._32, view._33, view._34);
+	sorter.Sort(particles, top, &emitterData[0], &visible[pass][0], plane, currentTime, threads);
+	const std::vector<unsigned int>& order = sorter.GetOrder();
+	if (order.empty())
+		return;
+
+	//the main pass and the reflection draw the same particles, only the first one uploads
+	if (uploads.IsDirty())
+	{
+		const std::vector<UploadRange>& ranges = uploads.Plan(top);
+		for (const UploadRange& range : ranges)
+		{
+			D3D11_BOX box = {};
+			box.left = range.offset * sizeof(Particle);
+			box.right = (range.offset + range.count) * sizeof(Particle);
+			box.bottom = 1;
+			box.back = 1;
+			context->UpdateSubresource(particleBuffer, 0, &box, particles + range.offset, 0, 0);
+		}
+	}
+
+	D3D11_MAPPED_SUBRESOURCE mapped = {};
+	if (emittersDirty)
+	{
+		context->Map(emitterBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+		memcpy(mapped.pData, &emitterData[0], sizeof(ParticleEmitterData) * emitterTop);
+		context->Unmap(emitterBuffer, 0);
+		emittersDirty = false;
+	}
+	context->Map(orderBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+	memcpy(mapped.pData, order.data(), sizeof(unsigned int) * order.size());
+	context->Unmap(orderBuffer, 0);
+
+	UINT stride = 0;
+	UINT offset = 0;
+	ID3D11Buffer* nullBuffer = nullptr;
+	context->IASetIndexBuffer(indexBuffer, DXGI_FORMAT_R32_UINT, 0);
+	context->IASetVertexBuffers(0, 1, &nullBuffer, &stride, &offset);
+
+	vs->SetMatrix4x4("view", view);
+	vs->SetMatrix4x4("projection", projection);
+	vs->SetFloat("currentTime", currentTime);
+	vs->SetShader();
+	vs->CopyAllBufferData();
+
+	ID3D11ShaderResourceView* srvs[3] = { particleSRV, emitterSRV, orderSRV };
+	context->VSSetShaderResources(0, 3, srvs);
+
+	ps->SetShaderResourceView("particle", texture);
+	ps->SetShader();
+	ps->CopyAllBufferData();
+
+	context->DrawIndexed((UINT)order.size() * 6, 0, 0);
+}
+
+int ParticlePool::GetCapacity()
+{
+	return allocator.GetCapacity();
+}
+
+int ParticlePool::GetTop()
+{
+	return allocator.GetTop();
+}
+
+int ParticlePool::GetUsedCount()
+{
+	return allocator.GetUsed();
+}
+
+int ParticlePool::GetEmitterCount()
+{
+	return emitterTop - (int)freeEmitters.size();
+}
+
+int ParticlePool::GetVisibleCount(int pass)
+{
+	return visibleCount[pass];
+}
+
+const ParticleSorter& ParticlePool::GetSorter()
+{
+	return sorter;
+}
+
+int ParticlePool::GetUploadedBytes()
+{
+	return uploads.GetPlannedBytes();
+}
+
+int ParticlePool::GetUploadedRanges()
+{
+	return uploads.GetPlannedRanges();
+}
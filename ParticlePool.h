@@ -0,0 +1,94 @@
+#pragma once
+#include"Particles.h"
+#include"SimpleShader.h"
+#include"SlabAllocator.h"
+#include"ParticleSorter.h"
+#include"UploadPlanner.h"
+#include"Frustum.h"
+#include<vector>
+
+//particles in the whole pool, and emitters that can have a range of it at once
+#define PARTICLE_POOL_SIZE 65536
+#define PARTICLE_POOL_EMITTERS 256
+//the smallest range an emitter is given
+#define PARTICLE_SLAB_SIZE 64
+
+//every emitter's particles in one array, uploaded to one structured buffer and drawn with one
+//draw call. emitters are given a slab of the array for their ring of particles and a slot for
+//what their particles share. slots nobody is using hold particles that are long dead. every
+//draw sorts the live particles back to front and ParticlesVS reads them through that order,
+//so overlapping emitters blend right. particles don't change after they are spawned unless
+//they are simulated, so only the slots written since the last draw are uploaded. emitters
+//keep the pool up to date with a box their particles stay in, and the ones whose box is off
+//screen are left out of a pass altogether
+class ParticlePool
+{
+	Particle* particles;
+	SlabAllocator allocator;
+	UploadPlanner uploads; //the slots written since the last upload
+
+	std::vector<ParticleEmitterData> emitterData;
+	std::vector<XMFLOAT3> boundsMin; //min above max when the emitter has no particles
+	std::vector<XMFLOAT3> boundsMax;
+	std::vector<unsigned char> visible[2]; //for each pass, whether the last Cull saw the emitter
+	int visibleCount[2];
+	std::vector<int> freeEmitters;
+	int emitterTop; //one past the last emitter slot ever handed out
+	bool emittersDirty;
+
+	ID3D11Buffer* particleBuffer;
+	ID3D11ShaderResourceView* particleSRV;
+	ID3D11Buffer* emitterBuffer;
+	ID3D11ShaderResourceView* emitterSRV;
+	ID3D11Buffer* indexBuffer;
+	ID3D11Buffer* orderBuffer;
+	ID3D11ShaderResourceView* orderSRV;
+
+	ParticleSorter sorter;
+	ThreadPool* threads;
+
+	SimpleVertexShader* vs;
+	SimplePixelShader* ps;
+	ID3D11ShaderResourceView* texture;
+
+public:
+	//threads sorts the particles, it can be null
+	ParticlePool(ID3D11Device* device, SimpleVertexShader* vs, SimplePixelShader* ps, ID3D11ShaderResourceView* texture, ThreadPool* threads);
+	~ParticlePool();
+
+	//the offset of room for count particles, or -1 when the pool is full
+	int Allocate(int count);
+	void Free(int offset, int count);
+	//makes count particles from offset dead, so they are not drawn
+	void Clear(int offset, int count);
+	Particle* GetParticles();
+	//call after writing count particles from offset, they go up with the next Draw
+	void MarkDirty(int offset, int count);
+
+	//a slot for an emitter's shared data, or -1 when they are all taken
+	int AddEmitter();
+	void RemoveEmitter(int index);
+	void SetEmitterData(int index, const ParticleEmitterData& data);
+	//a box the emitter's living particles stay in, or none when it has no particles
+	void SetEmitterBounds(int index, XMFLOAT3 min, XMFLOAT3 max);
+	void ClearEmitterBounds(int index);
+
+	//finds the emitters the view can see for a pass, false when there aren't any and the pass
+	//can skip drawing particles at all. pass 0 is the main view and 1 the reflection
+	bool Cull(XMFLOAT4X4 view, XMFLOAT4X4 projection, int pass = 0);
+	//uploads whatever changed, sorts the live particles of the emitters the last Cull for the
+	//pass saw and draws them in one call
+	void Draw(ID3D11DeviceContext* context, XMFLOAT4X4 view, XMFLOAT4X4 projection, float currentTime, int pass = 0);
+
+	int GetCapacity();
+	//particles under the highest slab in use, what a draw goes through
+	int GetTop();
+	int GetUsedCount();
+	int GetEmitterCount();
+	//emitters the last Cull for the pass saw
+	int GetVisibleCount(int pass);
+	const ParticleSorter& GetSorter();
+	//what the last upload of particles sent
+	int GetUploadedBytes();
+	int GetUploadedRanges();
+};
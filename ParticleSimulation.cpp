@@ -0,0 +1,237 @@
+#include "ParticleSimulation.h"
+#include<cmath>
+#include<cfloat>
+
+//particles a job on the pool, enough that handing them out costs little next to the work
+static const int SIMULATION_BLOCK_SIZE = 2048;
+
+ParticleSimulation::ParticleSimulation(int capacity)
+{
+	this->capacity = capacity;
+	int padded = capacity + 3;
+	positionX.assign(padded, 0.0f);
+	positionY.assign(padded, 0.0f);
+	positionZ.assign(padded, 0.0f);
+	velocityX.assign(padded, 0.0f);
+	velocityY.assign(padded, 0.0f);
+	velocityZ.assign(padded, 0.0f);
+
+	forces = {};
+	ground = nullptr;
+	groundOffset = XMFLOAT3(0, 0, 0);
+	waterLevel = -FLT_MAX;
+}
+
+void ParticleSimulation::SetForces(const ParticleForces& forces)
+{
+	this->forces = forces;
+}
+
+void ParticleSimulation::SetCollision(const HeightField* ground, XMFLOAT3 groundOffset, float waterLevel)
+{
+	this->ground = ground;
+	this->groundOffset = groundOffset;
+	this->waterLevel = waterLevel;
+}
+
+void ParticleSimulation::Spawn(int index, XMFLOAT3 position, XMFLOAT3 velocity)
+{
+	positionX[index] = position.x;
+	positionY[index] = position.y;
+	positionZ[index] = position.z;
+	velocityX[index] = velocity.x;
+	velocityY[index] = velocity.y;
+	velocityZ[index] = velocity.z;
+}
+
+void ParticleSimulation::Simulate(Particle* particles, int start, int count, XMFLOAT3 acceleration, float deltaTime, float currentTime, ThreadPool* threads)
+{
+	if (count <= 0)
+		return;
+
+	int blockCount = (count + SIMULATION_BLOCK_SIZE - 1) / SIMULATION_BLOCK_SIZE;
+	auto job = [&](int block)
+	{
+		int blockStart = start + block * SIMULATION_BLOCK_SIZE;
+		int blockCount = count - block * SIMULATION_BLOCK_SIZE;
+		if (blockCount > SIMULATION_BLOCK_SIZE)
+			blockCount = SIMULATION_BLOCK_SIZE;
+		SimulateBlock(particles, blockStart, blockCount, acceleration, deltaTime, currentTime);
+	};
+
+	if (threads && blockCount > 1)
+		threads->ParallelFor(blockCount, job);
+	else
+	{
+		for (int block = 0; block < blockCount; block++)
+			job(block);
+	}
+}
+
+void ParticleSimulation::SimulateBlock(Particle* particles, int start, int count, XMFLOAT3 acceleration, float deltaTime, float currentTime)
+{
+	//the drag is solved exactly for the step, so a big drag or a long frame can't overshoot the wind
+	XMVECTOR step = XMVectorReplicate(deltaTime);
+	XMVECTOR keep = XMVectorReplicate(expf(-forces.drag * deltaTime));
+	XMVECTOR windX = XMVectorReplicate(forces.wind.x);
+	XMVECTOR windY = XMVectorReplicate(forces.wind.y);
+	XMVECTOR windZ = XMVectorReplicate(forces.wind.z);
+	XMVECTOR accelerationX = XMVectorReplicate(acceleration.x * deltaTime);
+	XMVECTOR accelerationY = XMVectorReplicate(acceleration.y * deltaTime);
+	XMVECTOR accelerationZ = XMVectorReplicate(acceleration.z * deltaTime);
+	XMVECTOR turbulence = XMVectorReplicate(forces.turbulence * deltaTime);
+	XMVECTOR turbulenceScale = XMVectorReplicate(forces.turbulenceScale);
+	XMVECTOR turbulenceTime = XMVectorReplicate(currentTime * 0.7f);
+	XMVECTOR bounce = XMVectorReplicate(-forces.bounce);
+	XMVECTOR slide = XMVectorReplicate(1.0f - forces.friction);
+	XMVECTOR water = XMVectorReplicate(waterLevel);
+	XMVECTOR now = XMVectorReplicate(currentTime);
+	XMVECTOR zero = XMVectorZero();
+	XMVECTOR laneIndex = XMVectorSet(0.0f, 1.0f, 2.0f, 3.0f);
+	bool collide = ground || waterLevel > -FLT_MAX;
+
+	//the ground under a block of particles, found in the field's space a chunk at a time. the
+	//field clamps at its edges, so points off it get no ground at all
+	const int chunkSize = 256;
+	alignas(16) float localX[chunkSize];
+	alignas(16) float localZ[chunkSize];
+	alignas(16) float floorHeight[chunkSize];
+
+	for (int chunk = start; chunk < start + count; chunk += chunkSize)
+	{
+		int size = start + count - chunk < chunkSize ? start + count - chunk : chunkSize;
+		int padded = (size + 3) & ~3;
+
+		for (int i = 0; i < padded; i += 4)
+		{
+			int p = chunk + i;
+			//lanes past the end are read but written back as they were, when the ring has
+			//wrapped they are live particles of its other run
+			XMVECTOR inside = XMVectorLess(laneIndex, XMVectorReplicate((float)(size - i)));
+			XMVECTOR oldVX = XMLoadFloat4((const XMFLOAT4*)&velocityX[p]);
+			XMVECTOR oldVY = XMLoadFloat4((const XMFLOAT4*)&velocityY[p]);
+			XMVECTOR oldVZ = XMLoadFloat4((const XMFLOAT4*)&velocityZ[p]);
+			XMVECTOR oldPX = XMLoadFloat4((const XMFLOAT4*)&positionX[p]);
+			XMVECTOR oldPY = XMLoadFloat4((const XMFLOAT4*)&positionY[p]);
+			XMVECTOR oldPZ = XMLoadFloat4((const XMFLOAT4*)&positionZ[p]);
+			XMVECTOR vx = oldVX;
+			XMVECTOR vy = oldVY;
+			XMVECTOR vz = oldVZ;
+			XMVECTOR px = oldPX;
+			XMVECTOR py = oldPY;
+			XMVECTOR pz = oldPZ;
+
+			//a swirl from sines of the other two axes, so it has no divergence and stirs the
+			//particles without bunching them up
+			if (forces.turbulence != 0.0f)
+			{
+				vx += XMVectorSin(pz * turbulenceScale + turbulenceTime) * turbulence;
+				vy += XMVectorSin(px * turbulenceScale + turbulenceTime) * turbulence;
+				vz += XMVectorSin(py * turbulenceScale + turbulenceTime) * turbulence;
+			}
+
+			vx = windX + (vx + accelerationX - windX) * keep;
+			vy = windY + (vy + accelerationY - windY) * keep;
+			vz = windZ + (vz + accelerationZ - windZ) * keep;
+			px += vx * step;
+			py += vy * step;
+			pz += vz * step;
+
+			XMStoreFloat4((XMFLOAT4*)&velocityX[p], XMVectorSelect(oldVX, vx, inside));
+			XMStoreFloat4((XMFLOAT4*)&velocityY[p], XMVectorSelect(oldVY, vy, inside));
+			XMStoreFloat4((XMFLOAT4*)&velocityZ[p], XMVectorSelect(oldVZ, vz, inside));
+			XMStoreFloat4((XMFLOAT4*)&positionX[p], XMVectorSelect(oldPX, px, inside));
+			XMStoreFloat4((XMFLOAT4*)&positionY[p], XMVectorSelect(oldPY, py, inside));
+			XMStoreFloat4((XMFLOAT4*)&positionZ[p], XMVectorSelect(oldPZ, pz, inside));
+		}
+
+		if (collide)
+		{
+			if (ground && !ground->IsEmpty())
+			{
+				for (int i = 0; i < padded; i++)
+				{
+					localX[i] = positionX[chunk + i] - groundOffset.x;
+					localZ[i] = positionZ[chunk + i] - groundOffset.z;
+				}
+				ground->GetHeights(localX, localZ, floorHeight, padded);
+				for (int i = 0; i < padded; i++)
+				{
+					floorHeight[i] = ground->Contains(localX[i], localZ[i]) ? floorHeight[i] + groundOffset.y : -FLT_MAX;
+				}
+			}
+			else
+			{
+				for (int i = 0; i < padded; i++)
+					floorHeight[i] = -FLT_MAX;
+			}
+
+			//particles under the floor are put back on it and sent back up, the slope is
+			//left out and they bounce straight up
+			for (int i = 0; i < padded; i += 4)
+			{
+				int p = chunk + i;
+				XMVECTOR floor = XMVectorMax(XMLoadFloat4((const XMFLOAT4*)&floorHeight[i]), water);
+				XMVECTOR py = XMLoadFloat4((const XMFLOAT4*)&positionY[p]);
+				XMVECTOR inside = XMVectorLess(laneIndex, XMVectorReplicate((float)(size - i)));
+				XMVECTOR below = XMVectorAndInt(XMVectorLess(py, floor), inside);
+				XMVECTOR falling = XMVectorAndInt(below, XMVectorLess(XMLoadFloat4((const XMFLOAT4*)&velocityY[p]), zero));
+
+				XMVECTOR vy = XMLoadFloat4((const XMFLOAT4*)&velocityY[p]);
+				XMStoreFloat4((XMFLOAT4*)&positionY[p], XMVectorSelect(py, floor, below));
+				XMStoreFloat4((XMFLOAT4*)&velocityY[p], XMVectorSelect(vy, vy * bounce, falling));
+				XMVECTOR vx = XMLoadFloat4((const XMFLOAT4*)&velocityX[p]);
+				XMVECTOR vz = XMLoadFloat4((const XMFLOAT4*)&velocityZ[p]);
+				XMStoreFloat4((XMFLOAT4*)&velocityX[p], XMVectorSelect(vx, vx * slide, below));
+				XMStoreFloat4((XMFLOAT4*)&velocityZ[p], XMVectorSelect(vz, vz * slide, below));
+			}
+		}
+
+		//back into the upload layout, the shader adds t * velocity back on
+		for (int i = 0; i < size; i += 4)
+		{
+			int p = chunk + i;
+			int lanes = size - i < 4 ? size - i : 4;
+			XMVECTOR spawnTime = XMVectorSet(particles[p].spawnTime,
+				lanes > 1 ? particles[p + 1].spawnTime : currentTime,
+				lanes > 2 ? particles[p + 2].spawnTime : currentTime,
+				lanes > 3 ? particles[p + 3].spawnTime : currentTime);
+			XMVECTOR age = now - spawnTime;
+			XMVECTOR vx = XMLoadFloat4((const XMFLOAT4*)&velocityX[p]);
+			XMVECTOR vy = XMLoadFloat4((const XMFLOAT4*)&velocityY[p]);
+			XMVECTOR vz = XMLoadFloat4((const XMFLOAT4*)&velocityZ[p]);
+			XMFLOAT4 startX;
+			XMFLOAT4 startY;
+			XMFLOAT4 startZ;
+			XMStoreFloat4(&startX, XMLoadFloat4((const XMFLOAT4*)&positionX[p]) - age * vx);
+			XMStoreFloat4(&startY, XMLoadFloat4((const XMFLOAT4*)&positionY[p]) - age * vy);
+			XMStoreFloat4(&startZ, XMLoadFloat4((const XMFLOAT4*)&positionZ[p]) - age * vz);
+			for (int lane = 0; lane < lanes; lane++)
+			{
+				Particle& particle = particles[p + lane];
+				particle.startPosition = XMFLOAT3((&startX.x)[lane], (&startY.x)[lane], (&startZ.x)[lane]);
+				particle.startVelocity = XMFLOAT3(velocityX[p + lane], velocityY[p + lane], velocityZ[p + lane]);
+			}
+		}
+	}
+}
+
+XMFLOAT3 ParticleSimulation::GetPosition(int index) const
+{
+	return XMFLOAT3(positionX[index], positionY[index], positionZ[index]);
+}
+
+XMFLOAT3 ParticleSimulation::GetVelocity(int index) const
+{
+	return XMFLOAT3(velocityX[index], velocityY[index], velocityZ[index]);
+}
+
+int ParticleSimulation::GetCapacity() const
+{
+	return capacity;
+}
+
+const ParticleForces& ParticleSimulation::GetForces() const
+{
+	return forces;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include"Particles.h"
+#include"HeightField.h"
+#include"ThreadPool.h"
+#include<vector>
+
+//what pushes simulated particles around besides their emitter's acceleration
+struct ParticleForces
+{
+	XMFLOAT3 wind; //the air's velocity, drag pulls particles towards it
+	float drag; //how fast a particle takes on the wind's velocity, a fraction a second
+	float turbulence; //strength of a swirl that changes along the particles' paths, m/s^2
+	float turbulenceScale; //how many swirls a metre
+	float bounce; //part of its speed into the ground a particle keeps going back up
+	float friction; //part of its speed along the ground a particle loses when it hits
+};
+
+//moves particles on the cpu for the effects the closed form in ParticlesVS can't do, drag,
+//turbulence and bouncing off the ground or the sea. positions and velocities are kept one
+//array a field and stepped four at a time in blocks spread over a ThreadPool. the results go
+//back into the same Particle layout the pool uploads, with the start position set so the
+//shader's t * startVelocity + startPosition lands on the simulated position. the emitter's
+//acceleration has to be zero in the shader for that, it is applied here instead
+class ParticleSimulation
+{
+	//one array a field. blocks can start anywhere in an emitter's ring, so there are three
+	//spare slots past the end for the vector loops to run over
+	std::vector<float> positionX;
+	std::vector<float> positionY;
+	std::vector<float> positionZ;
+	std::vector<float> velocityX;
+	std::vector<float> velocityY;
+	std::vector<float> velocityZ;
+	int capacity;
+
+	ParticleForces forces;
+	const HeightField* ground;
+	XMFLOAT3 groundOffset; //where the field's origin is in the world
+	float waterLevel;
+
+	//steps count particles from start four at a time. the last four can read up to three
+	//slots past the end but leave them as they were
+	void SimulateBlock(Particle* particles, int start, int count, XMFLOAT3 acceleration, float deltaTime, float currentTime);
+
+public:
+	ParticleSimulation(int capacity);
+
+	void SetForces(const ParticleForces& forces);
+	//the ground particles bounce off, a height field placed at offset, and a flat sea. no
+	//field and a water level of -FLT_MAX turns collision off
+	void SetCollision(const HeightField* ground, XMFLOAT3 groundOffset, float waterLevel);
+
+	//starts the particle in slot index
+	void Spawn(int index, XMFLOAT3 position, XMFLOAT3 velocity);
+	//steps count particles from start and writes them into particles[start...]. threads can be null
+	void Simulate(Particle* particles, int start, int count, XMFLOAT3 acceleration, float deltaTime, float currentTime, ThreadPool* threads);
+
+	XMFLOAT3 GetPosition(int index) const;
+	XMFLOAT3 GetVelocity(int index) const;
+	int GetCapacity() const;
+	const ParticleForces& GetForces() const;
+};
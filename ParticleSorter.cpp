@@ -0,0 +1,186 @@
+#include "ParticleSorter.h"
+#include<algorithm>
+#include<cfloat>
+#include<cmath>
+
+//particles a job gets on the pool, in every step of the sort
+static const int SORT_BLOCK_SIZE = 4096;
+
+void ParticleSorter::Sort(const Particle* particles, int count, const ParticleEmitterData* emitters, const unsigned char* visible, XMFLOAT4 plane, float currentTime, ThreadPool* threads)
+{
+	if ((int)depths.size() < count)
+	{
+		depths.resize(count);
+		order.reserve(count);
+		scratchOrder.reserve(count);
+		keys.resize(count);
+		scratchKeys.resize(count);
+	}
+
+	FindDepths(particles, count, emitters, visible, plane, currentTime, threads);
+
+	RadixSort(count, threads);
+}
+
+void ParticleSorter::FindDepths(const Particle* particles, int count, const ParticleEmitterData* emitters, const unsigned char* visible, XMFLOAT4 plane, float currentTime, ThreadPool* threads)
+{
+	int blockCount = (count + SORT_BLOCK_SIZE - 1) / SORT_BLOCK_SIZE;
+	blockLive.assign(blockCount, 0);
+	blockMin.assign(blockCount, FLT_MAX);
+	blockMax.assign(blockCount, -FLT_MAX);
+
+	auto job = [&](int block)
+	{
+		int start = block * SORT_BLOCK_SIZE;
+		int end = std::min(start + SORT_BLOCK_SIZE, count);
+		int live = 0;
+		float minDepth = FLT_MAX;
+		float maxDepth = -FLT_MAX;
+		for (int slot = start; slot < end; slot++)
+		{
+			//the same position ParticlesVS works out
+			const Particle& p = particles[slot];
+			const ParticleEmitterData& e = emitters[p.emitterIndex];
+			float t = currentTime - p.spawnTime;
+			//particles of an emitter that is off screen are left out like dead ones
+			if (t < 0 || t >= e.lifetime || (visible && !visible[p.emitterIndex]))
+			{
+				depths[slot] = -FLT_MAX;
+				continue;
+			}
+
+			float a = 0.5f * t * t;
+			float x = a * e.acceleration.x + t * p.startVelocity.x + p.startPosition.x;
+			float y = a * e.acceleration.y + t * p.startVelocity.y + p.startPosition.y;
+			float z = a * e.acceleration.z + t * p.startVelocity.z + p.startPosition.z;
+			float depth = plane.x * x + plane.y * y + plane.z * z + plane.w;
+			depths[slot] = depth;
+			minDepth = std::min(minDepth, depth);
+			maxDepth = std::max(maxDepth, depth);
+			live++;
+		}
+		blockLive[block] = live;
+		blockMin[block] = minDepth;
+		blockMax[block] = maxDepth;
+	};
+
+	if (threads && blockCount > 1)
+		threads->ParallelFor(blockCount, job);
+	else
+	{
+		for (int block = 0; block < blockCount; block++)
+			job(block);
+	}
+}
+
+void ParticleSorter::RadixSort(int count, ThreadPool* threads)
+{
+	int blockCount = (int)blockLive.size();
+	std::vector<int> offsets(blockCount + 1, 0);
+	float minDepth = FLT_MAX;
+	float maxDepth = -FLT_MAX;
+	for (int b = 0; b < blockCount; b++)
+	{
+		offsets[b + 1] = offsets[b] + blockLive[b];
+		minDepth = std::min(minDepth, blockMin[b]);
+		maxDepth = std::max(maxDepth, blockMax[b]);
+	}
+	int live = offsets[blockCount];
+	order.resize(live);
+	scratchOrder.resize(live);
+	if (live == 0)
+		return;
+
+	//the live slots and their keys packed together, the farthest gets the smallest key
+	float scale = maxDepth > minDepth ? 65535.0f / (maxDepth - minDepth) : 0.0f;
+	auto pack = [&](int block)
+	{
+		int start = block * SORT_BLOCK_SIZE;
+		int end = std::min(start + SORT_BLOCK_SIZE, count);
+		int out = offsets[block];
+		for (int slot = start; slot < end; slot++)
+		{
+			if (depths[slot] == -FLT_MAX)
+				continue;
+			scratchOrder[out] = slot;
+			scratchKeys[out] = (unsigned short)(65535 - (int)((depths[slot] - minDepth) * scale));
+			out++;
+		}
+	};
+	if (threads && blockCount > 1)
+		threads->ParallelFor(blockCount, pack);
+	else
+	{
+		for (int block = 0; block < blockCount; block++)
+			pack(block);
+	}
+
+	//two stable passes, low byte then high byte. every block counts its digits, the counts
+	//give each block where its run of each digit starts, then every block scatters its own
+	int sortBlocks = (live + SORT_BLOCK_SIZE - 1) / SORT_BLOCK_SIZE;
+	histograms.resize(sortBlocks * 256);
+	unsigned int* sourceOrder = scratchOrder.data();
+	unsigned short* sourceKeys = scratchKeys.data();
+	unsigned int* targetOrder = order.data();
+	unsigned short* targetKeys = keys.data();
+	for (int shift = 0; shift < 16; shift += 8)
+	{
+		auto histogram = [&](int block)
+		{
+			int* digits = &histograms[block * 256];
+			std::fill(digits, digits + 256, 0);
+			int end = std::min((block + 1) * SORT_BLOCK_SIZE, live);
+			for (int i = block * SORT_BLOCK_SIZE; i < end; i++)
+				digits[(sourceKeys[i] >> shift) & 255]++;
+		};
+		auto scatter = [&](int block)
+		{
+			int* digits = &histograms[block * 256];
+			int end = std::min((block + 1) * SORT_BLOCK_SIZE, live);
+			for (int i = block * SORT_BLOCK_SIZE; i < end; i++)
+			{
+				int out = digits[(sourceKeys[i] >> shift) & 255]++;
+				targetOrder[out] = sourceOrder[i];
+				targetKeys[out] = sourceKeys[i];
+			}
+		};
+
+		if (threads && sortBlocks > 1)
+			threads->ParallelFor(sortBlocks, histogram);
+		else
+		{
+			for (int block = 0; block < sortBlocks; block++)
+				histogram(block);
+		}
+
+		int total = 0;
+		for (int digit = 0; digit < 256; digit++)
+		{
+			for (int block = 0; block < sortBlocks; block++)
+			{
+				int n = histograms[block * 256 + digit];
+				histograms[block * 256 + digit] = total;
+				total += n;
+			}
+		}
+
+		if (threads && sortBlocks > 1)
+			threads->ParallelFor(sortBlocks, scatter);
+		else
+		{
+			for (int block = 0; block < sortBlocks; block++)
+				scatter(block);
+		}
+
+		std::swap(sourceOrder, targetOrder);
+		std::swap(sourceKeys, targetKeys);
+	}
+
+	//after two passes the result is back in scratchOrder
+	std::swap(order, scratchOrder);
+}
+
+const std::vector<unsigned int>& ParticleSorter::GetOrder() const
+{
+	return order;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include"Particles.h"
+#include"ThreadPool.h"
+#include<vector>
+
+//puts the live particles of the pool in back to front order for alpha blending. the key is
+//each particle's depth along the camera's forward axis, quantized to 16 bits over the range
+//the particles cover and radix sorted in two passes of eight bits, with blocks of particles
+//histogrammed and scattered on a ThreadPool. every sort is a full one, dense particles move
+//past too many of their neighbours between frames for last frame's order to be worth fixing up
+class ParticleSorter
+{
+	std::vector<unsigned int> order;
+	std::vector<unsigned int> scratchOrder;
+	std::vector<unsigned short> keys;
+	std::vector<unsigned short> scratchKeys;
+	std::vector<float> depths; //for every slot, -FLT_MAX when it is dead
+
+	//for each block the live slots in it, the depths they span and their histograms
+	std::vector<int> blockLive;
+	std::vector<float> blockMin;
+	std::vector<float> blockMax;
+	std::vector<int> histograms;
+
+	void FindDepths(const Particle* particles, int count, const ParticleEmitterData* emitters, const unsigned char* visible, XMFLOAT4 plane, float currentTime, ThreadPool* threads);
+	void RadixSort(int count, ThreadPool* threads);
+
+public:
+	//orders the live particles among the first count slots. plane is the camera's forward axis
+	//and offset, a point's depth is dot(plane.xyz, point) + plane.w. particles of emitters
+	//visible has a 0 for are left out, visible can be null to keep them all
+	void Sort(const Particle* particles, int count, const ParticleEmitterData* emitters, const unsigned char* visible, XMFLOAT4 plane, float currentTime, ThreadPool* threads);
+
+	//slots of the live particles, farthest first
+	const std::vector<unsigned int>& GetOrder() const;
+};
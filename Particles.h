@@ -13,7 +13,20 @@ struct Particle
 	XMFLOAT3 startVelocity;
 
 	float rotationEnd;
-	XMFLOAT3 padding;
+	unsigned int emitterIndex; //which ParticleEmitterData it is drawn with
+	XMFLOAT2 padding;
+};
+
+//what every particle of one emitter shares, ParticlesVS reads it by the particle's emitterIndex
+struct ParticleEmitterData
+{
+	XMFLOAT4 startColor;
+	XMFLOAT4 endColor;
+	XMFLOAT3 acceleration;
+	float lifetime;
+	float startSize;
+	float endSize;
+	XMFLOAT2 padding;
 };
 
 //single vertex of a particle
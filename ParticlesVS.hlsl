@@ -3,17 +3,6 @@ cbuffer externalData: register(b0)
 	matrix view;
 	matrix projection;
 
-	int startIndex;
-
-	float3 acceleration;
-
-	float4 startColor;
-	float4 endColor;
-
-	float startSize;
-	float endSize;
-
-	float lifetime;
 	float currentTime;
 };
 
@@ -26,7 +15,19 @@ struct Particle
 	float3 startVelocity;
 
 	float rotationEnd;
-	float3 padding;
+	uint emitterIndex;
+	float2 padding;
+};
+
+struct EmitterData
+{
+	float4 startColor;
+	float4 endColor;
+	float3 acceleration;
+	float lifetime;
+	float startSize;
+	float endSize;
+	float2 padding;
 };
 
 struct VertexToPixel
@@ -36,7 +37,10 @@ struct VertexToPixel
 	float4 color: COLOR;
 };
 
+//every emitter's particles, what each emitter's share, and the live ones farthest first
 StructuredBuffer<Particle> ParticleData: register(t0);
+StructuredBuffer<EmitterData> Emitters: register(t1);
+StructuredBuffer<uint> DrawOrder: register(t2);
 
 VertexToPixel main(uint id: SV_VertexID)
 {
@@ -45,14 +49,24 @@ VertexToPixel main(uint id: SV_VertexID)
 	uint particleID = id / 4; //every group of 4 vertex is a particle
 	uint cornerID = id % 4;
 
-	Particle p = ParticleData.Load(particleID + startIndex);
+	Particle p = ParticleData.Load(DrawOrder.Load(particleID));
+	EmitterData e = Emitters.Load(p.emitterIndex);
 
 	float t = currentTime - p.spawnTime;
-	float percent = t / lifetime; //percent to lerp with
+	float percent = t / e.lifetime; //percent to lerp with
 
-	float3 pos = 0.5 * t * t * acceleration + t * p.startVelocity + p.startPosition;
-	float4 color = lerp(startColor, endColor, percent);
-	float size = lerp(startSize, endSize, percent);
+	//the order only has live particles, anything else collapses to a point and draws nothing
+	if (t < 0 || t >= e.lifetime)
+	{
+		output.position = float4(0, 0, 0, 0);
+		output.uv = float2(0, 0);
+		output.color = float4(0, 0, 0, 0);
+		return output;
+	}
+
+	float3 pos = 0.5 * t * t * e.acceleration + t * p.startVelocity + p.startPosition;
+	float4 color = lerp(e.startColor, e.endColor, percent);
+	float size = lerp(e.startSize, e.endSize, percent);
 	float rotation = lerp(p.rotationStart, p.rotationEnd, percent);
 
 	float2 offsets[4];
@@ -0,0 +1,62 @@
+#include "Philox.h"
+#include<cmath>
+
+static const unsigned int PHILOX_M0 = 0xD2511F53;
+static const unsigned int PHILOX_M1 = 0xCD9E8D57;
+static const unsigned int PHILOX_W0 = 0x9E3779B9; //the golden ratio
+static const unsigned int PHILOX_W1 = 0xBB67AE85; //sqrt(3) - 1
+static const int PHILOX_ROUNDS = 10;
+
+Philox::Philox(unsigned int seed, unsigned int stream)
+{
+	key[0] = seed;
+	key[1] = stream;
+}
+
+void Philox::Generate(const unsigned int counter[4], unsigned int output[4]) const
+{
+	unsigned int c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+	unsigned int k0 = key[0], k1 = key[1];
+	for (int round = 0; round < PHILOX_ROUNDS; round++)
+	{
+		unsigned long long product0 = (unsigned long long)PHILOX_M0 * c0;
+		unsigned long long product1 = (unsigned long long)PHILOX_M1 * c2;
+		unsigned int hi0 = (unsigned int)(product0 >> 32), lo0 = (unsigned int)product0;
+		unsigned int hi1 = (unsigned int)(product1 >> 32), lo1 = (unsigned int)product1;
+
+		c0 = hi1 ^ c1 ^ k0;
+		c1 = lo1;
+		c2 = hi0 ^ c3 ^ k1;
+		c3 = lo0;
+
+		k0 += PHILOX_W0;
+		k1 += PHILOX_W1;
+	}
+	output[0] = c0;
+	output[1] = c1;
+	output[2] = c2;
+	output[3] = c3;
+}
+
+void Philox::Gaussian(const unsigned int counter[4], float output[4]) const
+{
+	unsigned int bits[4];
+	Generate(counter, bits);
+
+	//the top 24 bits as a float in (0, 1], never zero so the log is safe
+	float uniform[4];
+	for (int i = 0; i < 4; i++)
+	{
+		uniform[i] = ((bits[i] >> 8) + 1) * (1.0f / 16777216.0f);
+	}
+
+	//box muller, two normal numbers from every two uniform ones
+	const float twoPi = 6.28318531f;
+	for (int i = 0; i < 4; i += 2)
+	{
+		float radius = sqrtf(-2.0f * logf(uniform[i]));
+		float angle = twoPi * uniform[i + 1];
+		output[i] = radius * cosf(angle);
+		output[i + 1] = radius * sinf(angle);
+	}
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+//counter based random numbers, philox 4x32 with 10 rounds. the same counter and seed always
+//give the same four numbers, so every texel can make its own on any thread in any order
+class Philox
+{
+	unsigned int key[2];
+
+public:
+	Philox(unsigned int seed, unsigned int stream = 0);
+
+	//four random 32 bit numbers for the counter
+	void Generate(const unsigned int counter[4], unsigned int output[4]) const;
+	//four numbers from a normal distribution with mean zero and variance one
+	void Gaussian(const unsigned int counter[4], float output[4]) const;
+};
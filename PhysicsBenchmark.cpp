@@ -0,0 +1,710 @@
+#include "PhysicsBenchmark.h"
+#include "OceanBenchmark.h"
+#include "ParticleBenchmark.h"
+#include "SweepAndPrune.h"
+#include "RigidBody.h"
+#include "OrientedBox.h"
+#include "AABBTree.h"
+#include "PairCache.h"
+#include "HeightField.h"
+#include<chrono>
+#include<random>
+#include<vector>
+#include<cmath>
+#include<algorithm>
+#include<cstdio>
+
+using namespace DirectX;
+
+void RunBroadphaseBenchmark(int bodyCount, int frameCount, unsigned int seed)
+{
+	std::mt19937 randomGenerator(seed);
+
+	//spreading the bodies so that every body overlaps a handful of others
+	float worldSize = 20.0f * powf((float)bodyCount, 1.0f / 3.0f);
+	std::uniform_real_distribution<float> position(-worldSize, worldSize);
+	std::uniform_real_distribution<float> extent(0.5f, 2.0f);
+	std::uniform_real_distribution<float> velocity(-1.0f, 1.0f);
+
+	std::vector<XMFLOAT3> centers(bodyCount);
+	std::vector<XMFLOAT3> halfSizes(bodyCount);
+	std::vector<XMFLOAT3> velocities(bodyCount);
+	std::vector<XMFLOAT3> mins(bodyCount);
+	std::vector<XMFLOAT3> maxs(bodyCount);
+
+	for (int i = 0; i < bodyCount; i++)
+	{
+		centers[i] = XMFLOAT3(position(randomGenerator), position(randomGenerator), position(randomGenerator));
+		halfSizes[i] = XMFLOAT3(extent(randomGenerator), extent(randomGenerator), extent(randomGenerator));
+		velocities[i] = XMFLOAT3(velocity(randomGenerator), velocity(randomGenerator), velocity(randomGenerator));
+	}
+
+	SweepAndPrune broadphase;
+	std::vector<int> proxies(bodyCount);
+
+	double sapSeconds = 0;
+	double bruteSeconds = 0;
+	size_t sapPairs = 0;
+	size_t brutePairs = 0;
+	float dt = 1.0f / 60.0f;
+
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		for (int i = 0; i < bodyCount; i++)
+		{
+			XMStoreFloat3(&centers[i], XMLoadFloat3(&centers[i]) + XMLoadFloat3(&velocities[i]) * dt);
+			XMStoreFloat3(&mins[i], XMLoadFloat3(&centers[i]) - XMLoadFloat3(&halfSizes[i]));
+			XMStoreFloat3(&maxs[i], XMLoadFloat3(&centers[i]) + XMLoadFloat3(&halfSizes[i]));
+		}
+
+		auto start = std::chrono::high_resolution_clock::now();
+
+		for (int i = 0; i < bodyCount; i++)
+		{
+			if (frame == 0)
+				proxies[i] = broadphase.AddProxy(mins[i], maxs[i], nullptr);
+			else
+				broadphase.UpdateProxy(proxies[i], mins[i], maxs[i]);
+		}
+		sapPairs += broadphase.FindPairs().size();
+
+		auto middle = std::chrono::high_resolution_clock::now();
+
+		//the old loop, every body against every other body
+		for (int i = 0; i < bodyCount; i++)
+		{
+			for (int j = i + 1; j < bodyCount; j++)
+			{
+				if (mins[i].x <= maxs[j].x && mins[j].x <= maxs[i].x &&
+					mins[i].y <= maxs[j].y && mins[j].y <= maxs[i].y &&
+					mins[i].z <= maxs[j].z && mins[j].z <= maxs[i].z)
+				{
+					brutePairs++;
+				}
+			}
+		}
+
+		auto end = std::chrono::high_resolution_clock::now();
+
+		sapSeconds += std::chrono::duration<double>(middle - start).count();
+		bruteSeconds += std::chrono::duration<double>(end - middle).count();
+	}
+
+	printf("broadphase: %d bodies, %d frames\n", bodyCount, frameCount);
+	printf("  sweep and prune: %8.3f ms/frame, %zu pairs\n", sapSeconds * 1000.0 / frameCount, sapPairs);
+	printf("  all pairs:       %8.3f ms/frame, %zu pairs\n", bruteSeconds * 1000.0 / frameCount, brutePairs);
+}
+
+void RunNarrowphaseBenchmark(int pairCount, int repeatCount, unsigned int seed)
+{
+	std::mt19937 randomGenerator(seed);
+	std::uniform_real_distribution<float> position(-3.0f, 3.0f);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> angle(0.0f, XM_2PI);
+
+	//a unit cube, the same corners a cube.obj rigid body ends up with
+	std::vector<XMFLOAT3> cubePoints;
+	for (int i = 0; i < 8; i++)
+	{
+		cubePoints.emplace_back(XMFLOAT3(i & 1 ? 0.5f : -0.5f, i & 2 ? 0.5f : -0.5f, i & 4 ? 0.5f : -0.5f));
+	}
+
+	std::shared_ptr<const CollisionShape> cubeShape = std::make_shared<const CollisionShape>(cubePoints);
+
+	//no scaling, the old test uses the unscaled radius for its sphere check and would
+	//reject pairs that really do overlap
+	std::vector<std::shared_ptr<RigidBody>> bodies(pairCount * 2);
+	for (size_t i = 0; i < bodies.size(); i++)
+	{
+		XMVECTOR axis = XMVector3Normalize(XMVectorSet(unit(randomGenerator), unit(randomGenerator), unit(randomGenerator), 0.0f));
+		XMMATRIX rotation = XMMatrixRotationQuaternion(XMQuaternionRotationAxis(axis, angle(randomGenerator)));
+		XMMATRIX translation = XMMatrixTranslation(position(randomGenerator), position(randomGenerator), position(randomGenerator));
+
+		XMFLOAT4X4 model;
+		XMStoreFloat4x4(&model, rotation * translation);
+		bodies[i] = std::make_shared<RigidBody>(cubeShape);
+		bodies[i]->SetModelMatrix(model);
+	}
+
+	std::vector<OrientedBox> boxesA(pairCount);
+	std::vector<OrientedBox> boxesB(pairCount);
+	for (int i = 0; i < pairCount; i++)
+	{
+		boxesA[i] = bodies[i * 2]->GetOrientedBox();
+		boxesB[i] = bodies[i * 2 + 1]->GetOrientedBox();
+	}
+
+	std::vector<bool> referenceResults(pairCount);
+	std::vector<bool> stackResults(pairCount);
+	bool* batchResults = new bool[pairCount];
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int repeat = 0; repeat < repeatCount; repeat++)
+	{
+		for (int i = 0; i < pairCount; i++)
+		{
+			referenceResults[i] = bodies[i * 2]->SATCollisionReference(bodies[i * 2 + 1]);
+		}
+	}
+	auto afterReference = std::chrono::high_resolution_clock::now();
+	for (int repeat = 0; repeat < repeatCount; repeat++)
+	{
+		for (int i = 0; i < pairCount; i++)
+		{
+			stackResults[i] = bodies[i * 2]->SATCollision(bodies[i * 2 + 1]);
+		}
+	}
+	auto afterStack = std::chrono::high_resolution_clock::now();
+	for (int repeat = 0; repeat < repeatCount; repeat++)
+	{
+		OBBOverlapBatch(boxesA.data(), boxesB.data(), pairCount, batchResults);
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+
+	int overlapping = 0;
+	int referenceMismatches = 0;
+	int batchMismatches = 0;
+	for (int i = 0; i < pairCount; i++)
+	{
+		if (stackResults[i]) overlapping++;
+		if (stackResults[i] != referenceResults[i]) referenceMismatches++;
+		if (stackResults[i] != batchResults[i]) batchMismatches++;
+	}
+	delete[] batchResults;
+
+	double tests = (double)pairCount * repeatCount;
+	printf("narrowphase: %d pairs, %d repeats, %d overlapping\n", pairCount, repeatCount, overlapping);
+	printf("  vectors (old): %8.1f ns/pair\n", std::chrono::duration<double>(afterReference - start).count() * 1e9 / tests);
+	printf("  stack:         %8.1f ns/pair, %d differ from old\n", std::chrono::duration<double>(afterStack - afterReference).count() * 1e9 / tests, referenceMismatches);
+	printf("  batch of 4:    %8.1f ns/pair, %d differ from stack\n", std::chrono::duration<double>(end - afterStack).count() * 1e9 / tests, batchMismatches);
+}
+
+void RunSpatialQueryBenchmark(int bodyCount, int queryCount, unsigned int seed)
+{
+	std::mt19937 randomGenerator(seed);
+	float worldSize = 20.0f * powf((float)bodyCount, 1.0f / 3.0f);
+	std::uniform_real_distribution<float> position(-worldSize, worldSize);
+	std::uniform_real_distribution<float> extent(0.5f, 2.0f);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	std::vector<XMFLOAT3> mins(bodyCount);
+	std::vector<XMFLOAT3> maxs(bodyCount);
+	std::vector<int> proxies(bodyCount);
+	AABBTree tree;
+
+	for (int i = 0; i < bodyCount; i++)
+	{
+		XMVECTOR center = XMVectorSet(position(randomGenerator), position(randomGenerator), position(randomGenerator), 0.0f);
+		XMVECTOR half = XMVectorReplicate(extent(randomGenerator));
+		XMStoreFloat3(&mins[i], center - half);
+		XMStoreFloat3(&maxs[i], center + half);
+		proxies[i] = tree.CreateProxy(mins[i], maxs[i], (void*)(size_t)(i + 1));
+	}
+
+	//moving everything a few times so the queries run on a refitted tree
+	int reinserted = 0;
+	for (int step = 0; step < 10; step++)
+	{
+		for (int i = 0; i < bodyCount; i++)
+		{
+			XMVECTOR offset = XMVectorSet(unit(randomGenerator), unit(randomGenerator), unit(randomGenerator), 0.0f) * 0.3f;
+			XMStoreFloat3(&mins[i], XMLoadFloat3(&mins[i]) + offset);
+			XMStoreFloat3(&maxs[i], XMLoadFloat3(&maxs[i]) + offset);
+			if (tree.MoveProxy(proxies[i], mins[i], maxs[i]))
+				reinserted++;
+		}
+	}
+
+	std::vector<XMFLOAT3> origins(queryCount);
+	std::vector<XMFLOAT3> directions(queryCount);
+	for (int i = 0; i < queryCount; i++)
+	{
+		origins[i] = XMFLOAT3(position(randomGenerator), position(randomGenerator), position(randomGenerator));
+		XMStoreFloat3(&directions[i], XMVector3Normalize(XMVectorSet(unit(randomGenerator), unit(randomGenerator), unit(randomGenerator), 0.0f)));
+	}
+
+	float maxDistance = worldSize;
+	std::vector<size_t> treeHits(queryCount);
+	std::vector<size_t> scanHits(queryCount);
+	size_t treeSphereHits = 0;
+	size_t scanSphereHits = 0;
+	std::vector<void*> results;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < queryCount; i++)
+	{
+		float distance;
+		treeHits[i] = (size_t)tree.RayCast(origins[i], directions[i], maxDistance, distance);
+	}
+	auto afterTreeRays = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < queryCount; i++)
+	{
+		//closest entry over every box
+		float closest = maxDistance;
+		scanHits[i] = 0;
+		for (int j = 0; j < bodyCount; j++)
+		{
+			float tMin = 0.0f;
+			float tMax = closest;
+			const float* o = &origins[i].x;
+			const float* d = &directions[i].x;
+			const float* bMin = &mins[j].x;
+			const float* bMax = &maxs[j].x;
+			for (int k = 0; k < 3 && tMin <= tMax; k++)
+			{
+				float t1 = (bMin[k] - o[k]) / d[k];
+				float t2 = (bMax[k] - o[k]) / d[k];
+				tMin = std::max(tMin, std::min(t1, t2));
+				tMax = std::min(tMax, std::max(t1, t2));
+			}
+			if (tMin <= tMax)
+			{
+				closest = tMin;
+				scanHits[i] = j + 1;
+			}
+		}
+	}
+	auto afterScanRays = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < queryCount; i++)
+	{
+		results.clear();
+		tree.QuerySphere(origins[i], 10.0f, results);
+		treeSphereHits += results.size();
+	}
+	auto afterTreeSpheres = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < queryCount; i++)
+	{
+		XMVECTOR center = XMLoadFloat3(&origins[i]);
+		for (int j = 0; j < bodyCount; j++)
+		{
+			XMVECTOR closest = XMVectorClamp(center, XMLoadFloat3(&mins[j]), XMLoadFloat3(&maxs[j]));
+			if (XMVectorGetX(XMVector3LengthSq(closest - center)) <= 100.0f)
+				scanSphereHits++;
+		}
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+
+	int rayMismatches = 0;
+	for (int i = 0; i < queryCount; i++)
+	{
+		if (treeHits[i] != scanHits[i]) rayMismatches++;
+	}
+
+	printf("spatial queries: %d bodies, %d queries, tree height %d, %d re-inserts in 10 moves\n",
+		bodyCount, queryCount, tree.GetHeight(), reinserted);
+	printf("  ray tree:      %8.2f us/query, %d differ from scan\n", std::chrono::duration<double>(afterTreeRays - start).count() * 1e6 / queryCount, rayMismatches);
+	printf("  ray scan:      %8.2f us/query\n", std::chrono::duration<double>(afterScanRays - afterTreeRays).count() * 1e6 / queryCount);
+	printf("  sphere tree:   %8.2f us/query, %zu hits\n", std::chrono::duration<double>(afterTreeSpheres - afterScanRays).count() * 1e6 / queryCount, treeSphereHits);
+	printf("  sphere scan:   %8.2f us/query, %zu hits\n", std::chrono::duration<double>(end - afterTreeSpheres).count() * 1e6 / queryCount, scanSphereHits);
+
+	//the way Game uses it: turning bodies whose proxies follow them once a step, then shots
+	//traced over the step they flew with the callback testing the oriented boxes
+	std::vector<XMFLOAT3> cube;
+	for (int corner = 0; corner < 8; corner++)
+		cube.push_back(XMFLOAT3(corner & 1 ? 1.0f : -1.0f, corner & 2 ? 1.0f : -1.0f, corner & 4 ? 1.0f : -1.0f));
+	int movingCount = bodyCount / 10;
+	std::vector<std::shared_ptr<RigidBody>> bodies(movingCount);
+	std::vector<XMFLOAT3> centers(movingCount);
+	std::vector<XMFLOAT3> spins(movingCount);
+	std::vector<int> movingProxies(movingCount);
+	AABBTree movingTree;
+	auto place = [&](int i, float time)
+	{
+		XMMATRIX world = XMMatrixScaling(1.5f, 0.5f, 3.0f) *
+			XMMatrixRotationQuaternion(XMQuaternionRotationAxis(XMLoadFloat3(&spins[i]), time * 2.0f)) *
+			XMMatrixTranslation(centers[i].x, centers[i].y + sinf(time + i) * 2.0f, centers[i].z);
+		XMFLOAT4X4 matrix;
+		XMStoreFloat4x4(&matrix, world);
+		bodies[i]->SetModelMatrix(matrix);
+	};
+	for (int i = 0; i < movingCount; i++)
+	{
+		bodies[i] = std::make_shared<RigidBody>(cube);
+		centers[i] = XMFLOAT3(position(randomGenerator) * 0.15f, position(randomGenerator) * 0.15f, position(randomGenerator) * 0.15f);
+		XMStoreFloat3(&spins[i], XMVector3Normalize(XMVectorSet(unit(randomGenerator), unit(randomGenerator), unit(randomGenerator), 0.0f)));
+		place(i, 0.0f);
+		movingProxies[i] = movingTree.CreateProxy(bodies[i]->GetMinGlobal(), bodies[i]->GetMaxGlobal(), (void*)(size_t)(i + 1));
+	}
+
+	int shotCount = 0;
+	int shotHits = 0;
+	int shotMismatches = 0;
+	double shotTreeSeconds = 0;
+	for (int step = 1; step <= 60; step++)
+	{
+		float time = step / 60.0f;
+		for (int i = 0; i < movingCount; i++)
+		{
+			place(i, time);
+			movingTree.MoveProxy(movingProxies[i], bodies[i]->GetMinGlobal(), bodies[i]->GetMaxGlobal());
+		}
+
+		for (int shot = 0; shot < queryCount / 10; shot++)
+		{
+			XMFLOAT3 from(position(randomGenerator) * 0.15f, position(randomGenerator) * 0.15f, position(randomGenerator) * 0.15f);
+			XMFLOAT3 direction;
+			XMStoreFloat3(&direction, XMVector3Normalize(XMVectorSet(unit(randomGenerator), unit(randomGenerator), unit(randomGenerator), 0.0f)));
+			float length = 60.0f;
+
+			auto shotStart = std::chrono::high_resolution_clock::now();
+			float hitDistance;
+			size_t hit = (size_t)movingTree.RayCast(from, direction, length, hitDistance,
+				[&](int proxy, void* userData, float closest)
+				{
+					float distance;
+					size_t index = (size_t)userData - 1;
+					if (!RayOBB(bodies[index]->GetOrientedBox(), from, direction, closest, distance))
+						return -1.0f;
+					return distance;
+				});
+			shotTreeSeconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - shotStart).count();
+
+			size_t scanHit = 0;
+			float closest = length;
+			for (int i = 0; i < movingCount; i++)
+			{
+				float distance;
+				if (RayOBB(bodies[i]->GetOrientedBox(), from, direction, closest, distance))
+				{
+					closest = distance;
+					scanHit = i + 1;
+				}
+			}
+
+			shotCount++;
+			if (hit != 0)
+				shotHits++;
+			if (hit != scanHit)
+				shotMismatches++;
+		}
+	}
+	printf("  shots:         %8.2f us/query through %d turning bodies, %d of %d hit, %d differ from scan\n",
+		shotTreeSeconds * 1e6 / shotCount, movingCount, shotHits, shotCount, shotMismatches);
+}
+
+void RunConvexBenchmark(int pairCount, int frameCount, unsigned int seed)
+{
+	std::mt19937 randomGenerator(seed);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> angle(0.0f, XM_2PI);
+
+	//a lumpy rock, points inside a squashed sphere
+	std::vector<XMFLOAT3> rockPoints;
+	while (rockPoints.size() < 300)
+	{
+		XMFLOAT3 p(unit(randomGenerator), unit(randomGenerator), unit(randomGenerator));
+		if (p.x * p.x + p.y * p.y + p.z * p.z <= 1.0f)
+			rockPoints.emplace_back(XMFLOAT3(p.x * 1.5f, p.y * 0.7f, p.z));
+	}
+	std::shared_ptr<const CollisionShape> rockShape = std::make_shared<const CollisionShape>(rockPoints);
+
+	//the sphere around the box, what the early out used before the minimal one
+	XMFLOAT3 rockMin = rockShape->GetMin();
+	XMFLOAT3 rockMax = rockShape->GetMax();
+	XMVECTOR boxCenter = (XMLoadFloat3(&rockMin) + XMLoadFloat3(&rockMax)) * 0.5f;
+	float boxRadius = XMVectorGetX(XMVector3Length(XMLoadFloat3(&rockMax) - boxCenter));
+
+	//every pair starts close enough for the boxes to overlap some of the time
+	std::vector<std::shared_ptr<RigidBody>> bodies(pairCount * 2);
+	std::vector<XMFLOAT3> axes(pairCount * 2);
+	std::vector<float> phases(pairCount * 2);
+	for (size_t i = 0; i < bodies.size(); i++)
+	{
+		bodies[i] = std::make_shared<RigidBody>(rockShape);
+		XMStoreFloat3(&axes[i], XMVector3Normalize(XMVectorSet(unit(randomGenerator), unit(randomGenerator), unit(randomGenerator), 0.0f)));
+		phases[i] = angle(randomGenerator);
+	}
+
+	PairCache pairCache;
+	double coldSeconds = 0.0;
+	double warmSeconds = 0.0;
+	int mismatches = 0;
+	int boxOverlaps = 0;
+	int hullOverlaps = 0;
+	int sphereOverlaps = 0;
+	int boxSphereOverlaps = 0;
+	int sphereMisses = 0;
+
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		float t = frame * (1.0f / 60.0f);
+		for (size_t i = 0; i < bodies.size(); i++)
+		{
+			//the pairs orbit each other slowly while tumbling
+			float side = (i & 1) ? 1.0f : -1.0f;
+			float offset = 1.4f + 0.6f * sinf(t + phases[i]);
+			XMMATRIX rotation = XMMatrixRotationQuaternion(XMQuaternionRotationAxis(XMLoadFloat3(&axes[i]), phases[i] + t));
+			XMMATRIX translation = XMMatrixTranslation(side * offset + (float)(i / 2) * 10.0f, 0.0f, 0.0f);
+
+			XMFLOAT4X4 model;
+			XMStoreFloat4x4(&model, rotation * translation);
+			bodies[i]->SetModelMatrix(model);
+		}
+
+		auto start = std::chrono::high_resolution_clock::now();
+		int coldHits = 0;
+		for (int i = 0; i < pairCount; i++)
+		{
+			if (bodies[i * 2]->ConvexCollision(bodies[i * 2 + 1])) coldHits++;
+		}
+		auto afterCold = std::chrono::high_resolution_clock::now();
+
+		pairCache.BeginFrame();
+		int warmHits = 0;
+		for (int i = 0; i < pairCount; i++)
+		{
+			if (bodies[i * 2]->ConvexCollision(bodies[i * 2 + 1], pairCache.Get(i * 2, i * 2 + 1))) warmHits++;
+		}
+		pairCache.EvictStale();
+		auto end = std::chrono::high_resolution_clock::now();
+
+		coldSeconds += std::chrono::duration<double>(afterCold - start).count();
+		warmSeconds += std::chrono::duration<double>(end - afterCold).count();
+		mismatches += abs(coldHits - warmHits);
+		hullOverlaps += warmHits;
+
+		for (int i = 0; i < pairCount; i++)
+		{
+			if (bodies[i * 2]->SATCollision(bodies[i * 2 + 1])) boxOverlaps++;
+		}
+
+		//the minimal spheres against the box's and against gjk without any early out
+		for (int i = 0; i < pairCount; i++)
+		{
+			XMFLOAT4X4 modelA = bodies[i * 2]->GetModelMatrix();
+			XMFLOAT4X4 modelB = bodies[i * 2 + 1]->GetModelMatrix();
+			bool spheres = bodies[i * 2]->BoundingSphereCheck(bodies[i * 2 + 1]);
+			if (spheres) sphereOverlaps++;
+
+			XMVECTOR centerA = XMVector3TransformCoord(boxCenter, XMLoadFloat4x4(&modelA));
+			XMVECTOR centerB = XMVector3TransformCoord(boxCenter, XMLoadFloat4x4(&modelB));
+			if (XMVectorGetX(XMVector3Length(centerA - centerB)) < boxRadius * 2.0f) boxSphereOverlaps++;
+
+			if (!spheres && GJKCollision(rockShape->GetHull(), modelA, rockShape->GetHull(), modelB, nullptr, nullptr)) sphereMisses++;
+		}
+	}
+
+	double tests = (double)pairCount * frameCount;
+	printf("convex: %d pairs, %d frames, %d hull vertices\n", pairCount, frameCount, (int)rockShape->GetHull().GetVertices().size());
+	printf("  boxes overlap %d times, hulls only %d times\n", boxOverlaps, hullOverlaps);
+	printf("  minimal spheres overlap %d times, the box's spheres %d times, %d hull hits missed\n", sphereOverlaps, boxSphereOverlaps, sphereMisses);
+	printf("  gjk cold:      %8.1f ns/pair\n", coldSeconds * 1e9 / tests);
+	printf("  gjk warm:      %8.1f ns/pair, %d differ from cold\n", warmSeconds * 1e9 / tests, mismatches);
+}
+
+void RunSeparatingAxisBenchmark(int pairCount, int frameCount, unsigned int seed)
+{
+	std::mt19937 randomGenerator(seed);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> angle(0.0f, XM_2PI);
+	std::uniform_real_distribution<float> gap(1.3f, 1.9f);
+
+	std::vector<XMFLOAT3> cubePoints;
+	for (int i = 0; i < 8; i++)
+	{
+		cubePoints.emplace_back(XMFLOAT3(i & 1 ? 0.5f : -0.5f, i & 2 ? 0.5f : -0.5f, i & 4 ? 0.5f : -0.5f));
+	}
+	std::shared_ptr<const CollisionShape> cubeShape = std::make_shared<const CollisionShape>(cubePoints);
+
+	//the second box of every pair sits just out of reach in a random direction
+	std::vector<std::shared_ptr<RigidBody>> bodies(pairCount * 2);
+	std::vector<XMFLOAT3> axes(pairCount * 2);
+	std::vector<XMFLOAT3> offsets(pairCount);
+	std::vector<float> phases(pairCount * 2);
+	for (size_t i = 0; i < bodies.size(); i++)
+	{
+		bodies[i] = std::make_shared<RigidBody>(cubeShape);
+		XMStoreFloat3(&axes[i], XMVector3Normalize(XMVectorSet(unit(randomGenerator), unit(randomGenerator), unit(randomGenerator), 0.0f)));
+		phases[i] = angle(randomGenerator);
+	}
+	for (int i = 0; i < pairCount; i++)
+	{
+		XMVECTOR direction = XMVector3Normalize(XMVectorSet(unit(randomGenerator), unit(randomGenerator), unit(randomGenerator), 0.0f));
+		XMStoreFloat3(&offsets[i], direction * gap(randomGenerator));
+	}
+
+	//the lookup is paid for anyway by whoever tests the pair, so it isn't timed
+	PairCache pairCache;
+	std::vector<CollisionCache*> caches(pairCount);
+	for (int i = 0; i < pairCount; i++)
+	{
+		caches[i] = pairCache.Get(i * 2, i * 2 + 1);
+	}
+	std::vector<bool> coldResults(pairCount);
+	std::vector<bool> warmResults(pairCount);
+	double coldSeconds = 0.0;
+	double warmSeconds = 0.0;
+	int mismatches = 0;
+	int overlapping = 0;
+
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		float t = frame * (1.0f / 60.0f) * 0.2f;
+		for (size_t i = 0; i < bodies.size(); i++)
+		{
+			XMMATRIX rotation = XMMatrixRotationQuaternion(XMQuaternionRotationAxis(XMLoadFloat3(&axes[i]), phases[i] + t));
+			XMFLOAT3 offset = (i & 1) ? offsets[i / 2] : XMFLOAT3(0, 0, 0);
+			XMMATRIX translation = XMMatrixTranslation(offset.x + (float)(i / 2) * 10.0f, offset.y, offset.z);
+
+			XMFLOAT4X4 model;
+			XMStoreFloat4x4(&model, rotation * translation);
+			bodies[i]->SetModelMatrix(model);
+		}
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < pairCount; i++)
+		{
+			coldResults[i] = bodies[i * 2]->SATCollision(bodies[i * 2 + 1]);
+		}
+		auto afterCold = std::chrono::high_resolution_clock::now();
+
+		for (int i = 0; i < pairCount; i++)
+		{
+			warmResults[i] = bodies[i * 2]->SATCollision(bodies[i * 2 + 1], caches[i]);
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+
+		coldSeconds += std::chrono::duration<double>(afterCold - start).count();
+		warmSeconds += std::chrono::duration<double>(end - afterCold).count();
+
+		for (int i = 0; i < pairCount; i++)
+		{
+			if (warmResults[i] != coldResults[i]) mismatches++;
+			if (warmResults[i]) overlapping++;
+		}
+	}
+
+	double tests = (double)pairCount * frameCount;
+	printf("separating axis cache: %d pairs, %d frames, %d overlapping\n", pairCount, frameCount, overlapping);
+	printf("  all 15 axes:   %8.1f ns/pair\n", coldSeconds * 1e9 / tests);
+	printf("  cached first:  %8.1f ns/pair, %d differ\n", warmSeconds * 1e9 / tests, mismatches);
+}
+
+void RunHeightFieldBenchmark(int size, int queryCount, unsigned int seed)
+{
+	std::mt19937 randomGenerator(seed);
+
+	//hills with some smaller bumps on them, scaled like the valley heightmap
+	std::vector<unsigned short> heights(size * size);
+	for (int z = 0; z < size; z++)
+	{
+		for (int x = 0; x < size; x++)
+		{
+			float h = 32000.0f + 12000.0f * sinf(x * 0.05f) * cosf(z * 0.07f) + 8000.0f * sinf(x * 0.31f + z * 0.17f);
+			heights[z * size + x] = (unsigned short)h;
+		}
+	}
+	float spacing = 0.1f;
+	float half = (size - 1) * spacing * 0.5f;
+	HeightField field(heights, size, size, 20.0f / 65535.0f, spacing, -half, -half);
+
+	std::uniform_real_distribution<float> coordinate(-half, half);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::vector<float> x(queryCount);
+	std::vector<float> z(queryCount);
+	std::vector<float> single(queryCount);
+	std::vector<float> batch(queryCount);
+	for (int i = 0; i < queryCount; i++)
+	{
+		x[i] = coordinate(randomGenerator);
+		z[i] = coordinate(randomGenerator);
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < queryCount; i++)
+	{
+		single[i] = field.GetHeight(x[i], z[i]);
+	}
+	auto afterSingle = std::chrono::high_resolution_clock::now();
+	field.GetHeights(x.data(), z.data(), batch.data(), queryCount);
+	auto afterBatch = std::chrono::high_resolution_clock::now();
+
+	float largestError = 0.0f;
+	for (int i = 0; i < queryCount; i++)
+	{
+		largestError = std::max(largestError, fabsf(single[i] - batch[i]));
+	}
+
+	//rays from above the hills heading down at random angles
+	int rayCount = queryCount / 100;
+	std::vector<XMFLOAT3> origins(rayCount);
+	std::vector<XMFLOAT3> directions(rayCount);
+	for (int i = 0; i < rayCount; i++)
+	{
+		origins[i] = XMFLOAT3(coordinate(randomGenerator), 16.0f, coordinate(randomGenerator));
+		XMVECTOR direction = XMVector3Normalize(XMVectorSet(unit(randomGenerator), -0.3f - fabsf(unit(randomGenerator)), unit(randomGenerator), 0.0f));
+		XMStoreFloat3(&directions[i], direction);
+	}
+
+	std::vector<float> fastDistances(rayCount, -1.0f);
+	std::vector<float> slowDistances(rayCount, -1.0f);
+	auto rayStart = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < rayCount; i++)
+	{
+		float distance;
+		XMFLOAT3 normal;
+		if (field.RayCast(origins[i], directions[i], 100.0f, distance, normal))
+			fastDistances[i] = distance;
+	}
+	auto afterFast = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < rayCount; i++)
+	{
+		//a fiftieth of a sample per step
+		for (float t = 0.0f; t < 100.0f; t += spacing * 0.02f)
+		{
+			float px = origins[i].x + directions[i].x * t;
+			float pz = origins[i].z + directions[i].z * t;
+			if (!field.Contains(px, pz))
+				break;
+			if (origins[i].y + directions[i].y * t <= field.GetHeight(px, pz))
+			{
+				slowDistances[i] = t;
+				break;
+			}
+		}
+	}
+	auto rayEnd = std::chrono::high_resolution_clock::now();
+
+	int rayMismatches = 0;
+	for (int i = 0; i < rayCount; i++)
+	{
+		if ((fastDistances[i] < 0.0f) != (slowDistances[i] < 0.0f) || fabsf(fastDistances[i] - slowDistances[i]) > spacing * 0.2f)
+			rayMismatches++;
+	}
+
+	printf("height field: %dx%d samples, %d levels\n", size, size, field.GetLevelCount());
+	printf("  single:        %8.2f ns/point\n", std::chrono::duration<double>(afterSingle - start).count() * 1e9 / queryCount);
+	printf("  batch of 4:    %8.2f ns/point, largest difference %g\n", std::chrono::duration<double>(afterBatch - afterSingle).count() * 1e9 / queryCount, largestError);
+	printf("  ray pyramid:   %8.2f us/ray\n", std::chrono::duration<double>(afterFast - rayStart).count() * 1e6 / rayCount);
+	printf("  ray march:     %8.2f us/ray, %d differ\n", std::chrono::duration<double>(rayEnd - afterFast).count() * 1e6 / rayCount, rayMismatches);
+}
+
+#ifdef PHYSICS_BENCHMARK_MAIN
+int main()
+{
+	RunBroadphaseBenchmark(1000, 120);
+	RunBroadphaseBenchmark(10000, 30);
+	RunNarrowphaseBenchmark(10000, 20);
+	RunSpatialQueryBenchmark(10000, 1000);
+	RunConvexBenchmark(1000, 300);
+	RunSeparatingAxisBenchmark(10000, 300);
+	RunHeightFieldBenchmark(513, 1000000);
+	RunWaveBenchmark(4096, 120);
+	RunOceanBenchmark(256, 120);
+	RunFFTPlanBenchmark();
+	RunCascadeBenchmark(120);
+	RunOceanCacheBenchmark(256, 64);
+	RunSpectrumBenchmark(256, 20);
+	RunOceanQuadtreeBenchmark(120);
+	RunWakeBenchmark(4096, 600);
+	RunWakeBenchmark(512, 600);
+	RunParticleRandomBenchmark(100000);
+	RunParticlePoolBenchmark(36000);
+	RunParticleSimulationBenchmark(1000000, 60);
+	RunParticleSortBenchmark(65536, 120);
+	RunUploadPlanBenchmark(3600);
+	RunParticleBudgetBenchmark(256, 360, 3000);
+	RunParticleBoundsBenchmark(64, 600);
+	return 0;
+}
+#endif
@@ -0,0 +1,31 @@
+#pragma once
+
+//headless benchmarks for the collision code, they only need DirectXMath and the
+//standard library so they can run on a machine without a gpu
+//build PhysicsBenchmark.cpp with PHYSICS_BENCHMARK_MAIN defined to get a console program,
+//its main also runs the ones in OceanBenchmark.h and ParticleBenchmark.h
+
+//moves bodyCount random boxes for frameCount frames and times the sweep and prune
+//broadphase against the all pairs loop it replaced
+void RunBroadphaseBenchmark(int bodyCount, int frameCount, unsigned int seed = 1);
+
+//runs pairCount random box pairs through the vector based SATCollisionReference,
+//the stack based SATCollision and the four wide batch, and checks that they agree
+void RunNarrowphaseBenchmark(int pairCount, int repeatCount, unsigned int seed = 1);
+
+//fills an AABBTree with bodyCount random boxes, moves them and times ray and sphere
+//queries against a linear scan over the same boxes, then traces shots through turning bodies
+//the way Game does and checks the oriented box each one hits against a scan
+void RunSpatialQueryBenchmark(int bodyCount, int queryCount, unsigned int seed = 1);
+
+//tumbles pairCount pairs of rock shaped hulls next to each other for frameCount frames and
+//times ConvexCollision from scratch against warm starting from a PairCache
+void RunConvexBenchmark(int pairCount, int frameCount, unsigned int seed = 1);
+
+//slowly turns pairCount pairs of boxes that nearly touch and times SATCollision with and
+//without the separating axis from the last frame
+void RunSeparatingAxisBenchmark(int pairCount, int frameCount, unsigned int seed = 1);
+
+//builds a rolling size x size height field and times single and batched height queries,
+//and rays through the min/max pyramid against marching the ray in small steps
+void RunHeightFieldBenchmark(int size, int queryCount, unsigned int seed = 1);
@@ -1,31 +1,20 @@
 #include "RigidBody.h"
+#include "PairCache.h"
 
-RigidBody::RigidBody(std::vector<XMFLOAT3> points)
+RigidBody::RigidBody(const std::vector<XMFLOAT3>& points)
+	: RigidBody(std::make_shared<const CollisionShape>(points))
 {
-	//Count the points of the incoming list
-	size_t uVertexCount = points.size();
-
-	XMStoreFloat4x4(&modelMatrix, XMMatrixIdentity());
-
-	//If there are none just return, we have no information to create the BS from
-	if (uVertexCount == 0)
-		return;
-
-	//Max and min as the first vector of the list
-	maxL = minL = points[0];
+}
 
-	//Get the max and min out of the list
-	for (unsigned int i = 1; i < uVertexCount; ++i)
-	{
-		if (maxL.x < points[i].x) maxL.x = points[i].x;
-		else if (minL.x > points[i].x) minL.x = points[i].x;
+RigidBody::RigidBody(std::shared_ptr<const CollisionShape> shape)
+{
+	this->shape = shape;
 
-		if (maxL.y < points[i].y) maxL.y = points[i].y;
-		else if (minL.y > points[i].y) minL.y = points[i].y;
+	XMStoreFloat4x4(&modelMatrix, XMMatrixIdentity());
 
-		if (maxL.z < points[i].z) maxL.z = points[i].z;
-		else if (minL.z > points[i].z) minL.z = points[i].z;
-	}
+	//the bounds were found once when the shape was cooked
+	minL = shape->GetMin();
+	maxL = shape->GetMax();
 
 	//with model matrix being the identity, local and global are the same
 	minG = minL;
@@ -35,14 +24,11 @@ RigidBody::RigidBody(std::vector<XMFLOAT3> points)
 	XMStoreFloat3(&center, (XMLoadFloat3(&maxL) + XMLoadFloat3(&minL)) / 2);
 
 	//we calculate the distance between min and max vectors
-	XMStoreFloat3(&halfWidth, (XMLoadFloat3(&maxL) + XMLoadFloat3(&minL)) / 2);
-
-	//Get the distance between the center and either the min or the max
-	XMVECTOR vector1 = XMLoadFloat3(&center);
-	XMVECTOR vector2 = XMLoadFloat3(&minL);
-	XMVECTOR vectorSub = XMVectorSubtract(vector1, vector2);
-	XMVECTOR length = XMVector3Length(vectorSub);
-	XMStoreFloat(&radius, length);
+	XMStoreFloat3(&halfWidth, (XMLoadFloat3(&maxL) - XMLoadFloat3(&minL)) / 2);
+
+	UpdateOrientedBox();
+	UpdateBoundingSphere();
+	StorePreviousPose();
 }
 
 void RigidBody::SetModelMatrix(XMFLOAT4X4 modelMatrix)
@@ -94,6 +80,48 @@ void RigidBody::SetModelMatrix(XMFLOAT4X4 modelMatrix)
 	//we calculate the distance between min and max vectors
 	//arbbSize = maxG - minG;
 	XMStoreFloat3(&arbbSize, XMLoadFloat3(&maxG) - XMLoadFloat3(&minG));
+
+	UpdateOrientedBox();
+	UpdateBoundingSphere();
+}
+
+void RigidBody::UpdateBoundingSphere()
+{
+	//the sphere cooked with the shape, grown by the most the matrix stretches any direction
+	XMMATRIX model = XMLoadFloat4x4(&modelMatrix);
+	XMFLOAT3 sphereCenterL = shape->GetSphereCenter();
+	XMStoreFloat3(&sphereCenterG, XMVector3TransformCoord(XMLoadFloat3(&sphereCenterL), model));
+	float scale = std::max(XMVectorGetX(XMVector3Length(model.r[0])),
+		std::max(XMVectorGetX(XMVector3Length(model.r[1])), XMVectorGetX(XMVector3Length(model.r[2]))));
+	radius = shape->GetSphereRadius() * scale;
+}
+
+void RigidBody::UpdateOrientedBox()
+{
+	//placing the box that was fitted to the points when the shape was cooked
+	const OrientedBox& local = shape->GetFittedBox();
+	XMMATRIX model = XMLoadFloat4x4(&modelMatrix);
+	XMStoreFloat3(&obb.center, XMVector3TransformCoord(XMLoadFloat3(&local.center), model));
+
+	//the length of a transformed axis is the scale along it
+	XMVECTOR axes[3];
+	float scale[3];
+	for (int i = 0; i < 3; i++)
+	{
+		axes[i] = XMVector3TransformNormal(XMLoadFloat3(&local.axes[i]), model);
+		scale[i] = XMVectorGetX(XMVector3Length(axes[i]));
+	}
+
+	//non uniform scale skews a rotated box a little, so the axes are made orthogonal again
+	axes[0] = XMVector3Normalize(axes[0]);
+	axes[1] = XMVector3Normalize(axes[1] - axes[0] * XMVector3Dot(axes[1], axes[0]));
+	axes[2] = XMVector3Cross(axes[0], axes[1]);
+	for (int i = 0; i < 3; i++)
+	{
+		XMStoreFloat3(&obb.axes[i], axes[i]);
+	}
+
+	obb.halfExtents = XMFLOAT3(local.halfExtents.x * scale[0], local.halfExtents.y * scale[1], local.halfExtents.z * scale[2]);
 }
 
 XMFLOAT3 RigidBody::GetMinLocal()
@@ -134,30 +162,162 @@ XMFLOAT3 RigidBody::GetCenterGlobal()
 	return globalCenter;
 }
 
+XMFLOAT3 RigidBody::GetSphereCenterGlobal()
+{
+	return sphereCenterG;
+}
+
 float RigidBody::GetRadius()
 {
 	return radius;
 }
 
+std::shared_ptr<const CollisionShape> RigidBody::GetCollisionShape()
+{
+	return shape;
+}
+
+const OrientedBox& RigidBody::GetOrientedBox()
+{
+	return obb;
+}
+
+void RigidBody::StorePreviousPose()
+{
+	previousObb = obb;
+	previousMinG = minG;
+	previousMaxG = maxG;
+}
+
+XMFLOAT3 RigidBody::GetSweptMinGlobal()
+{
+	XMFLOAT3 sweptMin;
+	XMStoreFloat3(&sweptMin, XMVectorMin(XMLoadFloat3(&previousMinG), XMLoadFloat3(&minG)));
+	return sweptMin;
+}
+
+XMFLOAT3 RigidBody::GetSweptMaxGlobal()
+{
+	XMFLOAT3 sweptMax;
+	XMStoreFloat3(&sweptMax, XMVectorMax(XMLoadFloat3(&previousMaxG), XMLoadFloat3(&maxG)));
+	return sweptMax;
+}
+
 bool RigidBody::BoundingSphereCheck(std::shared_ptr<RigidBody> other)
 {
-	XMVECTOR vector1 = XMLoadFloat3(&GetCenterGlobal());
-	XMVECTOR vector2 = XMLoadFloat3(&other->GetCenterGlobal());
-	XMVECTOR vectorSub = XMVectorSubtract(vector1, vector2);
-	XMVECTOR length = XMVector3Length(vectorSub);
-	XMFLOAT3 dist;
-	XMStoreFloat3(&dist, length);
-
-	if (dist.x < this->GetRadius() + other->GetRadius())
+	XMVECTOR vector1 = XMLoadFloat3(&sphereCenterG);
+	XMVECTOR vector2 = XMLoadFloat3(&other->sphereCenterG);
+	float distanceSq = XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(vector1, vector2)));
+	float reach = radius + other->radius;
+
+	return distanceSq <= reach * reach;
+}
+
+bool RigidBody::SATCollision(std::shared_ptr<RigidBody> other, CollisionCache* cache)
+{
+	if (this == other.get())
 	{
-		return true;
+		return false;
 	}
 
-	return false;
+	//the minimal spheres turn most pairs down before any of the box's 15 axes
+	if (!BoundingSphereCheck(other))
+	{
+		return false;
+	}
+
+	//both boxes are cached in SetModelMatrix, so this doesn't touch the heap
+	return CachedOBBOverlap(other.get(), cache);
+}
+
+bool RigidBody::ClaimCache(CollisionCache* cache, const RigidBody* other)
+{
+	if (cache->owner != this && cache->owner != other)
+	{
+		//left over from bodies that had the same proxies before
+		cache->owner = this;
+		cache->separatingAxis = -1;
+		cache->gjk.count = 0;
+	}
+	return cache->owner != this;
+}
+
+bool RigidBody::CachedOBBOverlap(const RigidBody* other, CollisionCache* cache)
+{
+	if (cache == nullptr)
+	{
+		return OBBOverlap(obb, other->obb);
+	}
+
+	//the axis numbers depend on which box comes first, so the owner's box always does
+	bool flipped = ClaimCache(cache, other);
+	const OrientedBox& first = flipped ? other->obb : obb;
+	const OrientedBox& second = flipped ? obb : other->obb;
+
+	if (cache->separatingAxis >= 0 && OBBSeparatedOnAxis(first, second, cache->separatingAxis))
+	{
+		return false;
+	}
+
+	return OBBOverlap(first, second, &cache->separatingAxis);
+}
+
+bool RigidBody::SweptCollision(std::shared_ptr<RigidBody> other, float& toi)
+{
+	if (this == other.get())
+	{
+		return false;
+	}
+
+	//only the translation is swept, the rotation during one step is small enough to ignore
+	XMFLOAT3 displacement;
+	XMFLOAT3 otherDisplacement;
+	XMStoreFloat3(&displacement, XMLoadFloat3(&obb.center) - XMLoadFloat3(&previousObb.center));
+	XMStoreFloat3(&otherDisplacement, XMLoadFloat3(&other->obb.center) - XMLoadFloat3(&other->previousObb.center));
+
+	return SweptOBB(previousObb, displacement, other->previousObb, otherDisplacement, toi);
+}
+
+bool RigidBody::ConvexCollision(std::shared_ptr<RigidBody> other, CollisionCache* cache, ContactInfo* contact)
+{
+	if (this == other.get())
+	{
+		return false;
+	}
+
+	//the spheres and then the boxes are much cheaper and already rule out most pairs
+	if (!BoundingSphereCheck(other) || !CachedOBBOverlap(other.get(), cache))
+	{
+		return false;
+	}
+
+	//the cached simplex is made of the owner's hull vertices first, so the owner always goes in as hull a
+	GJKCache* gjkCache = nullptr;
+	bool flipped = false;
+	if (cache != nullptr)
+	{
+		gjkCache = &cache->gjk;
+		flipped = ClaimCache(cache, other.get());
+	}
+
+	bool colliding;
+	if (flipped)
+	{
+		colliding = GJKCollision(other->shape->GetHull(), other->modelMatrix, shape->GetHull(), modelMatrix, gjkCache, contact);
+		if (contact != nullptr)
+		{
+			contact->normal = XMFLOAT3(-contact->normal.x, -contact->normal.y, -contact->normal.z);
+		}
+	}
+	else
+	{
+		colliding = GJKCollision(shape->GetHull(), modelMatrix, other->shape->GetHull(), other->modelMatrix, gjkCache, contact);
+	}
 
+	return colliding;
 }
 
-bool RigidBody::SATCollision(std::shared_ptr<RigidBody> other)
+bool RigidBody::SATCollisionReference(std::shared_ptr<RigidBody> other)
 {
 	
 	if (this == other.get())
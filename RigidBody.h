@@ -3,9 +3,17 @@
 #include<vector>
 #include<algorithm>
 #include<memory>
+#include"OrientedBox.h"
+#include"CollisionShape.h"
+#include"GJK.h"
 using namespace DirectX;
+
+struct CollisionCache;
+
 class RigidBody
 {
+	std::shared_ptr<const CollisionShape> shape; //cooked bounds, shared with every body of the same mesh
+
 	XMFLOAT3 center; //center point in local space
 	XMFLOAT3 minL; //minimum coordinate in local space (for OBB)
 	XMFLOAT3 maxL; //maximum coordinate in local space (for OBB)
@@ -13,12 +21,28 @@ class RigidBody
 	XMFLOAT3 maxG; //maximum coordinate in global space (for ARBB)
 	XMFLOAT3 halfWidth; //half the size of the Oriented Bounding Box
 	XMFLOAT3 arbbSize;// size of the Axis (Re)Alligned Bounding Box
-	float radius;
+	XMFLOAT3 sphereCenterG; //center of the shape's minimal sphere in global space
+	float radius; //of the shape's minimal sphere, grown by the largest scale of the model matrix
 
 	XMFLOAT4X4 modelMatrix; //Matrix that will take us from local to world coordinate
+	OrientedBox obb; //the local box placed in world space, rebuilt with the model matrix
+
+	//pose at the start of the physics step, used by the swept tests
+	OrientedBox previousObb;
+	XMFLOAT3 previousMinG;
+	XMFLOAT3 previousMaxG;
+
+	void UpdateOrientedBox();
+	void UpdateBoundingSphere();
+	//makes the cache belong to this pair, true when the other body is its owner
+	bool ClaimCache(CollisionCache* cache, const RigidBody* other);
+	//box test that tries the cached separating axis before the other 14
+	bool CachedOBBOverlap(const RigidBody* other, CollisionCache* cache);
 
 public:
-	RigidBody(std::vector<XMFLOAT3> points);
+	//cooks a shape just for this body
+	RigidBody(const std::vector<XMFLOAT3>& points);
+	RigidBody(std::shared_ptr<const CollisionShape> shape);
 	void SetModelMatrix(XMFLOAT4X4 modelMatrix);
 
 	//getters
@@ -29,11 +53,30 @@ public:
 	XMFLOAT4X4 GetModelMatrix();
 	XMFLOAT3 GetCenterLocal();
 	XMFLOAT3 GetCenterGlobal();
+	XMFLOAT3 GetSphereCenterGlobal();
 	float GetRadius();
+	std::shared_ptr<const CollisionShape> GetCollisionShape();
+	const OrientedBox& GetOrientedBox();
+
+	//remembers the current pose as the start of the step
+	void StorePreviousPose();
+	//bounds of everything the box touched since StorePreviousPose
+	XMFLOAT3 GetSweptMinGlobal();
+	XMFLOAT3 GetSweptMaxGlobal();
+	//whether the minimal spheres overlap, the early out before the boxes and the hulls
 	bool BoundingSphereCheck(std::shared_ptr<RigidBody> other);
 
 	//collision detection
-	bool SATCollision(std::shared_ptr<RigidBody> other);
+	//with a cache the axis that separated the pair last frame is tested first
+	bool SATCollision(std::shared_ptr<RigidBody> other, CollisionCache* cache = nullptr);
+	//checks the whole motion since StorePreviousPose instead of only the end pose
+	//toi is the fraction of the step at which the boxes first touch
+	bool SweptCollision(std::shared_ptr<RigidBody> other, float& toi);
+	//gjk on the convex hulls of the meshes once the boxes overlap
+	//the cache warm starts the pair from last frame, contact gets the normal from this body to the other
+	bool ConvexCollision(std::shared_ptr<RigidBody> other, CollisionCache* cache = nullptr, ContactInfo* contact = nullptr);
+	//the original vector based test, kept to check the new one against
+	bool SATCollisionReference(std::shared_ptr<RigidBody> other);
 	bool IsOverlapping(XMFLOAT3 normal,std::vector<XMFLOAT3> thisPoints, std::vector<XMFLOAT3> otherPoints);
 };
 
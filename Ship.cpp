@@ -5,6 +5,7 @@ Ship::Ship(std::shared_ptr<Mesh> mesh, std::shared_ptr<Material> material):Entit
 	XMStoreFloat4(&originalRotation, XMQuaternionIdentity());
 	health = 5;
 	tag = "Player";
+	layer = CollisionLayer::Player;
 }
 
 Ship::~Ship()
@@ -98,11 +99,11 @@ float Ship::GetHealth()
 	return health;
 }
 
-bool Ship::IsColliding(std::shared_ptr<Entity> other)
+bool Ship::IsColliding(std::shared_ptr<Entity> other, CollisionCache* cache)
 {
-	//checking if it collided with the obstacle
-	if (other->GetTag() == "Obstacle"&&useRigidBody
-		&& GetRigidBody()->SATCollision(other->GetRigidBody()))
+	//checking if it collided with the obstacle, the hull is tested so the ship doesn't collide as a box
+	if (other->GetCollisionLayer() == CollisionLayer::Obstacle&&useRigidBody
+		&& GetRigidBody()->ConvexCollision(other->GetRigidBody(), cache))
 	{
 		health -= 1;
 		if (health <= 0)
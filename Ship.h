@@ -19,7 +19,7 @@ public:
 
 	float GetHealth();
 
-	bool IsColliding(std::shared_ptr<Entity> other) override;
+	bool IsColliding(std::shared_ptr<Entity> other, CollisionCache* cache = nullptr) override;
 
 	void SetOriginalRotation(XMFLOAT4 originalRotation);
 
@@ -0,0 +1,111 @@
+#include "SlabAllocator.h"
+
+SlabAllocator::SlabAllocator(int capacity, int minSlab)
+{
+	this->capacity = capacity;
+	this->minSlab = minSlab;
+	top = 0;
+	used = 0;
+
+	int classCount = 1;
+	for (int size = minSlab; size < capacity; size *= 2)
+		classCount++;
+	freeSlabs.resize(classCount);
+}
+
+int SlabAllocator::GetSizeClass(int count) const
+{
+	int sizeClass = 0;
+	for (int size = minSlab; size < count; size *= 2)
+		sizeClass++;
+	return sizeClass;
+}
+
+int SlabAllocator::Allocate(int count)
+{
+	int sizeClass = GetSizeClass(count);
+	if (count <= 0 || sizeClass >= (int)freeSlabs.size())
+		return -1;
+	int size = minSlab << sizeClass;
+
+	int offset = -1;
+	if (!freeSlabs[sizeClass].empty())
+	{
+		offset = freeSlabs[sizeClass].back();
+		freeSlabs[sizeClass].pop_back();
+	}
+	else if (top + size <= capacity)
+	{
+		offset = top;
+		top += size;
+	}
+	else
+	{
+		//the smallest free slab that is bigger, keeping its first half and freeing the rest
+		for (int bigger = sizeClass + 1; bigger < (int)freeSlabs.size(); bigger++)
+		{
+			if (freeSlabs[bigger].empty())
+				continue;
+			offset = freeSlabs[bigger].back();
+			freeSlabs[bigger].pop_back();
+			for (int split = bigger - 1; split >= sizeClass; split--)
+			{
+				freeSlabs[split].push_back(offset + (minSlab << split));
+			}
+			break;
+		}
+	}
+
+	if (offset >= 0)
+		used += size;
+	return offset;
+}
+
+void SlabAllocator::Free(int offset, int count)
+{
+	int sizeClass = GetSizeClass(count);
+	used -= minSlab << sizeClass;
+	freeSlabs[sizeClass].push_back(offset);
+
+	//take the top down past every free slab that ends on it
+	bool lowered = true;
+	while (lowered)
+	{
+		lowered = false;
+		for (int c = 0; c < (int)freeSlabs.size() && !lowered; c++)
+		{
+			std::vector<int>& slabs = freeSlabs[c];
+			for (int i = 0; i < (int)slabs.size(); i++)
+			{
+				if (slabs[i] + (minSlab << c) == top)
+				{
+					top = slabs[i];
+					slabs[i] = slabs.back();
+					slabs.pop_back();
+					lowered = true;
+					break;
+				}
+			}
+		}
+	}
+}
+
+int SlabAllocator::GetSlabSize(int count) const
+{
+	return minSlab << GetSizeClass(count);
+}
+
+int SlabAllocator::GetCapacity() const
+{
+	return capacity;
+}
+
+int SlabAllocator::GetTop() const
+{
+	return top;
+}
+
+int SlabAllocator::GetUsed() const
+{
+	return used;
+}
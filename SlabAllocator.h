@@ -0,0 +1,33 @@
+#pragma once
+#include<vector>
+
+//hands out ranges of a fixed array in power of two slabs, from minSlab up to the whole array.
+//freed slabs go on a list for their size and are handed out again before anything new is cut
+//off the top, and a slab that is too big is split in halves until it fits. halves are never
+//joined back up, the same few sizes are asked for over and over so that is not needed. the top
+//is lowered when the slabs under it are freed, so everything in use stays below GetTop()
+class SlabAllocator
+{
+	int capacity;
+	int minSlab;
+	int top;
+	int used; //elements in slabs that are handed out, rounded up to their slab size
+	std::vector<std::vector<int>> freeSlabs; //offsets, one list for each size from minSlab up
+
+	int GetSizeClass(int count) const;
+
+public:
+	SlabAllocator(int capacity, int minSlab = 64);
+
+	//the offset of a slab of at least count elements, or -1 when there is no room
+	int Allocate(int count);
+	//count has to be what the slab was allocated with
+	void Free(int offset, int count);
+
+	//the size of the slab count elements get
+	int GetSlabSize(int count) const;
+	int GetCapacity() const;
+	//one past the last element that can be in use
+	int GetTop() const;
+	int GetUsed() const;
+};
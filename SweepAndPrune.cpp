@@ -0,0 +1,214 @@
+#include "SweepAndPrune.h"
+
+SweepAndPrune::SweepAndPrune()
+{
+	axis = 0;
+	needsCompaction = false;
+}
+
+int SweepAndPrune::AddProxy(XMFLOAT3 min, XMFLOAT3 max, void* userData, unsigned int category, unsigned int mask)
+{
+	//removed proxies have to leave the endpoint list before their id is handed out again
+	if (needsCompaction)
+	{
+		endpoints.erase(std::remove_if(endpoints.begin(), endpoints.end(),
+			[this](const Endpoint& e) { return !proxies[e.proxy].active; }), endpoints.end());
+		needsCompaction = false;
+	}
+
+	int id;
+	if (freeProxies.size() > 0)
+	{
+		id = freeProxies.back();
+		freeProxies.pop_back();
+	}
+	else
+	{
+		id = (int)proxies.size();
+		proxies.emplace_back();
+	}
+
+	proxies[id].min = min;
+	proxies[id].max = max;
+	proxies[id].userData = userData;
+	proxies[id].category = category;
+	proxies[id].mask = mask;
+	proxies[id].active = true;
+
+	//the insertion sort in FindPairs moves it to the right place
+	Endpoint endpoint;
+	endpoint.min = GetAxis(min, axis);
+	endpoint.max = GetAxis(max, axis);
+	endpoint.proxy = id;
+	endpoints.emplace_back(endpoint);
+
+	return id;
+}
+
+void SweepAndPrune::RemoveProxy(int proxy)
+{
+	if (proxy < 0 || proxy >= (int)proxies.size() || !proxies[proxy].active)
+		return;
+
+	proxies[proxy].active = false;
+	proxies[proxy].userData = nullptr;
+	freeProxies.emplace_back(proxy);
+	needsCompaction = true;
+}
+
+void SweepAndPrune::UpdateProxy(int proxy, XMFLOAT3 min, XMFLOAT3 max)
+{
+	proxies[proxy].min = min;
+	proxies[proxy].max = max;
+}
+
+void SweepAndPrune::SetProxyFilter(int proxy, unsigned int category, unsigned int mask)
+{
+	proxies[proxy].category = category;
+	proxies[proxy].mask = mask;
+}
+
+void SweepAndPrune::Clear()
+{
+	proxies.clear();
+	freeProxies.clear();
+	endpoints.clear();
+	pairs.clear();
+	needsCompaction = false;
+}
+
+const std::vector<BroadphasePair>& SweepAndPrune::FindPairs()
+{
+	if (needsCompaction)
+	{
+		endpoints.erase(std::remove_if(endpoints.begin(), endpoints.end(),
+			[this](const Endpoint& e) { return !proxies[e.proxy].active; }), endpoints.end());
+		needsCompaction = false;
+	}
+
+	ChooseSweepAxis();
+	SortEndpoints();
+
+	pairs.clear();
+
+	//sweeping along the axis, every box only has to be tested against the boxes
+	//that start before it ends
+	size_t count = endpoints.size();
+	for (size_t i = 0; i < count; i++)
+	{
+		const Endpoint& current = endpoints[i];
+		const Proxy& a = proxies[current.proxy];
+
+		for (size_t j = i + 1; j < count && endpoints[j].min <= current.max; j++)
+		{
+			const Proxy& b = proxies[endpoints[j].proxy];
+
+			//layers that never collide are dropped before touching the bounds
+			if ((a.mask & b.category) == 0 || (b.mask & a.category) == 0)
+				continue;
+
+			//the sweep axis already overlaps, check the other two
+			if (a.min.x > b.max.x || b.min.x > a.max.x ||
+				a.min.y > b.max.y || b.min.y > a.max.y ||
+				a.min.z > b.max.z || b.min.z > a.max.z)
+			{
+				continue;
+			}
+
+			BroadphasePair pair;
+			if (current.proxy < endpoints[j].proxy)
+			{
+				pair.proxyA = current.proxy;
+				pair.proxyB = endpoints[j].proxy;
+			}
+			else
+			{
+				pair.proxyA = endpoints[j].proxy;
+				pair.proxyB = current.proxy;
+			}
+			pair.userDataA = proxies[pair.proxyA].userData;
+			pair.userDataB = proxies[pair.proxyB].userData;
+			pairs.emplace_back(pair);
+		}
+	}
+
+	return pairs;
+}
+
+int SweepAndPrune::GetProxyCount()
+{
+	return (int)endpoints.size();
+}
+
+int SweepAndPrune::GetSweepAxis()
+{
+	return axis;
+}
+
+float SweepAndPrune::GetAxis(const XMFLOAT3& v, int axis)
+{
+	if (axis == 0) return v.x;
+	if (axis == 1) return v.y;
+	return v.z;
+}
+
+void SweepAndPrune::ChooseSweepAxis()
+{
+	if (endpoints.size() < 2)
+		return;
+
+	//the axis along which the centers are spread the most gives the fewest false overlaps
+	XMVECTOR sum = XMVectorZero();
+	XMVECTOR sumSq = XMVectorZero();
+	for (size_t i = 0; i < endpoints.size(); i++)
+	{
+		const Proxy& p = proxies[endpoints[i].proxy];
+		XMVECTOR center = (XMLoadFloat3(&p.min) + XMLoadFloat3(&p.max)) * 0.5f;
+		sum += center;
+		sumSq += center * center;
+	}
+
+	float invCount = 1.0f / endpoints.size();
+	XMFLOAT3 variance;
+	XMStoreFloat3(&variance, sumSq * invCount - (sum * invCount) * (sum * invCount));
+
+	int best = 0;
+	if (variance.y > GetAxis(variance, best)) best = 1;
+	if (variance.z > GetAxis(variance, best)) best = 2;
+
+	//only switch when it is clearly better, switching axis throws away the coherent order
+	if (best != axis && GetAxis(variance, best) > 2.0f * GetAxis(variance, axis))
+	{
+		axis = best;
+		for (size_t i = 0; i < endpoints.size(); i++)
+		{
+			endpoints[i].min = GetAxis(proxies[endpoints[i].proxy].min, axis);
+		}
+		std::sort(endpoints.begin(), endpoints.end(),
+			[](const Endpoint& a, const Endpoint& b) { return a.min < b.min; });
+	}
+}
+
+void SweepAndPrune::SortEndpoints()
+{
+	//pulling in this frame's bounds
+	for (size_t i = 0; i < endpoints.size(); i++)
+	{
+		const Proxy& p = proxies[endpoints[i].proxy];
+		endpoints[i].min = GetAxis(p.min, axis);
+		endpoints[i].max = GetAxis(p.max, axis);
+	}
+
+	//insertion sort, the list is almost sorted from the last frame
+	for (size_t i = 1; i < endpoints.size(); i++)
+	{
+		Endpoint key = endpoints[i];
+		size_t j = i;
+		while (j > 0 && endpoints[j - 1].min > key.min)
+		{
+			endpoints[j] = endpoints[j - 1];
+			j--;
+		}
+		endpoints[j] = key;
+	}
+}
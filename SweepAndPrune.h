@@ -0,0 +1,70 @@
+#pragma once
+#include<DirectXMath.h>
+#include<vector>
+#include<algorithm>
+using namespace DirectX;
+
+//pair of proxies whose bounding boxes overlap
+//proxyA is always the smaller id so every pair is reported once
+struct BroadphasePair
+{
+	int proxyA;
+	int proxyB;
+	void* userDataA;
+	void* userDataB;
+};
+
+//incremental sweep and prune broadphase
+//proxies are kept sorted by their minimum along one axis and the order is repaired
+//with an insertion sort every frame, which is close to O(n) because bodies only move
+//a little between frames. only depends on DirectXMath so it can run without a device
+class SweepAndPrune
+{
+	//world space bounds of a single body
+	struct Proxy
+	{
+		XMFLOAT3 min;
+		XMFLOAT3 max;
+		void* userData;
+		unsigned int category; //bits this proxy belongs to
+		unsigned int mask; //bits this proxy can pair with
+		bool active;
+	};
+
+	//interval of a proxy along the sweep axis, stored contiguously for the sweep
+	struct Endpoint
+	{
+		float min;
+		float max;
+		int proxy;
+	};
+
+	std::vector<Proxy> proxies;
+	std::vector<int> freeProxies; //ids that can be reused by AddProxy
+	std::vector<Endpoint> endpoints; //active proxies sorted along the sweep axis
+	std::vector<BroadphasePair> pairs;
+
+	int axis; //0 = x, 1 = y, 2 = z
+	bool needsCompaction; //set when a proxy was removed since the last sweep
+
+	float GetAxis(const XMFLOAT3& v, int axis);
+	void ChooseSweepAxis();
+	void SortEndpoints();
+
+public:
+	SweepAndPrune();
+
+	//returns the id of the new proxy
+	//two proxies are only paired when each one's mask has a bit of the other's category
+	int AddProxy(XMFLOAT3 min, XMFLOAT3 max, void* userData, unsigned int category = 1, unsigned int mask = ~0u);
+	void RemoveProxy(int proxy);
+	void UpdateProxy(int proxy, XMFLOAT3 min, XMFLOAT3 max);
+	void SetProxyFilter(int proxy, unsigned int category, unsigned int mask);
+	void Clear();
+
+	//re-sorts the proxies and returns every overlapping pair
+	const std::vector<BroadphasePair>& FindPairs();
+
+	int GetProxyCount();
+	int GetSweepAxis();
+};
@@ -228,6 +228,9 @@ void Terrain::LoadHeightMap(std::string heightmap, unsigned int width, unsigned
 	file.read((char*)& heights[0], numVertices * numVertsFactor); // Double the size, since each pixel is 16-bit
 	file.close();
 
+	//kept for the ground queries, in the same layout as the vertices below
+	heightField = HeightField(heights, width, height, yScale / yFactor, xzScale, -halfWidth * xzScale, -halfHeight * xzScale);
+
 	// Create the initial mesh data
 	for (int z = 0; z < height; z++)
 	{
@@ -377,4 +380,103 @@ void Terrain::Draw(XMFLOAT4X4 view, XMFLOAT4X4 projection, ID3D11DeviceContext*
 	context->DrawIndexed(numIndices, 0, 0);
 }
 
+XMFLOAT3 Terrain::GetOffset()
+{
+	//the world matrix is stored transposed, the translation is in the last column
+	XMFLOAT4X4 world = GetWorldMatrix();
+	return XMFLOAT3(world._14, world._24, world._34);
+}
+
+float Terrain::GetHeight(float x, float z)
+{
+	XMFLOAT3 offset = GetOffset();
+	return heightField.GetHeight(x - offset.x, z - offset.z) + offset.y;
+}
+
+XMFLOAT3 Terrain::GetNormal(float x, float z)
+{
+	XMFLOAT3 offset = GetOffset();
+	return heightField.GetNormal(x - offset.x, z - offset.z);
+}
+
+void Terrain::GetHeights(const float* x, const float* z, float* heights, int count)
+{
+	XMFLOAT3 offset = GetOffset();
 
+	//moving the points into the field's space a chunk at a time
+	const int chunkSize = 64;
+	float localX[chunkSize];
+	float localZ[chunkSize];
+	for (int start = 0; start < count; start += chunkSize)
+	{
+		int size = count - start < chunkSize ? count - start : chunkSize;
+		for (int i = 0; i < size; i++)
+		{
+			localX[i] = x[start + i] - offset.x;
+			localZ[i] = z[start + i] - offset.z;
+		}
+
+		heightField.GetHeights(localX, localZ, heights + start, size);
+		for (int i = 0; i < size; i++)
+		{
+			heights[start + i] += offset.y;
+		}
+	}
+}
+
+bool Terrain::RayCast(XMFLOAT3 origin, XMFLOAT3 direction, float maxDistance, float& distance, XMFLOAT3& normal)
+{
+	XMFLOAT3 offset = GetOffset();
+	XMFLOAT3 localOrigin(origin.x - offset.x, origin.y - offset.y, origin.z - offset.z);
+	return heightField.RayCast(localOrigin, direction, maxDistance, distance, normal);
+}
+
+bool Terrain::CollideBody(std::shared_ptr<RigidBody> body, float& depth)
+{
+	const OrientedBox& box = body->GetOrientedBox();
+	XMVECTOR center = XMLoadFloat3(&box.center);
+	XMVECTOR axes[3];
+	for (int i = 0; i < 3; i++)
+	{
+		axes[i] = XMLoadFloat3(&box.axes[i]) * (&box.halfExtents.x)[i];
+	}
+
+	//the eight corners of the box go through the batched query together
+	float x[8];
+	float y[8];
+	float z[8];
+	for (int i = 0; i < 8; i++)
+	{
+		XMFLOAT3 corner;
+		XMStoreFloat3(&corner, center + (i & 1 ? axes[0] : -axes[0]) + (i & 2 ? axes[1] : -axes[1]) + (i & 4 ? axes[2] : -axes[2]));
+		x[i] = corner.x;
+		y[i] = corner.y;
+		z[i] = corner.z;
+	}
+
+	float ground[8];
+	GetHeights(x, z, ground, 8);
+
+	XMFLOAT3 offset = GetOffset();
+	depth = 0.0f;
+	bool colliding = false;
+	for (int i = 0; i < 8; i++)
+	{
+		//the field only clamps at its edges, corners past them aren't over the terrain
+		if (!heightField.Contains(x[i] - offset.x, z[i] - offset.z))
+			continue;
+
+		if (ground[i] - y[i] > depth)
+		{
+			depth = ground[i] - y[i];
+			colliding = true;
+		}
+	}
+
+	return colliding;
+}
+
+const HeightField& Terrain::GetHeightField()
+{
+	return heightField;
+}
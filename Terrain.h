@@ -3,6 +3,9 @@
 #include "Mesh.h"
 #include"SimpleShader.h"
 #include"Lights.h"
+#include"HeightField.h"
+#include"RigidBody.h"
+#include<memory>
 
 enum class TerrainBitDepth
 {
@@ -41,6 +44,16 @@ public:
 
 	void Draw(XMFLOAT4X4 view, XMFLOAT4X4 projection, ID3D11DeviceContext* context, Light light);
 
+	//ground queries in world space, answered from the heights kept by LoadHeightMap
+	float GetHeight(float x, float z);
+	XMFLOAT3 GetNormal(float x, float z);
+	void GetHeights(const float* x, const float* z, float* heights, int count);
+	bool RayCast(XMFLOAT3 origin, XMFLOAT3 direction, float maxDistance, float& distance, XMFLOAT3& normal);
+	//how far the lowest corner of the body's box is under the ground, false when it is
+	//above it or off the terrain
+	bool CollideBody(std::shared_ptr<RigidBody> body, float& depth);
+	const HeightField& GetHeightField();
+
 private:
 
 	ID3D11Buffer* vertexBuffer;
@@ -50,6 +63,8 @@ private:
 	bool recalculateMatrix;
 	XMFLOAT3 position;
 
+	HeightField heightField; //heights in the terrain's local space
+
 	ID3D11ShaderResourceView* texture1	  ;
 	ID3D11ShaderResourceView* texture2		  ;
 	ID3D11ShaderResourceView* texture3		  ;
@@ -70,5 +85,8 @@ private:
 
 	void Update();
 
+	//where the local space of the height field is in the world
+	XMFLOAT3 GetOffset();
+
 };
 
@@ -0,0 +1,100 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int workerCount)
+{
+	job = nullptr;
+	count = 0;
+	next = 0;
+	busy = 0;
+	generation = 0;
+	stopping = false;
+
+	if (workerCount < 0)
+	{
+		workerCount = (int)std::thread::hardware_concurrency() - 1;
+		if (workerCount < 0)
+			workerCount = 0;
+	}
+
+	for (int i = 0; i < workerCount; i++)
+	{
+		workers.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+}
+
+void ThreadPool::WorkerLoop()
+{
+	int seenGeneration = 0;
+	while (true)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		wake.wait(lock, [&]() { return stopping || generation != seenGeneration; });
+		if (stopping)
+			return;
+		seenGeneration = generation;
+		lock.unlock();
+
+		RunJobs();
+
+		lock.lock();
+		busy--;
+		if (busy == 0)
+			done.notify_one();
+	}
+}
+
+void ThreadPool::RunJobs()
+{
+	//handing out one index at a time keeps the threads even when the jobs are not
+	for (int i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+	{
+		(*job)(i);
+	}
+}
+
+void ThreadPool::ParallelFor(int count, const std::function<void(int)>& job)
+{
+	if (workers.empty() || count <= 1)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			job(i);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->job = &job;
+		this->count = count;
+		next = 0;
+		busy = (int)workers.size();
+		generation++;
+	}
+	wake.notify_all();
+
+	RunJobs();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [&]() { return busy == 0; });
+	this->job = nullptr;
+}
+
+int ThreadPool::GetWorkerCount()
+{
+	return (int)workers.size();
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include<thread>
+#include<mutex>
+#include<condition_variable>
+#include<atomic>
+#include<functional>
+#include<vector>
+
+//a few worker threads that stay asleep until there is a loop to split up
+//the thread calling ParallelFor works on the loop too, so a pool of zero workers just runs it inline
+class ThreadPool
+{
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+
+	const std::function<void(int)>* job;
+	int count;
+	std::atomic<int> next;
+	int busy; //workers still on the current loop
+	int generation; //bumped for every loop so sleeping workers know there is work
+	bool stopping;
+
+	void WorkerLoop();
+	void RunJobs();
+
+public:
+	//workerCount below zero uses one worker per extra hardware thread
+	ThreadPool(int workerCount = -1);
+	~ThreadPool();
+
+	//calls job(i) for i in [0, count) across the pool and returns when all of them are done
+	void ParallelFor(int count, const std::function<void(int)>& job);
+	int GetWorkerCount();
+};
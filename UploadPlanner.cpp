@@ -0,0 +1,95 @@
+#include "UploadPlanner.h"
+#include<algorithm>
+
+UploadPlanner::UploadPlanner(int capacity, int elementSize, int mergeGap, int maxRanges)
+{
+	this->capacity = capacity;
+	this->elementSize = elementSize;
+	this->mergeGap = mergeGap;
+	this->maxRanges = maxRanges < 1 ? 1 : maxRanges;
+	plannedBytes = 0;
+}
+
+void UploadPlanner::MarkDirty(int offset, int count)
+{
+	if (offset < 0)
+	{
+		count += offset;
+		offset = 0;
+	}
+	if (offset + count > capacity)
+		count = capacity - offset;
+	if (count > 0)
+		marks.push_back({ offset, count });
+}
+
+void UploadPlanner::MarkAll()
+{
+	marks.clear();
+	marks.push_back({ 0, capacity });
+}
+
+bool UploadPlanner::IsDirty() const
+{
+	return !marks.empty();
+}
+
+const std::vector<UploadRange>& UploadPlanner::Plan(int limit)
+{
+	plan.clear();
+	std::sort(marks.begin(), marks.end(), [](const UploadRange& a, const UploadRange& b) { return a.offset < b.offset; });
+
+	for (const UploadRange& mark : marks)
+	{
+		int end = std::min(mark.offset + mark.count, limit);
+		if (end <= mark.offset)
+			continue;
+
+		if (!plan.empty() && mark.offset <= plan.back().offset + plan.back().count + mergeGap)
+		{
+			UploadRange& last = plan.back();
+			last.count = std::max(last.offset + last.count, end) - last.offset;
+		}
+		else
+			plan.push_back({ mark.offset, end - mark.offset });
+	}
+	marks.clear();
+
+	//too many copies, the closest two are joined until there are few enough
+	while ((int)plan.size() > maxRanges)
+	{
+		int closest = 0;
+		int smallestGap = capacity;
+		for (int i = 0; i + 1 < (int)plan.size(); i++)
+		{
+			int gap = plan[i + 1].offset - (plan[i].offset + plan[i].count);
+			if (gap < smallestGap)
+			{
+				smallestGap = gap;
+				closest = i;
+			}
+		}
+		plan[closest].count = plan[closest + 1].offset + plan[closest + 1].count - plan[closest].offset;
+		plan.erase(plan.begin() + closest + 1);
+	}
+
+	plannedBytes = 0;
+	for (const UploadRange& range : plan)
+		plannedBytes += range.count * elementSize;
+	return plan;
+}
+
+int UploadPlanner::GetPlannedBytes() const
+{
+	return plannedBytes;
+}
+
+int UploadPlanner::GetPlannedRanges() const
+{
+	return (int)plan.size();
+}
+
+int UploadPlanner::GetElementSize() const
+{
+	return elementSize;
+}
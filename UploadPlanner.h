@@ -0,0 +1,41 @@
+#pragma once
+#include<vector>
+
+//a run of elements of a buffer to upload
+struct UploadRange
+{
+	int offset;
+	int count;
+};
+
+//collects the parts of a cpu copy of a buffer that changed and turns them into a few ranges to
+//upload. marks that touch or overlap are joined, and so are ranges with a gap of less than
+//mergeGap elements between them, as sending a few extra elements costs less than another
+//copy. when there would still be more than maxRanges the ones with the smallest gaps between
+//them are joined until there aren't. it only counts elements, so it runs without a device
+class UploadPlanner
+{
+	std::vector<UploadRange> marks;
+	std::vector<UploadRange> plan;
+	int capacity;
+	int elementSize;
+	int mergeGap;
+	int maxRanges;
+	int plannedBytes;
+
+public:
+	UploadPlanner(int capacity, int elementSize, int mergeGap = 64, int maxRanges = 16);
+
+	void MarkDirty(int offset, int count);
+	void MarkAll();
+	bool IsDirty() const;
+
+	//the ranges to upload, sorted, for everything marked since the last plan, leaving out
+	//anything at limit or past it. the marks are cleared
+	const std::vector<UploadRange>& Plan(int limit);
+
+	//what the last plan sends
+	int GetPlannedBytes() const;
+	int GetPlannedRanges() const;
+	int GetElementSize() const;
+};
@@ -1,15 +1,19 @@
 #include "Water.h"
+#include<algorithm>
+#include<string>
+#include<cmath>
+#include<cstring>
 
-Water::Water(std::shared_ptr<Mesh> waterMesh, ID3D11ShaderResourceView* waterTex,
+Water::Water(ID3D11ShaderResourceView* waterTex,
 	ID3D11ShaderResourceView* waterNormal1, ID3D11ShaderResourceView* waterNormal2,
 	SimplePixelShader* waterPS, SimpleVertexShader* waterVS, SimpleHullShader* waterHS, SimpleDomainShader* waterDS,
-	SimpleComputeShader* h0CS, SimpleComputeShader* htCS, SimpleComputeShader* twiddleFactorsCS,
-	SimpleComputeShader* butterflyCS, SimpleComputeShader* inversionCS, SimpleComputeShader* sobelFilter,
+	SimpleComputeShader* htCS, SimpleComputeShader* fftStageCS,
+	SimpleComputeShader* inversionCS, SimpleComputeShader* sobelFilter,
 	SimpleComputeShader* jacobianCS, ID3D11SamplerState* samplerState,
-	ID3D11Device* device, ID3D11ShaderResourceView* noiseR1, ID3D11ShaderResourceView* noiseI1,
-	ID3D11ShaderResourceView* noiseR2, ID3D11ShaderResourceView* noiseI2)
+	ID3D11Device* device, const OceanSpectrumDesc& spectrumDesc, const std::vector<OceanCascadeDesc>& cascadeDescs,
+	ThreadPool* threads)
+	: quadtree(8192.0f, 8.0f, 16.0f, 2.0f), spectrum(threads), wake(4096, 256, 0.5f)
 {
-	this->waterMesh = waterMesh;
 	this->waterTex = waterTex;
 	this->waterNormal1 = waterNormal1;
 	this->waterNormal2 = waterNormal2;
@@ -18,450 +22,107 @@ Water::Water(std::shared_ptr<Mesh> waterMesh, ID3D11ShaderResourceView* waterTex
 	this->waterHS = waterHS;
 	this->waterDS = waterDS;
 	this->samplerState = samplerState;
-	this->noiseR1 = noiseR1;
-	this->noiseI1 = noiseI1;
-	this->noiseR2 = noiseR2;
-	this->noiseI2 = noiseI2;
-	this->h0CS = h0CS;
+	this->spectrumDesc = spectrumDesc;
 	this->htCS = htCS;
-	this->twiddleFactorsCS = twiddleFactorsCS;
-	this->butterflyCS = butterflyCS;
+	this->fftStageCS = fftStageCS;
 	this->inversionCS = inversionCS;
 	this->sobelFilter = sobelFilter;
 	this->jacobianCS = jacobianCS;
 
-	texSize = 256;
-	int bits = (int)(log(256) / log(2));
-
-	//initializing the UAV
-
-	//h0 texture
-	ID3D11Texture2D* h0Tex2D;
-
-	D3D11_TEXTURE2D_DESC h0TexDesc = {};
-	h0TexDesc.Width = texSize;
-	h0TexDesc.Height = texSize;
-	h0TexDesc.ArraySize = 1;
-	h0TexDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
-	h0TexDesc.CPUAccessFlags = 0;
-	h0TexDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-	h0TexDesc.MipLevels = 1;
-	h0TexDesc.MiscFlags = 0;
-	h0TexDesc.SampleDesc.Count = 1;
-	h0TexDesc.SampleDesc.Quality = 0;
-	h0TexDesc.Usage = D3D11_USAGE_DEFAULT;
-	device->CreateTexture2D(&h0TexDesc, 0, &h0Tex2D);
-
-	D3D11_SHADER_RESOURCE_VIEW_DESC h0SrvDesc = {};
-	h0SrvDesc.Format = h0TexDesc.Format;
-	h0SrvDesc.Texture2D.MipLevels = 1;
-	h0SrvDesc.Texture2D.MostDetailedMip = 0;
-	h0SrvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-	device->CreateShaderResourceView(h0Tex2D, &h0SrvDesc, &h0SRV);
-
-	D3D11_UNORDERED_ACCESS_VIEW_DESC h0UavDesc = {};
-	h0UavDesc.Format = h0TexDesc.Format;
-	h0UavDesc.Texture2D.MipSlice = 0;
-	h0UavDesc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
-	device->CreateUnorderedAccessView(h0Tex2D, &h0UavDesc, &h0URV);
-
-	h0Tex2D->Release();
-
-
-	//h0 minus texture
-	//initializing the UAV
-	ID3D11Texture2D* h0MinusTex2D;
-
-	D3D11_TEXTURE2D_DESC h0MinusTexDesc = {};
-	h0MinusTexDesc.Width = texSize;
-	h0MinusTexDesc.Height = texSize;
-	h0MinusTexDesc.ArraySize = 1;
-	h0MinusTexDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
-	h0MinusTexDesc.CPUAccessFlags = 0;
-	h0MinusTexDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-	h0MinusTexDesc.MipLevels = 1;
-	h0MinusTexDesc.MiscFlags = 0;
-	h0MinusTexDesc.SampleDesc.Count = 1;
-	h0MinusTexDesc.SampleDesc.Quality = 0;
-	h0MinusTexDesc.Usage = D3D11_USAGE_DEFAULT;
-	device->CreateTexture2D(&h0MinusTexDesc, 0, &h0MinusTex2D);
-
-	D3D11_SHADER_RESOURCE_VIEW_DESC h0MinusSrvDesc = {};
-	h0MinusSrvDesc.Format = h0TexDesc.Format;
-	h0MinusSrvDesc.Texture2D.MipLevels = 1;
-	h0MinusSrvDesc.Texture2D.MostDetailedMip = 0;
-	h0MinusSrvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-	device->CreateShaderResourceView(h0MinusTex2D, &h0MinusSrvDesc, &h0MinusSRV);
-
-	D3D11_UNORDERED_ACCESS_VIEW_DESC h0MinusUavDesc = {};
-	h0MinusUavDesc.Format = h0TexDesc.Format;
-	h0MinusUavDesc.Texture2D.MipSlice = 0;
-	h0MinusUavDesc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
-	device->CreateUnorderedAccessView(h0MinusTex2D, &h0MinusUavDesc, &h0MinusURV);
-
-	h0MinusTex2D->Release();
-
-
-
-	//hkx minus texture
-	//initializing the UAV
-	ID3D11Texture2D* hkxTex2D;
-
-	D3D11_TEXTURE2D_DESC hkxTex2DDesc = {};
-	hkxTex2DDesc.Width = texSize;
-	hkxTex2DDesc.Height = texSize;
-	hkxTex2DDesc.ArraySize = 1;
-	hkxTex2DDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
-	hkxTex2DDesc.CPUAccessFlags = 0;
-	hkxTex2DDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-	hkxTex2DDesc.MipLevels = 1;
-	hkxTex2DDesc.MiscFlags = 0;
-	hkxTex2DDesc.SampleDesc.Count = 1;
-	hkxTex2DDesc.SampleDesc.Quality = 0;
-	hkxTex2DDesc.Usage = D3D11_USAGE_DEFAULT;
-	device->CreateTexture2D(&hkxTex2DDesc, 0, &hkxTex2D);
-
-	D3D11_SHADER_RESOURCE_VIEW_DESC hkxTexSRVDesc = {};
-	hkxTexSRVDesc.Format = hkxTex2DDesc.Format;
-	hkxTexSRVDesc.Texture2D.MipLevels = 1;
-	hkxTexSRVDesc.Texture2D.MostDetailedMip = 0;
-	hkxTexSRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-	device->CreateShaderResourceView(hkxTex2D, &hkxTexSRVDesc, &htxSRV);
-
-	D3D11_UNORDERED_ACCESS_VIEW_DESC hkxTexUAVDesc = {};
-	hkxTexUAVDesc.Format = hkxTex2DDesc.Format;
-	hkxTexUAVDesc.Texture2D.MipSlice = 0;
-	hkxTexUAVDesc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
-	device->CreateUnorderedAccessView(hkxTex2D, &hkxTexUAVDesc, &htxUAV);
-
-	hkxTex2D->Release();
-
-	//hky minus texture
-	//initializing the UAV
-	ID3D11Texture2D* hkyTex2D;
-
-	D3D11_TEXTURE2D_DESC hkyTex2DDesc = {};
-	hkyTex2DDesc.Width = texSize;
-	hkyTex2DDesc.Height = texSize;
-	hkyTex2DDesc.ArraySize = 1;
-	hkyTex2DDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
-	hkyTex2DDesc.CPUAccessFlags = 0;
-	hkyTex2DDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-	hkyTex2DDesc.MipLevels = 1;
-	hkyTex2DDesc.MiscFlags = 0;
-	hkyTex2DDesc.SampleDesc.Count = 1;
-	hkyTex2DDesc.SampleDesc.Quality = 0;
-	hkyTex2DDesc.Usage = D3D11_USAGE_DEFAULT;
-	device->CreateTexture2D(&hkyTex2DDesc, 0, &hkyTex2D);
-
-	D3D11_SHADER_RESOURCE_VIEW_DESC hkyTexSRVDesc = {};
-	hkyTexSRVDesc.Format = hkyTex2DDesc.Format;
-	hkyTexSRVDesc.Texture2D.MipLevels = 1;
-	hkyTexSRVDesc.Texture2D.MostDetailedMip = 0;
-	hkyTexSRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-	device->CreateShaderResourceView(hkyTex2D, &hkyTexSRVDesc, &htySRV);
-
-	D3D11_UNORDERED_ACCESS_VIEW_DESC hkyTexUAVDesc = {};
-	hkyTexUAVDesc.Format = hkyTex2DDesc.Format;
-	hkyTexUAVDesc.Texture2D.MipSlice = 0;
-	hkyTexUAVDesc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
-	device->CreateUnorderedAccessView(hkyTex2D, &hkyTexUAVDesc, &htyUAV);
-
-	hkyTex2D->Release();
-
-	//hkx minus texture
-	//initializing the UAV
-	ID3D11Texture2D* hkzTex2D;
-
-	D3D11_TEXTURE2D_DESC hkzTex2DDesc = {};
-	hkzTex2DDesc.Width = texSize;
-	hkzTex2DDesc.Height = texSize;
-	hkzTex2DDesc.ArraySize = 1;
-	hkzTex2DDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
-	hkzTex2DDesc.CPUAccessFlags = 0;
-	hkzTex2DDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-	hkzTex2DDesc.MipLevels = 1;
-	hkzTex2DDesc.MiscFlags = 0;
-	hkzTex2DDesc.SampleDesc.Count = 1;
-	hkzTex2DDesc.SampleDesc.Quality = 0;
-	hkzTex2DDesc.Usage = D3D11_USAGE_DEFAULT;
-	device->CreateTexture2D(&hkzTex2DDesc, 0, &hkzTex2D);
-
-	D3D11_SHADER_RESOURCE_VIEW_DESC hkzTexSRVDesc = {};
-	hkzTexSRVDesc.Format = hkzTex2DDesc.Format;
-	hkzTexSRVDesc.Texture2D.MipLevels = 1;
-	hkzTexSRVDesc.Texture2D.MostDetailedMip = 0;
-	hkzTexSRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-	device->CreateShaderResourceView(hkzTex2D, &hkzTexSRVDesc, &htzSRV);
-
-	D3D11_UNORDERED_ACCESS_VIEW_DESC hkzTexUAVDesc = {};
-	hkzTexUAVDesc.Format = hkzTex2DDesc.Format;
-	hkzTexUAVDesc.Texture2D.MipSlice = 0;
-	hkzTexUAVDesc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
-	device->CreateUnorderedAccessView(hkzTex2D, &hkzTexUAVDesc, &htzUAV);
-
-	hkzTex2D->Release();
-
-
-	//twiddle indices texture
-	ID3D11Texture2D* twiddleIndicesTex;
-
-	D3D11_TEXTURE2D_DESC twiddleIndicesTexDesc = {};
-	twiddleIndicesTexDesc.Width = bits;
-	twiddleIndicesTexDesc.Height = texSize;
-	twiddleIndicesTexDesc.ArraySize = 1;
-	twiddleIndicesTexDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
-	twiddleIndicesTexDesc.CPUAccessFlags = 0;
-	twiddleIndicesTexDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-	twiddleIndicesTexDesc.MipLevels = 1;
-	twiddleIndicesTexDesc.MiscFlags = 0;
-	twiddleIndicesTexDesc.SampleDesc.Count = 1;
-	twiddleIndicesTexDesc.SampleDesc.Quality = 0;
-	twiddleIndicesTexDesc.Usage = D3D11_USAGE_DEFAULT;
-	device->CreateTexture2D(&twiddleIndicesTexDesc, 0, &twiddleIndicesTex);
-
-	D3D11_SHADER_RESOURCE_VIEW_DESC twiddleIndicesSRVDesc = {};
-	twiddleIndicesSRVDesc.Format = twiddleIndicesTexDesc.Format;
-	twiddleIndicesSRVDesc.Texture2D.MipLevels = 1;
-	twiddleIndicesSRVDesc.Texture2D.MostDetailedMip = 0;
-	twiddleIndicesSRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-	device->CreateShaderResourceView(twiddleIndicesTex, &twiddleIndicesSRVDesc, &twiddleSRV);
-
-	D3D11_UNORDERED_ACCESS_VIEW_DESC twiddleIndicesUAVDesc = {};
-	twiddleIndicesUAVDesc.Format = twiddleIndicesTexDesc.Format;
-	twiddleIndicesUAVDesc.Texture2D.MipSlice = 0;
-	twiddleIndicesUAVDesc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
-	device->CreateUnorderedAccessView(twiddleIndicesTex, &twiddleIndicesUAVDesc, &twiddleUAV);
-
-	twiddleIndicesTex->Release();
-
-	//pingpong0
-	ID3D11Texture2D* pingpong0Tex;
-
-	D3D11_TEXTURE2D_DESC pingpong0TexDesc = {};
-	pingpong0TexDesc.Width = texSize;
-	pingpong0TexDesc.Height = texSize;
-	pingpong0TexDesc.ArraySize = 1;
-	pingpong0TexDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
-	pingpong0TexDesc.CPUAccessFlags = 0;
-	pingpong0TexDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-	pingpong0TexDesc.MipLevels = 1;
-	pingpong0TexDesc.MiscFlags = 0;
-	pingpong0TexDesc.SampleDesc.Count = 1;
-	pingpong0TexDesc.SampleDesc.Quality = 0;
-	pingpong0TexDesc.Usage = D3D11_USAGE_DEFAULT;
-	device->CreateTexture2D(&pingpong0TexDesc, 0, &pingpong0Tex);
-
-	D3D11_SHADER_RESOURCE_VIEW_DESC pingpong0SRVDesc = {};
-	pingpong0SRVDesc.Format = pingpong0TexDesc.Format;
-	pingpong0SRVDesc.Texture2D.MipLevels = 1;
-	pingpong0SRVDesc.Texture2D.MostDetailedMip = 0;
-	pingpong0SRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-	device->CreateShaderResourceView(pingpong0Tex, &pingpong0SRVDesc, &pingpong0SRV);
-
-	D3D11_UNORDERED_ACCESS_VIEW_DESC pingpong0UAVDesc = {};
-	pingpong0UAVDesc.Format = pingpong0TexDesc.Format;
-	pingpong0UAVDesc.Texture2D.MipSlice = 0;
-	pingpong0UAVDesc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
-	device->CreateUnorderedAccessView(pingpong0Tex, &pingpong0UAVDesc, &pingpong0UAV);
-
-	pingpong0Tex->Release();
-
-	//pingpong1
-	ID3D11Texture2D* pingpong1Tex;
-
-	D3D11_TEXTURE2D_DESC pingpong1TexDesc = {};
-	pingpong1TexDesc.Width = texSize;
-	pingpong1TexDesc.Height = texSize;
-	pingpong1TexDesc.ArraySize = 1;
-	pingpong1TexDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
-	pingpong1TexDesc.CPUAccessFlags = 0;
-	pingpong1TexDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-	pingpong1TexDesc.MipLevels = 1;
-	pingpong1TexDesc.MiscFlags = 0;
-	pingpong1TexDesc.SampleDesc.Count = 1;
-	pingpong1TexDesc.SampleDesc.Quality = 0;
-	pingpong1TexDesc.Usage = D3D11_USAGE_DEFAULT;
-	device->CreateTexture2D(&pingpong1TexDesc, 0, &pingpong1Tex);
-
-	D3D11_SHADER_RESOURCE_VIEW_DESC pingpong1SRVDesc = {};
-	pingpong1SRVDesc.Format = pingpong1TexDesc.Format;
-	pingpong1SRVDesc.Texture2D.MipLevels = 1;
-	pingpong1SRVDesc.Texture2D.MostDetailedMip = 0;
-	pingpong1SRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-	device->CreateShaderResourceView(pingpong1Tex, &pingpong1SRVDesc, &dySRV);
-
-	D3D11_UNORDERED_ACCESS_VIEW_DESC pingpong1UAVDesc = {};
-	pingpong1UAVDesc.Format = pingpong1TexDesc.Format;
-	pingpong1UAVDesc.Texture2D.MipSlice = 0;
-	pingpong1UAVDesc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
-	device->CreateUnorderedAccessView(pingpong1Tex, &pingpong1UAVDesc, &dyUAV);
-
-	pingpong1Tex->Release();
-
-	//dx
-	ID3D11Texture2D* dxTex;
-
-	D3D11_TEXTURE2D_DESC dxTexDesc = {};
-	dxTexDesc.Width = texSize;
-	dxTexDesc.Height = texSize;
-	dxTexDesc.ArraySize = 1;
-	dxTexDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
-	dxTexDesc.CPUAccessFlags = 0;
-	dxTexDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-	dxTexDesc.MipLevels = 1;
-	dxTexDesc.MiscFlags = 0;
-	dxTexDesc.SampleDesc.Count = 1;
-	dxTexDesc.SampleDesc.Quality = 0;
-	dxTexDesc.Usage = D3D11_USAGE_DEFAULT;
-	device->CreateTexture2D(&dxTexDesc, 0, &dxTex);
-
-	D3D11_SHADER_RESOURCE_VIEW_DESC dxSRVDesc = {};
-	dxSRVDesc.Format = dxTexDesc.Format;
-	dxSRVDesc.Texture2D.MipLevels = 1;
-	dxSRVDesc.Texture2D.MostDetailedMip = 0;
-	dxSRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-	device->CreateShaderResourceView(dxTex, &dxSRVDesc, &dxSRV);
-
-	D3D11_UNORDERED_ACCESS_VIEW_DESC dxUAVDesc = {};
-	dxUAVDesc.Format = dxTexDesc.Format;
-	dxUAVDesc.Texture2D.MipSlice = 0;
-	dxUAVDesc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
-	device->CreateUnorderedAccessView(dxTex, &dxUAVDesc, &dxUAV);
-
-	dxTex->Release();
-
-	//dz
-	ID3D11Texture2D* dzTex;
-
-	D3D11_TEXTURE2D_DESC dzTexDesc = {};
-	dzTexDesc.Width = texSize;
-	dzTexDesc.Height = texSize;
-	dzTexDesc.ArraySize = 1;
-	dzTexDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
-	dzTexDesc.CPUAccessFlags = 0;
-	dzTexDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-	dzTexDesc.MipLevels = 1;
-	dzTexDesc.MiscFlags = 0;
-	dzTexDesc.SampleDesc.Count = 1;
-	dzTexDesc.SampleDesc.Quality = 0;
-	dzTexDesc.Usage = D3D11_USAGE_DEFAULT;
-	device->CreateTexture2D(&dzTexDesc, 0, &dzTex);
-
-	D3D11_SHADER_RESOURCE_VIEW_DESC dzSRVDesc = {};
-	dzSRVDesc.Format = dzTexDesc.Format;
-	dzSRVDesc.Texture2D.MipLevels = 1;
-	dzSRVDesc.Texture2D.MostDetailedMip = 0;
-	dzSRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-	device->CreateShaderResourceView(dzTex, &dzSRVDesc, &dzSRV);
-
-	D3D11_UNORDERED_ACCESS_VIEW_DESC dzUAVDesc = {};
-	dzUAVDesc.Format = dzTexDesc.Format;
-	dzUAVDesc.Texture2D.MipSlice = 0;
-	dzUAVDesc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
-	device->CreateUnorderedAccessView(dzTex, &dzUAVDesc, &dzUAV);
-
-	dzTex->Release();
-	
+	waves.AddWave(XMFLOAT4(1.0f, 1.0f, 0.3f, 2.0f));
+	waves.AddWave(XMFLOAT4(0, 1, 0.3f, 2.0f));
+	waves.AddWave(XMFLOAT4(-1, 1, 0.3f, 2.0f));
+	waves.AddWave(XMFLOAT4(1, 0, 0.3f, 2.0f));
+
+	//the world matrix is set every update, starting with identity until then
+	XMStoreFloat4x4(&worldMat, XMMatrixIdentity());
+
+	//WaterDS scales the maps by 0.02 of the 300 metre quad, a few metres a cascade, and
+	//moves the surface sideways by nearly twice that
+	quadtree.SetBounds(-2.0f, 20.0f);
+
+	D3D11_BUFFER_DESC patchBufferDesc = {};
+	patchBufferDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	patchBufferDesc.ByteWidth = MAX_OCEAN_PATCHES * sizeof(OceanPatch);
+	patchBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	patchBufferDesc.StructureByteStride = sizeof(OceanPatch);
+	patchBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	patchBufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+	device->CreateBuffer(&patchBufferDesc, 0, &patchBuffer);
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC patchSRVDesc = {};
+	patchSRVDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+	patchSRVDesc.Format = DXGI_FORMAT_UNKNOWN;
+	patchSRVDesc.Buffer.FirstElement = 0;
+	patchSRVDesc.Buffer.NumElements = MAX_OCEAN_PATCHES;
+	device->CreateShaderResourceView(patchBuffer, &patchSRVDesc, &patchSRV);
+
+	//the wake's heights, only the tiles the particles touch are written each frame
+	D3D11_TEXTURE2D_DESC wakeDesc = {};
+	wakeDesc.Width = wake.GetResolution();
+	wakeDesc.Height = wake.GetResolution();
+	wakeDesc.ArraySize = 1;
+	wakeDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	wakeDesc.Format = DXGI_FORMAT_R32_FLOAT;
+	wakeDesc.MipLevels = 1;
+	wakeDesc.SampleDesc.Count = 1;
+	wakeDesc.Usage = D3D11_USAGE_DEFAULT;
+	std::vector<float> flat(wake.GetResolution() * wake.GetResolution(), 0.0f);
+	D3D11_SUBRESOURCE_DATA wakeData = {};
+	wakeData.pSysMem = flat.data();
+	wakeData.SysMemPitch = sizeof(float) * wake.GetResolution();
+	device->CreateTexture2D(&wakeDesc, &wakeData, &wakeTexture);
+	device->CreateShaderResourceView(wakeTexture, nullptr, &wakeSRV);
+	lastShipPos = XMFLOAT3(0, 0, 0);
+	wakeDistance = -1.0f;
+
+	//the cascades from the longest patch down, as many as the shaders have maps for
+	std::vector<OceanCascadeDesc> descs = cascadeDescs;
+	std::sort(descs.begin(), descs.end(),
+		[](const OceanCascadeDesc& a, const OceanCascadeDesc& b) { return a.L > b.L; });
+	if (descs.size() > MAX_OCEAN_CASCADES)
+		descs.resize(MAX_OCEAN_CASCADES);
+	if (descs.empty())
+		descs.push_back(OceanCascadeDesc{ 256, 1000, 1 });
+
+	for (auto& desc : descs)
+	{
+		//the sizes CreateFFTPlan has a plan for
+		if (desc.fftSize < 64 || desc.fftSize > 1024 || (desc.fftSize & (desc.fftSize - 1)) != 0)
+			desc.fftSize = 256;
+	}
+	this->cascadeDescs = descs;
+
+	std::vector<OceanSpectrumDesc> spectra = SplitSpectrum(spectrumDesc);
+	for (size_t i = 0; i < descs.size(); i++)
+	{
+		cascades.emplace_back(std::make_unique<OceanCascade>(device, *spectrum.GetH0(spectra[i]),
+			descs[i].L, descs[i].updateInterval, (int)i));
+	}
+	frame = 0;
 
-	//normal map
-	ID3D11Texture2D* normalMapTex;
-
-	D3D11_TEXTURE2D_DESC normalMapTexDesc = {};
-	normalMapTexDesc.Width = texSize;
-	normalMapTexDesc.Height = texSize;
-	normalMapTexDesc.ArraySize = 1;
-	normalMapTexDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
-	normalMapTexDesc.CPUAccessFlags = 0;
-	normalMapTexDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-	normalMapTexDesc.MipLevels = 1;
-	normalMapTexDesc.MiscFlags = 0;
-	normalMapTexDesc.SampleDesc.Count = 1;
-	normalMapTexDesc.SampleDesc.Quality = 0;
-	normalMapTexDesc.Usage = D3D11_USAGE_DEFAULT;
-	device->CreateTexture2D(&normalMapTexDesc, 0, &normalMapTex);
-
-	D3D11_SHADER_RESOURCE_VIEW_DESC normalMapSRVDesc = {};
-	normalMapSRVDesc.Format = normalMapTexDesc.Format;
-	normalMapSRVDesc.Texture2D.MipLevels = 1;
-	normalMapSRVDesc.Texture2D.MostDetailedMip = 0;
-	normalMapSRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-	device->CreateShaderResourceView(normalMapTex, &normalMapSRVDesc, &normalMapSRV);
-
-	D3D11_UNORDERED_ACCESS_VIEW_DESC normalMapUAVDesc = {};
-	normalMapUAVDesc.Format = normalMapTexDesc.Format;
-	normalMapUAVDesc.Texture2D.MipSlice = 0;
-	normalMapUAVDesc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
-	device->CreateUnorderedAccessView(normalMapTex, &normalMapUAVDesc, &normalMapUAV);
-
-	normalMapTex->Release();
-
-	//folding map
-	ID3D11Texture2D* foldingMapTex;
-
-	D3D11_TEXTURE2D_DESC foldingMapTexDesc = {};
-	foldingMapTexDesc.Width = texSize;
-	foldingMapTexDesc.Height = texSize;
-	foldingMapTexDesc.ArraySize = 1;
-	foldingMapTexDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
-	foldingMapTexDesc.CPUAccessFlags = 0;
-	foldingMapTexDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-	foldingMapTexDesc.MipLevels = 1;
-	foldingMapTexDesc.MiscFlags = 0;
-	foldingMapTexDesc.SampleDesc.Count = 1;
-	foldingMapTexDesc.SampleDesc.Quality = 0;
-	foldingMapTexDesc.Usage = D3D11_USAGE_DEFAULT;
-	device->CreateTexture2D(&foldingMapTexDesc, 0, &foldingMapTex);
-
-	D3D11_SHADER_RESOURCE_VIEW_DESC foldingMapSRVDesc = {};
-	foldingMapSRVDesc.Format = foldingMapTexDesc.Format;
-	foldingMapSRVDesc.Texture2D.MipLevels = 1;
-	foldingMapSRVDesc.Texture2D.MostDetailedMip = 0;
-	foldingMapSRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-	device->CreateShaderResourceView(foldingMapTex, &foldingMapSRVDesc, &foldingMapSRV);
-
-	D3D11_UNORDERED_ACCESS_VIEW_DESC foldingMapUAVDesc = {};
-	foldingMapUAVDesc.Format = normalMapTexDesc.Format;
-	foldingMapUAVDesc.Texture2D.MipSlice = 0;
-	foldingMapUAVDesc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
-	device->CreateUnorderedAccessView(foldingMapTex, &foldingMapUAVDesc, &foldingMapUAV);
-
-	foldingMapTex->Release();
+	for (int i = 0; i < 5; i++)
+	{
+		bakedTextures[i] = nullptr;
+		bakedSRVs[i] = nullptr;
+	}
 }
 
 Water::~Water()
 {
-	h0MinusURV->Release();
-	h0URV->Release();
-	h0SRV->Release();
-	h0MinusSRV->Release();
-
-	htxSRV->Release();
-	htxUAV->Release();
-
-	htySRV->Release();
-	htyUAV->Release();
+	patchBuffer->Release();
+	patchSRV->Release();
+	wakeTexture->Release();
+	wakeSRV->Release();
 
-	htzSRV->Release();
-	htzUAV->Release();
-
-	twiddleSRV->Release();
-	twiddleUAV->Release();
-
-	pingpong0SRV->Release();
-	pingpong0UAV->Release();
-
-	dySRV->Release();
-	dyUAV->Release();
-
-	dxSRV->Release();
-	dxUAV->Release();
-
-	dzSRV->Release();
-	dzUAV->Release();
-
-	normalMapSRV->Release();
-	normalMapUAV->Release();
+	//the cascades release their own maps
+	for (int i = 0; i < 5; i++)
+	{
+		if (bakedTextures[i])
+			bakedTextures[i]->Release();
+		if (bakedSRVs[i])
+			bakedSRVs[i]->Release();
+	}
 }
 
 void Water::Update(float deltaTime,XMFLOAT3 shipPos)
@@ -477,28 +138,117 @@ void Water::Update(float deltaTime,XMFLOAT3 shipPos)
 	XMMATRIX rot = XMMatrixRotationQuaternion(XMQuaternionIdentity());
 
 	XMStoreFloat4x4(&worldMat, XMMatrixTranspose(matScale* rot* matTrans));
+
+	//the ship leaves a ring every couple of metres, higher the faster it goes
+	if (wakeDistance < 0.0f)
+	{
+		lastShipPos = shipPos;
+		wakeDistance = 0.0f;
+	}
+	float dx = shipPos.x - lastShipPos.x;
+	float dz = shipPos.z - lastShipPos.z;
+	float moved = sqrtf(dx * dx + dz * dz);
+	wakeDistance += moved;
+	if (wakeDistance >= 2.0f && deltaTime > 0.0f)
+	{
+		float speed = moved / deltaTime;
+		wake.EmitRing(shipPos.x, shipPos.z, speed * 0.02f < 0.4f ? speed * 0.02f : 0.4f, 24);
+		wakeDistance = 0.0f;
+	}
+	lastShipPos = shipPos;
+
+	wake.Update(deltaTime);
+	wake.Splat(shipPos.x, shipPos.z);
+}
+
+void Water::UpdateWakeMap(ID3D11DeviceContext* context)
+{
+	//one box a tile, the tiles cleared since the last upload go up as zeroes. every fixed step
+	//this frame splatted, so the list has all of their tiles
+	int resolution = wake.GetResolution();
+	int tilesARow = resolution / WAKE_TILE_SIZE;
+	const std::vector<float>& heights = wake.GetHeights();
+	for (int tile : wake.GetDirtyTiles())
+	{
+		int x = (tile % tilesARow) * WAKE_TILE_SIZE;
+		int y = (tile / tilesARow) * WAKE_TILE_SIZE;
+		D3D11_BOX box = { (UINT)x, (UINT)y, 0, (UINT)(x + WAKE_TILE_SIZE), (UINT)(y + WAKE_TILE_SIZE), 1 };
+		context->UpdateSubresource(wakeTexture, 0, &box, &heights[y * resolution + x], sizeof(float) * resolution, 0);
+	}
+	wake.ClearDirtyTiles();
+}
+
+void Water::AddSplash(XMFLOAT3 position, float strength)
+{
+	wake.EmitRing(position.x, position.z, strength, 32);
+}
+
+WaveParticles& Water::GetWake()
+{
+	return wake;
 }
 
 void Water::Draw(Light lights, ID3D11ShaderResourceView* cubeMap, std::shared_ptr<Camera> camera,
 	ID3D11DeviceContext* context, float deltaTime, float totalTime, ID3D11SamplerState* waterSampler)
 {
 
-	RenderFFT(totalTime*1.4);
+	//the maps the surface is drawn with, the cascades' or the baked loop's
+	ID3D11ShaderResourceView* heightSRV;
+	ID3D11ShaderResourceView* heightXSRV;
+	ID3D11ShaderResourceView* heightZSRV;
+	ID3D11ShaderResourceView* normalSRV;
+	ID3D11ShaderResourceView* foldingSRV;
+	int cascadeCount = (int)cascades.size();
+	if (bakedOcean)
+	{
+		//the same time RenderFFT gives HtOceanCS
+		UpdateBakedMaps(context, totalTime * 1.4f + 500);
+		heightXSRV = bakedSRVs[0];
+		heightSRV = bakedSRVs[1];
+		heightZSRV = bakedSRVs[2];
+		normalSRV = bakedSRVs[3];
+		foldingSRV = bakedSRVs[4];
+		cascadeCount = 1;
+	}
+	else
+	{
+		RenderFFT(totalTime*1.4);
+		heightXSRV = cascades[0]->GetDisplacementSRV(0);
+		heightSRV = cascades[0]->GetDisplacementSRV(1);
+		heightZSRV = cascades[0]->GetDisplacementSRV(2);
+		normalSRV = cascades[0]->GetNormalMapSRV();
+		foldingSRV = cascades[0]->GetFoldingMapSRV();
+	}
 
 	//static float totalTime = 0;
 	//totalTime += deltaTime;
-	
-	waterVS->SetShaderResourceView("heightMap", dySRV);
-	waterVS->SetShaderResourceView("heightMapX", dxSRV);
-	waterVS->SetShaderResourceView("heightMapZ", dzSRV);
+
+	//the patches around the camera this frame, anything past the buffer is left out
+	quadtree.Update(camera->GetPosition(), camera->GetViewMatrix(), camera->GetProjectionMatrix());
+	const std::vector<OceanPatch>& patches = quadtree.GetPatches();
+	int patchCount = (int)patches.size() < MAX_OCEAN_PATCHES ? (int)patches.size() : MAX_OCEAN_PATCHES;
+	D3D11_MAPPED_SUBRESOURCE mapped = {};
+	context->Map(patchBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+	memcpy(mapped.pData, patches.data(), sizeof(OceanPatch) * patchCount);
+	context->Unmap(patchBuffer, 0);
+
+	//worldMat is already transposed, and so is its inverse
+	XMFLOAT4X4 worldInverse;
+	XMStoreFloat4x4(&worldInverse, XMMatrixInverse(nullptr, XMLoadFloat4x4(&worldMat)));
+
+	waterVS->SetShaderResourceView("patches", patchSRV);
+	waterVS->SetMatrix4x4("worldInverse", worldInverse);
+	waterVS->SetShaderResourceView("heightMap", heightSRV);
+	waterVS->SetShaderResourceView("heightMapX", heightXSRV);
+	waterVS->SetShaderResourceView("heightMapZ", heightZSRV);
 	waterVS->SetSamplerState("sampleOptions", samplerState);
 	waterVS->SetMatrix4x4("world", worldMat);
 	waterVS->SetMatrix4x4("view", camera->GetViewMatrix());
 	waterVS->SetMatrix4x4("projection", camera->GetProjectionMatrix());
-	waterVS->SetFloat4("waveA", XMFLOAT4(1.0f, 1.0f, 0.3f, 2.0f));
-	waterVS->SetFloat4("waveB", XMFLOAT4(0, 1, 0.3f, 2.0f));
-	waterVS->SetFloat4("waveC", XMFLOAT4(-1, 1, 0.3f, 2.0f));
-	waterVS->SetFloat4("waveD", XMFLOAT4(1, 0, 0.3f, 2.0f));
+	waterVS->SetFloat4("waveA", waves.GetWave(0));
+	waterVS->SetFloat4("waveB", waves.GetWave(1));
+	waterVS->SetFloat4("waveC", waves.GetWave(2));
+	waterVS->SetFloat4("waveD", waves.GetWave(3));
 	waterVS->SetFloat("speed", 0.60f);
 	waterVS->SetFloat2("windDir", XMFLOAT2(1, 1));
 	waterVS->SetFloat("windSpeed", 40);
@@ -521,8 +271,24 @@ void Water::Draw(Light lights, ID3D11ShaderResourceView* cubeMap, std::shared_pt
 	waterPS->SetShaderResourceView("waterTexture", waterTex);
 	waterPS->SetShaderResourceView("normalTexture1", waterNormal1);
 	waterPS->SetShaderResourceView("normalTexture2", waterNormal2);
-	waterPS->SetShaderResourceView("normalTexture3", normalMapSRV);
-	waterPS->SetShaderResourceView("foldingMap", foldingMapSRV);
+	//the first cascade keeps the old names, the rest are numbered. the uv of every cascade is
+	//scaled by how many of its patches fit in the first one's
+	XMFLOAT4 cascadeScale(1, 1, 1, 1);
+	float* scales = &cascadeScale.x;
+	for (int i = 1; i < cascadeCount; i++)
+	{
+		scales[i] = (float)cascades[0]->GetL() / cascades[i]->GetL();
+	}
+
+	waterPS->SetShaderResourceView("normalTexture3", normalSRV);
+	waterPS->SetShaderResourceView("foldingMap", foldingSRV);
+	for (int i = 1; i < cascadeCount; i++)
+	{
+		waterPS->SetShaderResourceView("normalMap" + std::to_string(i), cascades[i]->GetNormalMapSRV());
+		waterPS->SetShaderResourceView("foldingMap" + std::to_string(i), cascades[i]->GetFoldingMapSRV());
+	}
+	waterPS->SetFloat4("cascadeScale", cascadeScale);
+	waterPS->SetInt("cascadeCount", cascadeCount);
 	waterPS->SetSamplerState("sampleOptions", samplerState);
 	waterPS->SetSamplerState("waterSampleOptions", waterSampler);
 
@@ -540,68 +306,119 @@ void Water::Draw(Light lights, ID3D11ShaderResourceView* cubeMap, std::shared_pt
 	waterDS->SetMatrix4x4("world", worldMat);
 	waterDS->SetFloat3("cameraPos", camera->GetPosition());
 
-	waterDS->SetShaderResourceView("heightMap", dySRV);
-	waterDS->SetShaderResourceView("heightMapX", dxSRV);
-	waterDS->SetShaderResourceView("heightMapZ", dzSRV);
+	waterDS->SetShaderResourceView("heightMap", heightSRV);
+	waterDS->SetShaderResourceView("heightMapX", heightXSRV);
+	waterDS->SetShaderResourceView("heightMapZ", heightZSRV);
+	for (int i = 1; i < cascadeCount; i++)
+	{
+		std::string index = std::to_string(i);
+		waterDS->SetShaderResourceView("heightMap" + index, cascades[i]->GetDisplacementSRV(1));
+		waterDS->SetShaderResourceView("heightMapX" + index, cascades[i]->GetDisplacementSRV(0));
+		waterDS->SetShaderResourceView("heightMapZ" + index, cascades[i]->GetDisplacementSRV(2));
+	}
+	waterDS->SetFloat4("cascadeScale", cascadeScale);
+	waterDS->SetInt("cascadeCount", cascadeCount);
+	UpdateWakeMap(context);
+	waterDS->SetShaderResourceView("wakeMap", wakeSRV);
+	//texel i of the grid is at the origin plus i cells, the texture has it half a texel in
+	XMFLOAT2 wakeOrigin = wake.GetGridOrigin();
+	wakeOrigin.x -= wake.GetCellSize() * 0.5f;
+	wakeOrigin.y -= wake.GetCellSize() * 0.5f;
+	waterDS->SetFloat2("wakeOrigin", wakeOrigin);
+	waterDS->SetFloat("wakeSize", wake.GetResolution() * wake.GetCellSize());
 	waterDS->SetSamplerState("sampleOptions", samplerState);
 	waterDS->CopyAllBufferData();
 	waterDS->SetShader();
 
-	UINT stride = sizeof(Vertex);
+	//WaterVS makes the vertices from the patch buffer, nothing comes from the input assembler
+	UINT stride = 0;
 	UINT offset = 0;
-	auto tempVertBuffer = waterMesh->GetVertexBuffer();
-	context->IASetVertexBuffers(0, 1, &tempVertBuffer, &stride, &offset);
-	context->IASetIndexBuffer(waterMesh->GetIndexBuffer(), DXGI_FORMAT_R32_UINT, 0);
+	ID3D11Buffer* nullBuffer = nullptr;
+	context->IASetVertexBuffers(0, 1, &nullBuffer, &stride, &offset);
+	context->IASetIndexBuffer(nullptr, DXGI_FORMAT_R32_UINT, 0);
 
 	context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_3_CONTROL_POINT_PATCHLIST);
-	context->DrawIndexed(waterMesh->GetIndexCount(), 0, 0);
+	context->DrawInstanced(6, patchCount, 0, 0);
 	context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	context->HSSetShader(nullptr, 0, 0);
 	context->DSSetShader(nullptr, 0, 0);
 
 }
 
-void Water::CreateH0Texture()
+std::vector<OceanSpectrumDesc> Water::SplitSpectrum(const OceanSpectrumDesc& desc)
+{
+	const float PI = 3.14159265f;
+	std::vector<OceanSpectrumDesc> spectra;
+	float kMin = 0;
+	for (size_t i = 0; i < cascadeDescs.size(); i++)
+	{
+		//the next cascade takes over six of its own wavelengths into its patch, so it never
+		//shows one wave tiled, unless this one runs out of texels before that
+		float kMax = 0;
+		if (i + 1 < cascadeDescs.size())
+		{
+			float nyquist = PI * cascadeDescs[i].fftSize / cascadeDescs[i].L;
+			kMax = 6 * 2 * PI / cascadeDescs[i + 1].L;
+			if (kMax > 0.5f * nyquist)
+				kMax = 0.5f * nyquist;
+		}
+
+		OceanSpectrumDesc cascadeSpectrum = desc;
+		cascadeSpectrum.fftRes = cascadeDescs[i].fftSize;
+		cascadeSpectrum.L = cascadeDescs[i].L;
+		cascadeSpectrum.kMin = kMin;
+		cascadeSpectrum.kMax = kMax;
+		cascadeSpectrum.seed = desc.seed + (unsigned int)i;
+
+		//phillips is tuned to the first patch, each mode's height goes with the size of the
+		//wave number grid, 2 pi / L, and the inverse fft divides by size squared, so amp is
+		//scaled to keep all cascades on the first one's spectrum. the others are in metres
+		if (desc.type == OceanSpectrumType::Phillips)
+		{
+			float scale = ((float)cascadeDescs[0].L / cascadeDescs[i].L) *
+				((float)cascadeDescs[i].fftSize / cascadeDescs[0].fftSize) *
+				((float)cascadeDescs[i].fftSize / cascadeDescs[0].fftSize);
+			cascadeSpectrum.amp = desc.amp * scale * scale;
+		}
+
+		spectra.push_back(cascadeSpectrum);
+		kMin = kMax;
+	}
+	return spectra;
+}
+
+void Water::SetSpectrum(const OceanSpectrumDesc& desc, ID3D11DeviceContext* context)
+{
+	spectrumDesc = desc;
+	std::vector<OceanSpectrumDesc> spectra = SplitSpectrum(desc);
+	for (size_t i = 0; i < cascades.size(); i++)
+	{
+		cascades[i]->UploadH0(context, *spectrum.GetH0(spectra[i]));
+	}
+}
+
+const OceanSpectrumDesc& Water::GetSpectrum()
 {
-	h0CS->SetInt("fftRes", 256);
-	h0CS->SetInt("L", 1000);
-	h0CS->SetFloat("amp", 4);
-	h0CS->SetFloat2("windDir", XMFLOAT2(1, 1));
-	h0CS->SetFloat("windSpeed", 40.0f);
-
-	h0CS->SetShaderResourceView("noiseR1", noiseR1);
-	h0CS->SetShaderResourceView("noiseI1", noiseI1);
-	h0CS->SetShaderResourceView("noiseR2", noiseR2);
-	h0CS->SetShaderResourceView("noiseI2", noiseI2);
-	h0CS->SetSamplerState("sampleOptions", samplerState);
-
-	h0CS->SetUnorderedAccessView("tildeH0", h0URV);
-	h0CS->SetUnorderedAccessView("tildeMinusH0", h0MinusURV);
-
-	h0CS->CopyAllBufferData();
-	h0CS->SetShader();
-	h0CS->DispatchByThreads(256, 256, 1);
-
-	h0CS->SetUnorderedAccessView("tildeH0", 0);
-	h0CS->SetUnorderedAccessView("tildeMinusH0", 0);
+	return spectrumDesc;
 }
 
-void Water::CreateHtTexture(float totalTime)
+void Water::CreateHtTexture(OceanCascade& cascade, float totalTime)
 {
-	htCS->SetInt("fftRes", 256);
-	htCS->SetInt("L", 1000);
+	htCS->SetInt("fftRes", cascade.GetSize());
+	htCS->SetInt("L", cascade.GetL());
 	htCS->SetFloat("time", totalTime);
+	htCS->SetFloat("loopPeriod", 0);
 
 	htCS->SetShader();
 	
-	htCS->SetUnorderedAccessView("tildeH0", h0URV);
-	htCS->SetUnorderedAccessView("tildeMinusH0", h0MinusURV);
-	htCS->SetUnorderedAccessView("tildeHktDx", htxUAV);
-	htCS->SetUnorderedAccessView("tildeHktDy", htyUAV);
-	htCS->SetUnorderedAccessView("tildeHktDz", htzUAV);
+	htCS->SetUnorderedAccessView("tildeH0", cascade.GetH0UAV());
+	htCS->SetUnorderedAccessView("tildeMinusH0", cascade.GetH0MinusUAV());
+	htCS->SetUnorderedAccessView("tildeHktDx", cascade.GetSpectrumUAV(0));
+	htCS->SetUnorderedAccessView("tildeHktDy", cascade.GetSpectrumUAV(1));
+	htCS->SetUnorderedAccessView("tildeHktDz", cascade.GetSpectrumUAV(2));
 
 	htCS->CopyAllBufferData();
-	htCS->DispatchByThreads(256, 256, 1);
+	htCS->DispatchByThreads(cascade.GetSize(), cascade.GetSize(), 1);
 
 	htCS->SetUnorderedAccessView("tildeH0", 0);
 	htCS->SetUnorderedAccessView("tildeMinusH0", 0);
@@ -610,249 +427,238 @@ void Water::CreateHtTexture(float totalTime)
 	htCS->SetUnorderedAccessView("tildeHktDz", 0);
 }
 
-int Water::CreateBitReversedIndices(int num, int d)
+void Water::RunFFT(OceanCascade& cascade, ID3D11UnorderedAccessView* spectrum, ID3D11UnorderedAccessView* output)
 {
-	unsigned int count = sizeof(num) * 8 - 1;
-	unsigned int reverseNum = num;
+	int texSize = cascade.GetSize();
+	const FFTPassPlan* fftPlan = cascade.GetPlan();
 
-	num >>= 1;
-	while (num)
-	{
-		reverseNum <<= 1;
-		reverseNum |= num & 1;
-		num >>= 1;
-		count--;
-	}
-	//this is our bit reversed number
-	reverseNum <<= count;
+	fftStageCS->SetShader();
+	fftStageCS->SetShaderResourceView("twiddles", cascade.GetTwiddleSRV());
+	fftStageCS->SetUnorderedAccessView("pingpong0", spectrum);
+	fftStageCS->SetUnorderedAccessView("pingpong1", cascade.GetPingpongUAV());
+	fftStageCS->SetInt("fftRes", texSize);
 
-	//rotating this number left
-	return (reverseNum << d) | (reverseNum >> (CHAR_BIT * sizeof(reverseNum) - d));
-}
-
-void Water::CreateTwiddleIndices()
-{
-	BitIndices bitreversedIndices[256];
-
-	int bits = (int)(log(256) / log(2));
+	int pingpong = 0;
 
-	for (int i = 0; i < 256; i++)
+	//horizontal fft, then vertical, each pass doing a whole radix 2, 4 or 8 step
+	for (int direction = 0; direction < 2; direction++)
 	{
-		bitreversedIndices[i].index = CreateBitReversedIndices(i, bits);
-	}
+		for (int i = 0; i < fftPlan->GetStageCount(); i++)
+		{
+			FFTStage stage = fftPlan->GetStage(i);
+			fftStageCS->SetInt("radix", stage.radix);
+			fftStageCS->SetInt("span", stage.span);
+			fftStageCS->SetInt("direction", direction);
+			fftStageCS->SetInt("pingpong", pingpong);
+			fftStageCS->CopyAllBufferData();
+			fftStageCS->DispatchByThreads(texSize / stage.radix, texSize, 1);
 
-	twiddleFactorsCS->SetInt("fftRes", 256);
-	twiddleFactorsCS->SetData("indices", &bitreversedIndices[0], sizeof(BitIndices) * 256);
-	twiddleFactorsCS->SetUnorderedAccessView("twiddleIndices", twiddleUAV);
+			pingpong++;
+			pingpong %= 2;
+		}
+	}
 
-	twiddleFactorsCS->CopyAllBufferData();
-	twiddleFactorsCS->SetShader();
-	twiddleFactorsCS->DispatchByThreads(bits, 256, 1);
+	fftStageCS->SetShaderResourceView("twiddles", 0);
+	fftStageCS->SetUnorderedAccessView("pingpong0", 0);
+	fftStageCS->SetUnorderedAccessView("pingpong1", 0);
 
-	twiddleFactorsCS->SetUnorderedAccessView("twiddleIndices", 0);
+	inversionCS->SetShader();
+	inversionCS->SetInt("N", texSize);
+	inversionCS->SetInt("pingpong", pingpong);
+	inversionCS->SetUnorderedAccessView("displacement", output);
+	inversionCS->SetUnorderedAccessView("pingpong0", spectrum);
+	inversionCS->SetUnorderedAccessView("pingpong1", cascade.GetPingpongUAV());
+	inversionCS->CopyAllBufferData();
+	inversionCS->DispatchByThreads(texSize, texSize, 1);
+	inversionCS->SetUnorderedAccessView("displacement", 0);
+	inversionCS->SetUnorderedAccessView("pingpong0", 0);
+	inversionCS->SetUnorderedAccessView("pingpong1", 0);
 }
 
 void Water::RenderFFT(float totalTime)
 {
-	CreateHtTexture(totalTime+500);
+	for (auto& cascade : cascades)
+	{
+		//slow cascades keep last frame's maps, they are rendered at the current time once due
+		if (!cascade->IsDue(frame))
+			continue;
+
+		int texSize = cascade->GetSize();
+
+		CreateHtTexture(*cascade, totalTime + 500);
+
+		RunFFT(*cascade, cascade->GetSpectrumUAV(1), cascade->GetDisplacementUAV(1));
+		RunFFT(*cascade, cascade->GetSpectrumUAV(0), cascade->GetDisplacementUAV(0));
+		RunFFT(*cascade, cascade->GetSpectrumUAV(2), cascade->GetDisplacementUAV(2));
+
+		jacobianCS->SetShader();
+		jacobianCS->SetUnorderedAccessView("heightMapDX", cascade->GetDisplacementUAV(0));
+		jacobianCS->SetUnorderedAccessView("heightMapDY", cascade->GetDisplacementUAV(1));
+		jacobianCS->SetUnorderedAccessView("foldingMap", cascade->GetFoldingMapUAV());
+		jacobianCS->CopyAllBufferData();
+		jacobianCS->DispatchByThreads(texSize, texSize, 1);
+		jacobianCS->SetUnorderedAccessView("heightMapDX",0);
+		jacobianCS->SetUnorderedAccessView("heightMapDY",0);
+		jacobianCS->SetUnorderedAccessView("foldingMap",0);
+
+
+		sobelFilter->SetShader();
+		sobelFilter->SetInt("N", texSize);
+		sobelFilter->SetFloat("normalStrength", 8);
+		sobelFilter->SetSamplerState("sampleOptions", samplerState);
+		sobelFilter->SetShaderResourceView("heightMap", cascade->GetDisplacementSRV(1));
+		sobelFilter->SetUnorderedAccessView("normalMap", cascade->GetNormalMapUAV());
+		sobelFilter->CopyAllBufferData();
+		sobelFilter->DispatchByThreads(texSize, texSize, 1);
+		sobelFilter->SetShaderResourceView("heightMap", 0);
+		sobelFilter->SetUnorderedAccessView("normalMap", 0);
+	}
 
-	butterflyCS->SetUnorderedAccessView("twiddleIndices", twiddleUAV);
-	butterflyCS->SetUnorderedAccessView("pingpong0", htyUAV);
-	butterflyCS->SetUnorderedAccessView("pingpong1", pingpong0UAV);
+	frame++;
+}
 
-	int log2N = (int)(log(256) / log(2));
+OceanSpectrumDesc Water::GetBakedSpectrum()
+{
+	OceanSpectrumDesc desc = SplitSpectrum(spectrumDesc)[0];
+	desc.kMax = 0;
+	return desc;
+}
 
-	int pingpong = 0;
+void Water::UseBakedOcean(std::shared_ptr<OceanCache> cache, ID3D11Device* device)
+{
+	bakedOcean = cache;
+	cascades.clear();
 
-	butterflyCS->SetShader();
-	
-	//horizontal fft
-	for (int i = 0; i < log2N; i++)
+	int size = cache->GetResolution();
+	for (int m = 0; m < CACHE_MAP_COUNT; m++)
 	{
-	
-		butterflyCS->SetInt("pingpong", pingpong);
-		butterflyCS->SetInt("direction", 0);
-		butterflyCS->SetInt("stage", i);
-		butterflyCS->CopyAllBufferData();
-		butterflyCS->DispatchByThreads(256, 256, 1);
-		
-	
-		pingpong++;
-		pingpong %= 2;
-	
+		bakedMaps[m].resize(size * size);
 	}
-	
-	//vertical fft
-	for (int i = 0; i < log2N; i++)
+
+	//the displacements and folding are single floats, the normal fits in a byte a component
+	DXGI_FORMAT formats[5] = { DXGI_FORMAT_R32_FLOAT, DXGI_FORMAT_R32_FLOAT, DXGI_FORMAT_R32_FLOAT,
+		DXGI_FORMAT_R8G8B8A8_SNORM, DXGI_FORMAT_R32_FLOAT };
+	for (int i = 0; i < 5; i++)
 	{
-		butterflyCS->SetInt("pingpong", pingpong);
-		butterflyCS->SetInt("direction", 1);
-		butterflyCS->SetInt("stage", i);
-		butterflyCS->CopyAllBufferData();
-		butterflyCS->DispatchByThreads(256, 256, 1);
-	
-		pingpong++;
-		pingpong %= 2;
-	
+		if (bakedTextures[i])
+			bakedTextures[i]->Release();
+		if (bakedSRVs[i])
+			bakedSRVs[i]->Release();
+
+		D3D11_TEXTURE2D_DESC texDesc = {};
+		texDesc.Width = size;
+		texDesc.Height = size;
+		texDesc.ArraySize = 1;
+		texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		texDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		texDesc.Format = formats[i];
+		texDesc.MipLevels = 1;
+		texDesc.MiscFlags = 0;
+		texDesc.SampleDesc.Count = 1;
+		texDesc.SampleDesc.Quality = 0;
+		texDesc.Usage = D3D11_USAGE_DYNAMIC;
+		device->CreateTexture2D(&texDesc, 0, &bakedTextures[i]);
+
+		D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+		srvDesc.Format = texDesc.Format;
+		srvDesc.Texture2D.MipLevels = 1;
+		srvDesc.Texture2D.MostDetailedMip = 0;
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+		device->CreateShaderResourceView(bakedTextures[i], &srvDesc, &bakedSRVs[i]);
 	}
-	
-	butterflyCS->SetUnorderedAccessView("twiddleIndices", 0);
-	butterflyCS->SetUnorderedAccessView("pingpong0", 0);
-	butterflyCS->SetUnorderedAccessView("pingpong1", 0);
-	
-	inversionCS->SetShader();
-	inversionCS->SetInt("N", 256);
-	inversionCS->SetInt("pingpong", pingpong);
-	inversionCS->SetUnorderedAccessView("displacement", dyUAV);
-	inversionCS->SetUnorderedAccessView("pingpong0", htyUAV);
-	inversionCS->SetUnorderedAccessView("pingpong1", pingpong0UAV);
-	inversionCS->CopyAllBufferData();
-	inversionCS->DispatchByThreads(256, 256, 1);
-	inversionCS->SetUnorderedAccessView("displacement", 0);
-	inversionCS->SetUnorderedAccessView("pingpong0", 0);
-	inversionCS->SetUnorderedAccessView("pingpong1", 0);
+}
 
-	if (true)
+void Water::UpdateBakedMaps(ID3D11DeviceContext* context, float time)
+{
+	int size = bakedOcean->GetResolution();
+	float* maps[CACHE_MAP_COUNT];
+	for (int m = 0; m < CACHE_MAP_COUNT; m++)
 	{
-		//dx fft
-		pingpong = 0;
-
-		butterflyCS->SetUnorderedAccessView("twiddleIndices", twiddleUAV);
-		butterflyCS->SetUnorderedAccessView("pingpong0", htxUAV);
-		butterflyCS->SetUnorderedAccessView("pingpong1", pingpong0UAV);
-
-		int pingpong = 0;
-
-		butterflyCS->SetShader();
+		maps[m] = bakedMaps[m].data();
+	}
+	bakedOcean->Sample(time, maps);
 
-		//horizontal fft
-		for (int i = 0; i < log2N; i++)
+	//the float maps row by row, the rows can be padded
+	const int floatMaps[4] = { CACHE_DISPLACEMENT_X, CACHE_HEIGHT, CACHE_DISPLACEMENT_Z, CACHE_FOLDING };
+	const int floatTextures[4] = { 0, 1, 2, 4 };
+	for (int i = 0; i < 4; i++)
+	{
+		D3D11_MAPPED_SUBRESOURCE mapped = {};
+		context->Map(bakedTextures[floatTextures[i]], 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+		const float* source = maps[floatMaps[i]];
+		for (int y = 0; y < size; y++)
 		{
-
-			butterflyCS->SetInt("pingpong", pingpong);
-			butterflyCS->SetInt("direction", 0);
-			butterflyCS->SetInt("stage", i);
-			butterflyCS->CopyAllBufferData();
-			butterflyCS->DispatchByThreads(256, 256, 1);
-
-
-			pingpong++;
-			pingpong %= 2;
-
+			memcpy((char*)mapped.pData + y * mapped.RowPitch, source + y * size, size * sizeof(float));
 		}
+		context->Unmap(bakedTextures[floatTextures[i]], 0);
+	}
 
-		//vertical fft
-		for (int i = 0; i < log2N; i++)
+	//the normal's z is the positive root, NormalMapCS always points it up
+	D3D11_MAPPED_SUBRESOURCE mapped = {};
+	context->Map(bakedTextures[3], 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+	for (int y = 0; y < size; y++)
+	{
+		signed char* row = (signed char*)mapped.pData + y * mapped.RowPitch;
+		for (int x = 0; x < size; x++)
 		{
-			butterflyCS->SetInt("pingpong", pingpong);
-			butterflyCS->SetInt("direction", 1);
-			butterflyCS->SetInt("stage", i);
-			butterflyCS->CopyAllBufferData();
-			butterflyCS->DispatchByThreads(256, 256, 1);
-
-			pingpong++;
-			pingpong %= 2;
-
+			float nx = maps[CACHE_NORMAL_X][y * size + x];
+			float ny = maps[CACHE_NORMAL_Y][y * size + x];
+			float zSquared = 1 - nx * nx - ny * ny;
+			float nz = zSquared > 0 ? sqrtf(zSquared) : 0;
+			row[x * 4 + 0] = (signed char)lroundf(nx * 127);
+			row[x * 4 + 1] = (signed char)lroundf(ny * 127);
+			row[x * 4 + 2] = (signed char)lroundf(nz * 127);
+			row[x * 4 + 3] = 127;
 		}
-
-		butterflyCS->SetUnorderedAccessView("twiddleIndices", 0);
-		butterflyCS->SetUnorderedAccessView("pingpong0", 0);
-		butterflyCS->SetUnorderedAccessView("pingpong1", 0);
-
-		inversionCS->SetShader();
-		inversionCS->SetInt("N", 256);
-		inversionCS->SetInt("pingpong", pingpong);
-		inversionCS->SetUnorderedAccessView("displacement", dxUAV);
-		inversionCS->SetUnorderedAccessView("pingpong0", htxUAV);
-		inversionCS->SetUnorderedAccessView("pingpong1", pingpong0UAV);
-		inversionCS->CopyAllBufferData();
-		inversionCS->DispatchByThreads(256, 256, 1);
-		inversionCS->SetUnorderedAccessView("displacement", 0);
-		inversionCS->SetUnorderedAccessView("pingpong0", 0);
-		inversionCS->SetUnorderedAccessView("pingpong1", 0);
-
 	}
+	context->Unmap(bakedTextures[3], 0);
+}
 
-	if (true)
+void Water::GetSurfaceHeights(const float* x, const float* z, float totalTime, float* heights,
+	float* normalX, float* normalY, float* normalZ, int count)
+{
+	//the water mesh is scaled evenly and moved, so normals carry over and only the
+	//points and heights need converting
+	float scale = worldMat._11;
+	XMFLOAT3 offset(worldMat._14, worldMat._24, worldMat._34);
+	bool needNormals = normalX != nullptr && normalY != nullptr && normalZ != nullptr;
+
+	//moving the points into the mesh's space a chunk at a time
+	const int chunkSize = 64;
+	float localX[chunkSize];
+	float localZ[chunkSize];
+	for (int start = 0; start < count; start += chunkSize)
 	{
-		//dz fft
-		pingpong = 0;
-
-		butterflyCS->SetUnorderedAccessView("twiddleIndices", twiddleUAV);
-		butterflyCS->SetUnorderedAccessView("pingpong0", htzUAV);
-		butterflyCS->SetUnorderedAccessView("pingpong1", pingpong0UAV);
-
-		int pingpong = 0;
-
-		butterflyCS->SetShader();
-
-		//horizontal fft
-		for (int i = 0; i < log2N; i++)
+		int size = count - start < chunkSize ? count - start : chunkSize;
+		for (int i = 0; i < size; i++)
 		{
-
-			butterflyCS->SetInt("pingpong", pingpong);
-			butterflyCS->SetInt("direction", 0);
-			butterflyCS->SetInt("stage", i);
-			butterflyCS->CopyAllBufferData();
-			butterflyCS->DispatchByThreads(256, 256, 1);
-
-
-			pingpong++;
-			pingpong %= 2;
-
+			localX[i] = (x[start + i] - offset.x) / scale;
+			localZ[i] = (z[start + i] - offset.z) / scale;
 		}
 
-		//vertical fft
-		for (int i = 0; i < log2N; i++)
+		if (needNormals)
 		{
-			butterflyCS->SetInt("pingpong", pingpong);
-			butterflyCS->SetInt("direction", 1);
-			butterflyCS->SetInt("stage", i);
-			butterflyCS->CopyAllBufferData();
-			butterflyCS->DispatchByThreads(256, 256, 1);
-
-			pingpong++;
-			pingpong %= 2;
-
+			waves.GetHeights(localX, localZ, totalTime, heights + start,
+				normalX + start, normalY + start, normalZ + start, size);
+		}
+		else
+		{
+			waves.GetHeights(localX, localZ, totalTime, heights + start, nullptr, nullptr, nullptr, size);
 		}
 
-		butterflyCS->SetUnorderedAccessView("twiddleIndices", 0);
-		butterflyCS->SetUnorderedAccessView("pingpong0", 0);
-		butterflyCS->SetUnorderedAccessView("pingpong1", 0);
-
-		inversionCS->SetShader();
-		inversionCS->SetInt("N", 256);
-		inversionCS->SetInt("pingpong", pingpong);
-		inversionCS->SetUnorderedAccessView("displacement", dzUAV);
-		inversionCS->SetUnorderedAccessView("pingpong0", htzUAV);
-		inversionCS->SetUnorderedAccessView("pingpong1", pingpong0UAV);
-		inversionCS->CopyAllBufferData();
-		inversionCS->DispatchByThreads(256, 256, 1);
-		inversionCS->SetUnorderedAccessView("displacement", 0);
-		inversionCS->SetUnorderedAccessView("pingpong0", 0);
-		inversionCS->SetUnorderedAccessView("pingpong1", 0);
+		for (int i = 0; i < size; i++)
+		{
+			heights[start + i] = heights[start + i] * scale + offset.y;
+		}
 	}
+}
 
-	jacobianCS->SetShader();
-	jacobianCS->SetUnorderedAccessView("heightMapDX",dxUAV);
-	jacobianCS->SetUnorderedAccessView("heightMapDY",dyUAV);
-	jacobianCS->SetUnorderedAccessView("foldingMap",foldingMapUAV);
-	jacobianCS->CopyAllBufferData();
-	jacobianCS->DispatchByThreads(256, 256, 1);
-	jacobianCS->SetUnorderedAccessView("heightMapDX",0);
-	jacobianCS->SetUnorderedAccessView("heightMapDY",0);
-	jacobianCS->SetUnorderedAccessView("foldingMap",0);
-
-
-	sobelFilter->SetShader();
-	sobelFilter->SetInt("N", 256);
-	sobelFilter->SetFloat("normalStrength", 8);
-	sobelFilter->SetSamplerState("sampleOptions", samplerState);
-	sobelFilter->SetShaderResourceView("heightMap", dySRV);
-	sobelFilter->SetUnorderedAccessView("normalMap", normalMapUAV);
-	sobelFilter->CopyAllBufferData();
-	sobelFilter->DispatchByThreads(256, 256, 1);
-	sobelFilter->SetUnorderedAccessView("heightMap", 0);
-	sobelFilter->SetUnorderedAccessView("normalMap", 0);
+const GerstnerWaves& Water::GetWaves()
+{
+	return waves;
+}
 
+OceanQuadtree& Water::GetQuadtree()
+{
+	return quadtree;
 }
@@ -5,20 +5,24 @@
 #include"SimpleShader.h"
 #include"Camera.h"
 #include "Lights.h"
+#include"GerstnerWaves.h"
+#include"OceanCascade.h"
+#include"OceanCache.h"
+#include"OceanQuadtree.h"
+#include"WaveParticles.h"
 #include<limits.h>
 #include<memory>
+#include<vector>
 
-struct BitIndices
-{
-	int index;
-	XMFLOAT3 padding;
-};
+//as many cascades as WaterDS and WaterPS have maps for
+#define MAX_OCEAN_CASCADES 4
+//the most quadtree patches drawn in a frame, the size of the buffer WaterVS reads them from
+#define MAX_OCEAN_PATCHES 1024
 
 using namespace DirectX;
 class Water
 {
 	//water variables
-	std::shared_ptr<Mesh> waterMesh;
 	ID3D11ShaderResourceView* waterTex;
 	ID3D11ShaderResourceView* waterNormal1;
 	ID3D11ShaderResourceView* waterNormal2;
@@ -29,69 +33,60 @@ class Water
 	SimpleDomainShader* waterDS;
 	ID3D11SamplerState* samplerState;
 
-	XMFLOAT4X4 worldMat;
+	XMFLOAT4X4 worldMat; //the old 300 metre quad, the uv the maps are sampled with comes from it
+
+	//the surface is drawn as the quadtree's patches around the camera, six vertices each
+	OceanQuadtree quadtree;
+	ID3D11Buffer* patchBuffer;
+	ID3D11ShaderResourceView* patchSRV;
 
-	SimpleComputeShader* h0CS;
 	SimpleComputeShader* htCS;
-	SimpleComputeShader* twiddleFactorsCS;
-	SimpleComputeShader* butterflyCS;
+	SimpleComputeShader* fftStageCS;
 	SimpleComputeShader* inversionCS;
 	SimpleComputeShader* sobelFilter;
 	SimpleComputeShader* jacobianCS;
 
-	ID3D11ShaderResourceView* noiseR1;
-	ID3D11ShaderResourceView* noiseI1;
-	ID3D11ShaderResourceView* noiseR2;
-	ID3D11ShaderResourceView* noiseI2;
-
-	ID3D11ShaderResourceView* h0SRV;
-	ID3D11ShaderResourceView* h0MinusSRV;
-	ID3D11UnorderedAccessView* h0URV;
-	ID3D11UnorderedAccessView* h0MinusURV;
-
-	ID3D11ShaderResourceView*  htxSRV;
-	ID3D11UnorderedAccessView* htxUAV;
-
-	ID3D11ShaderResourceView*  htySRV;
-	ID3D11UnorderedAccessView* htyUAV;
+	//h0 of every cascade comes out of here, the same settings are only made once
+	OceanSpectrum spectrum;
+	OceanSpectrumDesc spectrumDesc;
 
-	ID3D11ShaderResourceView*  htzSRV;
-	ID3D11UnorderedAccessView* htzUAV;
+	//biggest patch first, its uv is the one the others are scaled against
+	std::vector<std::unique_ptr<OceanCascade>> cascades;
+	std::vector<OceanCascadeDesc> cascadeDescs; //in the same order as cascades
+	int frame; //counts RenderFFT calls, for the cascades that skip frames
 
-	ID3D11ShaderResourceView* twiddleSRV;
-	ID3D11UnorderedAccessView* twiddleUAV;
+	//low end mode, the maps are streamed out of a baked loop instead of the fft. dx, dy, dz,
+	//the normal map and the folding map, filled from the cpu every draw
+	std::shared_ptr<OceanCache> bakedOcean;
+	std::vector<float> bakedMaps[CACHE_MAP_COUNT];
+	ID3D11Texture2D* bakedTextures[5];
+	ID3D11ShaderResourceView* bakedSRVs[5];
 
-	ID3D11ShaderResourceView* pingpong0SRV;
-	ID3D11UnorderedAccessView* pingpong0UAV;
+	void UpdateBakedMaps(ID3D11DeviceContext* context, float time);
+	//the spectrum each cascade makes its h0 from, each with its own band and seed
+	std::vector<OceanSpectrumDesc> SplitSpectrum(const OceanSpectrumDesc& desc);
 
-	ID3D11ShaderResourceView* dySRV;
-	ID3D11UnorderedAccessView* dyUAV;
+	GerstnerWaves waves; //the waves WaterVS gets as waveA..waveD
 
-	ID3D11ShaderResourceView* dxSRV;
-	ID3D11UnorderedAccessView* dxUAV;
-
-	ID3D11ShaderResourceView* dzSRV;
-	ID3D11UnorderedAccessView* dzUAV;
-
-	ID3D11ShaderResourceView* normalMapSRV;
-	ID3D11UnorderedAccessView* normalMapUAV;
-
-	ID3D11ShaderResourceView* foldingMapSRV;
-	ID3D11UnorderedAccessView* foldingMapUAV;
-
-	int texSize;
+	//the ship's wake and shot splashes, splatted around the ship and added on by WaterDS
+	WaveParticles wake;
+	ID3D11Texture2D* wakeTexture;
+	ID3D11ShaderResourceView* wakeSRV;
+	XMFLOAT3 lastShipPos;
+	float wakeDistance; //metres sailed since the last ring
 
+	void UpdateWakeMap(ID3D11DeviceContext* context);
 
 
 public:
-	Water(std::shared_ptr<Mesh> waterMesh, ID3D11ShaderResourceView* waterTex,
+	Water(ID3D11ShaderResourceView* waterTex,
 		ID3D11ShaderResourceView* waterNormal1, ID3D11ShaderResourceView* waterNormal2,
 		SimplePixelShader* waterPS, SimpleVertexShader* waterVS, SimpleHullShader* waterHS,SimpleDomainShader* waterDS,
-		SimpleComputeShader* h0CS, SimpleComputeShader* htCS, SimpleComputeShader* twiddleFactorsCS,
-		SimpleComputeShader* butterflyCS, SimpleComputeShader* inversionCS, SimpleComputeShader* sobelFilter,
+		SimpleComputeShader* htCS, SimpleComputeShader* fftStageCS,
+		SimpleComputeShader* inversionCS, SimpleComputeShader* sobelFilter,
 		SimpleComputeShader* jacobianCS,ID3D11SamplerState* samplerState,
-		ID3D11Device* device, ID3D11ShaderResourceView* noiseR1, ID3D11ShaderResourceView* noiseI1,
-		ID3D11ShaderResourceView* noiseR2, ID3D11ShaderResourceView* noiseI2);
+		ID3D11Device* device, const OceanSpectrumDesc& spectrumDesc, const std::vector<OceanCascadeDesc>& cascadeDescs,
+		ThreadPool* threads = nullptr);
 	~Water();
 
 	void Update(float deltaTime, XMFLOAT3 shipPos);
@@ -99,11 +94,34 @@ public:
 	void Draw(Light lights, ID3D11ShaderResourceView* cubeMap, std::shared_ptr<Camera> camera,
 		ID3D11DeviceContext* context, float deltaTime, float totalTime,ID3D11SamplerState* waterSampler);
 
-	void CreateH0Texture();
-	void CreateHtTexture(float totalTime);
-	int CreateBitReversedIndices(int num, int d);
-	void CreateTwiddleIndices();
+	//makes h0 again for every cascade from new settings, the fft size and L of the desc are
+	//ignored since every cascade has its own
+	void SetSpectrum(const OceanSpectrumDesc& desc, ID3D11DeviceContext* context);
+	const OceanSpectrumDesc& GetSpectrum();
+
+	void CreateHtTexture(OceanCascade& cascade, float totalTime);
+	//inverse fft of one spectrum of a cascade into one of its displacement maps
+	void RunFFT(OceanCascade& cascade, ID3D11UnorderedAccessView* spectrum, ID3D11UnorderedAccessView* output);
+	//renders the cascades that are due this frame, the others keep their last maps
 	void RenderFFT(float totalTime);
 
+	//what low end mode should bake, the first cascade's spectrum with the same seed and
+	//amplitude but no upper end to its band, so its waves match the fft's swell and the finer
+	//ones it has room for stand in for the cascades it replaces
+	OceanSpectrumDesc GetBakedSpectrum();
+	//draws from the baked loop from now on, the cascades and their maps are let go
+	void UseBakedOcean(std::shared_ptr<OceanCache> cache, ID3D11Device* device);
+
+	//surface heights and normals in world space under count points, totalTime is the same
+	//time Draw gives the shader. the normal arrays can be null
+	void GetSurfaceHeights(const float* x, const float* z, float totalTime, float* heights,
+		float* normalX, float* normalY, float* normalZ, int count);
+	const GerstnerWaves& GetWaves();
+	OceanQuadtree& GetQuadtree();
+
+	//a ring of waves where something hit the water, strength is its height in metres
+	void AddSplash(XMFLOAT3 position, float strength);
+	WaveParticles& GetWake();
+
 };
 
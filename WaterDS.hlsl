@@ -19,6 +19,10 @@ cbuffer dsExternData: register (b0)
 	float3 cameraPos;
 	float2 windDir;
 	float motion;
+	float4 cascadeScale; //how many of each cascade's patches fit in the first one's
+	int cascadeCount;
+	float2 wakeOrigin; //world x and z of the wake map's corner
+	float wakeSize; //metres the wake map covers
 };
 
 // Output control point
@@ -49,8 +53,31 @@ Texture2D heightMap: register(t0);
 Texture2D heightMapX: register(t1);
 Texture2D heightMapZ: register(t2);
 
+//the displacements of the smaller cascades, Water binds as many as it has
+Texture2D heightMap1: register(t3);
+Texture2D heightMapX1: register(t4);
+Texture2D heightMapZ1: register(t5);
+Texture2D heightMap2: register(t6);
+Texture2D heightMapX2: register(t7);
+Texture2D heightMapZ2: register(t8);
+Texture2D heightMap3: register(t9);
+Texture2D heightMapX3: register(t10);
+Texture2D heightMapZ3: register(t11);
+
+//the wave particles around the ship, world space metres on top of everything else
+Texture2D wakeMap: register(t12);
+
 SamplerState sampleOptions: register(s0);
 
+//x, height and z of one cascade, scaled the way the first one always was
+float3 SampleCascade(Texture2D mapY, Texture2D mapX, Texture2D mapZ, float2 uv)
+{
+	float height = mapY.SampleLevel(sampleOptions, uv, 0).r * 0.02;
+	float heightX = mapX.SampleLevel(sampleOptions, uv, 0).r * 1.8 * 0.02;
+	float heightZ = mapZ.SampleLevel(sampleOptions, uv, 0).r * 1.8 * 0.02;
+	return float3(heightX, height, heightZ);
+}
+
 [domain("tri")]
 DS_OUTPUT main(
 	HS_CONSTANT_DATA_OUTPUT input,
@@ -76,12 +103,25 @@ DS_OUTPUT main(
 	float heightX = heightMapX.SampleLevel(sampleOptions, Output.uv+ (40 * float2(1, 1)), 0).r*1.8* 0.02;//max(0,  -distance(Output.worldPosition, cameraPos) / 10000.5);
 	float heightZ = heightMapZ.SampleLevel(sampleOptions, Output.uv+ (40 * float2(1, 1)), 0).r*1.8* 0.02;//max(0,  -distance(Output.worldPosition, cameraPos) / 10000.5);
 
-	pos.y  = height;
-	pos.x -= heightX;
-	pos.z -= heightZ;
+	float2 cascadeUV = Output.uv + (40 * float2(1, 1));
+	float3 detail = float3(0, 0, 0);
+	if (cascadeCount > 1)
+		detail += SampleCascade(heightMap1, heightMapX1, heightMapZ1, cascadeUV * cascadeScale.y);
+	if (cascadeCount > 2)
+		detail += SampleCascade(heightMap2, heightMapX2, heightMapZ2, cascadeUV * cascadeScale.z);
+	if (cascadeCount > 3)
+		detail += SampleCascade(heightMap3, heightMapX3, heightMapZ3, cascadeUV * cascadeScale.w);
+
+	pos.y  = height + detail.y;
+	pos.x -= heightX + detail.x;
+	pos.z -= heightZ + detail.z;
 
 	//wPos *= -Output.normal;
 	float4 wPos = mul(float4(pos, 1.0f), world);
+
+	float2 wakeUV = (wPos.xz - wakeOrigin) / wakeSize;
+	if (all(wakeUV >= 0) && all(wakeUV <= 1))
+		wPos.y += wakeMap.SampleLevel(sampleOptions, wakeUV, 0).r;
 	matrix viewProj = mul(view, projection);
 
 	float4 csPos = mul(wPos, viewProj);
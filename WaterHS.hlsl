@@ -10,6 +10,8 @@ struct HullShaderInput
 	float2 motion		: TEXCOORD2;
 	float2 heightUV		: TEXCOORD3;
 	noperspective float2 screenUV		: VPOS;
+	float edgeTess		: TEXCOORD4; //the edge across from this control point
+	float insideTess	: TEXCOORD5;
 };
 
 // Output control point
@@ -57,23 +59,11 @@ HS_CONSTANT_DATA_OUTPUT CalcHSPatchConstants(
 {
 	HS_CONSTANT_DATA_OUTPUT Output;
 
-	float3 center = ip[0].position + ip[1].position + ip[2].position;
-	center /= 3;
-	
-	float3 centerWorld = mul(float4(center, 1.0f), world).xyz;
-	
-	float d = distance(centerWorld, cameraPos);
-	
-	float d0 = 30;
-	float d1 = 1000;
-	
-	float tess = 64.0f * saturate((d1 - d) / (d1 - d0))+1;
-	
-	// Insert code to compute Output here
-	Output.EdgeTessFactor[0] = 
-		Output.EdgeTessFactor[1] = 
-		Output.EdgeTessFactor[2] = 
-		Output.InsideTessFactor = tess; 
+	//the quadtree picks the factors, every edge against a bigger patch already matches it
+	Output.EdgeTessFactor[0] = ip[0].edgeTess;
+	Output.EdgeTessFactor[1] = ip[1].edgeTess;
+	Output.EdgeTessFactor[2] = ip[2].edgeTess;
+	Output.InsideTessFactor = ip[0].insideTess;
 
 	//float3 v0 = mul(float4(ip[0].position, 1.0f), world).xyz;
 	//float3 v1 = mul(float4(ip[1].position, 1.0f), world).xyz;
@@ -96,7 +86,7 @@ HS_CONSTANT_DATA_OUTPUT CalcHSPatchConstants(
 }
 
 [domain("tri")]
-[partitioning("fractional_odd")]
+[partitioning("integer")]
 [outputtopology("triangle_cw")]
 [outputcontrolpoints(3)]
 [patchconstantfunc("CalcHSPatchConstants")]
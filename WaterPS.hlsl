@@ -35,6 +35,8 @@ cbuffer LightData: register(b0)
 	Light dirLight;
 	//Light lights[MAX_LIGHTS];
 	//int lightCount;
+	float4 cascadeScale; //how many of each cascade's patches fit in the first one's
+	int cascadeCount;
 };
 
 //function that accepts light and normal and then calculates the final color
@@ -77,9 +79,24 @@ Texture2D reflectionTexture: register(t4);
 TextureCube cubeMap: register(t5);
 Texture2D foam: register(t6);
 Texture2D foldingMap: register(t7);
+//the normals and folding of the smaller cascades
+Texture2D normalMap1: register(t8);
+Texture2D foldingMap1: register(t9);
+Texture2D normalMap2: register(t10);
+Texture2D foldingMap2: register(t11);
+Texture2D normalMap3: register(t12);
+Texture2D foldingMap3: register(t13);
 SamplerState sampleOptions: register(s0);
 SamplerState waterSampleOptions: register(s1);
 
+//the slope of one cascade's normal, so the cascades can be added up before normalizing
+float2 CascadeSlope(Texture2D normalMap, float2 uv)
+{
+	float3 normal = saturate(normalMap.Sample(sampleOptions, uv)).rgb;
+	normal = (normal * 2.0f) - 1.0f;
+	return normal.xy / max(normal.z, 0.001f);
+}
+
 float4 main(VertexToPixel input) : SV_TARGET
 {
 
@@ -102,10 +119,26 @@ float4 main(VertexToPixel input) : SV_TARGET
 
 	normal3 = (normal3 * 2.0f) - 1.0f;
 
+	//the smaller cascades tile faster, they add their slopes to the first one's
+	float2 slope = normal3.xy / max(normal3.z, 0.001f);
+	if (cascadeCount > 1)
+		slope += CascadeSlope(normalMap1, input.uv * cascadeScale.y);
+	if (cascadeCount > 2)
+		slope += CascadeSlope(normalMap2, input.uv * cascadeScale.z);
+	if (cascadeCount > 3)
+		slope += CascadeSlope(normalMap3, input.uv * cascadeScale.w);
+	normal3 = normalize(float3(slope, 1.0f));
+
 	float4 surfaceColor = waterTexture.Sample(sampleOptions, input.uv);
 
 	float4 foamColor = foam.Sample(sampleOptions, input.uv*10);
 	float4 foldingColor = foldingMap.Sample(sampleOptions, input.uv);
+	if (cascadeCount > 1)
+		foldingColor = max(foldingColor, foldingMap1.Sample(sampleOptions, input.uv * cascadeScale.y));
+	if (cascadeCount > 2)
+		foldingColor = max(foldingColor, foldingMap2.Sample(sampleOptions, input.uv * cascadeScale.z));
+	if (cascadeCount > 3)
+		foldingColor = max(foldingColor, foldingMap3.Sample(sampleOptions, input.uv * cascadeScale.w));
 
 	//surfaceColor = pow(surfaceColor, 2.2);
 	//surfaceColor += float4(0.2, 0.2, 0.2,0);
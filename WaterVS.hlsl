@@ -20,6 +20,7 @@ cbuffer externalData : register(b0)
 	matrix projection;
 	matrix lightView;
 	matrix lightProj;
+	matrix worldInverse; //takes the patches from world space back to the old quad's
 };
 
 
@@ -47,8 +48,24 @@ struct HullShaderInput
 	float2 motion		: TEXCOORD2;
 	float2 heightUV		: TEXCOORD3;
 	noperspective float2 screenUV		: VPOS;
+	float edgeTess		: TEXCOORD4; //the edge across from this control point
+	float insideTess	: TEXCOORD5;
 };
 
+//one OceanPatch from Water's quadtree
+struct OceanPatch
+{
+	float2 origin;
+	float size;
+	float insideTess;
+	float4 edgeTess; //-x, +x, -z and +z
+};
+
+//the six corners of a patch's two triangles, wound like quad.obj, and which edge of the
+//patch is across from each one. 4 is the diagonal, which gets the inside factor
+static const float2 patchCorners[6] = { float2(0, 1), float2(1, 1), float2(0, 0), float2(0, 0), float2(1, 1), float2(1, 0) };
+static const uint patchEdges[6] = { 4, 0, 3, 1, 2, 4 };
+
 // Struct representing the data we're sending down the pipeline
 struct VertexToPixel
 {
@@ -100,6 +117,8 @@ Texture2D heightMap: register(t0);
 Texture2D heightMapX: register(t1);
 Texture2D heightMapZ: register(t2);
 
+StructuredBuffer<OceanPatch> patches: register(t3);
+
 SamplerState sampleOptions: register(s0);
 static const float2 size = { 2.0,0.0 };
 static const float3 off = { -1.0,0.0,1.0 };
@@ -110,11 +129,27 @@ static const float3 off = { -1.0,0.0,1.0 };
 // - Output is a single struct of data to pass down the pipeline
 // - Named "main" because that's the default the shader compiler looks for
 // --------------------------------------------------------
-HullShaderInput main(VertexShaderInput input)
+HullShaderInput main(uint id: SV_VertexID, uint instance: SV_InstanceID)
 {
 	// Set up output struct
 	HullShaderInput output;
 
+	//every patch is six vertices, put back into the quad's space so the rest goes on as if
+	//this was a vertex of quad.obj
+	OceanPatch patch = patches[instance];
+	uint corner = id % 6;
+	float2 patchPos = patch.origin + patchCorners[corner] * patch.size;
+	float3 localPos = mul(float4(patchPos.x, 0.0f, patchPos.y, 1.0f), worldInverse).xyz;
+
+	VertexShaderInput input;
+	input.position = float3(localPos.x, 0.0f, localPos.z);
+	input.normal = float3(0.0f, 1.0f, 0.0f);
+	input.tangent = float3(1.0f, 0.0f, 0.0f);
+	input.uv = float2(localPos.x + 0.5f, 0.5f - localPos.z);
+
+	output.edgeTess = patchEdges[corner] == 4 ? patch.insideTess : patch.edgeTess[patchEdges[corner]];
+	output.insideTess = patch.insideTess;
+
 	// First we multiply them together to get a single matrix which represents
 	// all of those transformations (world to view to projection space)
 	matrix worldViewProj = mul(mul(world, view), projection);
@@ -129,16 +164,19 @@ HullShaderInput main(VertexShaderInput input)
 
 	output.heightUV = input.uv;
 
-	float texelSize = 1.0 / 256.0;
+	//the maps are as big as Water's fft
+	float mapWidth, mapHeight;
+	heightMap.GetDimensions(mapWidth, mapHeight);
+	float texelSize = 1.0 / mapWidth;
 
 	float height  =  heightMap.SampleLevel(sampleOptions, input.uv,0).r;
 	float heightX = heightMapX.SampleLevel(sampleOptions, input.uv,0).r*1.8;
 	float heightZ = heightMapZ.SampleLevel(sampleOptions, input.uv,0).r*1.8;
 
-	float2 offxy = { off.x / 256.0 , off.y / 256.0 };
-	float2 offzy = { off.z / 256.0 , off.y / 256.0 };
-	float2 offyx = { off.y / 256.0 , off.x / 256.0 };
-	float2 offyz = { off.y / 256.0 , off.z / 256.0 };
+	float2 offxy = { off.x * texelSize , off.y * texelSize };
+	float2 offzy = { off.z * texelSize , off.y * texelSize };
+	float2 offyx = { off.y * texelSize , off.x * texelSize };
+	float2 offyz = { off.y * texelSize , off.z * texelSize };
 
 	//float hL = heightMap.SampleLevel(sampleOptions, float2(input.uv.x - texelSize, input.uv.y),0).r;
 	//float hR = heightMap.SampleLevel(sampleOptions, float2(input.uv.x + texelSize, input.uv.y),0).r;
@@ -0,0 +1,382 @@
+#include "WaveParticles.h"
+#include<cmath>
+#include<algorithm>
+#include<unordered_map>
+
+static const float PI = 3.1415926535897932384626433832795f;
+
+WaveParticles::WaveParticles(int budget, int resolution, float cellSize, float speed, float radius)
+{
+	this->budget = (budget + 3) & ~3;
+	this->speed = speed;
+	this->radius = radius;
+	this->cellSize = cellSize;
+	this->resolution = (resolution + WAKE_TILE_SIZE - 1) / WAKE_TILE_SIZE * WAKE_TILE_SIZE;
+	damping = 0.3f;
+	minAmplitude = 0.005f;
+	count = 0;
+
+	//twice the budget, so a burst of rings can land before the next Update merges them
+	int capacity = this->budget * 2;
+	originX.resize(capacity);
+	originZ.resize(capacity);
+	directionX.resize(capacity);
+	directionZ.resize(capacity);
+	amplitude.resize(capacity);
+	age.resize(capacity);
+	dispersion.resize(capacity);
+	x.resize(capacity);
+	z.resize(capacity);
+
+	//four over, the splat writes whole vectors past the end of a row
+	heights.resize(this->resolution * this->resolution + 4);
+	int tilesARow = this->resolution / WAKE_TILE_SIZE;
+	tiles.resize(tilesARow * tilesARow);
+	tileListed.resize(tilesARow * tilesARow);
+	gridOrigin = XMFLOAT2(0, 0);
+
+	splitCount = 0;
+	mergeCount = 0;
+	dropCount = 0;
+}
+
+void WaveParticles::Add(float originX, float originZ, float directionX, float directionZ, float amplitude, float age, float dispersion)
+{
+	if (count >= (int)this->amplitude.size())
+		return;
+
+	int i = count++;
+	this->originX[i] = originX;
+	this->originZ[i] = originZ;
+	this->directionX[i] = directionX;
+	this->directionZ[i] = directionZ;
+	this->amplitude[i] = amplitude;
+	this->age[i] = age;
+	this->dispersion[i] = dispersion;
+	x[i] = originX + directionX * speed * age;
+	z[i] = originZ + directionZ * speed * age;
+}
+
+void WaveParticles::Remove(int index)
+{
+	int last = --count;
+	originX[index] = originX[last];
+	originZ[index] = originZ[last];
+	directionX[index] = directionX[last];
+	directionZ[index] = directionZ[last];
+	amplitude[index] = amplitude[last];
+	age[index] = age[last];
+	dispersion[index] = dispersion[last];
+	x[index] = x[last];
+	z[index] = z[last];
+}
+
+void WaveParticles::EmitRing(float x, float z, float amplitude, int count)
+{
+	float step = 2 * PI / count;
+	for (int i = 0; i < count; i++)
+	{
+		float angle = step * i;
+		Add(x, z, cosf(angle), sinf(angle), amplitude, 0.0f, step);
+	}
+}
+
+void WaveParticles::SetDamping(float damping)
+{
+	this->damping = damping;
+}
+
+void WaveParticles::Update(float deltaTime)
+{
+	splitCount = 0;
+	mergeCount = 0;
+	dropCount = 0;
+
+	//four particles at a time, the lanes past count are padding and never read back
+	XMVECTOR step = XMVectorReplicate(deltaTime);
+	XMVECTOR decay = XMVectorReplicate(expf(-damping * deltaTime));
+	for (int i = 0; i < count; i += 4)
+	{
+		XMVECTOR particleAge = XMLoadFloat4((const XMFLOAT4*)&age[i]) + step;
+		XMVECTOR particleAmplitude = XMLoadFloat4((const XMFLOAT4*)&amplitude[i]) * decay;
+		XMVECTOR distance = XMVectorScale(particleAge, speed);
+		XMVECTOR px = XMLoadFloat4((const XMFLOAT4*)&originX[i]) + XMLoadFloat4((const XMFLOAT4*)&directionX[i]) * distance;
+		XMVECTOR pz = XMLoadFloat4((const XMFLOAT4*)&originZ[i]) + XMLoadFloat4((const XMFLOAT4*)&directionZ[i]) * distance;
+		XMStoreFloat4((XMFLOAT4*)&age[i], particleAge);
+		XMStoreFloat4((XMFLOAT4*)&amplitude[i], particleAmplitude);
+		XMStoreFloat4((XMFLOAT4*)&x[i], px);
+		XMStoreFloat4((XMFLOAT4*)&z[i], pz);
+	}
+
+	for (int i = count - 1; i >= 0; i--)
+	{
+		if (amplitude[i] < minAmplitude)
+			Remove(i);
+	}
+
+	Subdivide();
+	Merge();
+}
+
+void WaveParticles::Subdivide()
+{
+	//a front whose particles are more than half a radius apart starts to show gaps, each of
+	//them becomes three a third as high over a third of the angle. only while it fits
+	int existing = count;
+	for (int i = 0; i < existing && count + 2 <= budget; i++)
+	{
+		float gap = dispersion[i] * speed * age[i];
+		if (gap <= radius * 0.5f || amplitude[i] < minAmplitude * 3)
+			continue;
+
+		float third = dispersion[i] / 3;
+		float c = cosf(third);
+		float s = sinf(third);
+		float dx = directionX[i];
+		float dz = directionZ[i];
+		amplitude[i] /= 3;
+		dispersion[i] = third;
+		Add(originX[i], originZ[i], dx * c - dz * s, dx * s + dz * c, amplitude[i], age[i], third);
+		Add(originX[i], originZ[i], dx * c + dz * s, dz * c - dx * s, amplitude[i], age[i], third);
+		splitCount++;
+	}
+}
+
+void WaveParticles::Merge()
+{
+	if (count <= budget)
+		return;
+
+	//particles in the same radius sized cell heading within an eighth of a turn of each other
+	//are one bump by now. the first keeps the rest, weighted by their heights
+	std::unordered_map<unsigned long long, int> cells;
+	cells.reserve(count);
+	for (int i = 0; i < count; i++)
+	{
+		int cellX = (int)floorf(x[i] / radius);
+		int cellZ = (int)floorf(z[i] / radius);
+		int sector = (int)floorf((atan2f(directionZ[i], directionX[i]) + PI) / (2 * PI) * 8) & 7;
+		unsigned long long key = ((unsigned long long)(unsigned int)cellX << 32) |
+			((unsigned long long)((unsigned int)cellZ & 0x1fffffff) << 3) | (unsigned long long)sector;
+
+		auto found = cells.find(key);
+		if (found == cells.end())
+		{
+			cells[key] = i;
+			continue;
+		}
+
+		int keep = found->second;
+		float total = amplitude[keep] + amplitude[i];
+		float wKeep = amplitude[keep] / total;
+		float wMerged = amplitude[i] / total;
+		float px = x[keep] * wKeep + x[i] * wMerged;
+		float pz = z[keep] * wKeep + z[i] * wMerged;
+		float dx = directionX[keep] * wKeep + directionX[i] * wMerged;
+		float dz = directionZ[keep] * wKeep + directionZ[i] * wMerged;
+		float length = sqrtf(dx * dx + dz * dz);
+		if (length > 0.0f)
+		{
+			directionX[keep] = dx / length;
+			directionZ[keep] = dz / length;
+		}
+		amplitude[keep] = total;
+		dispersion[keep] = std::max(dispersion[keep], dispersion[i]);
+		x[keep] = px;
+		z[keep] = pz;
+		originX[keep] = px - directionX[keep] * speed * age[keep];
+		originZ[keep] = pz - directionZ[keep] * speed * age[keep];
+
+		//taken out below, so the indices in the map stay good until then
+		amplitude[i] = -1.0f;
+		mergeCount++;
+	}
+
+	for (int i = count - 1; i >= 0; i--)
+	{
+		if (amplitude[i] < 0.0f)
+			Remove(i);
+	}
+
+	//still too many, the weakest go
+	if (count > budget)
+	{
+		std::vector<float> sorted(amplitude.begin(), amplitude.begin() + count);
+		std::nth_element(sorted.begin(), sorted.begin() + (count - budget), sorted.end());
+		float threshold = sorted[count - budget];
+		for (int i = count - 1; i >= 0 && count > budget; i--)
+		{
+			if (amplitude[i] < threshold)
+			{
+				Remove(i);
+				dropCount++;
+			}
+		}
+		//the ones tied with the threshold
+		while (count > budget)
+		{
+			Remove(count - 1);
+			dropCount++;
+		}
+	}
+}
+
+void WaveParticles::Splat(float centreX, float centreZ)
+{
+	//snapped to whole texels so the bumps do not swim as the centre moves
+	float size = resolution * cellSize;
+	gridOrigin.x = floorf(centreX / cellSize) * cellSize - size / 2;
+	gridOrigin.y = floorf(centreZ / cellSize) * cellSize - size / 2;
+
+	//the tiles from last frame are cleared and given out once more so the texture is too
+	int tilesARow = resolution / WAKE_TILE_SIZE;
+	for (int t = 0; t < (int)tiles.size(); t++)
+	{
+		if (tiles[t] & 1)
+		{
+			int tileX = (t % tilesARow) * WAKE_TILE_SIZE;
+			int tileY = (t / tilesARow) * WAKE_TILE_SIZE;
+			for (int row = 0; row < WAKE_TILE_SIZE; row++)
+			{
+				std::fill_n(&heights[(tileY + row) * resolution + tileX], WAKE_TILE_SIZE, 0.0f);
+			}
+			tiles[t] = 2;
+		}
+		else
+		{
+			tiles[t] = 0;
+		}
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		SplatParticle(i);
+	}
+
+	for (int t = 0; t < (int)tiles.size(); t++)
+	{
+		if (tiles[t] && !tileListed[t])
+		{
+			tileListed[t] = 1;
+			dirtyTiles.push_back(t);
+		}
+	}
+}
+
+void WaveParticles::SplatParticle(int index)
+{
+	float px = (x[index] - gridOrigin.x) / cellSize;
+	float pz = (z[index] - gridOrigin.y) / cellSize;
+	float texels = radius / cellSize;
+	int x0 = std::max((int)ceilf(px - texels), 0);
+	int x1 = std::min((int)floorf(px + texels), resolution - 1);
+	int z0 = std::max((int)ceilf(pz - texels), 0);
+	int z1 = std::min((int)floorf(pz + texels), resolution - 1);
+	if (x0 > x1 || z0 > z1)
+		return;
+
+	int tilesARow = resolution / WAKE_TILE_SIZE;
+	for (int tileZ = z0 / WAKE_TILE_SIZE; tileZ <= z1 / WAKE_TILE_SIZE; tileZ++)
+	{
+		for (int tileX = x0 / WAKE_TILE_SIZE; tileX <= x1 / WAKE_TILE_SIZE; tileX++)
+		{
+			tiles[tileZ * tilesARow + tileX] |= 1;
+		}
+	}
+
+	//a cosine bump, four texels of a row at a time. the lanes past x1 are masked off, x1 can be
+	//the grid's edge rather than the radius's and past it is the start of the next row
+	float inverseTexels = 1.0f / texels;
+	XMVECTOR one = XMVectorSplatOne();
+	XMVECTOR lanes = XMVectorSet(0, 1, 2, 3);
+	XMVECTOR last = XMVectorReplicate((float)x1);
+	XMVECTOR height = XMVectorReplicate(amplitude[index] * 0.5f);
+	for (int tz = z0; tz <= z1; tz++)
+	{
+		float dz = (tz - pz) * inverseTexels;
+		XMVECTOR dzSq = XMVectorReplicate(dz * dz);
+		for (int tx = x0; tx <= x1; tx += 4)
+		{
+			XMVECTOR dx = XMVectorScale(lanes + XMVectorReplicate(tx - px), inverseTexels);
+			XMVECTOR d = XMVectorMin(XMVectorSqrt(dx * dx + dzSq), one);
+			XMVECTOR bump = height * (one + XMVectorCos(XMVectorScale(d, PI)));
+			XMVECTOR inside = XMVectorAndInt(XMVectorLess(d, one), XMVectorLessOrEqual(lanes + XMVectorReplicate((float)tx), last));
+			bump = XMVectorSelect(XMVectorZero(), bump, inside);
+			float* row = &heights[tz * resolution + tx];
+			XMStoreFloat4((XMFLOAT4*)row, XMLoadFloat4((const XMFLOAT4*)row) + bump);
+		}
+	}
+}
+
+float WaveParticles::GetHeight(float x, float z) const
+{
+	float px = (x - gridOrigin.x) / cellSize;
+	float pz = (z - gridOrigin.y) / cellSize;
+	int x0 = (int)floorf(px);
+	int z0 = (int)floorf(pz);
+	if (x0 < 0 || z0 < 0 || x0 + 1 >= resolution || z0 + 1 >= resolution)
+		return 0.0f;
+
+	float fx = px - x0;
+	float fz = pz - z0;
+	const float* row0 = &heights[z0 * resolution + x0];
+	const float* row1 = row0 + resolution;
+	return (row0[0] * (1 - fx) + row0[1] * fx) * (1 - fz) + (row1[0] * (1 - fx) + row1[1] * fx) * fz;
+}
+
+int WaveParticles::GetCount() const
+{
+	return count;
+}
+
+int WaveParticles::GetBudget() const
+{
+	return budget;
+}
+
+int WaveParticles::GetResolution() const
+{
+	return resolution;
+}
+
+float WaveParticles::GetCellSize() const
+{
+	return cellSize;
+}
+
+XMFLOAT2 WaveParticles::GetGridOrigin() const
+{
+	return gridOrigin;
+}
+
+const std::vector<float>& WaveParticles::GetHeights() const
+{
+	return heights;
+}
+
+const std::vector<int>& WaveParticles::GetDirtyTiles() const
+{
+	return dirtyTiles;
+}
+
+void WaveParticles::ClearDirtyTiles()
+{
+	for (int tile : dirtyTiles)
+		tileListed[tile] = 0;
+	dirtyTiles.clear();
+}
+
+int WaveParticles::GetSplitCount() const
+{
+	return splitCount;
+}
+
+int WaveParticles::GetMergeCount() const
+{
+	return mergeCount;
+}
+
+int WaveParticles::GetDropCount() const
+{
+	return dropCount;
+}
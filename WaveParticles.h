@@ -0,0 +1,86 @@
+#pragma once
+#include<DirectXMath.h>
+#include<vector>
+using namespace DirectX;
+
+//texels on a side of one tile of the height grid, the unit it is cleared and uploaded in
+#define WAKE_TILE_SIZE 16
+
+//wakes and splashes as wave particles, yuksel et al. 2007. every particle is a piece of a
+//ring front moving out from where it was made, and its height is a cosine bump of radius
+//radius. a front that spreads too thin splits into three, and when there are more particles
+//than the budget the ones heading the same way from the same spot are merged, then the
+//weakest are dropped. the particles are splatted into a small height grid around a centre,
+//only the tiles that change are given out for upload
+class WaveParticles
+{
+	//one array a field, padded to a multiple of four for the vector loops
+	std::vector<float> originX;
+	std::vector<float> originZ;
+	std::vector<float> directionX;
+	std::vector<float> directionZ;
+	std::vector<float> amplitude;
+	std::vector<float> age;
+	std::vector<float> dispersion; //the angle between this particle and the ones next to it
+	std::vector<float> x;
+	std::vector<float> z;
+	int count;
+	int budget;
+
+	float speed; //metres a second every front moves out
+	float radius;
+	float damping; //amplitude lost a second, as a fraction
+	float minAmplitude; //anything lower is gone
+
+	int resolution;
+	float cellSize;
+	XMFLOAT2 gridOrigin; //world x and z of the first texel
+	std::vector<float> heights;
+	//1 when splatted this frame, 2 when it was last frame and still has to be cleared
+	std::vector<unsigned char> tiles;
+	//tiles changed by any Splat since the last ClearDirtyTiles, and a flag for each in the list
+	std::vector<int> dirtyTiles;
+	std::vector<unsigned char> tileListed;
+
+	int splitCount;
+	int mergeCount;
+	int dropCount;
+
+	void Add(float originX, float originZ, float directionX, float directionZ, float amplitude, float age, float dispersion);
+	void Remove(int index);
+	void Subdivide();
+	void Merge();
+	void SplatParticle(int index);
+
+public:
+	//budget is rounded up to a multiple of four. the grid is resolution x resolution texels of
+	//cellSize metres, also rounded up to whole tiles
+	WaveParticles(int budget = 4096, int resolution = 256, float cellSize = 0.5f, float speed = 4.0f, float radius = 3.0f);
+
+	//a ring of count particles at (x, z), all with the same height to start with
+	void EmitRing(float x, float z, float amplitude, int count);
+	void SetDamping(float damping);
+
+	//moves every front on, lets them fade, then splits and merges to stay in the budget
+	void Update(float deltaTime);
+	//fills the grid around (centreX, centreZ) from the particles
+	void Splat(float centreX, float centreZ);
+	//the grid's height at a world position, zero outside it
+	float GetHeight(float x, float z) const;
+
+	int GetCount() const;
+	int GetBudget() const;
+	int GetResolution() const;
+	float GetCellSize() const;
+	XMFLOAT2 GetGridOrigin() const;
+	const std::vector<float>& GetHeights() const;
+	//tiles changed by every Splat since the last ClearDirtyTiles, y * tiles a row + x. Splat can
+	//run more than once between uploads, so the list keeps growing until it is cleared
+	const std::vector<int>& GetDirtyTiles() const;
+	//call once the dirty tiles have been uploaded
+	void ClearDirtyTiles();
+	//what the last Update did to keep to the budget
+	int GetSplitCount() const;
+	int GetMergeCount() const;
+	int GetDropCount() const;
+};
@@ -0,0 +1,59 @@
+#include "Xoshiro128.h"
+
+//spreads one seed over the whole state, vigna's advice for seeding the xoshiro family
+static unsigned long long SplitMix64(unsigned long long& x)
+{
+	unsigned long long z = (x += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+Xoshiro128::Xoshiro128(unsigned long long seed)
+{
+	Seed(seed);
+}
+
+void Xoshiro128::Seed(unsigned long long seed)
+{
+	//four words for each of the four lanes, splitmix64 never gives a lane all zeroes
+	unsigned int words[16];
+	for (int i = 0; i < 16; i += 2)
+	{
+		unsigned long long value = SplitMix64(seed);
+		words[i] = (unsigned int)value;
+		words[i + 1] = (unsigned int)(value >> 32);
+	}
+	for (int s = 0; s < 4; s++)
+	{
+		state[s] = _mm_set_epi32((int)words[12 + s], (int)words[8 + s], (int)words[4 + s], (int)words[s]);
+	}
+}
+
+__m128i Xoshiro128::Next4()
+{
+	__m128i result = _mm_add_epi32(state[0], state[3]);
+	__m128i t = _mm_slli_epi32(state[1], 9);
+
+	state[2] = _mm_xor_si128(state[2], state[0]);
+	state[3] = _mm_xor_si128(state[3], state[1]);
+	state[1] = _mm_xor_si128(state[1], state[2]);
+	state[0] = _mm_xor_si128(state[0], state[3]);
+	state[2] = _mm_xor_si128(state[2], t);
+	state[3] = _mm_or_si128(_mm_slli_epi32(state[3], 11), _mm_srli_epi32(state[3], 21));
+
+	return result;
+}
+
+XMVECTOR Xoshiro128::NextFloat4()
+{
+	//the top 23 bits as the mantissa of a float in [1, 2)
+	__m128i bits = _mm_or_si128(_mm_srli_epi32(Next4(), 9), _mm_set1_epi32(0x3F800000));
+	return _mm_sub_ps(_mm_castsi128_ps(bits), _mm_set1_ps(1.0f));
+}
+
+XMVECTOR Xoshiro128::NextSigned4()
+{
+	__m128i bits = _mm_or_si128(_mm_srli_epi32(Next4(), 9), _mm_set1_epi32(0x3F800000));
+	return _mm_sub_ps(_mm_mul_ps(_mm_castsi128_ps(bits), _mm_set1_ps(2.0f)), _mm_set1_ps(3.0f));
+}
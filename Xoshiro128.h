@@ -0,0 +1,23 @@
+#pragma once
+#include<DirectXMath.h>
+#include<emmintrin.h>
+using namespace DirectX;
+
+//xoshiro128+, blackman and vigna 2018, run as four generators side by side in sse2 lanes so
+//every call gives four numbers at once. seeded once from a 64 bit seed through splitmix64,
+//the same seed always gives the same numbers, which replays and benchmarks rely on
+class Xoshiro128
+{
+	__m128i state[4];
+
+public:
+	Xoshiro128(unsigned long long seed = 0);
+
+	void Seed(unsigned long long seed);
+	//four random 32 bit numbers, one from each lane
+	__m128i Next4();
+	//four floats in [0, 1), from the top 23 bits where xoshiro128+ is strongest
+	XMVECTOR NextFloat4();
+	//four floats in [-1, 1)
+	XMVECTOR NextSigned4();
+};